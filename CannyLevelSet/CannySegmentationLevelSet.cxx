@@ -279,7 +279,7 @@ CannySegmentationLevelSet
     return;
     }
   this->RunCanny();
-  m_OutputLevelSetViewer.SetImage( m_CannyFilter->GetOutput() );  
+  m_OutputLevelSetViewer.SetImage( this->GetLevelSetImage() );  
   m_OutputLevelSetViewer.Show();
 
 }
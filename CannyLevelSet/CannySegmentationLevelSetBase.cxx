@@ -16,6 +16,8 @@
 =========================================================================*/
 
 #include "CannySegmentationLevelSetBase.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
 #include <FL/fl_ask.H>
 
 
@@ -77,6 +79,15 @@ CannySegmentationLevelSetBase
   m_CannyEdgesThresholdFilter->SetInsideValue( 0 );
   m_CannyEdgesThresholdFilter->SetOutsideValue( 1 );
 
+  m_BrickedEvolution = BrickedEvolutionType::New();
+  m_BrickedEvolution->SetFilter( m_CannyFilter );
+  m_BrickedEvolution->SetInitialImage( m_FastMarchingFilter->GetOutput() );
+  m_BrickedEvolution->SetFeatureImage( m_CastImageFilter->GetOutput() );
+
+  m_UseBrickedLevelSet = false;
+  m_BrickedFilterTime = 0;
+  m_BrickedInitialTime = 0;
+
   m_SeedImage = SeedImageType::New();
 
   m_SeedValue = 0; // It must be set to the minus distance of the initial level set.
@@ -196,6 +207,10 @@ CannySegmentationLevelSetBase
 
   m_FastMarchingFilter->SetOutputSize( region.GetSize() );
 
+  m_BrickedEvolution->ReleaseFeatureCache();
+  m_BrickedLevelSetImage = 0;
+  m_BrickedCannyImage = 0;
+
   m_InputImageIsLoaded = true;
 
 }
@@ -361,7 +376,21 @@ CannySegmentationLevelSetBase
     this->ComputeEdgePotential();
     this->ComputeFastMarching();
     this->ShowStatus("Computing CannySegmentationLevelSet Filter");
-    m_CannyFilter->Update();
+    if( m_UseBrickedLevelSet )
+      {
+      this->RunBrickedCanny();
+      }
+    else
+      {
+      m_BrickedLevelSetImage = 0;
+      m_BrickedCannyImage = 0;
+      m_CannyFilter->SetInput(  m_FastMarchingFilter->GetOutput() );
+      m_CannyFilter->SetFeatureImage(   m_CastImageFilter->GetOutput() );
+      m_ThresholdFilter->SetInput( m_CannyFilter->GetOutput() );
+      m_CannyEdgesThresholdFilter->SetInput( m_CannyFilter->GetCannyImage() );
+      m_ItkExporter1->SetInput( m_CannyFilter->GetOutput() );
+      m_CannyFilter->Update();
+      }
     m_CannyEdgesThresholdFilter->Update();
     }
   catch( itk::ExceptionObject & exp )
@@ -375,6 +404,116 @@ CannySegmentationLevelSetBase
 
 
 
+/************************************
+ *
+ *  Run Canny on bricks
+ *
+ ***********************************/
+void
+CannySegmentationLevelSetBase
+::RunBrickedCanny( void )
+{
+  // Nothing to do if neither the parameters nor the zero set changed
+  const unsigned long initialTime = 
+                    m_FastMarchingFilter->GetOutput()->GetUpdateMTime();
+  if( m_BrickedLevelSetImage &&
+      m_CannyFilter->GetMTime() == m_BrickedFilterTime &&
+      initialTime == m_BrickedInitialTime )
+    {
+    return;
+    }
+
+  m_BrickedEvolution->SetIsoSurfaceValue( m_CannyFilter->GetIsoSurfaceValue() );
+  m_BrickedEvolution->Update();
+
+  m_BrickedLevelSetImage = m_BrickedEvolution->MakeVolumeOutput();
+  m_BrickedCannyImage = this->PasteInVolume( m_CannyFilter->GetCannyImage(),
+                          itk::NumericTraits<InternalPixelType>::Zero );
+
+  m_ThresholdFilter->SetInput( m_BrickedLevelSetImage );
+  m_CannyEdgesThresholdFilter->SetInput( m_BrickedCannyImage );
+  m_ItkExporter1->SetInput( m_BrickedLevelSetImage );
+
+  m_BrickedFilterTime = m_CannyFilter->GetMTime();
+  m_BrickedInitialTime = initialTime;
+
+  std::cout << "Canny level set on " 
+            << m_BrickedEvolution->GetRegion().GetSize()
+            << " pixels, " << m_BrickedEvolution->GetNumberOfRounds()
+            << " rounds, " << m_BrickedEvolution->GetNumberOfFeatureBricks()
+            << " of " << m_BrickedEvolution->GetNumberOfBricks()
+            << " feature bricks computed" << std::endl;
+}
+
+
+
+
+/************************************
+ *
+ *  Paste a region in the volume
+ *
+ ***********************************/
+CannySegmentationLevelSetBase::InternalImageType::Pointer
+CannySegmentationLevelSetBase
+::PasteInVolume( const InternalImageType * image, InternalPixelType background )
+{
+  const InternalImageType * volume = m_CastImageFilter->GetOutput();
+
+  InternalImageType::Pointer pasted = InternalImageType::New();
+  pasted->CopyInformation( volume );
+  pasted->SetRegions( volume->GetLargestPossibleRegion() );
+  pasted->Allocate();
+  pasted->FillBuffer( background );
+
+  typedef itk::ImageRegionConstIterator< InternalImageType > InputIteratorType;
+  typedef itk::ImageRegionIterator< InternalImageType >      OutputIteratorType;
+  InputIteratorType  in( image, image->GetBufferedRegion() );
+  OutputIteratorType out( pasted, image->GetBufferedRegion() );
+  for( ; !in.IsAtEnd(); ++in, ++out )
+    {
+    out.Set( in.Get() );
+    }
+
+  return pasted;
+}
+
+
+
+
+/************************************
+ *
+ *  Use the bricked evolution
+ *
+ ***********************************/
+void
+CannySegmentationLevelSetBase
+::SetUseBrickedLevelSet( bool value )
+{
+  m_UseBrickedLevelSet = value;
+}
+
+
+
+
+/************************************
+ *
+ *  Level set image
+ *
+ ***********************************/
+CannySegmentationLevelSetBase::InternalImageType *
+CannySegmentationLevelSetBase
+::GetLevelSetImage( void )
+{
+  if( m_BrickedLevelSetImage )
+    {
+    return m_BrickedLevelSetImage;
+    }
+  return m_CannyFilter->GetOutput();
+}
+
+
+
+
 /************************************
  *
  *  Stop Segmentation
@@ -27,6 +27,7 @@
 #include "itkBinaryThresholdImageFilter.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkBrickedLevelSetEvolution.h"
 
 #include "itkVTKImageExport.h"
 #include "vtkImageImport.h"
@@ -128,6 +129,11 @@ public:
   typedef FastMarchingFilterType::NodeContainer           NodeContainer;
 
 
+  /** Runs the Canny level set on the bricks around the zero set only */
+  typedef   itk::BrickedLevelSetEvolution< 
+                               CannyFilterType,
+                               InternalImageType >     BrickedEvolutionType;
+
   /** Types for the visualization pipeline */
   typedef itk::VTKImageExport< InternalImageType >        ExportFilterType;
 
@@ -163,12 +169,25 @@ public:
 
   virtual void SetThreshold( double value );
 
+  virtual void SetUseBrickedLevelSet( bool value );
+
+  /** Level set over the whole volume */
+  InternalImageType * GetLevelSetImage();
+
 
 protected:
 
   virtual void ConnectPipelines( vtkImageImport * importer, 
                                  ExportFilterType * exporter );
 
+  /** Run the Canny filter on the bricks around the zero set of the fast
+      marching, and paste its outputs in images of the whole volume */
+  virtual void RunBrickedCanny();
+
+  /** Image of the whole volume with the given region image pasted */
+  InternalImageType::Pointer PasteInVolume( const InternalImageType * image,
+                                            InternalPixelType background );
+
 
   ImageReaderType::Pointer                    m_ImageReader;
 
@@ -184,6 +203,18 @@ protected:
 
   CannyFilterType::Pointer                    m_CannyFilter;
 
+  BrickedEvolutionType::Pointer               m_BrickedEvolution;
+
+  bool                                        m_UseBrickedLevelSet;
+
+  InternalImageType::Pointer                  m_BrickedLevelSetImage;
+
+  InternalImageType::Pointer                  m_BrickedCannyImage;
+
+  unsigned long                               m_BrickedFilterTime;
+
+  unsigned long                               m_BrickedInitialTime;
+
   DerivativeFilterType::Pointer               m_DerivativeFilter;
 
   SigmoidFilterType::Pointer                  m_SigmoidFilter;
@@ -75,6 +75,7 @@ ceExtractorConsole
   progressSlider->Observe( m_ParametricSpace.GetPointer() );
   progressSlider->Observe( m_SpatialFunctionFilter.GetPointer() );
   progressSlider->Observe( m_InverseParametricFilter.GetPointer() );
+  progressSlider->Observe( m_FusedCurvePoints.GetPointer() );
 
 
   loadButton->Observe( m_Reader.GetPointer() );
@@ -88,6 +89,7 @@ ceExtractorConsole
   lambda3Button->Observe( m_EigenCastfilter3.GetPointer() );
   parametricSpaceButton->Observe( m_ParametricSpace.GetPointer() );
   extractedParametricPointsButton->Observe( m_SpatialFunctionFilter.GetPointer() );
+  extractedParametricPointsButton->Observe( m_FusedCurvePoints.GetPointer() );
   curve3DPointsButton->Observe( m_InverseParametricFilter.GetPointer() );
 
   m_Reader->AddObserver( itk::ModifiedEvent(), modulusButton->GetRedrawCommand() );
@@ -509,7 +511,14 @@ ceExtractorConsole
 ::ShowExtractedParametricPoints( void )
 {
 
-  m_SpatialFunctionFilter->Update(); 
+  if( m_UseFusedHessian )
+    {
+    m_FusedCurvePoints->Update();
+    }
+  else
+    {
+    m_SpatialFunctionFilter->Update(); 
+    }
   m_ExtractedParametricSpaceViewer.Show();
   this->ResetViewOfExtractedParametricSpace();
 
@@ -705,6 +714,18 @@ ceExtractorConsole
     fl_alert( expt.GetDescription() );
     }
 
+  // The extracted points come from the filter that ran
+  if( m_UseFusedHessian )
+    {
+    m_ExtractedParametricSpaceSamplesShape->SetPointSet( 
+                            m_FusedCurvePoints->GetOutput() );
+    }
+  else
+    {
+    m_ExtractedParametricSpaceSamplesShape->SetPointSet( 
+                            m_SpatialFunctionFilter->GetOutput() );
+    }
+
 
   this->ShowStatus("Done ");
   
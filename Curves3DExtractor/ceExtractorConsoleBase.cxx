@@ -33,6 +33,8 @@ ceExtractorConsoleBase
 
   m_ImageLoaded = false;
 
+  m_UseFusedHessian = false;
+
   m_Reader     = VolumeReaderType::New();
 
   //  || Gradient( Image ) ||
@@ -115,6 +117,13 @@ ceExtractorConsoleBase
   m_SpatialFunctionControl->SetRadius( 1.0f );
 #endif
   
+  // Same candidate points, computed slab by slab without the intermediate
+  // Hessian and eigenvalue images. Shares the spatial function above.
+  m_FusedCurvePoints = FusedCurvePointsFilterType::New();
+  m_FusedCurvePoints->SetInput( m_Reader->GetOutput() );
+  m_FusedCurvePoints->SetSpatialFunction( 
+                  m_SpatialFunctionFilter->GetSpatialFunction() );
+
   m_InverseParametricFilter = InverseParametricFilterType::New();
   m_InverseParametricFilter->SetInput( 
       m_SpatialFunctionFilter->GetOutput() );
@@ -229,6 +238,23 @@ ceExtractorConsoleBase
 {
   m_GradientMagnitude->SetSigma( value );
   m_Hessian->SetSigma( value );
+  m_FusedCurvePoints->SetSigma( value );
+}
+
+
+
+
+ 
+/************************************
+ *
+ *  Set Use Fused Hessian
+ *
+ ***********************************/
+void
+ceExtractorConsoleBase 
+::SetUseFusedHessian( bool value )
+{
+  m_UseFusedHessian = value;
 }
 
 
@@ -250,6 +276,24 @@ ceExtractorConsoleBase
     ShowStatus("Please load an image first");
     return;
   }
+
+  if( m_UseFusedHessian )
+  {
+    // The spatial function may have been edited through its control,
+    // which does not modify this filter.
+    m_FusedCurvePoints->Modified();
+    m_FusedCurvePoints->Update();
+
+    // The accepted points take the place of the output of the spatial
+    // function filter. The whole parametric space is only computed when
+    // it is shown.
+    m_InverseParametricFilter->SetInput( m_FusedCurvePoints->GetOutput() );
+    m_InverseParametricFilter->Update();
+    return;
+  }
+
+  m_InverseParametricFilter->SetInput( 
+      m_SpatialFunctionFilter->GetOutput() );
   
   m_EigenFilter->UpdateLargestPossibleRegion();
 
@@ -267,6 +311,8 @@ ceExtractorConsoleBase
   
   m_ParametricSpace->Update();
 
+  m_InverseParametricFilter->Update();
+
 }
 
 
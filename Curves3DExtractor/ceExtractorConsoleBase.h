@@ -40,6 +40,7 @@
 #include "itkJoinImageFilter.h"
 #include "PixelAccessors.h"
 #include "itkUnaryFunctorImageFilter.h"
+#include "itkFusedHessianCurvePointsFilter.h"
 
 // Define which type of spatial function to use
 // Only one of the following lines should be uncommented.
@@ -164,6 +165,14 @@ public:
                                       ImageSpaceMeshType 
                                       >         InverseParametricFilterType;
 
+  // Single pass, slab-streamed replacement of the Hessian -> eigenvalues
+  // -> parametric space -> spatial function chain.
+  typedef itk::FusedHessianCurvePointsFilter<
+                                      InputImageType,
+                                      MeshType,
+                                      SpatialFunctionType
+                                      >         FusedCurvePointsFilterType;
+
   typedef itk::PointSetToImageFilter< MeshType, ImageType > 
                                               PointSetToImageFilterType;
 
@@ -189,6 +198,7 @@ public:
   virtual void HideSpatialFunctionControl( void );
   virtual void Execute(void);
   virtual void SetSigma( RealType );
+  virtual void SetUseFusedHessian( bool );
 
 protected:
   VolumeReaderType::Pointer               m_Reader;
@@ -215,6 +225,8 @@ protected:
 
   SpatialFunctionControlType::Pointer     m_SpatialFunctionControl;
 
+  FusedCurvePointsFilterType::Pointer     m_FusedCurvePoints;
+
   InverseParametricFilterType::Pointer    m_InverseParametricFilter;
 
   PointSetToImageFilterType::Pointer      m_PointSetToImageFilter;
@@ -229,6 +241,8 @@ protected:
 
   bool   m_ImageLoaded;
 
+  bool   m_UseFusedHessian;
+
 };
 
 
@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkFusedHessianCurvePointsFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkFusedHessianCurvePointsFilter_h
+#define __itkFusedHessianCurvePointsFilter_h
+
+#include <vector>
+
+#include "itkImageToMeshFilter.h"
+#include "itkMultiThreader.h"
+
+namespace itk
+{
+
+/** \class FusedHessianCurvePointsFilter
+ *
+ * Computes, in one pass over a 3D image, what the chain
+ * HessianRecursiveGaussianImageFilter -> SymmetricEigenAnalysisImageFilter
+ * -> ImageToParametricSpaceFilter -> InteriorExteriorMeshFilter produces:
+ * a mesh whose points are the Hessian eigenvalues (largest, middle,
+ * smallest) of the voxels that fall inside a spatial function, and whose
+ * point data is the physical position of each voxel.
+ *
+ * The volume is processed in slabs of SlabThickness slices. For each slab
+ * the six Hessian components are obtained by separable convolution with
+ * sampled Gaussian derivative kernels (in float), the eigenvalues are
+ * computed with the closed-form trigonometric solution for symmetric 3x3
+ * matrices, and only the voxels accepted by the spatial function are
+ * appended to the output. Peak memory is therefore a few float slabs plus
+ * the accepted points, instead of the full Hessian and eigenvalue images.
+ * Slices of a slab are shared among threads.
+ *
+ * The output mesh can be fed directly to
+ * ParametricSpaceToImageSpaceMeshFilter.
+ *
+ */
+template <class TInputImage, class TOutputMesh, class TSpatialFunction>
+class ITK_EXPORT FusedHessianCurvePointsFilter :
+    public ImageToMeshFilter<TInputImage, TOutputMesh>
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef FusedHessianCurvePointsFilter Self;
+  typedef ImageToMeshFilter<TInputImage, TOutputMesh> Superclass;
+  typedef SmartPointer<Self> Pointer;
+  typedef SmartPointer<const Self>  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(FusedHessianCurvePointsFilter, ImageToMeshFilter);
+
+  /** Input image types. */
+  typedef TInputImage                              InputImageType;
+  typedef typename InputImageType::ConstPointer    InputImageConstPointer;
+  typedef typename InputImageType::PixelType       InputPixelType;
+  typedef typename InputImageType::RegionType      InputRegionType;
+  typedef typename InputImageType::IndexType       InputIndexType;
+  typedef typename InputImageType::SizeType        InputSizeType;
+
+  /** Output mesh types. */
+  typedef TOutputMesh                              OutputMeshType;
+  typedef typename OutputMeshType::Pointer         OutputMeshPointer;
+  typedef typename OutputMeshType::PointType       PointType;
+  typedef typename OutputMeshType::PixelType       PointDataType;
+
+  /** Spatial function selecting the candidate points. */
+  typedef TSpatialFunction                         SpatialFunctionType;
+  typedef typename SpatialFunctionType::Pointer    SpatialFunctionPointer;
+
+  /** Set/Get the sigma of the Gaussian, in physical units. */
+  itkSetMacro( Sigma, double );
+  itkGetConstMacro( Sigma, double );
+
+  /** Set/Get the number of slices computed at once. */
+  itkSetMacro( SlabThickness, unsigned int );
+  itkGetConstMacro( SlabThickness, unsigned int );
+
+  /** Set/Get the spatial function. If not set, all voxels are kept. */
+  itkSetObjectMacro( SpatialFunction, SpatialFunctionType );
+  itkGetObjectMacro( SpatialFunction, SpatialFunctionType );
+
+  /** Set/Get the number of threads. */
+  itkSetClampMacro( NumberOfThreads, int, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, int );
+
+protected:
+  FusedHessianCurvePointsFilter();
+  virtual ~FusedHessianCurvePointsFilter() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** The output mesh has no image-like information to propagate. */
+  virtual void GenerateOutputInformation() {};
+
+  virtual void GenerateData();
+
+private:
+  FusedHessianCurvePointsFilter( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  typedef std::vector<float>   KernelType;
+
+  /** Accepted point and its position, collected per thread. */
+  struct Candidate
+    {
+    PointType     m_Eigen;
+    PointDataType m_Position;
+    };
+  typedef std::vector<Candidate> CandidateListType;
+
+  /** Sampled Gaussian, first and second derivative kernels. */
+  void BuildKernels( double sigma, KernelType kernels[3] ) const;
+
+  /** Per slab work, split by slices among threads. */
+  static ITK_THREAD_RETURN_TYPE SlabThreaderCallback( void * arg );
+  void ProcessSlices( long firstSlice, long lastSlice,
+                      CandidateListType & candidates );
+
+  /** 1D convolution of a strided line with edge clamping. */
+  static void ConvolveLine( const float * in, float * out, long length,
+                            long stride, const KernelType & kernel );
+
+  double                         m_Sigma;
+  unsigned int                   m_SlabThickness;
+  SpatialFunctionPointer         m_SpatialFunction;
+  int                            m_NumberOfThreads;
+
+  /** Kernels along each axis: [axis][order]. */
+  KernelType                     m_Kernels[3][3];
+
+  /** State of the slab being processed. */
+  InputSizeType                  m_Size;
+  InputIndexType                 m_Start;
+  long                           m_SlabBegin;
+  long                           m_SlabEnd;
+  long                           m_SlabHaloBegin;
+  std::vector<float>             m_SlabInput;
+  std::vector<CandidateListType> m_ThreadCandidates;
+
+  MultiThreader::Pointer         m_Threader;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkFusedHessianCurvePointsFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,404 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkFusedHessianCurvePointsFilter.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkFusedHessianCurvePointsFilter_txx
+#define __itkFusedHessianCurvePointsFilter_txx
+
+#include "itkFusedHessianCurvePointsFilter.h"
+#include "vnl/vnl_math.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <class TInputImage, class TOutputMesh, class TSpatialFunction>
+FusedHessianCurvePointsFilter<TInputImage,TOutputMesh,TSpatialFunction>
+::FusedHessianCurvePointsFilter()
+{
+  m_Sigma           = 1.0;
+  m_SlabThickness   = 16;
+  m_SpatialFunction = NULL;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  m_Size.Fill( 0 );
+  m_Start.Fill( 0 );
+  m_SlabBegin     = 0;
+  m_SlabEnd       = 0;
+  m_SlabHaloBegin = 0;
+
+  m_Threader = MultiThreader::New();
+}
+
+
+template <class TInputImage, class TOutputMesh, class TSpatialFunction>
+void
+FusedHessianCurvePointsFilter<TInputImage,TOutputMesh,TSpatialFunction>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Sigma: " << m_Sigma << std::endl;
+  os << indent << "SlabThickness: " << m_SlabThickness << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+}
+
+
+template <class TInputImage, class TOutputMesh, class TSpatialFunction>
+void
+FusedHessianCurvePointsFilter<TInputImage,TOutputMesh,TSpatialFunction>
+::BuildKernels( double sigma, KernelType kernels[3] ) const
+{
+  // sigma is in pixels here. The kernels are applied as correlations, so
+  // the odd derivative kernel is stored mirrored.
+  const long radius = std::max( 1L,
+    static_cast<long>( vcl_ceil( 4.0 * sigma ) ) );
+  const long length = 2 * radius + 1;
+
+  std::vector<double> g( length );
+  double sum = 0.0;
+  for ( long k = 0; k < length; k++ )
+    {
+    const double t = k - radius;
+    g[k] = vcl_exp( -0.5 * t * t / ( sigma * sigma ) );
+    sum += g[k];
+    }
+
+  kernels[0].resize( length );
+  kernels[1].resize( length );
+  kernels[2].resize( length );
+
+  // Normalize so that the smoothing kernel preserves constants, the first
+  // derivative returns 1 on a unit ramp and the second derivative returns
+  // 2 on a unit parabola.
+  double moment1 = 0.0;
+  double mean2   = 0.0;
+  for ( long k = 0; k < length; k++ )
+    {
+    const double t = k - radius;
+    g[k] /= sum;
+    moment1 += t * ( t * g[k] );
+    mean2   += ( t * t / ( sigma * sigma ) - 1.0 ) * g[k] / ( sigma * sigma );
+    }
+  mean2 /= length;
+
+  double moment2 = 0.0;
+  std::vector<double> d2( length );
+  for ( long k = 0; k < length; k++ )
+    {
+    const double t = k - radius;
+    d2[k] = ( t * t / ( sigma * sigma ) - 1.0 ) * g[k] / ( sigma * sigma ) - mean2;
+    moment2 += 0.5 * t * t * d2[k];
+    }
+
+  for ( long k = 0; k < length; k++ )
+    {
+    const double t = k - radius;
+    kernels[0][k] = static_cast<float>( g[k] );
+    kernels[1][k] = static_cast<float>( t * g[k] / moment1 );
+    kernels[2][k] = static_cast<float>( d2[k] / moment2 );
+    }
+}
+
+
+template <class TInputImage, class TOutputMesh, class TSpatialFunction>
+void
+FusedHessianCurvePointsFilter<TInputImage,TOutputMesh,TSpatialFunction>
+::ConvolveLine( const float * in, float * out, long length, long stride,
+                const KernelType & kernel )
+{
+  const long radius = static_cast<long>( kernel.size() ) / 2;
+  const long size   = static_cast<long>( kernel.size() );
+
+  for ( long i = 0; i < length; i++ )
+    {
+    float value = 0.0f;
+    if ( i >= radius && i + radius < length )
+      {
+      const float * src = in + ( i - radius ) * stride;
+      for ( long k = 0; k < size; k++ )
+        {
+        value += kernel[k] * src[ k * stride ];
+        }
+      }
+    else
+      {
+      for ( long k = 0; k < size; k++ )
+        {
+        const long j = std::min( std::max( i + k - radius, 0L ), length - 1 );
+        value += kernel[k] * in[ j * stride ];
+        }
+      }
+    out[ i * stride ] = value;
+    }
+}
+
+
+template <class TInputImage, class TOutputMesh, class TSpatialFunction>
+void
+FusedHessianCurvePointsFilter<TInputImage,TOutputMesh,TSpatialFunction>
+::ProcessSlices( long firstSlice, long lastSlice,
+                 CandidateListType & candidates )
+{
+  const long nx = m_Size[0];
+  const long ny = m_Size[1];
+  const long nz = m_Size[2];
+  const long sliceSize = nx * ny;
+
+  InputImageConstPointer inputImage = this->GetInput();
+
+  // z-derivatives of order 0..2, then the six (z,y) combinations needed
+  // for the Hessian, then one row of each Hessian component.
+  std::vector<float> zPass( 3 * sliceSize );
+  std::vector<float> yPass( 6 * sliceSize );
+  std::vector<float> rows( 6 * nx );
+  std::vector<float> eigen( 3 * nx );
+
+  // (z order, y order, x order) of Hxx, Hxy, Hyy, Hxz, Hyz, Hzz.
+  static const unsigned int zOrder[6] = { 0, 0, 0, 1, 1, 2 };
+  static const unsigned int yOrder[6] = { 0, 1, 2, 0, 1, 0 };
+  static const unsigned int xOrder[6] = { 2, 1, 0, 1, 0, 0 };
+
+  const double twoThirdsPi = 2.0 * vnl_math::pi / 3.0;
+
+  for ( long z = firstSlice; z < lastSlice; z++ )
+    {
+    // Along z, reading the halo slab.
+    for ( unsigned int order = 0; order < 3; order++ )
+      {
+      const KernelType & kernel = m_Kernels[2][order];
+      const long radius = static_cast<long>( kernel.size() ) / 2;
+      float * out = &zPass[ order * sliceSize ];
+      std::fill( out, out + sliceSize, 0.0f );
+      for ( long k = 0; k < static_cast<long>( kernel.size() ); k++ )
+        {
+        const long zz = std::min( std::max( z + k - radius, 0L ), nz - 1 );
+        const float * in = &m_SlabInput[ ( zz - m_SlabHaloBegin ) * sliceSize ];
+        const float w = kernel[k];
+        for ( long i = 0; i < sliceSize; i++ )
+          {
+          out[i] += w * in[i];
+          }
+        }
+      }
+
+    // Along y, column by column.
+    for ( unsigned int c = 0; c < 6; c++ )
+      {
+      const float * in = &zPass[ zOrder[c] * sliceSize ];
+      float * out = &yPass[ c * sliceSize ];
+      for ( long x = 0; x < nx; x++ )
+        {
+        ConvolveLine( in + x, out + x, ny, nx, m_Kernels[1][ yOrder[c] ] );
+        }
+      }
+
+    // Along x, then eigenvalues and selection row by row.
+    for ( long y = 0; y < ny; y++ )
+      {
+      for ( unsigned int c = 0; c < 6; c++ )
+        {
+        ConvolveLine( &yPass[ c * sliceSize + y * nx ], &rows[ c * nx ], nx, 1,
+                      m_Kernels[0][ xOrder[c] ] );
+        }
+
+      const float * hxx = &rows[0];
+      const float * hxy = &rows[nx];
+      const float * hyy = &rows[2 * nx];
+      const float * hxz = &rows[3 * nx];
+      const float * hyz = &rows[4 * nx];
+      const float * hzz = &rows[5 * nx];
+      float * e1 = &eigen[0];
+      float * e2 = &eigen[nx];
+      float * e3 = &eigen[2 * nx];
+
+      // Closed-form eigenvalues of a symmetric 3x3 matrix. The loop body
+      // has no data dependent branches so it vectorizes across the row.
+      for ( long x = 0; x < nx; x++ )
+        {
+        const float q  = ( hxx[x] + hyy[x] + hzz[x] ) / 3.0f;
+        const float p1 = hxy[x] * hxy[x] + hxz[x] * hxz[x] + hyz[x] * hyz[x];
+        const float a  = hxx[x] - q;
+        const float b  = hyy[x] - q;
+        const float c  = hzz[x] - q;
+        const float p2 = a * a + b * b + c * c + 2.0f * p1;
+        const float p  = std::sqrt( p2 / 6.0f );
+        const float inv = 1.0f / std::max( p, 1e-30f );
+
+        const float b00 = a * inv;
+        const float b11 = b * inv;
+        const float b22 = c * inv;
+        const float b01 = hxy[x] * inv;
+        const float b02 = hxz[x] * inv;
+        const float b12 = hyz[x] * inv;
+        const float det = b00 * ( b11 * b22 - b12 * b12 )
+                        - b01 * ( b01 * b22 - b12 * b02 )
+                        + b02 * ( b01 * b12 - b11 * b02 );
+        const float r   = std::min( std::max( 0.5f * det, -1.0f ), 1.0f );
+        const float phi = std::acos( r ) / 3.0f;
+
+        e1[x] = q + 2.0f * p * std::cos( phi );
+        e3[x] = q + 2.0f * p * std::cos( phi + static_cast<float>( twoThirdsPi ) );
+        e2[x] = 3.0f * q - e1[x] - e3[x];
+        }
+
+      for ( long x = 0; x < nx; x++ )
+        {
+        Candidate candidate;
+        candidate.m_Eigen[0] = e1[x];
+        candidate.m_Eigen[1] = e2[x];
+        candidate.m_Eigen[2] = e3[x];
+        if ( m_SpatialFunction && !m_SpatialFunction->Evaluate( candidate.m_Eigen ) )
+          {
+          continue;
+          }
+
+        InputIndexType index;
+        index[0] = m_Start[0] + x;
+        index[1] = m_Start[1] + y;
+        index[2] = m_Start[2] + z;
+        Point<double, 3> position;
+        inputImage->TransformIndexToPhysicalPoint( index, position );
+        for ( unsigned int d = 0; d < 3; d++ )
+          {
+          candidate.m_Position[d] = position[d];
+          }
+        candidates.push_back( candidate );
+        }
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputMesh, class TSpatialFunction>
+ITK_THREAD_RETURN_TYPE
+FusedHessianCurvePointsFilter<TInputImage,TOutputMesh,TSpatialFunction>
+::SlabThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+
+  const long threadId = info->ThreadID;
+  const long numberOfThreads = info->NumberOfThreads;
+  const long slices = self->m_SlabEnd - self->m_SlabBegin;
+  const long chunk = ( slices + numberOfThreads - 1 ) / numberOfThreads;
+  const long first = self->m_SlabBegin + std::min( threadId * chunk, slices );
+  const long last  = self->m_SlabBegin + std::min( ( threadId + 1 ) * chunk, slices );
+
+  if ( first < last )
+    {
+    self->ProcessSlices( first, last, self->m_ThreadCandidates[threadId] );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TInputImage, class TOutputMesh, class TSpatialFunction>
+void
+FusedHessianCurvePointsFilter<TInputImage,TOutputMesh,TSpatialFunction>
+::GenerateData()
+{
+  InputImageConstPointer inputImage = this->GetInput();
+  if ( !inputImage )
+    {
+    itkExceptionMacro( << "Input image not set" );
+    }
+  if ( InputImageType::ImageDimension != 3 )
+    {
+    itkExceptionMacro( << "Only 3D images are supported" );
+    }
+
+  const InputRegionType region = inputImage->GetBufferedRegion();
+  m_Size  = region.GetSize();
+  m_Start = region.GetIndex();
+
+  for ( unsigned int d = 0; d < 3; d++ )
+    {
+    const double spacing = inputImage->GetSpacing()[d];
+    this->BuildKernels( m_Sigma / spacing, m_Kernels[d] );
+    for ( unsigned int k = 0; k < m_Kernels[d][1].size(); k++ )
+      {
+      m_Kernels[d][1][k] /= spacing;
+      m_Kernels[d][2][k] /= spacing * spacing;
+      }
+    }
+
+  const long nz = m_Size[2];
+  const long sliceSize = m_Size[0] * m_Size[1];
+  const long zRadius = static_cast<long>( m_Kernels[2][0].size() ) / 2;
+  const long thickness = std::max( 1L, static_cast<long>( m_SlabThickness ) );
+
+  m_Threader->SetNumberOfThreads( m_NumberOfThreads );
+  m_Threader->SetSingleMethod( Self::SlabThreaderCallback, this );
+
+  CandidateListType candidates;
+  const InputPixelType * buffer = inputImage->GetBufferPointer();
+
+  for ( m_SlabBegin = 0; m_SlabBegin < nz; m_SlabBegin += thickness )
+    {
+    m_SlabEnd = std::min( m_SlabBegin + thickness, nz );
+    m_SlabHaloBegin = std::max( m_SlabBegin - zRadius, 0L );
+    const long haloEnd = std::min( m_SlabEnd + zRadius, nz );
+
+    // Only the slab and its halo are converted to float.
+    m_SlabInput.resize( ( haloEnd - m_SlabHaloBegin ) * sliceSize );
+    const InputPixelType * src = buffer + m_SlabHaloBegin * sliceSize;
+    for ( unsigned long i = 0; i < m_SlabInput.size(); i++ )
+      {
+      m_SlabInput[i] = static_cast<float>( src[i] );
+      }
+
+    m_ThreadCandidates.assign( m_NumberOfThreads, CandidateListType() );
+    m_Threader->SingleMethodExecute();
+
+    // Threads own consecutive slices, so appending in thread order keeps
+    // the points in raster order.
+    for ( unsigned int t = 0; t < m_ThreadCandidates.size(); t++ )
+      {
+      candidates.insert( candidates.end(),
+        m_ThreadCandidates[t].begin(), m_ThreadCandidates[t].end() );
+      }
+
+    this->UpdateProgress( static_cast<float>( m_SlabEnd ) / nz );
+    }
+
+  m_SlabInput.clear();
+  m_ThreadCandidates.clear();
+
+  OutputMeshPointer outputMesh = this->GetOutput();
+
+  typename OutputMeshType::PointsContainer::Pointer points =
+    OutputMeshType::PointsContainer::New();
+  typename OutputMeshType::PointDataContainer::Pointer pointData =
+    OutputMeshType::PointDataContainer::New();
+  points->Reserve( candidates.size() );
+  pointData->Reserve( candidates.size() );
+
+  for ( unsigned long id = 0; id < candidates.size(); id++ )
+    {
+    points->SetElement( id, candidates[id].m_Eigen );
+    pointData->SetElement( id, candidates[id].m_Position );
+    }
+
+  outputMesh->SetPoints( points );
+  outputMesh->SetPointData( pointData );
+}
+
+} // end namespace itk
+
+#endif
@@ -287,24 +287,26 @@ DeformableModelApplication
 
  vtkPolyData* vgrid = vtkPolyData::New();
 
- // Create the vtkPoints object and set the number of points
+ // Create the vtkPoints object and set the number of points, in double
+ // precision like the itk mesh
  vtkPoints* vpoints = vtkPoints::New();
+ vpoints->SetDataTypeToDouble();
  vpoints->SetNumberOfPoints(numPoints);
 
  // iterate over all the points in the itk mesh filling in
- // the vtkPoints object as we go
+ // the raw vtkPoints array as we go
+ double * vpointsArray = static_cast<double *>( vpoints->GetVoidPointer(0) );
  SimplexMeshType::PointsContainer::Pointer points = m_SimplexMeshToShow->GetPoints();
  for(SimplexMeshType::PointsContainer::Iterator i = points->Begin();
      i != points->End(); ++i)
    {
      // Get the point index from the point container iterator
      int idx = i->Index();
-     // Set the vtk point at the index with the the coord array from itk
-     // itk returns a const pointer, but vtk is not const correct, so
-     // we have to use a const cast to get rid of the const
-     vtkFloatingPointType * pp = const_cast<vtkFloatingPointType*>(i->Value().GetDataPointer());
-
-     vpoints->SetPoint(idx, pp);
+     // Copy the coordinates from itk at the point index
+     const double * pp = i->Value().GetDataPointer();
+     vpointsArray[3*idx]   = pp[0];
+     vpointsArray[3*idx+1] = pp[1];
+     vpointsArray[3*idx+2] = pp[2];
 
    }
 
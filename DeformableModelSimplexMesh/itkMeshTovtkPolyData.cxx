@@ -15,9 +15,9 @@ itkMeshTovtkPolyData
 {
 
   m_itkTriangleMesh = TriangleMeshType::New();
-  m_Points = vtkPoints::New();
+  m_Points = NULL;
   m_PolyData = vtkPolyData::New();
-  m_Polys = vtkCellArray::New();
+  m_Polys = NULL;
 }
 
 
@@ -50,7 +50,6 @@ itkMeshTovtkPolyData
 
   InputPointsContainerPointer      myPoints = m_itkTriangleMesh->GetPoints();
   InputPointsContainerIterator     points = myPoints->Begin();
-  PointType point;
   
   if (numPoints == 0)
     {
@@ -58,17 +57,20 @@ itkMeshTovtkPolyData
       return; 
     }
 
+  // Fill the raw array of double precision vtkPoints, which holds the
+  // coordinates exactly as the itk::Mesh does.
+  m_Points = vtkPoints::New();
+  m_Points->SetDataTypeToDouble();
   m_Points->SetNumberOfPoints(numPoints);
-  
-  int idx=0;
-  double vpoint[3];
+
+  double * vpoint = static_cast<double *>( m_Points->GetVoidPointer(0) );
   while( points != myPoints->End() ) 
     {   
-    point = points.Value();
+    const PointType & point = points.Value();
     vpoint[0]= point[0];
     vpoint[1]= point[1];
     vpoint[2]= point[2];
-    m_Points->SetPoint(idx++,vpoint);
+    vpoint += 3;
     points++;
     }
 
@@ -76,15 +78,19 @@ itkMeshTovtkPolyData
 
   m_Points->Delete();
 
+  // Write the triangles into one connectivity array, in the vtkCellArray
+  // layout (3, id0, id1, id2, 3, ...), and hand it over in one call.
   CellsContainerPointer cells = m_itkTriangleMesh->GetCells();
   CellsContainerIterator cellIt = cells->Begin();
-  vtkIdType pts[3];
+
+  vtkIdTypeArray * connectivity = vtkIdTypeArray::New();
+  connectivity->SetNumberOfValues( 4 * cells->Size() );
+  vtkIdType * pts = connectivity->GetPointer(0);
+  vtkIdType numberOfTriangles = 0;
   while ( cellIt != cells->End() )
     {
-  CellType *nextCell = cellIt->Value();
+    CellType *nextCell = cellIt->Value();
     CellType::PointIdIterator pointIt = nextCell->PointIdsBegin() ;
-    PointType  p;
-    int i;
     
     switch (nextCell->GetType())
       {
@@ -93,12 +99,12 @@ itkMeshTovtkPolyData
       case CellType::POLYGON_CELL:
         break;        
       case CellType::TRIANGLE_CELL:
-        i=0;
+        *pts++ = 3;
         while (pointIt != nextCell->PointIdsEnd() ) 
         {
-        pts[i++] = *pointIt++;  
+        *pts++ = *pointIt++;  
         }
-        m_Polys->InsertNextCell(3,pts);
+        numberOfTriangles++;
         break;
       default:
         printf("something \n");
@@ -106,6 +112,11 @@ itkMeshTovtkPolyData
     cellIt++;
     
     }
+  connectivity->SetNumberOfValues( 4 * numberOfTriangles );
+
+  m_Polys = vtkCellArray::New();
+  m_Polys->SetCells( numberOfTriangles, connectivity );
+  connectivity->Delete();
   
   m_PolyData->SetPolys(m_Polys);
   m_Polys->Delete();
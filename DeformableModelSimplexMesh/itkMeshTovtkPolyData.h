@@ -3,6 +3,7 @@
 
 #include "vtkPoints.h"
 #include "vtkCellArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkPolyData.h"
 #include "itkDefaultDynamicMeshTraits.h"
 #include "itkMesh.h"
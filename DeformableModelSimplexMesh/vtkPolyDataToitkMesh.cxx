@@ -1,5 +1,7 @@
 
 #include <iostream>
+#include <utility>
+#include <vector>
 #include "vtkPolyDataToitkMesh.h"
 
 #ifndef vtkDoubleType
@@ -49,115 +51,117 @@ void
 vtkPolyDataToitkMesh
 ::ConvertvtkToitk()
 {
+  // A new mesh on every conversion, so that meshes handed out before are
+  // left untouched.
+  m_itkMesh = TriangleMeshType::New();
+
   //
-  // Transfer the points from the vtkPolyData into the itk::Mesh
+  // Transfer the points from the vtkPolyData into the itk::Mesh, reading
+  // the raw vtkPoints array. The point ids are increasing, so every point
+  // is inserted at the end of the map.
   //
   const unsigned int numberOfPoints = m_PolyData->GetNumberOfPoints();
   vtkPoints * vtkpoints =  m_PolyData->GetPoints();
- 
-  m_itkMesh->GetPoints()->Reserve( numberOfPoints );
-
-  for(unsigned int p =0; p < numberOfPoints; p++)
-    {
 
-    vtkFloatingPointType * apoint = vtkpoints->GetPoint( p );
-    m_itkMesh->SetPoint( p, TriangleMeshType::PointType( apoint ));
+  PointsContainerType::Pointer points = PointsContainerType::New();
+  PointsContainerType::STLContainerType & pointMap =
+    points->CastToSTLContainer();
 
-    // Need to convert the point to PoinType
-    TriangleMeshType::PointType pt;
-    for(unsigned int i=0;i<3; i++)
+  TriangleMeshType::PointType pt;
+  if( numberOfPoints > 0 && vtkpoints->GetDataType() == VTK_FLOAT )
+    {
+    const float * apoint =
+      static_cast<const float *>( vtkpoints->GetVoidPointer( 0 ) );
+    for(unsigned int p = 0; p < numberOfPoints; p++, apoint += 3)
       {
-       pt[i] = apoint[i];
-       }
-     m_itkMesh->SetPoint( p, pt);
-
+      pt[0] = apoint[0];
+      pt[1] = apoint[1];
+      pt[2] = apoint[2];
+      pointMap.insert( pointMap.end(), std::make_pair( p, pt ) );
+      }
     }
+  else if( numberOfPoints > 0 && vtkpoints->GetDataType() == VTK_DOUBLE )
+    {
+    const double * apoint =
+      static_cast<const double *>( vtkpoints->GetVoidPointer( 0 ) );
+    for(unsigned int p = 0; p < numberOfPoints; p++, apoint += 3)
+      {
+      pt[0] = apoint[0];
+      pt[1] = apoint[1];
+      pt[2] = apoint[2];
+      pointMap.insert( pointMap.end(), std::make_pair( p, pt ) );
+      }
+    }
+  else
+    {
+    double apoint[3];
+    for(unsigned int p = 0; p < numberOfPoints; p++)
+      {
+      vtkpoints->GetPoint( p, apoint );
+      pt[0] = apoint[0];
+      pt[1] = apoint[1];
+      pt[2] = apoint[2];
+      pointMap.insert( pointMap.end(), std::make_pair( p, pt ) );
+      }
+    }
+  m_itkMesh->SetPoints( points );
+
   //
-  // Transfer the cells from the vtkPolyData into the itk::Mesh
+  // Gather the point ids of all the triangles, from the triangle strips
+  // and then from the polygons, into one flat array.
   //
   vtkCellArray * triangleStrips = m_PolyData->GetStrips();
+  vtkCellArray * polygons = m_PolyData->GetPolys();
 
   vtkIdType  * cellPoints;
   vtkIdType    numberOfCellPoints;
 
-  //
-  // First count the total number of triangles from all the triangle strips.
-  //
-  unsigned int numberOfTriangles = 0;
+  std::vector<unsigned long> connectivity;
+  connectivity.reserve( 3 * ( triangleStrips->GetNumberOfConnectivityEntries()
+                              + polygons->GetNumberOfCells() ) );
 
   triangleStrips->InitTraversal();
   while( triangleStrips->GetNextCell( numberOfCellPoints, cellPoints ) )
     {
-    numberOfTriangles += numberOfCellPoints-2;
+    for( vtkIdType t = 0; t + 2 < numberOfCellPoints; t++ )
+      {
+      connectivity.push_back( cellPoints[t] );
+      connectivity.push_back( cellPoints[t+1] );
+      connectivity.push_back( cellPoints[t+2] );
+      }
     }
 
-   vtkCellArray * polygons = m_PolyData->GetPolys();
-  
-   polygons->InitTraversal();
-
-   while( polygons->GetNextCell( numberOfCellPoints, cellPoints ) )
-     {
-     if( numberOfCellPoints == 3 )
-       {
-        numberOfTriangles ++;
-       }
-     }
-
-   //
-  // Reserve memory in the itk::Mesh for all those triangles
-  //
-   m_itkMesh->GetCells()->Reserve( numberOfTriangles );
+  polygons->InitTraversal();
+  while( polygons->GetNextCell( numberOfCellPoints, cellPoints ) )
+    {
+    if( numberOfCellPoints != 3 ) // skip any non-triangle.
+      {
+      continue;
+      }
+    connectivity.push_back( cellPoints[0] );
+    connectivity.push_back( cellPoints[1] );
+    connectivity.push_back( cellPoints[2] );
+    }
 
-  // 
-  // Copy the triangles from vtkPolyData into the itk::Mesh
   //
+  // One triangle cell per three point ids, owned by the mesh through the
+  // default allocation method. The cells are inserted at the end of the
+  // map, in id order.
   //
+  const unsigned long numberOfTriangles = connectivity.size() / 3;
 
-   typedef TriangleMeshType::CellType   CellType;
-
-   typedef itk::TriangleCell< CellType > TriangleCellType;
-
-  // first copy the triangle strips
-   int cellId = 0;
-   triangleStrips->InitTraversal();
-   while( triangleStrips->GetNextCell( numberOfCellPoints, cellPoints ) )
-     {
-     unsigned int numberOfTrianglesInStrip = numberOfCellPoints - 2;
-
-     unsigned long pointIds[3];
-     pointIds[0] = cellPoints[0];
-     pointIds[1] = cellPoints[1];
-     pointIds[2] = cellPoints[2];
-       
-     for( unsigned int t=0; t < numberOfTrianglesInStrip; t++ )
-       {
-        TriangleMeshType::CellAutoPointer c;
-        TriangleCellType * tcell = new TriangleCellType;
-        tcell->SetPointIds( pointIds );
-        c.TakeOwnership( tcell );
-        m_itkMesh->SetCell( cellId, c );
-        cellId++;
-        pointIds[0] = pointIds[1];
-        pointIds[1] = pointIds[2];
-        pointIds[2] = cellPoints[t+3];
-       }
-       
-     }
-
-   // then copy the triangles 
-   polygons->InitTraversal();
-   while( polygons->GetNextCell( numberOfCellPoints, cellPoints ) )
-     {
-     if( numberOfCellPoints !=3 ) // skip any non-triangle.
-       {
-       continue;
-       }
-     TriangleMeshType::CellAutoPointer c;
-     TriangleCellType * t = new TriangleCellType;
-     t->SetPointIds( (unsigned long*)cellPoints );
-     c.TakeOwnership( t );
-     m_itkMesh->SetCell( cellId, c );
-     cellId++;
-     } 
-  
+  CellsContainerType::Pointer cells = CellsContainerType::New();
+  m_itkMesh->SetCells( cells );
+
+  CellsContainerType::STLContainerType & cellMap =
+    cells->CastToSTLContainer();
+  for( unsigned long cellId = 0; cellId < numberOfTriangles; cellId++ )
+    {
+    TriangleMeshType::CellAutoPointer cell;
+    TriangleCellType * triangle = new TriangleCellType;
+    triangle->SetPointIds( &connectivity[3 * cellId] );
+    cell.TakeOwnership( triangle );
+    cellMap.insert( cellMap.end(),
+      std::make_pair( cellId, cell.ReleaseOwnership() ) );
+    }
 }
@@ -26,6 +26,10 @@ class vtkPolyDataToitkMesh
 
   typedef itk::DefaultDynamicMeshTraits<double, 3, 3,double,double> TriangleMeshTraits;
   typedef itk::Mesh<double,3, TriangleMeshTraits> TriangleMeshType;
+  typedef TriangleMeshType::PointsContainer                 PointsContainerType;
+  typedef TriangleMeshType::CellsContainer                  CellsContainerType;
+  typedef TriangleMeshType::CellType                        CellType;
+  typedef itk::TriangleCell< CellType >                     TriangleCellType;
 
   /**
   The SetInput method provides pointer to the vtkPolyData
@@ -55,6 +55,7 @@ DuctExtractorConsole
   progressSlider->Observe( m_Smoother.GetPointer() );
   progressSlider->Observe( m_Laplacian.GetPointer() );
   progressSlider->Observe( m_RegionGrower.GetPointer() );
+  progressSlider->Observe( m_LazyRegionGrower.GetPointer() );
                               
   loadButton->Observe( m_Reader.GetPointer() );
   inputButton->Observe( m_Reader.GetPointer() );
@@ -62,6 +63,7 @@ DuctExtractorConsole
   laplacianButton->Observe( m_Laplacian.GetPointer() );
   smoothedButton->Observe( m_Smoother.GetPointer() );
   regionGrowthButton->Observe( m_RegionGrower.GetPointer() );
+  regionGrowthButton->Observe( m_LazyRegionGrower.GetPointer() );
 
   m_Reader->AddObserver( itk::ModifiedEvent(), laplacianButton->GetRedrawCommand());
   m_Reader->AddObserver( itk::ModifiedEvent(), smoothedButton->GetRedrawCommand());
@@ -302,9 +304,17 @@ DuctExtractorConsole
 {
 
   this->ShowStatus("Computing Region Growth...");
-  m_RegionGrower->UpdateLargestPossibleRegion();
   m_Viewer_Region_Growth->SetImage( m_Reader->GetOutput() );  
-  m_Viewer_Region_Growth->SetOverlay( m_RegionGrower->GetOutput() );  
+  if( m_UseLazyEvaluation )
+    {
+    m_LazyRegionGrower->Update();
+    m_Viewer_Region_Growth->SetOverlay( m_LazyRegionGrower->GetOutput() );  
+    }
+  else
+    {
+    m_RegionGrower->UpdateLargestPossibleRegion();
+    m_Viewer_Region_Growth->SetOverlay( m_RegionGrower->GetOutput() );  
+    }
   m_Viewer_Region_Growth->Show();
   this->ShowStatus("Region growth done");
 }
@@ -414,6 +424,7 @@ DuctExtractorConsole
   seed[2] = static_cast<IndexType::IndexValueType>( z );
 
   m_RegionGrower->AddSeed( seed );
+  m_LazyRegionGrower->AddSeed( seed );
 
 }
 
@@ -36,6 +36,13 @@ DuctExtractorConsoleBase
   m_RegionGrower  = RegionGrowthFilterType::New();
   m_Statistics    = StatisticsFilterType::New();
 
+  // Computes the smoothed Laplacian in bricks only where the region
+  // growing reaches. Its lower threshold is left unbounded, which is what
+  // the minimum of the Laplacian gives the full-volume region grower,
+  // until one is set on both.
+  m_LazyRegionGrower  = LazyRegionGrowthFilterType::New();
+  m_UseLazyEvaluation = false;
+
   m_Laplacian->SetSigma( 2.5 );
 
   m_Smoother->SetNumberOfIterations( 5 );
@@ -46,10 +53,18 @@ DuctExtractorConsoleBase
   m_RegionGrower->SetReplaceValue( 
        itk::NumericTraits< MaskPixelType >::One );
 
+  m_LazyRegionGrower->SetSigma( 2.5 );
+  m_LazyRegionGrower->SetNumberOfIterations( 5 );
+  m_LazyRegionGrower->SetTimeStep( 0.05 );
+  m_LazyRegionGrower->SetUpper( 1.0 );
+  m_LazyRegionGrower->SetReplaceValue( 
+       itk::NumericTraits< MaskPixelType >::One );
+
   m_Smoother->SetInput(  m_Reader->GetOutput()   );
   m_Laplacian->SetInput( m_Smoother->GetOutput() );
   m_RegionGrower->SetInput( m_Laplacian->GetOutput() );
   m_Statistics->SetInput( m_Laplacian->GetOutput() );
+  m_LazyRegionGrower->SetInput( m_Reader->GetOutput() );
 
   m_RegionGrower->SetLowerInput( m_Statistics->GetMinimumOutput() );
 
@@ -140,6 +155,7 @@ DuctExtractorConsoleBase
 {
   
   m_Laplacian->SetSigma( value );
+  m_LazyRegionGrower->SetSigma( value );
 
 }
 
@@ -158,6 +174,7 @@ DuctExtractorConsoleBase
 {
   
   m_RegionGrower->SetLower( value );
+  m_LazyRegionGrower->SetLower( value );
 
 }
 
@@ -175,6 +192,7 @@ DuctExtractorConsoleBase
 {
   
   m_RegionGrower->SetUpper( value );
+  m_LazyRegionGrower->SetUpper( value );
 
 }
 
@@ -193,6 +211,34 @@ DuctExtractorConsoleBase
 {
   
   m_Smoother->SetNumberOfIterations( numberOfIterations );
+  m_LazyRegionGrower->SetNumberOfIterations( numberOfIterations );
+
+}
+
+
+
+
+ 
+/*****************************************************
+ *
+ *  Select the Demand Driven Region Growing
+ *
+ ****************************************************/
+void
+DuctExtractorConsoleBase 
+::SetUseLazyEvaluation( bool value )
+{
+  
+  m_UseLazyEvaluation = value;
+
+  if( m_UseLazyEvaluation )
+    {
+    m_Writer_Segmentation->SetInput( m_LazyRegionGrower->GetOutput() );
+    }
+  else
+    {
+    m_Writer_Segmentation->SetInput( m_RegionGrower->GetOutput() );
+    }
 
 }
 
@@ -215,6 +261,13 @@ DuctExtractorConsoleBase
     return;
     }
   
+  if( m_UseLazyEvaluation )
+    {
+    this->ShowStatus("Computing Region Growing on demand...");
+    m_LazyRegionGrower->Update();
+    this->ShowStatus("Processing Completed");
+    return;
+    }
   
   this->ShowStatus("Smoothing the input image...");
   m_Smoother->UpdateLargestPossibleRegion();
@@ -263,5 +316,6 @@ DuctExtractorConsoleBase
   m_Smoother->AbortGenerateDataOn();
   m_Laplacian->AbortGenerateDataOn();
   m_RegionGrower->AbortGenerateDataOn();
+  m_LazyRegionGrower->AbortGenerateDataOn();
 }
 
@@ -24,6 +24,7 @@
 #include "itkCurvatureFlowImageFilter.h"
 #include "itkConnectedThresholdImageFilter.h"
 #include "itkStatisticsImageFilter.h"
+#include "itkBrickCachedConnectedThresholdImageFilter.h"
 
 class DuctExtractorConsoleBase 
 {
@@ -61,6 +62,11 @@ public:
                                           ImageType, 
                                           MaskImageType 
                                                 >  RegionGrowthFilterType;
+
+  typedef   itk::BrickCachedConnectedThresholdImageFilter<
+                                          InputImageType,
+                                          MaskImageType
+                                                >  LazyRegionGrowthFilterType;
             
 public:
 
@@ -76,6 +82,7 @@ public:
   virtual void SetRegionGrowingLowerThreshold( RealType );
   virtual void SetRegionGrowingUpperThreshold( RealType );
   virtual void SetSmoothingNumberOfIterations( unsigned int );
+  virtual void SetUseLazyEvaluation( bool );
 
   virtual void WriteSegmentation(void) = 0;
 
@@ -90,6 +97,9 @@ protected:
   RegionGrowthFilterType::Pointer    m_RegionGrower;
   StatisticsFilterType::Pointer      m_Statistics;
 
+  LazyRegionGrowthFilterType::Pointer m_LazyRegionGrower;
+  bool                               m_UseLazyEvaluation;
+
   bool                               m_ImageFileNameAvailable;
 
   VolumeWriterType::Pointer          m_Writer_Segmentation;
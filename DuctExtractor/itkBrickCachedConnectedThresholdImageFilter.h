@@ -0,0 +1,212 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkBrickCachedConnectedThresholdImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBrickCachedConnectedThresholdImageFilter_h
+#define __itkBrickCachedConnectedThresholdImageFilter_h
+
+#include <map>
+#include <vector>
+
+#include "itkImageToImageFilter.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkCurvatureFlowImageFilter.h"
+#include "itkLaplacianRecursiveGaussianImageFilter.h"
+
+namespace itk
+{
+
+/** \class BrickCachedConnectedThresholdImageFilter
+ *
+ * Region growing on the Laplacian of the curvature flow smoothed input,
+ * that is, the result of
+ *
+ *   CurvatureFlowImageFilter -> LaplacianRecursiveGaussianImageFilter
+ *     -> ConnectedThresholdImageFilter
+ *
+ * without filtering the whole volume. The image is divided into bricks of
+ * BrickSize voxels per side, and the smoothed Laplacian of a brick is only
+ * computed when the flood front first reaches it. Each brick is filtered
+ * with a margin of NumberOfIterations voxels plus four sigmas, so that
+ * the values in its core match the whole-volume filters up to the tail of
+ * the recursive Gaussian.
+ *
+ * Computed bricks are kept between updates as long as the input and the
+ * smoothing and Laplacian parameters do not change, so changing the
+ * thresholds or the seeds only re-runs the flood fill.
+ *
+ * The flood fill uses face connectivity, like ConnectedThresholdImageFilter.
+ *
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT BrickCachedConnectedThresholdImageFilter :
+    public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef BrickCachedConnectedThresholdImageFilter Self;
+  typedef ImageToImageFilter<TInputImage,TOutputImage> Superclass;
+  typedef SmartPointer<Self> Pointer;
+  typedef SmartPointer<const Self>  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods).  */
+  itkTypeMacro(BrickCachedConnectedThresholdImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef TInputImage                            InputImageType;
+  typedef typename InputImageType::ConstPointer  InputImageConstPointer;
+  typedef typename InputImageType::RegionType    RegionType;
+  typedef typename InputImageType::IndexType     IndexType;
+  typedef typename InputImageType::SizeType      SizeType;
+
+  typedef TOutputImage                           OutputImageType;
+  typedef typename OutputImageType::Pointer      OutputImagePointer;
+  typedef typename OutputImageType::PixelType    OutputImagePixelType;
+
+  /** Internal pipeline computing the values of one brick. */
+  typedef float                                  RealType;
+  typedef Image<RealType, itkGetStaticConstMacro(ImageDimension)>
+                                                 RealImageType;
+  typedef RegionOfInterestImageFilter<
+                    InputImageType, InputImageType > ExtractFilterType;
+  typedef CurvatureFlowImageFilter<
+                    InputImageType, RealImageType >  SmoothingFilterType;
+  typedef LaplacianRecursiveGaussianImageFilter<
+                    RealImageType, RealImageType >   LaplacianFilterType;
+
+  /** Seeds of the region growing. */
+  void AddSeed( const IndexType & seed )
+    {
+    m_Seeds.push_back( seed );
+    this->Modified();
+    }
+  void ClearSeeds()
+    {
+    if ( m_Seeds.size() > 0 )
+      {
+      m_Seeds.clear();
+      this->Modified();
+      }
+    }
+
+  /** Set/Get the interval of accepted Laplacian values. */
+  itkSetMacro( Lower, double );
+  itkGetConstMacro( Lower, double );
+  itkSetMacro( Upper, double );
+  itkGetConstMacro( Upper, double );
+
+  /** Set/Get the value of the grown voxels. */
+  itkSetMacro( ReplaceValue, OutputImagePixelType );
+  itkGetConstMacro( ReplaceValue, OutputImagePixelType );
+
+  /** Set/Get the curvature flow parameters. */
+  itkSetMacro( NumberOfIterations, unsigned int );
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+  itkSetMacro( TimeStep, double );
+  itkGetConstMacro( TimeStep, double );
+
+  /** Set/Get the sigma of the Laplacian, in physical units. */
+  itkSetMacro( Sigma, double );
+  itkGetConstMacro( Sigma, double );
+
+  /** Set/Get the edge length of the bricks, in voxels. */
+  itkSetClampMacro( BrickSize, unsigned int, 4, NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( BrickSize, unsigned int );
+
+  /** Number of bricks filtered by the last update, and in the cache. */
+  itkGetConstMacro( NumberOfComputedBricks, unsigned long );
+  unsigned long GetNumberOfCachedBricks() const
+    {
+    return static_cast<unsigned long>( m_Bricks.size() );
+    }
+
+  /** Number of bricks covering the whole image. */
+  itkGetConstMacro( NumberOfBricks, unsigned long );
+
+  /** Discard the cached bricks. */
+  void ReleaseBricks()
+    {
+    m_Bricks.clear();
+    }
+
+protected:
+  BrickCachedConnectedThresholdImageFilter();
+  ~BrickCachedConnectedThresholdImageFilter() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** The whole input is available and the whole mask is produced. */
+  virtual void GenerateInputRequestedRegion();
+  virtual void EnlargeOutputRequestedRegion( DataObject * );
+
+  virtual void GenerateData();
+
+private:
+  BrickCachedConnectedThresholdImageFilter( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  typedef std::vector<RealType>                    BrickType;
+  typedef std::map<unsigned long, BrickType>       BrickMapType;
+
+  /** Drop the cache if the input or the filter parameters changed. */
+  void ValidateCache();
+
+  /** Values of a brick, computed on first use. */
+  const BrickType & GetBrick( unsigned long brickId );
+
+  /** Region covered by a brick. */
+  RegionType GetBrickRegion( unsigned long brickId ) const;
+
+  std::vector<IndexType>         m_Seeds;
+  double                         m_Lower;
+  double                         m_Upper;
+  OutputImagePixelType           m_ReplaceValue;
+  unsigned int                   m_NumberOfIterations;
+  double                         m_TimeStep;
+  double                         m_Sigma;
+  unsigned int                   m_BrickSize;
+
+  unsigned long                  m_NumberOfComputedBricks;
+  unsigned long                  m_NumberOfBricks;
+
+  /** Brick grid of the current input. */
+  RegionType                     m_Region;
+  SizeType                       m_BricksPerAxis;
+  unsigned long                  m_BrickEdge;
+
+  /** Cache and the state it was computed for. */
+  BrickMapType                   m_Bricks;
+  const InputImageType *         m_CachedInput;
+  unsigned long                  m_CachedInputTime;
+  unsigned int                   m_CachedNumberOfIterations;
+  double                         m_CachedTimeStep;
+  double                         m_CachedSigma;
+  unsigned long                  m_CachedBrickEdge;
+
+  typename ExtractFilterType::Pointer    m_Extract;
+  typename SmoothingFilterType::Pointer  m_Smoother;
+  typename LaplacianFilterType::Pointer  m_Laplacian;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBrickCachedConnectedThresholdImageFilter.txx"
+#endif
+
+#endif
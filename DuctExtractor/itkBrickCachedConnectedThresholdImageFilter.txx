@@ -0,0 +1,346 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkBrickCachedConnectedThresholdImageFilter.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBrickCachedConnectedThresholdImageFilter_txx
+#define __itkBrickCachedConnectedThresholdImageFilter_txx
+
+#include "itkBrickCachedConnectedThresholdImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <class TInputImage, class TOutputImage>
+BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>
+::BrickCachedConnectedThresholdImageFilter()
+{
+  m_Lower = NumericTraits<RealType>::NonpositiveMin();
+  m_Upper = NumericTraits<RealType>::max();
+  m_ReplaceValue = NumericTraits<OutputImagePixelType>::One;
+  m_NumberOfIterations = 5;
+  m_TimeStep = 0.05;
+  m_Sigma = 2.5;
+  m_BrickSize = 32;
+
+  m_NumberOfComputedBricks = 0;
+  m_NumberOfBricks = 0;
+  m_BricksPerAxis.Fill( 0 );
+  m_BrickEdge = m_BrickSize;
+
+  m_CachedInput = 0;
+  m_CachedInputTime = 0;
+  m_CachedNumberOfIterations = 0;
+  m_CachedTimeStep = 0.0;
+  m_CachedSigma = 0.0;
+  m_CachedBrickEdge = 0;
+
+  m_Extract   = ExtractFilterType::New();
+  m_Smoother  = SmoothingFilterType::New();
+  m_Laplacian = LaplacianFilterType::New();
+  m_Smoother->SetInput( m_Extract->GetOutput() );
+  m_Laplacian->SetInput( m_Smoother->GetOutput() );
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Lower: " << m_Lower << std::endl;
+  os << indent << "Upper: " << m_Upper << std::endl;
+  os << indent << "ReplaceValue: "
+     << static_cast<typename NumericTraits<OutputImagePixelType>::PrintType>( m_ReplaceValue )
+     << std::endl;
+  os << indent << "NumberOfIterations: " << m_NumberOfIterations << std::endl;
+  os << indent << "TimeStep: " << m_TimeStep << std::endl;
+  os << indent << "Sigma: " << m_Sigma << std::endl;
+  os << indent << "BrickSize: " << m_BrickSize << std::endl;
+  os << indent << "NumberOfComputedBricks: " << m_NumberOfComputedBricks << std::endl;
+  os << indent << "NumberOfCachedBricks: " << m_Bricks.size() << std::endl;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+  if ( this->GetInput() )
+    {
+    typename InputImageType::Pointer input =
+      const_cast< InputImageType * >( this->GetInput() );
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>
+::EnlargeOutputRequestedRegion( DataObject *output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>
+::ValidateCache()
+{
+  const InputImageType * input = this->GetInput();
+
+  if ( m_CachedInput != input ||
+       m_CachedInputTime != input->GetMTime() ||
+       m_CachedNumberOfIterations != m_NumberOfIterations ||
+       m_CachedTimeStep != m_TimeStep ||
+       m_CachedSigma != m_Sigma ||
+       m_CachedBrickEdge != m_BrickEdge )
+    {
+    m_Bricks.clear();
+    m_CachedInput = input;
+    m_CachedInputTime = input->GetMTime();
+    m_CachedNumberOfIterations = m_NumberOfIterations;
+    m_CachedTimeStep = m_TimeStep;
+    m_CachedSigma = m_Sigma;
+    m_CachedBrickEdge = m_BrickEdge;
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+typename BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>::RegionType
+BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>
+::GetBrickRegion( unsigned long brickId ) const
+{
+  RegionType brick;
+  IndexType  index;
+  SizeType   size;
+
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const unsigned long b = brickId % m_BricksPerAxis[d];
+    brickId /= m_BricksPerAxis[d];
+    const unsigned long first = b * m_BrickEdge;
+    index[d] = m_Region.GetIndex()[d] + first;
+    size[d]  = std::min( m_BrickEdge,
+                         static_cast<unsigned long>( m_Region.GetSize()[d] ) - first );
+    }
+
+  brick.SetIndex( index );
+  brick.SetSize( size );
+  return brick;
+}
+
+
+template <class TInputImage, class TOutputImage>
+const typename BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>::BrickType &
+BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>
+::GetBrick( unsigned long brickId )
+{
+  typename BrickMapType::iterator it = m_Bricks.find( brickId );
+  if ( it != m_Bricks.end() )
+    {
+    return it->second;
+    }
+
+  if ( this->GetAbortGenerateData() )
+    {
+    ProcessAborted e( __FILE__, __LINE__ );
+    e.SetDescription( "Process aborted." );
+    e.SetLocation( ITK_LOCATION );
+    throw e;
+    }
+
+  const RegionType brick = this->GetBrickRegion( brickId );
+
+  // The curvature flow moves information by one voxel per iteration and
+  // the recursive Gaussian is negligible beyond four sigmas.
+  const typename InputImageType::SpacingType spacing = this->GetInput()->GetSpacing();
+  RegionType padded = brick;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const long margin = m_NumberOfIterations + 1 +
+      static_cast<long>( vcl_ceil( 4.0 * m_Sigma / spacing[d] ) );
+    IndexType index = padded.GetIndex();
+    SizeType  size  = padded.GetSize();
+    index[d] -= margin;
+    size[d]  += 2 * margin;
+    padded.SetIndex( index );
+    padded.SetSize( size );
+    }
+  padded.Crop( m_Region );
+
+  m_Extract->SetInput( this->GetInput() );
+  m_Extract->SetRegionOfInterest( padded );
+  m_Smoother->SetNumberOfIterations( m_NumberOfIterations );
+  m_Smoother->SetTimeStep( m_TimeStep );
+  m_Laplacian->SetSigma( m_Sigma );
+  m_Laplacian->Update();
+
+  // The extracted image starts at index zero.
+  RegionType core = brick;
+  IndexType coreIndex;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    coreIndex[d] = brick.GetIndex()[d] - padded.GetIndex()[d];
+    }
+  core.SetIndex( coreIndex );
+
+  BrickType & values = m_Bricks[brickId];
+  values.resize( brick.GetNumberOfPixels() );
+
+  ImageRegionConstIterator<RealImageType> it2( m_Laplacian->GetOutput(), core );
+  typename BrickType::iterator out = values.begin();
+  for ( it2.GoToBegin(); !it2.IsAtEnd(); ++it2, ++out )
+    {
+    *out = it2.Get();
+    }
+
+  m_NumberOfComputedBricks++;
+  this->UpdateProgress( static_cast<float>( m_Bricks.size() ) / m_NumberOfBricks );
+
+  return values;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+BrickCachedConnectedThresholdImageFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  InputImageConstPointer inputImage = this->GetInput();
+  OutputImagePointer     outputImage = this->GetOutput();
+
+  outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
+  outputImage->Allocate();
+  outputImage->FillBuffer( NumericTraits<OutputImagePixelType>::Zero );
+
+  m_Region = inputImage->GetLargestPossibleRegion();
+  m_BrickEdge = m_BrickSize;
+  m_NumberOfBricks = 1;
+  unsigned long numberOfPixels = 1;
+  unsigned long pixelStride[ImageDimension];
+  unsigned long brickStride[ImageDimension];
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    pixelStride[d] = numberOfPixels;
+    brickStride[d] = m_NumberOfBricks;
+    m_BricksPerAxis[d] = ( m_Region.GetSize()[d] + m_BrickEdge - 1 ) / m_BrickEdge;
+    m_NumberOfBricks *= m_BricksPerAxis[d];
+    numberOfPixels *= m_Region.GetSize()[d];
+    }
+
+  this->ValidateCache();
+  m_NumberOfComputedBricks = 0;
+
+  OutputImagePixelType * mask = outputImage->GetBufferPointer();
+  std::vector<bool> visited( numberOfPixels, false );
+  std::vector<unsigned long> front;
+
+  for ( unsigned int s = 0; s < m_Seeds.size(); s++ )
+    {
+    if ( !m_Region.IsInside( m_Seeds[s] ) )
+      {
+      continue;
+      }
+    unsigned long offset = 0;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      offset += ( m_Seeds[s][d] - m_Region.GetIndex()[d] ) * pixelStride[d];
+      }
+    if ( !visited[offset] )
+      {
+      visited[offset] = true;
+      front.push_back( offset );
+      }
+    }
+
+  // Consecutive voxels usually fall in the same brick, so remember the
+  // last one instead of searching the cache for every voxel.
+  unsigned long     lastBrickId = NumericTraits<unsigned long>::max();
+  const BrickType * lastBrick = 0;
+  RegionType        lastBrickRegion;
+
+  while ( !front.empty() )
+    {
+    const unsigned long offset = front.back();
+    front.pop_back();
+
+    unsigned long position[ImageDimension];
+    unsigned long brickId = 0;
+    unsigned long remainder = offset;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      position[d] = remainder % m_Region.GetSize()[d];
+      remainder  /= m_Region.GetSize()[d];
+      brickId    += ( position[d] / m_BrickEdge ) * brickStride[d];
+      }
+
+    if ( brickId != lastBrickId )
+      {
+      lastBrick = &this->GetBrick( brickId );
+      lastBrickRegion = this->GetBrickRegion( brickId );
+      lastBrickId = brickId;
+      }
+
+    unsigned long local = 0;
+    unsigned long localStride = 1;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      local += ( position[d] + m_Region.GetIndex()[d]
+                 - lastBrickRegion.GetIndex()[d] ) * localStride;
+      localStride *= lastBrickRegion.GetSize()[d];
+      }
+
+    const double value = ( *lastBrick )[local];
+    if ( value < m_Lower || value > m_Upper )
+      {
+      continue;
+      }
+    mask[offset] = m_ReplaceValue;
+
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      if ( position[d] > 0 && !visited[offset - pixelStride[d]] )
+        {
+        visited[offset - pixelStride[d]] = true;
+        front.push_back( offset - pixelStride[d] );
+        }
+      if ( position[d] + 1 < m_Region.GetSize()[d] && !visited[offset + pixelStride[d]] )
+        {
+        visited[offset + pixelStride[d]] = true;
+        front.push_back( offset + pixelStride[d] );
+        }
+      }
+    }
+
+  // The internal pipeline only needs to hold the last brick.
+  m_Laplacian->GetOutput()->ReleaseData();
+  m_Smoother->GetOutput()->ReleaseData();
+  m_Extract->GetOutput()->ReleaseData();
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,120 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    FastIterativeMarchingTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+// Runs the fast iterative method on a slow speed, where the arrival times
+// reach tens of thousands and the float rounding of a stored time is
+// larger than the tolerance, and compares it with the heap.
+
+#include "itkImage.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkFastIterativeMarchingImageFilter.h"
+#include "vnl/vnl_math.h"
+
+#include <iostream>
+#include <cstdlib>
+
+
+typedef float                                  PixelType;
+typedef itk::Image< PixelType, 3 >             ImageType;
+typedef itk::FastIterativeMarchingImageFilter<
+                     ImageType, ImageType >    FastMarchingFilterType;
+
+
+int main( int, char *[] )
+{
+  const unsigned int n = 48;
+
+  ImageType::SizeType size;
+  size.Fill( n );
+  ImageType::RegionType region;
+  region.SetSize( size );
+
+  // as slow as a sigmoid speed far from the edges
+  ImageType::Pointer speed = ImageType::New();
+  speed->SetRegions( region );
+  speed->Allocate();
+  speed->FillBuffer( 0.001 );
+
+  FastMarchingFilterType::NodeContainer::Pointer seeds =
+                              FastMarchingFilterType::NodeContainer::New();
+  seeds->Initialize();
+  FastMarchingFilterType::NodeType node;
+  ImageType::IndexType corner;
+  corner.Fill( 0 );
+  node.SetIndex( corner );
+  node.SetValue( 0.0 );
+  seeds->InsertElement( 0, node );
+
+  FastMarchingFilterType::Pointer filter = FastMarchingFilterType::New();
+  filter->SetInput( speed );
+  filter->SetTrialPoints( seeds );
+  filter->SetOutputSize( size );
+  filter->SetStoppingValue( 1e6 );
+  filter->SetTolerance( 1e-4 );
+
+  ImageType::Pointer reference;
+  try
+    {
+    filter->UseFastIterativeMethodOff();
+    filter->Update();
+    reference = filter->GetOutput();
+    reference->DisconnectPipeline();
+
+    // several slabs, so that the faces are exchanged too
+    filter->UseFastIterativeMethodOn();
+    filter->SetNumberOfThreads( 4 );
+    filter->Modified();
+    filter->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double largest = 0.0;
+  double maximumError = 0.0;
+  itk::ImageRegionConstIterator< ImageType > rit( reference, region );
+  itk::ImageRegionConstIterator< ImageType > fit( filter->GetOutput(), region );
+  for ( ; !rit.IsAtEnd(); ++rit, ++fit )
+    {
+    largest = vnl_math_max( largest, static_cast<double>( rit.Get() ) );
+    maximumError = vnl_math_max( maximumError,
+      vnl_math_abs( static_cast<double>( rit.Get() ) - fit.Get() ) /
+      vnl_math_max( 1.0, static_cast<double>( rit.Get() ) ) );
+    }
+
+  std::cout << "Largest arrival time: " << largest
+            << ", rounds: " << filter->GetNumberOfRounds()
+            << ", largest relative difference with the heap: "
+            << maximumError << std::endl;
+
+  if ( largest < 8192.0 )
+    {
+    std::cerr << "The arrival times are not large enough for the test"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( maximumError > 1e-3 )
+    {
+    std::cerr << "The fast iterative method differs from the heap"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
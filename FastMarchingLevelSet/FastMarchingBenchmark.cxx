@@ -0,0 +1,247 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    FastMarchingBenchmark.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+// Times the arrival time computation of the fast marching apps with the
+// heap and with the fast iterative method at 1 to N threads, and reports
+// the largest difference between the two below the stopping value.
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkFastIterativeMarchingImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkTimeProbe.h"
+#include "vnl/vnl_math.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+typedef float                                  PixelType;
+typedef itk::Image< PixelType, 3 >             ImageType;
+typedef itk::FastIterativeMarchingImageFilter<
+                     ImageType, ImageType >    FastMarchingFilterType;
+
+
+void usage()
+{
+  std::cerr << "\n";
+  std::cerr << "Usage: FastMarchingBenchmark <options>\n";
+  std::cerr << "       Compares the heap and the fast iterative fast marching.\n\n";
+  std::cerr << "   where <options> is one or more of the following:\n\n";
+  std::cerr << "       <-h>                     Display (this) usage information\n";
+  std::cerr << "       <-speed file>            Speed image (default: synthetic)\n";
+  std::cerr << "       <-size n>                Size of the synthetic speed image (default 128)\n";
+  std::cerr << "       <-stop value>            Stopping value (default 100)\n";
+  std::cerr << "       <-threads n>             Largest number of threads (default: all)\n";
+  std::cerr << "       <-tolerance value>       Tolerance of the fast iterative method\n";
+  std::cerr << "\n";
+  exit(1);
+}
+
+
+// Speed between 0.1 and 1 made of concentric shells, so that the front
+// has to bend around slow layers.
+ImageType::Pointer CreateSpeedImage( unsigned int n )
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill( n );
+  ImageType::RegionType region;
+  region.SetSize( size );
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    double r2 = 0.0;
+    for ( unsigned int d = 0; d < 3; d++ )
+      {
+      const double x = index[d] - 0.5 * n;
+      r2 += x * x;
+      }
+    const int shell = static_cast<int>( vcl_sqrt( r2 ) ) % 16;
+    const bool gap = ( index[0] % 32 ) < 4;
+    it.Set( ( shell < 12 || gap ) ? 1.0 : 0.1 );
+    }
+  return image;
+}
+
+
+int main( int argc, char *argv[] )
+{
+  const char * speedFileName = 0;
+  unsigned int syntheticSize = 128;
+  double stoppingValue = 100.0;
+  double tolerance = 1e-4;
+  int maximumThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  for ( int i = 1; i < argc; i++ )
+    {
+    const std::string option( argv[i] );
+    if ( option == "-h" || i + 1 >= argc )
+      {
+      usage();
+      }
+    else if ( option == "-speed" )
+      {
+      speedFileName = argv[++i];
+      }
+    else if ( option == "-size" )
+      {
+      syntheticSize = atoi( argv[++i] );
+      }
+    else if ( option == "-stop" )
+      {
+      stoppingValue = atof( argv[++i] );
+      }
+    else if ( option == "-threads" )
+      {
+      maximumThreads = atoi( argv[++i] );
+      }
+    else if ( option == "-tolerance" )
+      {
+      tolerance = atof( argv[++i] );
+      }
+    else
+      {
+      usage();
+      }
+    }
+
+  ImageType::Pointer speed;
+  try
+    {
+    if ( speedFileName )
+      {
+      typedef itk::ImageFileReader< ImageType > ReaderType;
+      ReaderType::Pointer reader = ReaderType::New();
+      reader->SetFileName( speedFileName );
+      reader->Update();
+      speed = reader->GetOutput();
+      speed->DisconnectPipeline();
+      }
+    else
+      {
+      speed = CreateSpeedImage( syntheticSize );
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const ImageType::RegionType region = speed->GetBufferedRegion();
+
+  // one seed at the center of the volume
+  FastMarchingFilterType::NodeContainer::Pointer seeds =
+                              FastMarchingFilterType::NodeContainer::New();
+  seeds->Initialize();
+  FastMarchingFilterType::NodeType node;
+  ImageType::IndexType center;
+  for ( unsigned int d = 0; d < 3; d++ )
+    {
+    center[d] = region.GetIndex()[d] + region.GetSize()[d] / 2;
+    }
+  node.SetIndex( center );
+  node.SetValue( 0.0 );
+  seeds->InsertElement( 0, node );
+
+  FastMarchingFilterType::Pointer filter = FastMarchingFilterType::New();
+  filter->SetInput( speed );
+  filter->SetTrialPoints( seeds );
+  filter->SetOutputSize( region.GetSize() );
+  filter->SetStoppingValue( stoppingValue );
+  filter->SetTolerance( tolerance );
+
+  std::cout << "Speed image: " << region.GetSize()
+            << "  stopping value: " << stoppingValue
+            << "  tolerance: " << tolerance << std::endl;
+
+  ImageType::Pointer reference;
+  try
+    {
+    itk::TimeProbe timer;
+    filter->UseFastIterativeMethodOff();
+    timer.Start();
+    filter->Update();
+    timer.Stop();
+    reference = filter->GetOutput();
+    reference->DisconnectPipeline();
+    std::cout << "Heap:                      "
+              << timer.GetMeanTime() << " s" << std::endl;
+
+    // 1, 2, 4, ... threads, and the largest number
+    std::vector<int> numbersOfThreads;
+    for ( int threads = 1; threads < maximumThreads; threads *= 2 )
+      {
+      numbersOfThreads.push_back( threads );
+      }
+    numbersOfThreads.push_back( vnl_math_max( maximumThreads, 1 ) );
+
+    filter->UseFastIterativeMethodOn();
+    for ( unsigned int t = 0; t < numbersOfThreads.size(); t++ )
+      {
+      const int threads = numbersOfThreads[t];
+      filter->SetNumberOfThreads( threads );
+      filter->Modified();
+      itk::TimeProbe probe;
+      probe.Start();
+      filter->Update();
+      probe.Stop();
+
+      double maximumError = 0.0;
+      unsigned long disagreements = 0;
+      itk::ImageRegionConstIterator< ImageType > rit( reference, region );
+      itk::ImageRegionConstIterator< ImageType > fit( filter->GetOutput(), region );
+      for ( ; !rit.IsAtEnd(); ++rit, ++fit )
+        {
+        const bool inReference = rit.Get() <= stoppingValue;
+        const bool inFiltered  = fit.Get() <= stoppingValue;
+        if ( inReference && inFiltered )
+          {
+          maximumError = vnl_math_max( maximumError,
+                    static_cast<double>( vnl_math_abs( rit.Get() - fit.Get() ) ) );
+          }
+        else if ( inReference != inFiltered )
+          {
+          disagreements++;
+          }
+        }
+
+      std::cout << "Fast iterative, " << threads << " thread(s): "
+                << probe.GetMeanTime() << " s, "
+                << filter->GetNumberOfRounds() << " rounds, "
+                << "max difference " << maximumError << ", "
+                << disagreements << " pixels across the stopping value"
+                << std::endl;
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -22,7 +22,7 @@
 
 #include "itkImage.h"
 #include "itkCastImageFilter.h"
-#include "itkFastMarchingImageFilter.h"
+#include "itkFastIterativeMarchingImageFilter.h"
 #include "itkGradientMagnitudeRecursiveGaussianImageFilter.h"
 #include "itkSigmoidImageFilter.h"
 #include "itkBinaryThresholdImageFilter.h"
@@ -79,7 +79,7 @@ public:
                                     InternalImageType>  DerivativeFilterType;
 
   /** Fast Marching filte use to evolve the contours */
-  typedef   itk::FastMarchingImageFilter< 
+  typedef   itk::FastIterativeMarchingImageFilter< 
                  InternalImageType, 
                  InternalImageType >     FastMarchingFilterType;
 
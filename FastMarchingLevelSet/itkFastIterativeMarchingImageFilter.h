@@ -0,0 +1,148 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkFastIterativeMarchingImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkFastIterativeMarchingImageFilter_h
+#define _itkFastIterativeMarchingImageFilter_h
+
+#include "itkFastMarchingImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class FastIterativeMarchingImageFilter
+ *
+ * FastMarchingImageFilter that can compute the arrival times with the
+ * fast iterative method of Jeong and Whitaker instead of the heap.
+ *
+ * When UseFastIterativeMethod is off (the default) the filter is a plain
+ * FastMarchingImageFilter. When it is on, the image is split in slabs
+ * along the last axis, one per thread. Each thread keeps a list of active
+ * pixels of its slab and updates them with the same upwind quadratic as
+ * FastMarchingImageFilter, using the current value of all the neighbors;
+ * a pixel leaves the list when its value changes by less than Tolerance,
+ * and then activates its neighbors. Between two rounds the faces of the
+ * slabs are exchanged, and the rounds stop when no face value decreases.
+ *
+ * The inputs and parameters are those of FastMarchingImageFilter: speed
+ * image or SpeedConstant, NormalizationFactor, alive and trial points,
+ * and StoppingValue. As with the heap, only the pixels whose arrival time
+ * is below StoppingValue propagate the front, their neighbors hold their
+ * tentative times and the other pixels keep the large value. The times
+ * converge to the ones of the heap to within about Tolerance. The heap
+ * filter's processed points and label image are not produced.
+ *
+ * \ingroup LevelSetSegmentation
+ */
+template <class TLevelSet, class TSpeedImage =
+          Image<float, ::itk::GetImageDimension<TLevelSet>::ImageDimension> >
+class ITK_EXPORT FastIterativeMarchingImageFilter :
+    public FastMarchingImageFilter<TLevelSet, TSpeedImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef FastIterativeMarchingImageFilter                Self;
+  typedef FastMarchingImageFilter<TLevelSet, TSpeedImage> Superclass;
+  typedef SmartPointer<Self>                              Pointer;
+  typedef SmartPointer<const Self>                        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(FastIterativeMarchingImageFilter, FastMarchingImageFilter);
+
+  itkStaticConstMacro(SetDimension, unsigned int, Superclass::SetDimension);
+
+  typedef typename Superclass::LevelSetImageType   LevelSetImageType;
+  typedef typename Superclass::PixelType           PixelType;
+  typedef typename Superclass::SpeedImageType      SpeedImageType;
+  typedef typename Superclass::NodeType            NodeType;
+  typedef typename Superclass::NodeContainer       NodeContainer;
+  typedef typename Superclass::IndexType           IndexType;
+  typedef typename LevelSetImageType::RegionType   RegionType;
+  typedef typename LevelSetImageType::SizeType     SizeType;
+
+  /** Choose the fast iterative method instead of the heap. */
+  itkSetMacro( UseFastIterativeMethod, bool );
+  itkGetConstMacro( UseFastIterativeMethod, bool );
+  itkBooleanMacro( UseFastIterativeMethod );
+
+  /** Change of value below which a pixel is converged. */
+  itkSetMacro( Tolerance, double );
+  itkGetConstMacro( Tolerance, double );
+
+  /** Number of rounds of the last fast iterative update. */
+  itkGetConstMacro( NumberOfRounds, unsigned int );
+
+protected:
+  FastIterativeMarchingImageFilter();
+  virtual ~FastIterativeMarchingImageFilter() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  void GenerateData();
+
+private:
+  FastIterativeMarchingImageFilter( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  typedef enum { Inactive = 0, Active = 1, Fixed = 2 } StateType;
+
+  /** Put the alive and trial points in the output and in the lists. */
+  void InitializeFronts();
+
+  /** Update the ghost faces of the slabs and activate the face pixels
+   * whose outer neighbor decreased. Returns false if no pixel is active. */
+  bool ExchangeFaces();
+
+  static ITK_THREAD_RETURN_TYPE MarchThreaderCallback( void * arg );
+
+  void ThreadedMarch( unsigned int slab );
+
+  /** Upwind solution at p from the current values, and the slab ghosts
+   * across its faces. */
+  double Solve( unsigned long p, unsigned int slab ) const;
+
+  bool                         m_UseFastIterativeMethod;
+  double                       m_Tolerance;
+  unsigned int                 m_NumberOfRounds;
+
+  /** Geometry of the output buffer and of the slabs. */
+  SizeType                     m_Size;
+  unsigned long                m_Strides[SetDimension];
+  double                       m_InverseSpacingSquared[SetDimension];
+  double                       m_LargeValue;
+  std::vector<unsigned long>   m_SlabStart;
+
+  PixelType *                  m_Buffer;
+  const typename SpeedImageType::PixelType * m_Speed;
+  std::vector<unsigned char>   m_State;
+
+  /** Active pixels of each slab, and the values of the slice below and
+   * above each slab at the start of the round. */
+  std::vector< std::vector<unsigned long> >   m_Active;
+  std::vector< std::vector<double> >          m_GhostBelow;
+  std::vector< std::vector<double> >          m_GhostAbove;
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkFastIterativeMarchingImageFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,430 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkFastIterativeMarchingImageFilter.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkFastIterativeMarchingImageFilter_txx
+#define _itkFastIterativeMarchingImageFilter_txx
+
+#include "itkFastIterativeMarchingImageFilter.h"
+#include "vnl/vnl_math.h"
+
+#include <cmath>
+
+namespace itk
+{
+
+template <class TLevelSet, class TSpeedImage>
+FastIterativeMarchingImageFilter<TLevelSet,TSpeedImage>
+::FastIterativeMarchingImageFilter()
+{
+  m_UseFastIterativeMethod = false;
+  m_Tolerance = 1e-4;
+  m_NumberOfRounds = 0;
+
+  m_LargeValue = static_cast<double>(
+    static_cast<PixelType>( NumericTraits<PixelType>::max() / 2.0 ) );
+  m_Buffer = 0;
+  m_Speed = 0;
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+double
+FastIterativeMarchingImageFilter<TLevelSet,TSpeedImage>
+::Solve( unsigned long p, unsigned int slab ) const
+{
+  double speed;
+  if ( m_Speed )
+    {
+    speed = static_cast<double>( m_Speed[p] ) / this->GetNormalizationFactor();
+    }
+  else
+    {
+    speed = this->GetSpeedConstant();
+    }
+  if ( speed <= 0.0 )
+    {
+    return m_LargeValue;
+    }
+
+  const unsigned int lastAxis = SetDimension - 1;
+  const unsigned long sliceSize = m_Strides[lastAxis];
+
+  // Smallest neighbor along each axis, sorted by value.
+  double values[SetDimension];
+  double factors[SetDimension];
+  for ( unsigned int d = 0; d < SetDimension; d++ )
+    {
+    const unsigned long coordinate = ( p / m_Strides[d] ) % m_Size[d];
+    double value = m_LargeValue;
+    if ( coordinate > 0 )
+      {
+      if ( d == lastAxis && coordinate == m_SlabStart[slab] )
+        {
+        value = m_GhostBelow[slab][p % sliceSize];
+        }
+      else
+        {
+        value = m_Buffer[p - m_Strides[d]];
+        }
+      }
+    if ( coordinate + 1 < m_Size[d] )
+      {
+      double next;
+      if ( d == lastAxis && coordinate + 1 == m_SlabStart[slab + 1] )
+        {
+        next = m_GhostAbove[slab][p % sliceSize];
+        }
+      else
+        {
+        next = m_Buffer[p + m_Strides[d]];
+        }
+      value = vnl_math_min( value, next );
+      }
+
+    unsigned int j = d;
+    while ( j > 0 && values[j-1] > value )
+      {
+      values[j] = values[j-1];
+      factors[j] = factors[j-1];
+      j--;
+      }
+    values[j] = value;
+    factors[j] = m_InverseSpacingSquared[d];
+    }
+
+  // Same quadratic as FastMarchingImageFilter::UpdateValue()
+  double solution = m_LargeValue;
+  double aa = 0.0;
+  double bb = 0.0;
+  double cc = -1.0 / ( speed * speed );
+  for ( unsigned int j = 0; j < SetDimension; j++ )
+    {
+    if ( solution < values[j] )
+      {
+      break;
+      }
+    aa += factors[j];
+    bb += values[j] * factors[j];
+    cc += values[j] * values[j] * factors[j];
+    const double discriminant = bb * bb - aa * cc;
+    if ( discriminant < 0.0 )
+      {
+      break;
+      }
+    solution = ( vcl_sqrt( discriminant ) + bb ) / aa;
+    }
+
+  return solution;
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+void
+FastIterativeMarchingImageFilter<TLevelSet,TSpeedImage>
+::InitializeFronts()
+{
+  LevelSetImageType * output = this->GetOutput();
+  const RegionType region = output->GetBufferedRegion();
+  const unsigned int lastAxis = SetDimension - 1;
+
+  for ( unsigned int s = 0; s + 1 < m_SlabStart.size(); s++ )
+    {
+    m_Active[s].clear();
+    }
+
+  for ( unsigned int pass = 0; pass < 2; pass++ )
+    {
+    typename NodeContainer::Pointer nodes =
+      ( pass == 0 ) ? this->GetAlivePoints() : this->GetTrialPoints();
+    if ( !nodes )
+      {
+      continue;
+      }
+
+    typename NodeContainer::ConstIterator node = nodes->Begin();
+    for ( ; node != nodes->End(); ++node )
+      {
+      const IndexType & index = node.Value().GetIndex();
+      if ( !region.IsInside( index ) )
+        {
+        continue;
+        }
+      const unsigned long p = output->ComputeOffset( index );
+      if ( m_State[p] != Inactive )
+        {
+        continue;
+        }
+      m_Buffer[p] = node.Value().GetValue();
+
+      // As with the heap, alive points are fixed boundary values and the
+      // front starts from the trial points, which may still be lowered.
+      if ( pass == 0 )
+        {
+        m_State[p] = Fixed;
+        continue;
+        }
+      const unsigned long slice = index[lastAxis] - region.GetIndex()[lastAxis];
+      unsigned int s = 0;
+      while ( slice >= m_SlabStart[s + 1] )
+        {
+        s++;
+        }
+      m_State[p] = Active;
+      m_Active[s].push_back( p );
+      }
+    }
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+bool
+FastIterativeMarchingImageFilter<TLevelSet,TSpeedImage>
+::ExchangeFaces()
+{
+  const unsigned int lastAxis = SetDimension - 1;
+  const unsigned long sliceSize = m_Strides[lastAxis];
+  const unsigned int numberOfSlabs = m_SlabStart.size() - 1;
+
+  bool active = false;
+  for ( unsigned int s = 0; s < numberOfSlabs; s++ )
+    {
+    for ( unsigned int side = 0; side < 2; side++ )
+      {
+      // slice outside of the slab, and face slice inside of it
+      unsigned long outside;
+      unsigned long inside;
+      if ( side == 0 )
+        {
+        if ( s == 0 )
+          {
+          continue;
+          }
+        outside = m_SlabStart[s] - 1;
+        inside = m_SlabStart[s];
+        }
+      else
+        {
+        if ( s + 1 == numberOfSlabs )
+          {
+          continue;
+          }
+        outside = m_SlabStart[s + 1];
+        inside = m_SlabStart[s + 1] - 1;
+        }
+      std::vector<double> & ghost =
+        ( side == 0 ) ? m_GhostBelow[s] : m_GhostAbove[s];
+
+      for ( unsigned long k = 0; k < sliceSize; k++ )
+        {
+        const double value = m_Buffer[outside * sliceSize + k];
+        if ( value < ghost[k] )
+          {
+          ghost[k] = value;
+          const unsigned long p = inside * sliceSize + k;
+          if ( m_State[p] == Inactive )
+            {
+            m_State[p] = Active;
+            m_Active[s].push_back( p );
+            }
+          }
+        }
+      }
+    active = active || !m_Active[s].empty();
+    }
+  return active;
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+ITK_THREAD_RETURN_TYPE
+FastIterativeMarchingImageFilter<TLevelSet,TSpeedImage>
+::MarchThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+  self->ThreadedMarch( info->ThreadID );
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+void
+FastIterativeMarchingImageFilter<TLevelSet,TSpeedImage>
+::ThreadedMarch( unsigned int slab )
+{
+  const unsigned int lastAxis = SetDimension - 1;
+  const unsigned long firstSlice = m_SlabStart[slab];
+  const unsigned long lastSlice = m_SlabStart[slab + 1];
+  const double stoppingValue = this->GetStoppingValue();
+
+  std::vector<unsigned long> & active = m_Active[slab];
+  std::vector<unsigned long> next;
+
+  while ( !active.empty() )
+    {
+    next.clear();
+    for ( unsigned int i = 0; i < active.size(); i++ )
+      {
+      const unsigned long p = active[i];
+      const PixelType previous = m_Buffer[p];
+
+      // compared as stored: a double solution stays below the rounded
+      // pixel value by the rounding error, larger than the tolerance for
+      // large arrival times
+      const PixelType solution =
+        static_cast<PixelType>( this->Solve( p, slab ) );
+      if ( solution < previous )
+        {
+        m_Buffer[p] = solution;
+        }
+      if ( static_cast<double>( previous ) - m_Buffer[p] > m_Tolerance )
+        {
+        next.push_back( p );
+        continue;
+        }
+      m_State[p] = Inactive;
+
+      // converged: the front moves on to the neighbors
+      if ( m_Buffer[p] > stoppingValue )
+        {
+        continue;
+        }
+      for ( unsigned int d = 0; d < SetDimension; d++ )
+        {
+        const unsigned long coordinate = ( p / m_Strides[d] ) % m_Size[d];
+        const unsigned long lowest = ( d == lastAxis ) ? firstSlice : 0;
+        const unsigned long highest = ( d == lastAxis ) ? lastSlice : m_Size[d];
+        for ( unsigned int side = 0; side < 2; side++ )
+          {
+          if ( side == 0 ? coordinate <= lowest : coordinate + 1 >= highest )
+            {
+            continue;
+            }
+          const unsigned long q =
+            ( side == 0 ) ? p - m_Strides[d] : p + m_Strides[d];
+          if ( m_State[q] != Inactive )
+            {
+            continue;
+            }
+          const PixelType solution =
+            static_cast<PixelType>( this->Solve( q, slab ) );
+          if ( solution < m_Buffer[q] )
+            {
+            m_Buffer[q] = solution;
+            m_State[q] = Active;
+            next.push_back( q );
+            }
+          }
+        }
+      }
+    active.swap( next );
+    }
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+void
+FastIterativeMarchingImageFilter<TLevelSet,TSpeedImage>
+::GenerateData()
+{
+  if ( !m_UseFastIterativeMethod )
+    {
+    this->Superclass::GenerateData();
+    return;
+    }
+
+  LevelSetImageType * output = this->GetOutput();
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+  output->FillBuffer( static_cast<PixelType>( m_LargeValue ) );
+
+  const RegionType region = output->GetBufferedRegion();
+  m_Size = region.GetSize();
+  m_Strides[0] = 1;
+  for ( unsigned int d = 1; d < SetDimension; d++ )
+    {
+    m_Strides[d] = m_Strides[d-1] * m_Size[d-1];
+    }
+  for ( unsigned int d = 0; d < SetDimension; d++ )
+    {
+    m_InverseSpacingSquared[d] = vnl_math_sqr( 1.0 / output->GetSpacing()[d] );
+    }
+
+  m_Buffer = output->GetBufferPointer();
+  const SpeedImageType * speedImage = this->GetInput();
+  m_Speed = 0;
+  if ( speedImage )
+    {
+    if ( speedImage->GetBufferedRegion() != region )
+      {
+      itkExceptionMacro( << "The fast iterative method needs a speed image "
+                         << "buffered over the output region" );
+      }
+    m_Speed = speedImage->GetBufferPointer();
+    }
+  m_State.assign( region.GetNumberOfPixels(), Inactive );
+
+  // one slab per thread along the last axis
+  const unsigned int lastAxis = SetDimension - 1;
+  const unsigned long slices = m_Size[lastAxis];
+  const unsigned int numberOfSlabs = vnl_math_min(
+    static_cast<unsigned long>( this->GetNumberOfThreads() ), slices );
+  m_SlabStart.resize( numberOfSlabs + 1 );
+  for ( unsigned int s = 0; s <= numberOfSlabs; s++ )
+    {
+    m_SlabStart[s] = ( slices * s ) / numberOfSlabs;
+    }
+  m_Active.resize( numberOfSlabs );
+  m_GhostBelow.assign( numberOfSlabs,
+    std::vector<double>( m_Strides[lastAxis], m_LargeValue ) );
+  m_GhostAbove.assign( numberOfSlabs,
+    std::vector<double>( m_Strides[lastAxis], m_LargeValue ) );
+
+  this->InitializeFronts();
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfSlabs );
+  this->GetMultiThreader()->SetSingleMethod( Self::MarchThreaderCallback,
+                                             this );
+
+  m_NumberOfRounds = 0;
+  while ( m_NumberOfRounds == 0 || this->ExchangeFaces() )
+    {
+    this->GetMultiThreader()->SingleMethodExecute();
+    m_NumberOfRounds++;
+    }
+
+  m_State.clear();
+  m_Buffer = 0;
+  m_Speed = 0;
+}
+
+
+template <class TLevelSet, class TSpeedImage>
+void
+FastIterativeMarchingImageFilter<TLevelSet,TSpeedImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "UseFastIterativeMethod: " << m_UseFastIterativeMethod
+     << std::endl;
+  os << indent << "Tolerance: " << m_Tolerance << std::endl;
+  os << indent << "NumberOfRounds: " << m_NumberOfRounds << std::endl;
+}
+
+} // namespace itk
+
+#endif
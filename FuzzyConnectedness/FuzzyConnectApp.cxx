@@ -20,6 +20,7 @@
 #include "PGMVolumeWriter.h"
 
 #include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
 
 #include <string>
 #include <stdio.h>
@@ -168,7 +169,7 @@ FuzzyConnectApp
 
   while(1)
    {
-   std::cout << std::endl << "Command [s|t|d|x]: ";
+   std::cout << std::endl << "Command [s|t|c|d|x]: ";
    std::cin.getline( currentLine, 150 );
    if( sscanf( currentLine, "%s", buffer ) >= 1 )
      {
@@ -201,6 +202,10 @@ FuzzyConnectApp
          this->WriteSegmentationImage();
          break;
         break;
+      case 'c':
+        std::cout << "Running the single threaded filter." << std::endl;
+        this->CompareWithReference();
+        break;
       case 'd':
         std::cout << "Seed: " << m_Seed << " Threshold: " << m_Threshold << std::endl;
         break;
@@ -271,7 +276,14 @@ FuzzyConnectApp
 
   m_Filter->SetThreshold( m_Threshold );
 
+  itk::TimeProbe probe;
+  probe.Start();
   m_Filter->Update();
+  probe.Stop();
+
+  std::cout << "map computed in " << probe.GetMeanTime() << " s ("
+            << m_Filter->GetNumberOfThreads() << " threads, "
+            << m_Filter->GetNumberOfRounds() << " rounds)" << std::endl;
  
 }
 
@@ -281,7 +293,56 @@ FuzzyConnectApp
 ::ComputeSegmentationImage()
 {
 
+  itk::TimeProbe probe;
+  probe.Start();
   m_Filter->UpdateThreshold( m_Threshold );
+  probe.Stop();
+
+  std::cout << "map thresholded in " << probe.GetMeanTime() << " s" << std::endl;
+
+}
+
+
+void
+FuzzyConnectApp
+::CompareWithReference()
+{
+
+  ReferenceFilterType::Pointer reference = ReferenceFilterType::New();
+  reference->SetInput( m_InputImage );
+  reference->SetObjectSeed( m_Seed );
+  reference->SetMean( m_ObjectMean );
+  reference->SetVariance( m_ObjectVariance );
+  reference->SetThreshold( m_Threshold );
+
+  itk::TimeProbe probe;
+  probe.Start();
+  reference->Update();
+  probe.Stop();
+
+  std::cout << "single threaded map computed in " << probe.GetMeanTime()
+            << " s" << std::endl;
+
+  // The reference connectedness is quantized to unsigned short, so a few
+  // pixels at the threshold may differ.
+  typedef itk::ImageRegionConstIterator<InputImageType> Iterator;
+  Iterator iter( m_Filter->GetOutput(), 
+                 m_Filter->GetOutput()->GetBufferedRegion() );
+  Iterator referenceIter( reference->GetOutput(), 
+                          m_Filter->GetOutput()->GetBufferedRegion() );
+
+  unsigned long differences = 0;
+  while( !iter.IsAtEnd() )
+    {
+    if( iter.Get() != referenceIter.Get() )
+      {
+      differences++;
+      }
+    ++iter;
+    ++referenceIter;
+    }
+
+  std::cout << differences << " pixels differ" << std::endl;
 
 }
 
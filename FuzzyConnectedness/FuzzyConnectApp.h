@@ -19,6 +19,7 @@
 
 #include "itkImage.h"
 #include "itkSimpleFuzzyConnectednessScalarImageFilter.h"
+#include "itkParallelFuzzyConnectednessImageFilter.h"
 #include <string>
 
 /** \class FuzzyConnectApp
@@ -50,10 +51,14 @@ public:
   typedef InputImageType::IndexType IndexType;
 
   /** Fuzzy connectedness filter type. */
-  typedef itk::SimpleFuzzyConnectednessScalarImageFilter<InputImageType,InputImageType>
+  typedef itk::ParallelFuzzyConnectednessImageFilter<InputImageType,InputImageType>
           FilterType;
   typedef FilterType::Pointer FilterPointer;
 
+  /** Single threaded fuzzy connectedness filter, for comparison. */
+  typedef itk::SimpleFuzzyConnectednessScalarImageFilter<InputImageType,InputImageType>
+          ReferenceFilterType;
+
   /** Constructors */
   FuzzyConnectApp();
   FuzzyConnectApp( const char * );
@@ -116,6 +121,9 @@ private:
    /*** Compute segmentation image  */
    void ComputeSegmentationImage();
 
+   /*** Run the single threaded filter and compare the segmentations  */
+   void CompareWithReference();
+
    /*** Write out segmentation image  */
    void WriteSegmentationImage();
 
@@ -0,0 +1,210 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelFuzzyConnectednessImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkParallelFuzzyConnectednessImageFilter_h
+#define _itkParallelFuzzyConnectednessImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkImage.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class ParallelFuzzyConnectednessImageFilter
+ *
+ * Fuzzy connectedness of a scalar image from a seed, with the affinity of
+ * SimpleFuzzyConnectednessScalarImageFilter: for two face neighbors of
+ * values f1 and f2,
+ *
+ *   w g( (f1 + f2) / 2 ; Mean, Variance )
+ *     + (1 - w) g( |f1 - f2| ; DifferenceMean, DifferenceVariance )
+ *
+ * with g the unnormalized Gaussian and w the Weight. The connectedness of
+ * a pixel is the largest, over the paths from the seed, of the smallest
+ * affinity along the path; it is given in [0,1] by GetFuzzyScene() and
+ * the output is 1 where it is above Threshold, 0 elsewhere.
+ *
+ * The computation is split in three stages, each one run by the threads
+ * of the filter on slabs along the last image axis:
+ *
+ * - the affinities between each pixel and its next neighbor along every
+ *   axis are computed once, in float, and kept until the input, Mean,
+ *   Variance, Weight or difference parameters change;
+ * - the connectedness is propagated from the seed. Each thread runs a
+ *   bucketed label correcting search (NumberOfBuckets buckets of
+ *   connectedness, highest first) restricted to its slab; between two
+ *   rounds the values are exchanged across the slab faces, and the rounds
+ *   stop when no face value changes. It is only run again when the seed
+ *   or the affinities change;
+ * - the connectedness is thresholded.
+ *
+ * UpdateThreshold() only runs the last stage.
+ *
+ * \ingroup FuzzyConnectednessSegmentation
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT ParallelFuzzyConnectednessImageFilter :
+    public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParallelFuzzyConnectednessImageFilter          Self;
+  typedef ImageToImageFilter<TInputImage, TOutputImage>  Superclass;
+  typedef SmartPointer<Self>                             Pointer;
+  typedef SmartPointer<const Self>                       ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ParallelFuzzyConnectednessImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+
+  typedef TInputImage                              InputImageType;
+  typedef typename InputImageType::PixelType       InputPixelType;
+  typedef typename InputImageType::IndexType       IndexType;
+  typedef typename InputImageType::SizeType        SizeType;
+  typedef typename InputImageType::RegionType      RegionType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename OutputImageType::PixelType      OutputPixelType;
+
+  typedef Image<float, itkGetStaticConstMacro(ImageDimension)>
+                                                   FuzzySceneType;
+
+  /** Seed of the object. */
+  itkSetMacro( ObjectSeed, IndexType );
+  itkGetConstReferenceMacro( ObjectSeed, IndexType );
+
+  /** Statistics of the object intensity. */
+  itkSetMacro( Mean, double );
+  itkGetConstMacro( Mean, double );
+  itkSetMacro( Variance, double );
+  itkGetConstMacro( Variance, double );
+
+  /** Statistics of the intensity difference between neighbors, used when
+   * Weight is below one. */
+  itkSetMacro( DifferenceMean, double );
+  itkGetConstMacro( DifferenceMean, double );
+  itkSetMacro( DifferenceVariance, double );
+  itkGetConstMacro( DifferenceVariance, double );
+
+  itkSetClampMacro( Weight, double, 0.0, 1.0 );
+  itkGetConstMacro( Weight, double );
+
+  /** Connectedness threshold, between 0 and 1. */
+  itkSetMacro( Threshold, double );
+  itkGetConstMacro( Threshold, double );
+
+  /** Number of connectedness buckets of the propagation. */
+  itkSetClampMacro( NumberOfBuckets, unsigned int, 2, 65536 );
+  itkGetConstMacro( NumberOfBuckets, unsigned int );
+
+  /** Threshold the last connectedness map again, into the current output,
+   * without propagating. When the input is newer than the map, or the
+   * seed or the statistics changed, the filter is updated instead. */
+  void UpdateThreshold( double threshold );
+
+  /** Connectedness map of the last update. */
+  FuzzySceneType * GetFuzzyScene()
+    { return m_FuzzyScene; }
+
+  /** Number of propagation rounds of the last update. */
+  itkGetConstMacro( NumberOfRounds, unsigned int );
+
+protected:
+  ParallelFuzzyConnectednessImageFilter();
+  virtual ~ParallelFuzzyConnectednessImageFilter() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** The whole input and output are needed. */
+  virtual void GenerateInputRequestedRegion();
+  virtual void EnlargeOutputRequestedRegion( DataObject * );
+
+  void GenerateData();
+
+private:
+  ParallelFuzzyConnectednessImageFilter( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  typedef enum { AffinityStage, PropagationStage, ThresholdStage } StageType;
+
+  /** Run the given stage with one thread per slab. */
+  void ExecuteStage( StageType stage );
+
+  static ITK_THREAD_RETURN_TYPE StageThreaderCallback( void * arg );
+
+  void ThreadedComputeAffinities( unsigned int slab );
+  void ThreadedPropagate( unsigned int slab );
+  void ThreadedThreshold( unsigned int slab );
+
+  /** Split the last axis between the threads. */
+  void ComputeSlabs();
+
+  /** Relax the pixel pairs across the slab faces. Returns true if a value
+   * changed. */
+  bool ExchangeFaces();
+
+  /** Whether the affinities were computed for the current input and
+   * parameters. */
+  bool AffinitiesAreValid() const;
+
+  void ComputeScene();
+
+  IndexType                    m_ObjectSeed;
+  double                       m_Mean;
+  double                       m_Variance;
+  double                       m_DifferenceMean;
+  double                       m_DifferenceVariance;
+  double                       m_Weight;
+  double                       m_Threshold;
+  unsigned int                 m_NumberOfBuckets;
+  unsigned int                 m_NumberOfRounds;
+
+  /** Affinity of each pixel with its next neighbor along each axis,
+   * interleaved, zero on the last face. */
+  std::vector<float>           m_Affinities;
+  const InputImageType *       m_AffinityInput;
+  unsigned long                m_AffinityInputTime;
+  double                       m_AffinityParameters[5];
+
+  typename FuzzySceneType::Pointer  m_FuzzyScene;
+  bool                         m_SceneIsValid;
+  IndexType                    m_SceneSeed;
+
+  /** Geometry of the buffers and slabs. */
+  SizeType                     m_Size;
+  unsigned long                m_Strides[ImageDimension];
+  std::vector<unsigned long>   m_SlabStart;
+
+  /** Pixels of each slab to propagate from in the next round, and the
+   * buckets of each slab. */
+  std::vector< std::vector<unsigned long> >                m_Pending;
+  std::vector< std::vector< std::vector<unsigned long> > > m_Buckets;
+
+  StageType                    m_Stage;
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkParallelFuzzyConnectednessImageFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,478 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelFuzzyConnectednessImageFilter.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkParallelFuzzyConnectednessImageFilter_txx
+#define _itkParallelFuzzyConnectednessImageFilter_txx
+
+#include "itkParallelFuzzyConnectednessImageFilter.h"
+#include "vnl/vnl_math.h"
+
+#include <cmath>
+
+namespace itk
+{
+
+template <class TInputImage, class TOutputImage>
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::ParallelFuzzyConnectednessImageFilter()
+{
+  m_ObjectSeed.Fill( 0 );
+  m_Mean = 0.0;
+  m_Variance = 1.0;
+  m_DifferenceMean = 0.0;
+  m_DifferenceVariance = 1.0;
+  m_Weight = 1.0;
+  m_Threshold = 0.5;
+  m_NumberOfBuckets = 256;
+  m_NumberOfRounds = 0;
+
+  m_AffinityInput = 0;
+  m_AffinityInputTime = 0;
+  for ( unsigned int i = 0; i < 5; i++ )
+    {
+    m_AffinityParameters[i] = 0.0;
+    }
+
+  m_FuzzyScene = FuzzySceneType::New();
+  m_SceneIsValid = false;
+  m_SceneSeed.Fill( 0 );
+
+  m_Stage = AffinityStage;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+  InputImageType * input = const_cast<InputImageType *>( this->GetInput() );
+  if ( input )
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <class TInputImage, class TOutputImage>
+bool
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::AffinitiesAreValid() const
+{
+  const InputImageType * input = this->GetInput();
+  return !m_Affinities.empty() &&
+         m_AffinityInput == input &&
+         m_AffinityInputTime == input->GetMTime() &&
+         m_AffinityParameters[0] == m_Mean &&
+         m_AffinityParameters[1] == m_Variance &&
+         m_AffinityParameters[2] == m_DifferenceMean &&
+         m_AffinityParameters[3] == m_DifferenceVariance &&
+         m_AffinityParameters[4] == m_Weight;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::ComputeSlabs()
+{
+  const RegionType region = this->GetInput()->GetBufferedRegion();
+  m_Size = region.GetSize();
+
+  m_Strides[0] = 1;
+  for ( unsigned int d = 1; d < ImageDimension; d++ )
+    {
+    m_Strides[d] = m_Strides[d-1] * m_Size[d-1];
+    }
+
+  const unsigned long slices = m_Size[ImageDimension - 1];
+  const unsigned int numberOfSlabs = vnl_math_min(
+    static_cast<unsigned long>( this->GetNumberOfThreads() ), slices );
+
+  m_SlabStart.resize( numberOfSlabs + 1 );
+  for ( unsigned int s = 0; s <= numberOfSlabs; s++ )
+    {
+    m_SlabStart[s] = ( slices * s ) / numberOfSlabs;
+    }
+
+  m_Pending.resize( numberOfSlabs );
+  m_Buckets.resize( numberOfSlabs );
+  for ( unsigned int s = 0; s < numberOfSlabs; s++ )
+    {
+    m_Buckets[s].resize( m_NumberOfBuckets );
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::StageThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+  const unsigned int slab = info->ThreadID;
+
+  switch ( self->m_Stage )
+    {
+    case AffinityStage:
+      self->ThreadedComputeAffinities( slab );
+      break;
+    case PropagationStage:
+      self->ThreadedPropagate( slab );
+      break;
+    case ThresholdStage:
+      self->ThreadedThreshold( slab );
+      break;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::ExecuteStage( StageType stage )
+{
+  m_Stage = stage;
+  this->GetMultiThreader()->SetNumberOfThreads( m_SlabStart.size() - 1 );
+  this->GetMultiThreader()->SetSingleMethod( Self::StageThreaderCallback,
+                                             this );
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::ThreadedComputeAffinities( unsigned int slab )
+{
+  const InputPixelType * input = this->GetInput()->GetBufferPointer();
+  float * affinities = &m_Affinities[0];
+
+  const double halfInverseVariance = 0.5 / m_Variance;
+  const double halfInverseDifferenceVariance = 0.5 / m_DifferenceVariance;
+
+  const unsigned long first =
+    m_SlabStart[slab] * m_Strides[ImageDimension - 1];
+  const unsigned long last =
+    m_SlabStart[slab + 1] * m_Strides[ImageDimension - 1];
+
+  for ( unsigned long p = first; p < last; p++ )
+    {
+    const double f1 = static_cast<double>( input[p] );
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      float & affinity = affinities[p * ImageDimension + d];
+      const unsigned long coordinate = ( p / m_Strides[d] ) % m_Size[d];
+      if ( coordinate + 1 >= m_Size[d] )
+        {
+        affinity = 0.0f;
+        continue;
+        }
+      const double f2 = static_cast<double>( input[p + m_Strides[d]] );
+      const double mean = 0.5 * ( f1 + f2 ) - m_Mean;
+      double value = vcl_exp( -mean * mean * halfInverseVariance );
+      if ( m_Weight < 1.0 )
+        {
+        const double difference = vcl_fabs( f1 - f2 ) - m_DifferenceMean;
+        value = m_Weight * value + ( 1.0 - m_Weight ) *
+          vcl_exp( -difference * difference * halfInverseDifferenceVariance );
+        }
+      affinity = static_cast<float>( value );
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::ThreadedPropagate( unsigned int slab )
+{
+  const float * affinities = &m_Affinities[0];
+  float * scene = m_FuzzyScene->GetBufferPointer();
+
+  const unsigned int lastAxis = ImageDimension - 1;
+  const unsigned long firstSlice = m_SlabStart[slab];
+  const unsigned long lastSlice = m_SlabStart[slab + 1];
+  const float bucketScale = static_cast<float>( m_NumberOfBuckets - 1 );
+
+  std::vector< std::vector<unsigned long> > & buckets = m_Buckets[slab];
+  std::vector<unsigned long> & pending = m_Pending[slab];
+
+  for ( unsigned int i = 0; i < pending.size(); i++ )
+    {
+    const unsigned long p = pending[i];
+    buckets[static_cast<unsigned int>( scene[p] * bucketScale )].push_back( p );
+    }
+  pending.clear();
+
+  // Strongest connectedness first. A pixel can only lower or keep the
+  // bucket of its neighbors, so the buckets above the current one stay
+  // empty; inside a bucket the pixels are corrected as often as needed.
+  for ( int b = m_NumberOfBuckets - 1; b >= 0; b-- )
+    {
+    std::vector<unsigned long> & bucket = buckets[b];
+    while ( !bucket.empty() )
+      {
+      const unsigned long p = bucket.back();
+      bucket.pop_back();
+      const float value = scene[p];
+
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        const unsigned long coordinate = ( p / m_Strides[d] ) % m_Size[d];
+        const unsigned long lowest = ( d == lastAxis ) ? firstSlice : 0;
+        const unsigned long highest = ( d == lastAxis ) ? lastSlice : m_Size[d];
+
+        if ( coordinate > lowest )
+          {
+          const unsigned long q = p - m_Strides[d];
+          const float candidate =
+            vnl_math_min( value, affinities[q * ImageDimension + d] );
+          if ( candidate > scene[q] )
+            {
+            scene[q] = candidate;
+            buckets[static_cast<unsigned int>( candidate * bucketScale )]
+              .push_back( q );
+            }
+          }
+        if ( coordinate + 1 < highest )
+          {
+          const unsigned long q = p + m_Strides[d];
+          const float candidate =
+            vnl_math_min( value, affinities[p * ImageDimension + d] );
+          if ( candidate > scene[q] )
+            {
+            scene[q] = candidate;
+            buckets[static_cast<unsigned int>( candidate * bucketScale )]
+              .push_back( q );
+            }
+          }
+        }
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+bool
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::ExchangeFaces()
+{
+  const float * affinities = &m_Affinities[0];
+  float * scene = m_FuzzyScene->GetBufferPointer();
+
+  const unsigned int lastAxis = ImageDimension - 1;
+  const unsigned long sliceSize = m_Strides[lastAxis];
+
+  bool changed = false;
+  for ( unsigned int s = 1; s + 1 < m_SlabStart.size(); s++ )
+    {
+    const unsigned long upperStart = m_SlabStart[s] * sliceSize;
+    for ( unsigned long k = 0; k < sliceSize; k++ )
+      {
+      const unsigned long upper = upperStart + k;
+      const unsigned long lower = upper - sliceSize;
+      const float affinity = affinities[lower * ImageDimension + lastAxis];
+
+      const float fromLower = vnl_math_min( scene[lower], affinity );
+      if ( fromLower > scene[upper] )
+        {
+        scene[upper] = fromLower;
+        m_Pending[s].push_back( upper );
+        changed = true;
+        }
+      const float fromUpper = vnl_math_min( scene[upper], affinity );
+      if ( fromUpper > scene[lower] )
+        {
+        scene[lower] = fromUpper;
+        m_Pending[s - 1].push_back( lower );
+        changed = true;
+        }
+      }
+    }
+  return changed;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::ComputeScene()
+{
+  const InputImageType * input = this->GetInput();
+  const RegionType region = input->GetBufferedRegion();
+
+  if ( !region.IsInside( m_ObjectSeed ) )
+    {
+    itkExceptionMacro( << "Seed " << m_ObjectSeed
+                       << " is outside of the image" );
+    }
+
+  m_FuzzyScene = FuzzySceneType::New();
+  m_FuzzyScene->CopyInformation( input );
+  m_FuzzyScene->SetRegions( region );
+  m_FuzzyScene->Allocate();
+  m_FuzzyScene->FillBuffer( 0.0f );
+
+  const unsigned long seed = input->ComputeOffset( m_ObjectSeed );
+  m_FuzzyScene->GetBufferPointer()[seed] = 1.0f;
+
+  const unsigned long seedSlice =
+    m_ObjectSeed[ImageDimension - 1] - region.GetIndex()[ImageDimension - 1];
+  for ( unsigned int s = 0; s + 1 < m_SlabStart.size(); s++ )
+    {
+    m_Pending[s].clear();
+    if ( seedSlice >= m_SlabStart[s] && seedSlice < m_SlabStart[s + 1] )
+      {
+      m_Pending[s].push_back( seed );
+      }
+    }
+
+  m_NumberOfRounds = 0;
+  do
+    {
+    this->ExecuteStage( PropagationStage );
+    m_NumberOfRounds++;
+    }
+  while ( this->ExchangeFaces() );
+
+  m_SceneSeed = m_ObjectSeed;
+  m_SceneIsValid = true;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::ThreadedThreshold( unsigned int slab )
+{
+  const float * scene = m_FuzzyScene->GetBufferPointer();
+  OutputPixelType * output = this->GetOutput()->GetBufferPointer();
+  const float threshold = static_cast<float>( m_Threshold );
+
+  const unsigned long first =
+    m_SlabStart[slab] * m_Strides[ImageDimension - 1];
+  const unsigned long last =
+    m_SlabStart[slab + 1] * m_Strides[ImageDimension - 1];
+
+  for ( unsigned long p = first; p < last; p++ )
+    {
+    output[p] = ( scene[p] > threshold ) ?
+      NumericTraits<OutputPixelType>::One :
+      NumericTraits<OutputPixelType>::Zero;
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::GenerateData()
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType * output = this->GetOutput();
+
+  output->SetBufferedRegion( input->GetBufferedRegion() );
+  output->Allocate();
+
+  this->ComputeSlabs();
+
+  if ( !this->AffinitiesAreValid() )
+    {
+    m_Affinities.resize(
+      input->GetBufferedRegion().GetNumberOfPixels() * ImageDimension );
+    this->ExecuteStage( AffinityStage );
+
+    m_AffinityInput = input;
+    m_AffinityInputTime = input->GetMTime();
+    m_AffinityParameters[0] = m_Mean;
+    m_AffinityParameters[1] = m_Variance;
+    m_AffinityParameters[2] = m_DifferenceMean;
+    m_AffinityParameters[3] = m_DifferenceVariance;
+    m_AffinityParameters[4] = m_Weight;
+    m_SceneIsValid = false;
+    }
+
+  if ( !m_SceneIsValid || m_SceneSeed != m_ObjectSeed )
+    {
+    this->ComputeScene();
+    }
+
+  this->ExecuteStage( ThresholdStage );
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::UpdateThreshold( double threshold )
+{
+  this->SetThreshold( threshold );
+
+  OutputImageType * output = this->GetOutput();
+  if ( !m_SceneIsValid || !output->GetBufferPointer() )
+    {
+    return;
+    }
+
+  // a modified input or statistics, or another seed, need a new scene
+  if ( !this->AffinitiesAreValid() || m_SceneSeed != m_ObjectSeed )
+    {
+    this->Update();
+    return;
+    }
+
+  this->ExecuteStage( ThresholdStage );
+  output->Modified();
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelFuzzyConnectednessImageFilter<TInputImage,TOutputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "ObjectSeed: " << m_ObjectSeed << std::endl;
+  os << indent << "Mean: " << m_Mean << std::endl;
+  os << indent << "Variance: " << m_Variance << std::endl;
+  os << indent << "DifferenceMean: " << m_DifferenceMean << std::endl;
+  os << indent << "DifferenceVariance: " << m_DifferenceVariance << std::endl;
+  os << indent << "Weight: " << m_Weight << std::endl;
+  os << indent << "Threshold: " << m_Threshold << std::endl;
+  os << indent << "NumberOfBuckets: " << m_NumberOfBuckets << std::endl;
+  os << indent << "NumberOfRounds: " << m_NumberOfRounds << std::endl;
+}
+
+} // namespace itk
+
+#endif
@@ -141,6 +141,16 @@ public:
   itkGetMacro( AppendOutputFile, bool );
   itkBooleanMacro( AppendOutputFile );
 
+  /** Train the codebook with the mini-batch K-means estimator. */
+  itkSetMacro( UseMiniBatchKmeans, bool );
+  itkGetMacro( UseMiniBatchKmeans, bool );
+  itkBooleanMacro( UseMiniBatchKmeans );
+
+  /** Run both K-means estimators and report time and distortion. */
+  itkSetMacro( CompareKmeansEstimators, bool );
+  itkGetMacro( CompareKmeansEstimators, bool );
+  itkBooleanMacro( CompareKmeansEstimators );
+
 protected:
   KmeansClassifierValidationApp();
   virtual ~KmeansClassifierValidationApp(){};
@@ -171,6 +181,8 @@ private:
   std::string                   m_ParameterFileName;
   std::string                   m_OutputFileName;
   bool                          m_AppendOutputFile;
+  bool                          m_UseMiniBatchKmeans;
+  bool                          m_CompareKmeansEstimators;
 
 };
 
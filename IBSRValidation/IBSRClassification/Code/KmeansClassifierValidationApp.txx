@@ -38,6 +38,8 @@ KmeansClassifierValidationApp<TImage,TMaskImage>
   m_ParameterFileName = "";
   m_OutputFileName = "";
   m_AppendOutputFile = true;
+  m_UseMiniBatchKmeans = false;
+  m_CompareKmeansEstimators = false;
 }
 
 
@@ -74,6 +76,8 @@ KmeansClassifierValidationApp<TImage,TMaskImage>
   this->m_Classifier->SetMaskInputImage( this->m_Parser->GetMaskImage() );
   this->m_Classifier->SetNumberOfClasses( m_NumberOfClasses );  
   this->m_Classifier->SetNumberOfChannels( this->m_Parser->GetNumberOfChannels() );  
+  this->m_Classifier->SetUseMiniBatchKmeans( m_UseMiniBatchKmeans );
+  this->m_Classifier->SetCompareKmeansEstimators( m_CompareKmeansEstimators );
  
 }
 
@@ -20,6 +20,7 @@
 #include "itkObject.h"
 
 #include "itkImageKmeansModelEstimator.h"
+#include "itkMiniBatchKmeansImageModelEstimator.h"
 #include "itkDistanceToCentroidMembershipFunction.h"
 
 #include "itkMinimumDecisionRule.h"
@@ -139,6 +140,20 @@ public:
     m_ClassCovariances = classCovariances;
     } 
 
+  /** Train the codebook with the mini-batch estimator. */
+  itkSetMacro( UseMiniBatchKmeans, bool );
+  itkGetMacro( UseMiniBatchKmeans, bool );
+  itkBooleanMacro( UseMiniBatchKmeans );
+
+  /** Run both estimators and report time and distortion. */
+  itkSetMacro( CompareKmeansEstimators, bool );
+  itkGetMacro( CompareKmeansEstimators, bool );
+  itkBooleanMacro( CompareKmeansEstimators );
+
+  /** Set the number of voxels sampled by the mini-batch estimator. */
+  itkSetMacro( NumberOfKmeansSamples, unsigned long );
+  itkGetMacro( NumberOfKmeansSamples, unsigned long );
+
   /** Method to execute the preprocessing. */
   virtual void Execute();
 
@@ -168,6 +183,10 @@ private:
   IntegerMatrixType                            m_ClassNumberOfSamples;
   DoubleMatrixArrayType                        m_ClassCovariances;      
 
+  bool                                         m_UseMiniBatchKmeans;
+  bool                                         m_CompareKmeansEstimators;
+  unsigned long                                m_NumberOfKmeansSamples;
+
 };
 
 } // namespace itk
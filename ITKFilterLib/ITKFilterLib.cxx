@@ -18,7 +18,12 @@
 // The first #include must be itkImage.h
 #include <itkImage.h>
 
+#include <itkCStyleCommand.h>
+
 #include <iostream>
+#include <vector>
+#include <string.h>
+#include <math.h>
 
 #include "ITKFilterLib.h"
 
@@ -31,6 +36,14 @@ typedef itk::Image<g_ItkFilterLibDataType,3>   g_ImageType;
 g_ImageType::Pointer g_InputImage;
 g_ImageType::Pointer g_OutputImage;
 
+// The memory given by the caller, and the settings of the streamed 
+//   execution.
+g_ItkFilterLibDataType * g_InputData = 0;
+g_ItkFilterLibDataType * g_OutputData = 0;
+unsigned long g_MaximumMemory = 0;
+g_ItkFilterLibProgressCallback g_ProgressCallback = 0;
+void * g_ProgressClientData = 0;
+
 
 //
 //
@@ -66,6 +79,179 @@ g_GaussianFilterType::Pointer g_gaussianFilter;
 
 
 
+//
+//
+// Streamed execution, shared by the filters of the .lib
+//
+//
+
+// Part of the image covered by the slab being filtered, and whether the 
+//   progress callback asked to stop.
+float g_StreamProgressStart = 0;
+float g_StreamProgressLength = 1;
+bool  g_StreamCancelled = false;
+
+/** Forwards the progress of the filter on one slab to the progress 
+ *    callback, as a fraction of the whole image.
+ **/
+static void
+StreamProgress(itk::Object * caller, const itk::EventObject &, void *)
+  {
+  itk::ProcessObject * process = dynamic_cast<itk::ProcessObject *>(caller);
+  if( !process || !g_ProgressCallback )
+    {
+    return;
+    }
+  float progress = g_StreamProgressStart 
+                   + g_StreamProgressLength * process->GetProgress();
+  if( g_ProgressCallback(progress, g_ProgressClientData) )
+    {
+    g_StreamCancelled = true;
+    process->AbortGenerateDataOn();
+    }
+  }
+
+/** Runs filter on slabs of whole slices along the third axis, each slab 
+ *    being read with padding slices on both sides.   imagesPerSlab is the
+ *    number of slab sized buffers the filter allocates, and is used with
+ *    g_MaximumMemory to choose the number of slices of a slab.
+ *  When the input and output data are the same memory, the slices written
+ *    by a slab are still read as padding by the next one, so their 
+ *    original values are kept aside and the slab is copied to a buffer 
+ *    before being filtered.
+ **/
+template <class TFilter>
+static bool
+ExecuteStreamed(TFilter * filter, int padding, int imagesPerSlab)
+  {
+  const g_ImageType::RegionType & region = 
+                                    g_InputImage->GetLargestPossibleRegion();
+  const g_ImageType::SizeType & size = region.GetSize();
+  const unsigned long sliceSize = size[0] * size[1];
+  const int depth = size[2];
+  const bool inPlace = ( g_InputData == g_OutputData );
+  if( inPlace )
+    {
+    imagesPerSlab++;
+    }
+
+  // Number of slices filtered by each slab, padding excluded
+  int coreDepth = depth;
+  if( g_MaximumMemory > 0 )
+    {
+    int slabDepth = g_MaximumMemory / ( imagesPerSlab * sliceSize 
+                                        * sizeof(g_ItkFilterLibDataType) );
+    if( slabDepth < depth )
+      {
+      coreDepth = slabDepth - 2 * padding;
+      if( coreDepth < 1 )
+        {
+        std::cerr << "itkFilterLib: the memory limit is too small for "
+                  << 2 * padding + 1 << " slices" << std::endl;
+        return false;
+        }
+      }
+    }
+
+  g_ImageType::Pointer slab = g_ImageType::New();
+  slab->SetOrigin( g_InputImage->GetOrigin() );
+  slab->SetSpacing( g_InputImage->GetSpacing() );
+
+  // The output of the filter may still share the caller's memory through 
+  //   GraftOutput; it gets its own buffer, reused by every slab.
+  filter->SetInput( slab );
+  filter->GetOutput()->SetPixelContainer( 
+                                      g_ImageType::PixelContainer::New() );
+
+  itk::CStyleCommand::Pointer observer = itk::CStyleCommand::New();
+  observer->SetCallback( StreamProgress );
+  unsigned long tag = filter->AddObserver( itk::ProgressEvent(), observer );
+  g_StreamCancelled = false;
+
+  std::vector<g_ItkFilterLibDataType> slabBuffer;
+  std::vector<g_ItkFilterLibDataType> savedSlices;
+
+  bool ok = true;
+  for( int z0 = 0; z0 < depth && ok; z0 += coreDepth )
+    {
+    int z1 = z0 + coreDepth < depth ? z0 + coreDepth : depth;
+    int p0 = z0 - padding > 0 ? z0 - padding : 0;
+    int p1 = z1 + padding < depth ? z1 + padding : depth;
+
+    g_ImageType::IndexType slabIndex = region.GetIndex();
+    slabIndex[2] = p0;
+    g_ImageType::SizeType slabSize = size;
+    slabSize[2] = p1 - p0;
+    g_ImageType::RegionType slabRegion( slabIndex, slabSize );
+    slab->SetRegions( slabRegion );
+
+    g_ItkFilterLibDataType * slabData = g_InputData + p0 * sliceSize;
+    if( inPlace )
+      {
+      // Slices p0 to z0 were overwritten by the previous slab
+      slabBuffer.resize( ( p1 - p0 ) * sliceSize );
+      if( z0 > p0 )
+        {
+        memcpy( &slabBuffer[0], &savedSlices[0], 
+                ( z0 - p0 ) * sliceSize * sizeof(g_ItkFilterLibDataType) );
+        }
+      memcpy( &slabBuffer[( z0 - p0 ) * sliceSize], 
+              g_InputData + z0 * sliceSize,
+              ( p1 - z0 ) * sliceSize * sizeof(g_ItkFilterLibDataType) );
+      slabData = &slabBuffer[0];
+      }
+    slab->GetPixelContainer()->SetImportPointer( slabData, 
+                                                 ( p1 - p0 ) * sliceSize );
+    slab->Modified();
+
+    g_StreamProgressStart = static_cast<float>( z0 ) / depth;
+    g_StreamProgressLength = static_cast<float>( z1 - z0 ) / depth;
+
+    try
+      {
+      filter->GetOutput()->SetRequestedRegion( slabRegion );
+      filter->Update();
+      }
+    catch( itk::ExceptionObject & err )
+      {
+      if( !g_StreamCancelled )
+        {
+        std::cerr << "itkFilterLib: " << err << std::endl;
+        }
+      ok = false;
+      break;
+      }
+
+    if( inPlace && z1 < depth )
+      {
+      // Original slices the next slab reads as padding
+      int next = z1 - padding > 0 ? z1 - padding : 0;
+      savedSlices.assign( slabData + ( next - p0 ) * sliceSize,
+                          slabData + ( z1 - p0 ) * sliceSize );
+      }
+
+    const g_ImageType * output = filter->GetOutput();
+    int outputStart = output->GetBufferedRegion().GetIndex()[2];
+    memcpy( g_OutputData + z0 * sliceSize,
+            output->GetBufferPointer() + ( z0 - outputStart ) * sliceSize,
+            ( z1 - z0 ) * sliceSize * sizeof(g_ItkFilterLibDataType) );
+
+    if( g_ProgressCallback 
+        && g_ProgressCallback( static_cast<float>( z1 ) / depth, 
+                               g_ProgressClientData ) )
+      {
+      g_StreamCancelled = true;
+      ok = false;
+      }
+    }
+
+  filter->RemoveObserver( tag );
+  filter->AbortGenerateDataOff();
+
+  return ok;
+  }
+
+
 /** Constructor: Input image and output image must be of the same size
  *     This could easily be changed, but holds true for most filters.
  **/
@@ -108,6 +294,7 @@ itkFilterLib(int * imageDimSize, float * imageOrigin, float * imageSpacing)
 void itkFilterLib::
 SetInputData(g_ItkFilterLibDataType * imageData)
   {
+  g_InputData = imageData;
   g_InputImage->GetPixelContainer()->SetImportPointer( imageData, 
                                                        m_DataQuantity );
   }
@@ -115,10 +302,25 @@ SetInputData(g_ItkFilterLibDataType * imageData)
 void itkFilterLib::
 SetOutputData(g_ItkFilterLibDataType * imageData)
   {
+  g_OutputData = imageData;
   g_OutputImage->GetPixelContainer()->SetImportPointer( imageData, 
                                                         m_DataQuantity );
   }
 
+void itkFilterLib::
+SetMaximumMemory(unsigned long bytes)
+  {
+  g_MaximumMemory = bytes;
+  }
+
+void itkFilterLib::
+SetProgressCallback(g_ItkFilterLibProgressCallback callback, 
+                    void * clientData)
+  {
+  g_ProgressCallback = callback;
+  g_ProgressClientData = clientData;
+  }
+
 
 //
 //
@@ -172,6 +374,63 @@ ExecuteAnisotropicDiffusionFilter(void)
   g_anisoFilter->Update();
   }
 
+/**
+ * ExecuteStreamedFilter: Same results as ExecuteFilter, computed slab by 
+ *   slab.   Each iteration of the diffusion reads the neighbors of a 
+ *   voxel, so the padding is one slice per iteration.   The filter holds 
+ *   its output and an update buffer for each slab.
+ * CHANGE HERE: Add in new instances of this member function for each 
+ *   new filter added.
+ */
+bool itkFilterLib::
+ExecuteStreamedAnisotropicDiffusionFilter(void)
+  {
+  bool fixed = g_anisoFilter->GetGradientMagnitudeIsFixed();
+  if( !fixed )
+    {
+    // Average gradient magnitude of the input, by central differences
+    const g_ImageType::SizeType & size = 
+                          g_InputImage->GetLargestPossibleRegion().GetSize();
+    const g_ImageType::SpacingType & spacing = g_InputImage->GetSpacing();
+    long stride[3];
+    stride[0] = 1;
+    stride[1] = size[0];
+    stride[2] = size[0] * size[1];
+    double sum = 0;
+    unsigned long count = 0;
+    for( unsigned long k = 1; k + 1 < size[2]; k++ )
+      {
+      for( unsigned long j = 1; j + 1 < size[1]; j++ )
+        {
+        const g_ItkFilterLibDataType * p = 
+                          g_InputData + k * stride[2] + j * stride[1] + 1;
+        for( unsigned long i = 1; i + 1 < size[0]; i++, p++ )
+          {
+          double magnitude = 0;
+          for( int d = 0; d < 3; d++ )
+            {
+            double g = ( p[stride[d]] - p[-stride[d]] ) / ( 2 * spacing[d] );
+            magnitude += g * g;
+            }
+          sum += magnitude;
+          count++;
+          }
+        }
+      }
+    g_anisoFilter->SetFixedAverageGradientMagnitude( 
+                                  count > 0 ? sqrt( sum / count ) : 0.0 );
+    }
+
+  bool ok = ExecuteStreamed( g_anisoFilter.GetPointer(),
+                             g_anisoFilter->GetNumberOfIterations(), 2 );
+
+  if( !fixed )
+    {
+    g_anisoFilter->SetGradientMagnitudeIsFixed( false );
+    }
+  return ok;
+  }
+
 
 //
 //
@@ -188,6 +447,12 @@ SetSigmaOfGaussianBlurFilter(float sigma)
   g_gaussianFilter->SetSigma(sigma);
   }
 
+void itkFilterLib::
+SetDirectionOfGaussianBlurFilter(int direction)
+  {
+  g_gaussianFilter->SetDirection(direction);
+  }
+
 /**
  * ExecuteFilter: Called to calculate the results and store them in the 
  *   memory pointed to by the SetOutputData(pntr) call.  Note: Doesn't 
@@ -204,3 +469,25 @@ ExecuteGaussianBlurFilter(void)
   g_gaussianFilter->GraftOutput ( g_OutputImage );
   g_gaussianFilter->Update();
   }
+
+/**
+ * ExecuteStreamedFilter: Same results as ExecuteFilter, computed slab by 
+ *   slab.   The recursive filter only smooths along its direction: slabs
+ *   need no padding unless it is the third axis, in which case five sigmas
+ *   of slices are read on each side.   The filter holds its output for 
+ *   each slab.
+ * CHANGE HERE: Add in new instances of this member function for each 
+ *   new filter added.
+ */
+bool itkFilterLib::
+ExecuteStreamedGaussianBlurFilter(void)
+  {
+  int padding = 0;
+  if( g_gaussianFilter->GetDirection() == 2 )
+    {
+    padding = static_cast<int>( ceil( 5 * g_gaussianFilter->GetSigma() 
+                                      / g_InputImage->GetSpacing()[2] ) );
+    }
+
+  return ExecuteStreamed( g_gaussianFilter.GetPointer(), padding, 1 );
+  }
@@ -31,6 +31,15 @@
 typedef float g_ItkFilterLibDataType;
 
 
+/** 
+ * Progress callback of the streamed execution.   It receives the fraction 
+ *   of the image processed so far, between 0 and 1, and the client data 
+ *   given with it.   Returning a non-zero value cancels the execution.
+ **/
+typedef int (*g_ItkFilterLibProgressCallback)(float progress, 
+                                              void * clientData);
+
+
 /** 
  * This class provides a demonstration of how to create a .lib that contains
  *   multiple itk filters that can be easily called from outside of itk by 
@@ -88,8 +97,34 @@ class itkFilterLib
      *    filter.
      **/
     void SetSigmaOfGaussianBlurFilter(float sigma);
+    void SetDirectionOfGaussianBlurFilter(int direction);
     void ExecuteGaussianBlurFilter(void);
 
+    /** 
+     *  Streamed execution: the image is processed in slabs of whole slices
+     *    along the third axis, each one read with the padding the filter 
+     *    needs so that the results match those of the Execute member 
+     *    functions.   A slab is taken directly from the input data, only 
+     *    the result of one slab is held by ITK at a time.
+     *  SetMaximumMemory sets the number of bytes the slab buffers may use, 
+     *    0 (the default) processes the whole image as a single slab.
+     *  The input and output data may point to the same memory, the image 
+     *    is then filtered in place.
+     *  The ExecuteStreamed member functions return false if the execution 
+     *    was cancelled by the progress callback, or if the memory limit is
+     *    too small for the padding of the filter.
+     *  The anisotropic diffusion filter estimates the average gradient 
+     *    magnitude of the whole image at each iteration, which a slab 
+     *    cannot do; unless it was set with 
+     *    SetFixedAverageGradientMagnitudeOfAnisotropicDiffusionFilter, it
+     *    is estimated once from the input image.
+     **/
+    void SetMaximumMemory(unsigned long bytes);
+    void SetProgressCallback(g_ItkFilterLibProgressCallback callback,
+                             void * clientData);
+    bool ExecuteStreamedAnisotropicDiffusionFilter(void);
+    bool ExecuteStreamedGaussianBlurFilter(void);
+
   private:
     
     int m_DataQuantity;
@@ -18,6 +18,52 @@
 #include "ITKFilterLib.h"
 
 #include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+/**
+ * Compares the streamed result with the whole image one, prints the 
+ *   largest difference and returns the number of voxels that differ by 
+ *   more than tolerance.
+ **/
+int CompareStreamed(const char * name, bool completed,
+                    const g_ItkFilterLibDataType * streamedImageData,
+                    const g_ItkFilterLibDataType * wholeImageData,
+                    int dataQuantity, float tolerance)
+  {
+  int numberOfMismatches = 0;
+  float maximumDifference = 0;
+  for(int i=0; i<dataQuantity; i++)
+    {
+    float difference = streamedImageData[i] - wholeImageData[i];
+    if(difference < 0)
+      {
+      difference = -difference;
+      }
+    if(difference > maximumDifference)
+      {
+      maximumDifference = difference;
+      }
+    if(difference > tolerance)
+      {
+      if(numberOfMismatches == 0)
+        {
+        std::cerr << "  First mismatch at voxel " << i << ": streamed " 
+                  << streamedImageData[i] << ", whole image " 
+                  << wholeImageData[i] << std::endl;
+        }
+      numberOfMismatches++;
+      }
+    }
+  std::cout << name << ":" << std::endl;
+  std::cout << "  Completed = " << completed << std::endl;
+  std::cout << "  Largest difference from the whole image = " 
+            << maximumDifference << std::endl;
+  std::cout << "  Voxels different from the whole image = " 
+            << numberOfMismatches << std::endl;
+  std::cout << std::endl;
+  return numberOfMismatches;
+  }
 
 /**
  * This test demonstrates how to use the .lib created in 
@@ -172,5 +218,148 @@ int main(int, char **)
             << finalNoiseMeanDiff << std::endl;
   std::cout << std::endl;
 
-  return true;
+
+  //
+  // Streamed execution: run the Gaussian filter again, in place, with 
+  //   only enough memory for two slices at a time.   The result is the 
+  //   same as the one of the whole image.
+  //
+  int dataQuantity = inputDimSize[0] * inputDimSize[1] * inputDimSize[2];
+  g_ItkFilterLibDataType * streamedImageData = 
+      new g_ItkFilterLibDataType [ dataQuantity ];
+  for(i=0; i<dataQuantity; i++)
+    {
+    streamedImageData[i] = inputImageData[i];
+    }
+  filter.SetInputData(streamedImageData);
+  filter.SetOutputData(streamedImageData);
+  filter.SetMaximumMemory(2 * inputDimSize[0] * inputDimSize[1] 
+                          * sizeof(g_ItkFilterLibDataType));
+
+  bool streamed = filter.ExecuteStreamedGaussianBlurFilter();
+
+  // The Gaussian smooths along the first axis only, so that slabs of 
+  //   whole slices need no padding and give the same voxels.
+  bool failed = !streamed;
+  if(CompareStreamed("Streamed Gaussian Filter", streamed, 
+                     streamedImageData, outputImageData, 
+                     dataQuantity, 1e-6f) > 0)
+    {
+    failed = true;
+    }
+
+  delete [] streamedImageData;
+  delete [] inputImageData;
+  delete [] outputImageData;
+
+
+  //
+  // Streamed execution with padding, on an image deep enough for several
+  //   slabs: a smooth volume with a little noise.
+  //
+  int deepDimSize[3];
+  deepDimSize[0] = 16;
+  deepDimSize[1] = 16;
+  deepDimSize[2] = 40;
+  const int sliceQuantity = deepDimSize[0] * deepDimSize[1];
+  dataQuantity = sliceQuantity * deepDimSize[2];
+
+  g_ItkFilterLibDataType * deepImageData = 
+      new g_ItkFilterLibDataType [ dataQuantity ];
+  g_ItkFilterLibDataType * wholeImageData = 
+      new g_ItkFilterLibDataType [ dataQuantity ];
+  streamedImageData = new g_ItkFilterLibDataType [ dataQuantity ];
+
+  unsigned long noiseState = 12345;
+  cnt = 0;
+  for(k=0; k<deepDimSize[2]; k++)
+    {
+    for(j=0; j<deepDimSize[1]; j++)
+      {
+      for(i=0; i<deepDimSize[0]; i++)
+        {
+        noiseState = noiseState * 1103515245UL + 12345UL;
+        deepImageData[cnt] = 1.0f + 0.5f * sin(0.3 * k + 0.2 * j) 
+                                  + 0.25f * cos(0.4 * i)
+                                  + 0.05f * ( ( noiseState >> 16 ) % 1000 ) 
+                                          / 1000.0f;
+        cnt++;
+        }
+      }
+    }
+
+  itkFilterLib deepFilter(deepDimSize, inputOrigin, inputSpacing);
+
+  // Gaussian along the third axis, whole image...
+  deepFilter.SetSigmaOfGaussianBlurFilter(1);
+  deepFilter.SetDirectionOfGaussianBlurFilter(2);
+  deepFilter.SetMaximumMemory(0);
+  deepFilter.SetInputData(deepImageData);
+  deepFilter.SetOutputData(wholeImageData);
+  deepFilter.ExecuteGaussianBlurFilter();
+
+  // ...and streamed in place, with 5 slices of padding on each side of 
+  //   slabs of 14 slices, so that the saved padding slices are used.   
+  //   The recursive filter restarts at each slab, which only changes the
+  //   core slices by the tail of the kernel beyond five sigmas.
+  for(i=0; i<dataQuantity; i++)
+    {
+    streamedImageData[i] = deepImageData[i];
+    }
+  deepFilter.SetInputData(streamedImageData);
+  deepFilter.SetOutputData(streamedImageData);
+  deepFilter.SetMaximumMemory(2 * 14 * sliceQuantity
+                              * sizeof(g_ItkFilterLibDataType));
+  streamed = deepFilter.ExecuteStreamedGaussianBlurFilter();
+  if(!streamed ||
+     CompareStreamed("Streamed Gaussian Filter along the third axis", 
+                     streamed, streamedImageData, wholeImageData, 
+                     dataQuantity, 1e-3f) > 0)
+    {
+    failed = true;
+    }
+
+  // Anisotropic diffusion with a fixed average gradient magnitude, which
+  //   the streamed execution needs to match the whole image one...
+  deepFilter.SetIterationsOfAnisotropicDiffusionFilter(3);
+  deepFilter.SetTimeStepOfAnisotropicDiffusionFilter(0.0625);
+  deepFilter.SetConductanceOfAnisotropicDiffusionFilter(1);
+  deepFilter.SetFixedAverageGradientMagnitudeOfAnisotropicDiffusionFilter(
+                                                                      0.2f);
+  deepFilter.SetMaximumMemory(0);
+  deepFilter.SetInputData(deepImageData);
+  deepFilter.SetOutputData(wholeImageData);
+  deepFilter.ExecuteAnisotropicDiffusionFilter();
+
+  // ...and streamed into another buffer, with one slice of padding per 
+  //   iteration on each side of slabs of 10 slices.
+  for(i=0; i<dataQuantity; i++)
+    {
+    streamedImageData[i] = 0;
+    }
+  deepFilter.SetInputData(deepImageData);
+  deepFilter.SetOutputData(streamedImageData);
+  deepFilter.SetMaximumMemory(2 * 10 * sliceQuantity
+                              * sizeof(g_ItkFilterLibDataType));
+  streamed = deepFilter.ExecuteStreamedAnisotropicDiffusionFilter();
+  if(!streamed ||
+     CompareStreamed("Streamed Anisotropic Filter", streamed, 
+                     streamedImageData, wholeImageData, 
+                     dataQuantity, 1e-5f) > 0)
+    {
+    failed = true;
+    }
+
+  delete [] streamedImageData;
+  delete [] wholeImageData;
+  delete [] deepImageData;
+
+  if(failed)
+    {
+    std::cerr << "The streamed result differs from the whole image" 
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
   }
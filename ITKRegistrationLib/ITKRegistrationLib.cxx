@@ -23,6 +23,8 @@
 
 #include "itkImageRegionIterator.h"
 #include "itkStatisticsImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 
 // Modules of the registration pipeline
 #include "itkResampleImageFilter.h"
@@ -32,7 +34,10 @@
 // This class wraps the multi-res MI registration method of itk
 #include "MIMRegistrator.h"
 
+#include "ITKRegistrationLib.h"
+
 #include <iostream>
+#include <string.h>
 
 /**
  * Transform the moving image into the space of the fixed image via
@@ -43,7 +48,8 @@ bool transformImage(typename itk::Image<dataT,3>::Pointer fixedIm,
                     typename itk::Image<dataT,3>::Pointer movingIm, 
                     itk::SmartPointer< itk::AffineTransform<double, 3> > 
                          transform,
-                    typename itk::Image<dataT,3>::Pointer outIm)
+                    typename itk::Image<dataT,3>::Pointer outIm,
+                    int numberOfThreads)
   {
   typedef itk::Image<dataT, 3> ImageType;
   typedef itk::AffineTransform<double, 3> TransformType;
@@ -62,6 +68,7 @@ bool transformImage(typename itk::Image<dataT,3>::Pointer fixedIm,
   resampler->SetOutputOrigin( fixedIm->GetOrigin() );
   resampler->SetOutputSpacing( fixedIm->GetSpacing() );
   resampler->SetDefaultPixelValue( 0 );
+  resampler->SetNumberOfThreads( numberOfThreads );
 
   resampler->GraftOutput(outIm);
 
@@ -71,69 +78,133 @@ bool transformImage(typename itk::Image<dataT,3>::Pointer fixedIm,
   return true;
   }
 
+
+typedef unsigned short                               g_PixelType;
+typedef itk::Image<g_PixelType,3>                    g_ImageType;
+typedef itk::MIMRegistrator<g_ImageType, g_ImageType> g_RegistratorType;
+typedef itk::StatisticsImageFilter<g_ImageType>      g_StatisticsFilterType;
+
 /**
- * Function to register two images. The resultImage contains the
- *   the outcome of a rigid transformation of the moving image into
- *   alignement with the fixed image.
+ * State kept by a handle between calls.   The registrator, and through it
+ *   the fixed image pyramid, persists as long as the fixed image is not 
+ *   set again.
  **/
-bool ITKRegistrationLib(int * fixedDimSize, float * fixedOrigin, 
-                        float * fixedSpacing, 
-                        unsigned short * fixedImageData, 
-                        int * movingDimSize, float * movingOrigin, 
-                        float * movingSpacing, 
-                        unsigned short * movingImageData,
-                        unsigned short * resultImageData)
+struct ITKRegistrationLibHandleStruct
+  {
+  g_RegistratorType::Pointer registrator;
+  g_ImageType::Pointer       fixedImage;
+  g_ImageType::Pointer       movingImage;
+  bool                       registered;
+  };
+
+// Threads shared by all the handles, and number of registrations and 
+//   resamplings running.
+itk::SimpleFastMutexLock g_ThreadLock;
+int g_NumberOfThreads = 0;
+int g_NumberOfRunning = 0;
+
+/**
+ * Share of the threads for a registration or resampling that starts.
+ *   Must be matched by a call to releaseThreads.
+ **/
+static int acquireThreads()
   {
-  typedef unsigned short PixelType;
-  typedef itk::Image<PixelType,3>      ImageType;
-  typedef itk::MIMRegistrator<ImageType, ImageType> RegistratorType;
-  typedef itk::StatisticsImageFilter<ImageType> StatisticsImageFilterType;
-  enum { ImageDimension = ImageType::ImageDimension };
-
-  // Setup the itkImage for the fixedImageData, i.e., the fixedImage
-  ImageType::SizeType fixedSize = {{fixedDimSize[0],
-                                    fixedDimSize[1],
-                                    fixedDimSize[2]}};
-  int fixedQuantity = fixedDimSize[0]*fixedDimSize[1]*fixedDimSize[2];
-  ImageType::Pointer fixedImage = ImageType::New();
+  g_ThreadLock.Lock();
+  g_NumberOfRunning++;
+  int total = g_NumberOfThreads > 0 ? g_NumberOfThreads 
+                : itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  int share = total / g_NumberOfRunning;
+  g_ThreadLock.Unlock();
+  return share > 0 ? share : 1;
+  }
+
+static void releaseThreads()
+  {
+  g_ThreadLock.Lock();
+  g_NumberOfRunning--;
+  g_ThreadLock.Unlock();
+  }
+
+/**
+ * Create an image over the given data.   The image does not own them.
+ **/
+static g_ImageType::Pointer importImage(int * dimSize, float * origin, 
+                                        float * spacing, 
+                                        g_PixelType * imageData)
+  {
+  g_ImageType::SizeType size;
+  size[0] = dimSize[0];
+  size[1] = dimSize[1];
+  size[2] = dimSize[2];
+  int quantity = dimSize[0]*dimSize[1]*dimSize[2];
+
+  g_ImageType::Pointer image = g_ImageType::New();
+  image->SetRegions( size );
+  image->SetOrigin( origin );
+  image->SetSpacing( spacing );
+  image->GetPixelContainer( )->SetImportPointer( imageData, quantity );
+  return image;
+  }
+
+
+ITKRegistrationLibHandle ITKRegistrationLibCreate(void)
+  {
+  ITKRegistrationLibHandle handle = new ITKRegistrationLibHandleStruct;
+  handle->registered = false;
+  return handle;
+  }
+
+void ITKRegistrationLibDestroy(ITKRegistrationLibHandle handle)
+  {
+  delete handle;
+  }
+
+void ITKRegistrationLibSetNumberOfThreads(int numberOfThreads)
+  {
+  g_ThreadLock.Lock();
+  g_NumberOfThreads = numberOfThreads;
+  g_ThreadLock.Unlock();
+  }
+
+bool ITKRegistrationLibSetFixedImage(ITKRegistrationLibHandle handle,
+                                     int * fixedDimSize, 
+                                     float * fixedOrigin, 
+                                     float * fixedSpacing, 
+                                     unsigned short * fixedImageData)
+  {
+  enum { ImageDimension = g_ImageType::ImageDimension };
+
+  if( !handle || !fixedImageData )
+    {
+    return false;
+    }
+
+  // The handle keeps its own copy of the fixed image, so that the data
+  //   and the pyramid computed from them stay valid between calls.
+  g_ImageType::SizeType fixedSize;
+  fixedSize[0] = fixedDimSize[0];
+  fixedSize[1] = fixedDimSize[1];
+  fixedSize[2] = fixedDimSize[2];
+  g_ImageType::Pointer fixedImage = g_ImageType::New();
   fixedImage->SetRegions( fixedSize );
   fixedImage->SetOrigin( fixedOrigin );
   fixedImage->SetSpacing( fixedSpacing );
-  fixedImage->GetPixelContainer( )->SetImportPointer( fixedImageData,
-                                                      fixedQuantity );
-  
-  // Setup the itkImage for the movingImageData, i.e., the movingImage
-  ImageType::SizeType movingSize = {{movingDimSize[0],
-                                     movingDimSize[1],
-                                     movingDimSize[2]}};
-  int movingQuantity = fixedDimSize[0]*movingDimSize[1]*movingDimSize[2];
-  ImageType::Pointer movingImage = ImageType::New();
-  movingImage->SetRegions( movingSize );
-  movingImage->SetOrigin( movingOrigin );
-  movingImage->SetSpacing( movingSpacing );
-  movingImage->GetPixelContainer( )->SetImportPointer( movingImageData, 
-                                                       movingQuantity );
+  fixedImage->Allocate();
+  memcpy( fixedImage->GetBufferPointer(), fixedImageData,
+          fixedImage->GetBufferedRegion().GetNumberOfPixels() 
+          * sizeof(g_PixelType) );
 
-  // Setup the itkImage for the resultsImageData, i.e., the resultsImage
-  ImageType::Pointer resultImage = ImageType::New();
-  resultImage->SetRegions( fixedSize );
-  resultImage->SetOrigin( fixedOrigin );
-  resultImage->SetSpacing( fixedSpacing );
-  resultImage->GetPixelContainer( )->SetImportPointer( resultImageData, 
-                                                       fixedQuantity );
-
-  // Create the registration method
-  RegistratorType::Pointer miReg = RegistratorType::New();
-
-  miReg->SetFixedImage ( fixedImage );
-  miReg->SetMovingImage ( movingImage ) ;
+  // A new registrator, so that nothing computed from the previous fixed
+  //   image is reused.
+  g_RegistratorType::Pointer miReg = g_RegistratorType::New();
+  miReg->SetFixedImage( fixedImage );
 
   // The mutual information metric uses a Parzen approach to density
   //   estimation - it requires a bandwidth estimate (i.e., a kernel
   //   size). We use the standard deviation of the image intensities
   //   as a basis for specifying the bandwidth.
-  StatisticsImageFilterType::Pointer fixedImageStatisticsFilter = 
-        StatisticsImageFilterType::New();
+  g_StatisticsFilterType::Pointer fixedImageStatisticsFilter = 
+        g_StatisticsFilterType::New();
   fixedImageStatisticsFilter->SetInput( fixedImage );
   fixedImageStatisticsFilter->Update(); // gotta call this since pipelining
                                         //  of none image data doesn't
@@ -141,19 +212,12 @@ bool ITKRegistrationLib(int * fixedDimSize, float * fixedOrigin,
   miReg->SetFixedImageStandardDeviation(
         fixedImageStatisticsFilter->GetSigma() * 0.4 );
 
-  StatisticsImageFilterType::Pointer movingImageStatisticsFilter = 
-        StatisticsImageFilterType::New();
-  movingImageStatisticsFilter->SetInput( movingImage );
-  movingImageStatisticsFilter->Update();
-  miReg->SetMovingImageStandardDeviation( 
-        movingImageStatisticsFilter->GetSigma() * 0.4 );
-
   // set multiresolution related parameters
   const int nLevels = 4;
   miReg->SetNumberOfLevels( nLevels );
 
   // permute the shrink factors  
-  unsigned int permutedFactors[ ImageDimension ];
+  g_RegistratorType::ShrinkFactorsArray permutedFactors;
   permutedFactors[ 0 ] = 2; 
   permutedFactors[ 1 ] = 2;
   permutedFactors[ 2 ] = 1;
@@ -185,24 +249,186 @@ bool ITKRegistrationLib(int * fixedDimSize, float * fixedOrigin,
   double scale = 1.0 / vnl_math_sqr( fixedDimSize[ 0 ] * 0.4 );
   miReg->SetTranslationScale( scale );
 
-  miReg->Execute();
+  handle->registrator = miReg;
+  handle->fixedImage = fixedImage;
+  handle->movingImage = 0;
+  handle->registered = false;
+
+  return true;
+  }
+
+bool ITKRegistrationLibRegister(ITKRegistrationLibHandle handle,
+                                int * movingDimSize, 
+                                float * movingOrigin, 
+                                float * movingSpacing, 
+                                unsigned short * movingImageData,
+                                double * transformParameters)
+  {
+  if( !handle || !handle->registrator || !movingImageData )
+    {
+    return false;
+    }
+
+  g_ImageType::Pointer movingImage = importImage( movingDimSize, 
+                                                  movingOrigin, 
+                                                  movingSpacing, 
+                                                  movingImageData );
+  handle->movingImage = movingImage;
+  handle->registered = false;
+
+  g_RegistratorType * miReg = handle->registrator;
+  miReg->SetMovingImage( movingImage );
+
+  g_StatisticsFilterType::Pointer movingImageStatisticsFilter = 
+        g_StatisticsFilterType::New();
+  movingImageStatisticsFilter->SetInput( movingImage );
+
+  int numberOfThreads = acquireThreads();
+  try
+    {
+    movingImageStatisticsFilter->SetNumberOfThreads( numberOfThreads );
+    movingImageStatisticsFilter->Update();
+    miReg->SetMovingImageStandardDeviation( 
+          movingImageStatisticsFilter->GetSigma() * 0.4 );
+
+    miReg->SetNumberOfThreads( numberOfThreads );
+    miReg->Execute();
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    releaseThreads();
+    std::cerr << err << std::endl;
+    return false;
+    }
+  releaseThreads();
+
+  handle->registered = true;
+
+  if( transformParameters )
+    {
+    const g_RegistratorType::ParametersType & parameters = 
+          miReg->GetTransformParameters();
+    for( int i = 0; i < ITKRegistrationLibNumberOfParameters; i++ )
+      {
+      transformParameters[ i ] = parameters[ i ];
+      }
+    }
+
+  return true;
+  }
 
-  std::cout << "Final tranformation matrix: " << std::endl
-            << miReg->GetAffineTransform()->GetMatrix() << std::endl;
+unsigned long ITKRegistrationLibGetFixedImagePyramidTime(
+                                       ITKRegistrationLibHandle handle)
+  {
+  if( !handle || !handle->registrator )
+    {
+    return 0;
+    }
+  return handle->registrator->GetFixedImagePyramid()
+                            ->GetOutput( 0 )->GetUpdateMTime();
+  }
 
-  itk::Point<double, 3> pnt;
-  itk::Point<double, 3> pntTransformed;
+bool ITKRegistrationLibGetAffineTransform(ITKRegistrationLibHandle handle,
+                                          double * matrix, double * offset)
+  {
+  if( !handle || !handle->registered )
+    {
+    return false;
+    }
+
+  g_RegistratorType::AffineTransformPointer transform = 
+        handle->registrator->GetAffineTransform();
+  for( int i = 0; i < 3; i++ )
+    {
+    for( int j = 0; j < 3; j++ )
+      {
+      matrix[ i * 3 + j ] = transform->GetMatrix()[ i ][ j ];
+      }
+    offset[ i ] = transform->GetOffset()[ i ];
+    }
 
-  pnt.Fill( 0.0 );
-  pntTransformed = miReg->GetAffineTransform()->TransformPoint(pnt);
+  return true;
+  }
 
-  std::cout << "Final offset: " << std::endl
-            << pntTransformed << std::endl;
+bool ITKRegistrationLibResample(ITKRegistrationLibHandle handle,
+                                unsigned short * resultImageData)
+  {
+  if( !handle || !handle->registered || !resultImageData )
+    {
+    return false;
+    }
 
-  transformImage<unsigned short>(fixedImage, movingImage, 
-                                 miReg->GetAffineTransform(), 
-                                 resultImage);
+  // Setup the itkImage for the resultsImageData, i.e., the resultsImage
+  g_ImageType::Pointer fixedImage = handle->fixedImage;
+  g_ImageType::Pointer resultImage = g_ImageType::New();
+  resultImage->SetRegions( fixedImage->GetLargestPossibleRegion() );
+  resultImage->SetOrigin( fixedImage->GetOrigin() );
+  resultImage->SetSpacing( fixedImage->GetSpacing() );
+  resultImage->GetPixelContainer( )->SetImportPointer( resultImageData, 
+        fixedImage->GetLargestPossibleRegion().GetNumberOfPixels() );
+
+  int numberOfThreads = acquireThreads();
+  try
+    {
+    transformImage<unsigned short>(fixedImage, handle->movingImage, 
+                                   handle->registrator->GetAffineTransform(),
+                                   resultImage, numberOfThreads);
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    releaseThreads();
+    std::cerr << err << std::endl;
+    return false;
+    }
+  releaseThreads();
 
   return true;
   }
 
+/**
+ * Function to register two images. The resultImage contains the
+ *   the outcome of a rigid transformation of the moving image into
+ *   alignement with the fixed image.
+ **/
+bool ITKRegistrationLib(int * fixedDimSize, float * fixedOrigin, 
+                        float * fixedSpacing, 
+                        unsigned short * fixedImageData, 
+                        int * movingDimSize, float * movingOrigin, 
+                        float * movingSpacing, 
+                        unsigned short * movingImageData,
+                        unsigned short * resultImageData)
+  {
+  ITKRegistrationLibHandle handle = ITKRegistrationLibCreate();
+
+  bool ok = ITKRegistrationLibSetFixedImage(handle, fixedDimSize, 
+                                            fixedOrigin, fixedSpacing,
+                                            fixedImageData)
+            && ITKRegistrationLibRegister(handle, movingDimSize, 
+                                          movingOrigin, movingSpacing,
+                                          movingImageData, 0);
+
+  if( ok )
+    {
+    g_RegistratorType::AffineTransformPointer transform = 
+          handle->registrator->GetAffineTransform();
+
+    std::cout << "Final tranformation matrix: " << std::endl
+              << transform->GetMatrix() << std::endl;
+
+    itk::Point<double, 3> pnt;
+    itk::Point<double, 3> pntTransformed;
+
+    pnt.Fill( 0.0 );
+    pntTransformed = transform->TransformPoint(pnt);
+
+    std::cout << "Final offset: " << std::endl
+              << pntTransformed << std::endl;
+
+    ok = ITKRegistrationLibResample(handle, resultImageData);
+    }
+
+  ITKRegistrationLibDestroy(handle);
+
+  return ok;
+  }
+
@@ -34,4 +34,76 @@ extern bool ITKRegistrationLib(int * fixedDimSize, float * fixedOrigin,
                                unsigned short * movingImageData,
                                unsigned short * resultImageData);
 
+/**
+ * Handle based version of the same registration, for callers that
+ * register several moving images onto one fixed image, or that run
+ * several registrations at once.
+ *
+ * ITKRegistrationLibCreate returns a new handle, to be released with
+ * ITKRegistrationLibDestroy.   A handle must only be used by one thread
+ * at a time; different handles may be used concurrently.
+ *
+ * ITKRegistrationLibSetFixedImage copies the fixed image into the handle
+ * and computes its statistics.   Its multi-resolution pyramid is computed
+ * by the first registration.   Both are kept until the fixed image is set
+ * again.
+ *
+ * ITKRegistrationLibRegister registers a moving image onto the fixed
+ * image.   The moving image data are not copied and must stay valid until
+ * the next registration or the resampling.   If transformParameters is not
+ * null, it receives the ITKRegistrationLibNumberOfParameters parameters
+ * of the rigid transform: a quaternion (x, y, z, w) followed by the
+ * translation.   The transform maps points of the fixed image onto the
+ * moving image.
+ *
+ * ITKRegistrationLibGetAffineTransform gives the same transform as a
+ * 3x3 matrix, in row order, and an offset.
+ *
+ * ITKRegistrationLibResample writes the moving image of the last
+ * registration, resampled in the space of the fixed image, into
+ * resultImageData, which must hold as many pixels as the fixed image.
+ *
+ * ITKRegistrationLibGetFixedImagePyramidTime returns the update time of
+ * the fixed image pyramid, 0 before the first registration.   It stays
+ * the same across the registrations of one fixed image.
+ *
+ * ITKRegistrationLibSetNumberOfThreads sets the number of threads shared
+ * by all the registrations and resamplings of the process; each one gets
+ * an equal share of those that run when it starts.   By default, the
+ * number of processors is used.
+ **/
+
+enum { ITKRegistrationLibNumberOfParameters = 7 };
+
+typedef struct ITKRegistrationLibHandleStruct * ITKRegistrationLibHandle;
+
+extern ITKRegistrationLibHandle ITKRegistrationLibCreate(void);
+
+extern void ITKRegistrationLibDestroy(ITKRegistrationLibHandle handle);
+
+extern bool ITKRegistrationLibSetFixedImage(ITKRegistrationLibHandle handle,
+                                            int * fixedDimSize, 
+                                            float * fixedOrigin, 
+                                            float * fixedSpacing, 
+                                            unsigned short * fixedImageData);
+
+extern bool ITKRegistrationLibRegister(ITKRegistrationLibHandle handle,
+                                       int * movingDimSize, 
+                                       float * movingOrigin, 
+                                       float * movingSpacing, 
+                                       unsigned short * movingImageData,
+                                       double * transformParameters);
+
+extern bool ITKRegistrationLibGetAffineTransform(
+                                       ITKRegistrationLibHandle handle,
+                                       double * matrix, double * offset);
+
+extern bool ITKRegistrationLibResample(ITKRegistrationLibHandle handle,
+                                       unsigned short * resultImageData);
+
+extern unsigned long ITKRegistrationLibGetFixedImagePyramidTime(
+                                       ITKRegistrationLibHandle handle);
+
+extern void ITKRegistrationLibSetNumberOfThreads(int numberOfThreads);
+
 #endif
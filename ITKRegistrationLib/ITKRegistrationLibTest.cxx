@@ -18,99 +18,123 @@
 #include "ITKRegistrationLib.h"
 
 #include <iostream>
-
-int main(int, char **)
+#include <cmath>
+#include <cstdlib>
+
+/**
+ * This test registers two moving images onto one fixed image through a
+ *   handle, checks the recovered translations, and checks that the 
+ *   fixed image pyramid is computed once for both registrations.
+ **/
+
+const int g_Size = 64;
+
+/**
+ * Checkerboard of 10 pixel blocks with 4 intensities, moved by 
+ *   (shiftX, shiftY) pixels.
+ **/
+static void fillImage(unsigned short * imageData, int shiftX, int shiftY)
   {
-  // Create the fixed image
-  int fixedDimSize[ 3 ];
-  fixedDimSize[ 0 ] = 100;
-  fixedDimSize[ 1 ] = 100;
-  fixedDimSize[ 2 ] = 100;
-  
-  float fixedOrigin[ 3 ];
-  fixedOrigin[ 0 ] = 0;
-  fixedOrigin[ 1 ] = 0;
-  fixedOrigin[ 2 ] = 0;
-
-  float fixedSpacing[ 3 ];
-  fixedSpacing[ 0 ] = 1;
-  fixedSpacing[ 1 ] = 1;
-  fixedSpacing[ 2 ] = 1;
-
-  unsigned short * fixedImageData = 
-        new unsigned short [fixedDimSize[0]
-                            * fixedDimSize[1]
-                            * fixedDimSize[2]
-                            * sizeof(unsigned short)];
-
   int i,j,k,cnt;
   cnt = 0;
-  for(k=0; k<fixedDimSize[ 2 ]; k++)
+  for(k=0; k<g_Size; k++)
     {
-    for(j=0; j<fixedDimSize[ 1 ]; j++)
+    for(j=0; j<g_Size; j++)
       {
-      for(i=0; i< fixedDimSize[ 0 ]; i++)
+      for(i=0; i<g_Size; i++)
         {
-        fixedImageData[ cnt ] = ( ( k / 10 + j / 10 ) % 2 ) * 2 
-                                + ( ( i / 10 ) % 2 );
+        imageData[ cnt ] = ( ( k / 10 + ( j + shiftY ) / 10 ) % 2 ) * 2 
+                           + ( ( ( i + shiftX ) / 10 ) % 2 );
         cnt++;
         }
       }
     }
+  }
+
+/**
+ * Register a moving image moved by (shiftX, shiftY) and check that the
+ *   transform is a translation by (-shiftX, -shiftY, 0): it maps the 
+ *   fixed image points onto the moving image.
+ **/
+static bool registerAndCheck(ITKRegistrationLibHandle handle, 
+                             int * dimSize, float * origin, float * spacing,
+                             int shiftX, int shiftY)
+  {
+  unsigned short * movingImageData = 
+        new unsigned short [dimSize[0] * dimSize[1] * dimSize[2]];
+  fillImage(movingImageData, shiftX, shiftY);
+
+  double parameters[ ITKRegistrationLibNumberOfParameters ];
+  bool registered = ITKRegistrationLibRegister(handle, dimSize, origin, 
+                                               spacing, movingImageData, 
+                                               parameters);
+  delete [] movingImageData;
+  if( !registered )
+    {
+    std::cerr << "Registration failed" << std::endl;
+    return false;
+    }
 
-  // Create the image to be registered to the fixed image, 
-  //   i.e., the moving image
-  int movingDimSize[ 3 ];
-  movingDimSize[ 0 ] = 100;
-  movingDimSize[ 1 ] = 100;
-  movingDimSize[ 2 ] = 100;
+  std::cout << "Moving image shifted by (" << shiftX << ", " << shiftY
+            << "), transform parameters:";
+  int i;
+  for(i=0; i<ITKRegistrationLibNumberOfParameters; i++)
+    {
+    std::cout << " " << parameters[ i ];
+    }
+  std::cout << std::endl;
+
+  const double tolerance = 1.0;
+  if( fabs( fabs( parameters[ 3 ] ) - 1.0 ) > 0.01 
+      || fabs( parameters[ 4 ] + shiftX ) > tolerance
+      || fabs( parameters[ 5 ] + shiftY ) > tolerance
+      || fabs( parameters[ 6 ] ) > tolerance )
+    {
+    std::cerr << "The translation was not recovered" << std::endl;
+    return false;
+    }
+  return true;
+  }
+
+int main(int, char **)
+  {
+  int dimSize[ 3 ];
+  dimSize[ 0 ] = g_Size;
+  dimSize[ 1 ] = g_Size;
+  dimSize[ 2 ] = g_Size;
   
-  float movingOrigin[ 3 ];
-  movingOrigin[ 0 ] = 0;
-  movingOrigin[ 1 ] = 0;
-  movingOrigin[ 2 ] = 0;
+  float origin[ 3 ];
+  origin[ 0 ] = 0;
+  origin[ 1 ] = 0;
+  origin[ 2 ] = 0;
 
-  float movingSpacing[ 3 ];
-  movingSpacing[ 0 ] = 1;
-  movingSpacing[ 1 ] = 1;
-  movingSpacing[ 2 ] = 1;
+  float spacing[ 3 ];
+  spacing[ 0 ] = 1;
+  spacing[ 1 ] = 1;
+  spacing[ 2 ] = 1;
 
-  unsigned short * movingImageData = 
-      new unsigned short [movingDimSize[ 0 ]
-                          * movingDimSize[ 1 ]
-                          * movingDimSize[ 2 ]
-                          * sizeof(unsigned short)];
+  unsigned short * fixedImageData = 
+        new unsigned short [dimSize[0] * dimSize[1] * dimSize[2]];
+  fillImage(fixedImageData, 0, 0);
 
-  cnt = 0;
-  for(k=0; k<movingDimSize[ 2 ]; k++)
+  ITKRegistrationLibHandle handle = ITKRegistrationLibCreate();
+  bool ok = ITKRegistrationLibSetFixedImage(handle, dimSize, origin, 
+                                            spacing, fixedImageData);
+  delete [] fixedImageData;
+
+  ok = ok && registerAndCheck(handle, dimSize, origin, spacing, 3, 0);
+  unsigned long pyramidTime = 
+        ITKRegistrationLibGetFixedImagePyramidTime(handle);
+
+  ok = ok && registerAndCheck(handle, dimSize, origin, spacing, 0, 2);
+  if( ok && ITKRegistrationLibGetFixedImagePyramidTime(handle) 
+            != pyramidTime )
     {
-    for(j=0; j<movingDimSize[ 1 ]; j++)
-      {
-      for(i=0; i< movingDimSize[ 0 ]; i++)
-        {
-        movingImageData[ cnt ] = ( ( k / 10 + j / 10 ) % 2 ) * 2 
-                                 + ( ( ( i + 3 ) / 10 ) % 2 );
-        cnt++;
-        }
-      }
+    std::cerr << "The fixed image pyramid was computed again" << std::endl;
+    ok = false;
     }
 
-  //
-  // Allocate space for storing the results image, 
-  //   i.e., the moving image after alignment with the fixed image
-  //
-  unsigned short * resultImageData = 
-      new unsigned short[fixedDimSize[0]
-                         * fixedDimSize[1]
-                         * fixedDimSize[2]
-                         * sizeof(unsigned short)];
-
-  ITKRegistrationLib(fixedDimSize, fixedOrigin, fixedSpacing, 
-                     fixedImageData, 
-                     movingDimSize, movingOrigin, movingSpacing, 
-                     movingImageData,
-                     resultImageData);
+  ITKRegistrationLibDestroy(handle);
   
-  return true;
-
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
   }
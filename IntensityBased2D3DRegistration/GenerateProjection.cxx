@@ -49,6 +49,16 @@
 #include "itkRayCastInterpolateImageFunction.h"
 // Software Guide : EndCodeSnippet
 
+// Software Guide : BeginLatex
+//
+// The Siddon-Jacobs ray caster is a faster alternative which sums the
+// exact intersection length of the ray with each voxel it crosses.
+//
+// Software Guide : EndLatex
+// Software Guide : BeginCodeSnippet
+#include "itkSiddonJacobsRayCastInterpolateImageFunction.h"
+// Software Guide : EndCodeSnippet
+
 #include "itkImage.h"
 
 #include "itkImageFileReader.h"
@@ -56,6 +66,8 @@
 
 #include "itkResampleImageFilter.h"
 #include "itkCastImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkTimeProbe.h"
 
 
 
@@ -79,6 +91,8 @@ void usage()
   std::cerr << "       <-normal float float>    The 2D projection normal position [default: 0x0mm]\n";
   std::cerr << "       <-cor float float float> The centre of rotation relative to centre of volume\n";
   std::cerr << "       <-threshold float>       Threshold [default: 0]\n";
+  std::cerr << "       <-siddon>                Use the Siddon-Jacobs ray caster [default: no]\n";
+  std::cerr << "       <-threads int>           Number of threads [default: all]\n";
   std::cerr << "                                by  john.hipwell@kcl.ac.uk\n";
   std::cerr << "                                and thomas@hartkens.de\n";
   std::cerr << "                                (Imaging Sciences KCL London)\n\n";
@@ -120,6 +134,9 @@ int main( int argc, char *argv[] )
 
   double threshold=0;
 
+  bool useSiddon = false;
+  int numberOfThreads = 0;
+
 
   // Parse command line parameters
 
@@ -251,6 +268,21 @@ int main( int argc, char *argv[] )
       argc--; argv++;
       }
 
+    if ((ok == false) && (strcmp(argv[1], "-siddon") == 0))
+      {
+      argc--; argv++;
+      ok = true;
+      useSiddon = true;
+      }
+
+    if ((ok == false) && (strcmp(argv[1], "-threads") == 0))
+      {
+      argc--; argv++;
+      ok = true;
+      numberOfThreads=atoi(argv[1]);
+      argc--; argv++;
+      }
+
     if (ok == false) 
       {
 
@@ -297,9 +329,20 @@ int main( int argc, char *argv[] )
                                     InternalImageType,
                                     double          >    InterpolatorType;
 
+  typedef itk::SiddonJacobsRayCastInterpolateImageFunction< 
+                                    InternalImageType,
+                                    double          >    SiddonInterpolatorType;
+
   TransformType::Pointer      transform     = TransformType::New();
   InterpolatorType::Pointer   interpolator  = InterpolatorType::New();
 
+  SiddonInterpolatorType::Pointer siddonInterpolator = SiddonInterpolatorType::New();
+
+  if (numberOfThreads > 0)
+    {
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads( numberOfThreads );
+    }
+
   typedef itk::ImageFileReader< ImageType3D > ImageReaderType3D;
 
   ImageReaderType3D::Pointer imageReader3D = ImageReaderType3D::New();
@@ -387,6 +430,10 @@ int main( int argc, char *argv[] )
   interpolator->SetThreshold( threshold );
   interpolator->SetTransform( transform );
 
+  siddonInterpolator->SetFocalPoint( focalPoint );
+  siddonInterpolator->SetThreshold( threshold );
+  siddonInterpolator->SetTransform( transform );
+
 
   // Write out the projection image at the registration position
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -399,12 +446,29 @@ int main( int argc, char *argv[] )
   filter->SetDefaultPixelValue( 0 );
 
   filter->SetTransform( transform );
-  filter->SetInterpolator( interpolator );
+  if (useSiddon)
+    {
+    filter->SetInterpolator( siddonInterpolator );
+    }
+  else
+    {
+    filter->SetInterpolator( interpolator );
+    }
 
   filter->SetSize( size2D );
   filter->SetOutputOrigin(  origin2D );
   filter->SetOutputSpacing( resolution2D );
 
+  if (verbose)
+    {
+    itk::TimeProbe timer;
+    timer.Start();
+    filter->Update();
+    timer.Stop();
+    std::cout << "Projection time: " << timer.GetMeanTime() << " s ("
+              << filter->GetNumberOfThreads() << " threads)" << std::endl;
+    }
+
    typedef itk::ImageFileWriter< ImageType2D >  WriterType;
     WriterType::Pointer writer = WriterType::New();
 
@@ -71,6 +71,16 @@
 #include "itkRayCastInterpolateImageFunction.h"
 // Software Guide : EndCodeSnippet
 
+// Software Guide : BeginLatex
+//
+// The Siddon-Jacobs ray caster is a faster alternative which sums the
+// exact intersection length of the ray with each voxel it crosses.
+//
+// Software Guide : EndLatex
+// Software Guide : BeginCodeSnippet
+#include "itkSiddonJacobsRayCastInterpolateImageFunction.h"
+// Software Guide : EndCodeSnippet
+
 // Software Guide : BeginLatex
 //
 // Finally a gradient descent optimizer is used to search for the
@@ -88,6 +98,8 @@
 
 #include "itkResampleImageFilter.h"
 #include "itkCastImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkTimeProbe.h"
 #include "itkSquaredDifferenceImageFilter.h"
 
 #include "itkCommand.h"
@@ -228,6 +240,8 @@ void usage()
   std::cerr << "       <-normal float float>    The 2D projection normal position [default: 0x0mm]\n";
   std::cerr << "       <-cor float float float> The centre of rotation relative to centre of volume\n";
   std::cerr << "       <-threshold float>       Threshold [default: 0]\n";
+  std::cerr << "       <-siddon>                Use the Siddon-Jacobs ray caster [default: no]\n";
+  std::cerr << "       <-threads int>           Number of threads [default: all]\n";
   std::cerr << "       <-diff file>             Difference image filename\n";
   std::cerr << "       <-o file>                Output image filename\n\n";
   std::cerr << "                                by  john.hipwell@kcl.ac.uk\n";
@@ -273,6 +287,9 @@ int main( int argc, char *argv[] )
 
   double threshold=0;
 
+  bool useSiddon = false;
+  int numberOfThreads = 0;
+
 
   // Parse command line parameters
 
@@ -404,6 +421,21 @@ int main( int argc, char *argv[] )
       argc--; argv++;
       }
 
+    if ((ok == false) && (strcmp(argv[1], "-siddon") == 0))
+      {
+      argc--; argv++;
+      ok = true;
+      useSiddon = true;
+      }
+
+    if ((ok == false) && (strcmp(argv[1], "-threads") == 0))
+      {
+      argc--; argv++;
+      ok = true;
+      numberOfThreads=atoi(argv[1]);
+      argc--; argv++;
+      }
+
     if ((ok == false) && (strcmp(argv[1], "-diff") == 0))
       {
       argc--; argv++;
@@ -499,6 +531,10 @@ int main( int argc, char *argv[] )
                                     InternalImageType,
                                     double          >    InterpolatorType;
 
+  typedef itk::SiddonJacobsRayCastInterpolateImageFunction< 
+                                    InternalImageType,
+                                    double          >    SiddonInterpolatorType;
+
   
   typedef itk::MultiResolutionImageRegistrationMethod< 
                                     InternalImageType, 
@@ -542,6 +578,8 @@ int main( int argc, char *argv[] )
   OptimizerType::Pointer      optimizer     = OptimizerType::New();
   InterpolatorType::Pointer   interpolator  = InterpolatorType::New();
   RegistrationType::Pointer   registration  = RegistrationType::New();
+
+  SiddonInterpolatorType::Pointer siddonInterpolator = SiddonInterpolatorType::New();
   // Software Guide : EndCodeSnippet
 
   // Software Guide : BeginLatex
@@ -553,7 +591,14 @@ int main( int argc, char *argv[] )
   registration->SetMetric(        metric        );
   registration->SetOptimizer(     optimizer     );
   registration->SetTransform(     transform     );
-  registration->SetInterpolator(  interpolator  );
+  if (useSiddon)
+    {
+    registration->SetInterpolator(  siddonInterpolator  );
+    }
+  else
+    {
+    registration->SetInterpolator(  interpolator  );
+    }
 
   registration->SetFixedImagePyramid( imagePyramid2D );
   registration->SetMovingImagePyramid( imagePyramid3D );
@@ -927,6 +972,10 @@ int main( int argc, char *argv[] )
   interpolator->SetTransform(transform);
   // Software Guide : EndCodeSnippet
 
+  siddonInterpolator->SetFocalPoint(focalPoint);
+  siddonInterpolator->SetThreshold(threshold);
+  siddonInterpolator->SetTransform(transform);
+
   // NB. Interpolator input image set in itkImageToImageMatric
 
   if (verbose)
@@ -1050,6 +1099,14 @@ int main( int argc, char *argv[] )
     std::cout << "Starting the registration now..." << std::endl;
     }
 
+  if (numberOfThreads > 0)
+    {
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads( numberOfThreads );
+    }
+
+  itk::TimeProbe registrationTimer;
+  registrationTimer.Start();
+
   try 
     { 
     // Software Guide : BeginLatex
@@ -1068,6 +1125,8 @@ int main( int argc, char *argv[] )
       return -1;
     } 
 
+  registrationTimer.Stop();
+
   typedef RegistrationType::ParametersType ParametersType;
   ParametersType finalParameters = registration->GetLastTransformParameters();
 
@@ -1085,6 +1144,7 @@ int main( int argc, char *argv[] )
   std::cout << " Translation Z = " << TranslationAlongZ  << std::endl;
   std::cout << " Iterations    = " << numberOfIterations << std::endl;
   std::cout << " Metric value  = " << bestValue          << std::endl;
+  std::cout << " Time          = " << registrationTimer.GetMeanTime() << " s" << std::endl;
 
   
   // Write out the projection image at the registration position
@@ -1098,7 +1158,7 @@ int main( int argc, char *argv[] )
   filter->SetDefaultPixelValue( 0 );
 
   filter->SetTransform( transform );
-  filter->SetInterpolator( interpolator );
+  filter->SetInterpolator( registration->GetInterpolator() );
 
   filter->SetSize( imageReader2D->GetOutput()->GetLargestPossibleRegion().GetSize() );
   filter->SetOutputOrigin(  imageReader2D->GetOutput()->GetOrigin() );
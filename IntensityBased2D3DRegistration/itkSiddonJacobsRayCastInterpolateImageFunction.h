@@ -0,0 +1,157 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkSiddonJacobsRayCastInterpolateImageFunction.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkSiddonJacobsRayCastInterpolateImageFunction_h
+#define __itkSiddonJacobsRayCastInterpolateImageFunction_h
+
+#include "itkInterpolateImageFunction.h"
+#include "itkTransform.h"
+#include "itkSimpleFastMutexLock.h"
+
+namespace itk
+{
+
+/** \class SiddonJacobsRayCastInterpolateImageFunction
+ *
+ * Drop-in replacement for RayCastInterpolateImageFunction. Evaluate()
+ * returns the integral, above Threshold, of the volume along the ray from
+ * the transformed focal point to the given point, which makes the function
+ * usable as the interpolator of a ResampleImageFilter (to generate a DRR)
+ * or of an image to image metric (to register against one).
+ *
+ * The ray is traversed with the incremental algorithm of Siddon as
+ * improved by Jacobs et al.: the ray is clipped once against the volume
+ * bounds, then each step moves to the next voxel boundary crossed, adding
+ * the voxel value times the exact intersection length. No per sample
+ * interpolation is done and the cost is proportional to the number of
+ * voxels crossed.
+ *
+ * The volume bounds and buffer are captured in SetInputImage(). The
+ * transformed focal point is recomputed only when the transform has been
+ * modified, so during a metric evaluation all rays share it. Evaluate()
+ * is reentrant, so the ResampleImageFilter threads can cast rays
+ * concurrently.
+ *
+ * Like RayCastInterpolateImageFunction, the image direction is ignored.
+ *
+ * \ingroup ImageFunctions
+ */
+template <class TInputImage, class TCoordRep = double>
+class ITK_EXPORT SiddonJacobsRayCastInterpolateImageFunction :
+    public InterpolateImageFunction<TInputImage,TCoordRep>
+{
+public:
+  /** Standard class typedefs. */
+  typedef SiddonJacobsRayCastInterpolateImageFunction       Self;
+  typedef InterpolateImageFunction<TInputImage,TCoordRep>   Superclass;
+  typedef SmartPointer<Self>                                Pointer;
+  typedef SmartPointer<const Self>                          ConstPointer;
+
+  /** Constants for the image dimensions */
+  itkStaticConstMacro(InputImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SiddonJacobsRayCastInterpolateImageFunction, InterpolateImageFunction);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Types inherited from the superclass. */
+  typedef typename Superclass::InputImageType      InputImageType;
+  typedef typename Superclass::OutputType          OutputType;
+  typedef typename Superclass::PointType           PointType;
+  typedef typename Superclass::IndexType           IndexType;
+  typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
+  typedef typename InputImageType::PixelType       PixelType;
+
+  /** Transform positioning the volume with respect to the projection. */
+  typedef Transform<TCoordRep,3,3>                 TransformType;
+  typedef typename TransformType::Pointer          TransformPointer;
+  typedef typename TransformType::InputPointType   InputPointType;
+  typedef typename TransformType::OutputPointType  OutputPointType;
+
+  /** Set/Get the transform. */
+  itkSetObjectMacro( Transform, TransformType );
+  itkGetObjectMacro( Transform, TransformType );
+
+  /** Set/Get the position of the focal point, before transformation. */
+  itkSetMacro( FocalPoint, InputPointType );
+  itkGetMacro( FocalPoint, InputPointType );
+
+  /** Set/Get the threshold above which voxels contribute. */
+  itkSetMacro( Threshold, double );
+  itkGetMacro( Threshold, double );
+
+  /** Capture the volume bounds and buffer. */
+  virtual void SetInputImage( const InputImageType * image );
+
+  /** Integral along the ray from the transformed focal point to point. */
+  virtual OutputType Evaluate( const PointType& point ) const;
+
+  virtual OutputType EvaluateAtContinuousIndex(
+      const ContinuousIndexType &index ) const;
+
+  /** Every point has a ray, whether or not it is inside the volume. */
+  virtual bool IsInsideBuffer( const PointType & ) const
+    {
+    return true;
+    }
+  virtual bool IsInsideBuffer( const ContinuousIndexType & ) const
+    {
+    return true;
+    }
+  virtual bool IsInsideBuffer( const IndexType & ) const
+    {
+    return true;
+    }
+
+protected:
+  SiddonJacobsRayCastInterpolateImageFunction();
+  ~SiddonJacobsRayCastInterpolateImageFunction(){};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Transformed focal point, recomputed when the transform changes. */
+  OutputPointType GetTransformedFocalPoint() const;
+
+private:
+  SiddonJacobsRayCastInterpolateImageFunction( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  TransformPointer               m_Transform;
+  InputPointType                 m_FocalPoint;
+  double                         m_Threshold;
+
+  /** Volume geometry captured from the input image. */
+  const PixelType *              m_Buffer;
+  double                         m_FirstPlane[3];
+  double                         m_Spacing[3];
+  long                           m_Size[3];
+  long                           m_Stride[3];
+
+  mutable SimpleFastMutexLock    m_CacheLock;
+  mutable unsigned long          m_CachedTransformMTime;
+  mutable const TransformType *  m_CachedTransform;
+  mutable OutputPointType        m_CachedFocalPoint;
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSiddonJacobsRayCastInterpolateImageFunction.txx"
+#endif
+
+#endif
@@ -0,0 +1,250 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkSiddonJacobsRayCastInterpolateImageFunction.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkSiddonJacobsRayCastInterpolateImageFunction_txx
+#define __itkSiddonJacobsRayCastInterpolateImageFunction_txx
+
+#include "itkSiddonJacobsRayCastInterpolateImageFunction.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template<class TInputImage, class TCoordRep>
+SiddonJacobsRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::SiddonJacobsRayCastInterpolateImageFunction()
+{
+  m_FocalPoint.Fill( 0.0 );
+  m_Threshold = 0.0;
+
+  m_Buffer = 0;
+  for ( unsigned int i = 0; i < 3; i++ )
+    {
+    m_FirstPlane[i] = 0.0;
+    m_Spacing[i]    = 1.0;
+    m_Size[i]       = 0;
+    m_Stride[i]     = 0;
+    }
+
+  m_CachedTransformMTime = 0;
+  m_CachedTransform = 0;
+  m_CachedFocalPoint.Fill( 0.0 );
+}
+
+
+template<class TInputImage, class TCoordRep>
+void
+SiddonJacobsRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Threshold: " << m_Threshold << std::endl;
+  os << indent << "FocalPoint: " << m_FocalPoint << std::endl;
+  os << indent << "Transform: " << m_Transform.GetPointer() << std::endl;
+}
+
+
+template<class TInputImage, class TCoordRep>
+void
+SiddonJacobsRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::SetInputImage( const InputImageType * image )
+{
+  Superclass::SetInputImage( image );
+
+  m_Buffer = 0;
+  if ( !image )
+    {
+    return;
+    }
+
+  const typename InputImageType::RegionType region = image->GetBufferedRegion();
+  const typename InputImageType::SpacingType spacing = image->GetSpacing();
+
+  // Voxel i along an axis spans [m_FirstPlane + i * spacing,
+  // m_FirstPlane + (i + 1) * spacing].
+  IndexType firstIndex = region.GetIndex();
+  PointType firstCenter;
+  image->TransformIndexToPhysicalPoint( firstIndex, firstCenter );
+
+  long stride = 1;
+  for ( unsigned int i = 0; i < 3; i++ )
+    {
+    m_Spacing[i]    = spacing[i];
+    m_FirstPlane[i] = firstCenter[i] - 0.5 * spacing[i];
+    m_Size[i]       = region.GetSize()[i];
+    m_Stride[i]     = stride;
+    stride *= m_Size[i];
+    }
+
+  m_Buffer = image->GetBufferPointer();
+}
+
+
+template<class TInputImage, class TCoordRep>
+typename SiddonJacobsRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::OutputPointType
+SiddonJacobsRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::GetTransformedFocalPoint() const
+{
+  OutputPointType focalPoint;
+
+  m_CacheLock.Lock();
+  if ( m_CachedTransform != m_Transform.GetPointer() ||
+       m_CachedTransformMTime != m_Transform->GetMTime() )
+    {
+    m_CachedFocalPoint = m_Transform->TransformPoint( m_FocalPoint );
+    m_CachedTransform = m_Transform.GetPointer();
+    m_CachedTransformMTime = m_Transform->GetMTime();
+    }
+  focalPoint = m_CachedFocalPoint;
+  m_CacheLock.Unlock();
+
+  return focalPoint;
+}
+
+
+template<class TInputImage, class TCoordRep>
+typename SiddonJacobsRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::OutputType
+SiddonJacobsRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::Evaluate( const PointType& point ) const
+{
+  if ( !m_Buffer || !m_Transform )
+    {
+    return 0;
+    }
+
+  const OutputPointType source = this->GetTransformedFocalPoint();
+
+  double direction[3];
+  double alphaMin = 0.0;
+  double alphaMax = 1.0;
+
+  // Parametric range of the ray inside the volume bounds, with the source
+  // at alpha = 0 and the point at alpha = 1.
+  for ( unsigned int i = 0; i < 3; i++ )
+    {
+    direction[i] = point[i] - source[i];
+    const double lower = m_FirstPlane[i];
+    const double upper = m_FirstPlane[i] + m_Size[i] * m_Spacing[i];
+    if ( direction[i] == 0.0 )
+      {
+      if ( source[i] < lower || source[i] > upper )
+        {
+        return 0;
+        }
+      continue;
+      }
+    const double a0 = ( lower - source[i] ) / direction[i];
+    const double a1 = ( upper - source[i] ) / direction[i];
+    alphaMin = std::max( alphaMin, std::min( a0, a1 ) );
+    alphaMax = std::min( alphaMax, std::max( a0, a1 ) );
+    }
+
+  if ( alphaMin >= alphaMax )
+    {
+    return 0;
+    }
+
+  const double rayLength = std::sqrt( direction[0] * direction[0] +
+                                      direction[1] * direction[1] +
+                                      direction[2] * direction[2] );
+
+  // First voxel, next crossing and crossing increment along each axis.
+  long   index[3];
+  long   step[3];
+  double alphaNext[3];
+  double alphaStep[3];
+  long   offset = 0;
+  for ( unsigned int i = 0; i < 3; i++ )
+    {
+    const double entry = ( source[i] + alphaMin * direction[i] - m_FirstPlane[i] )
+                         / m_Spacing[i];
+    if ( direction[i] > 0.0 )
+      {
+      index[i] = static_cast<long>( std::floor( entry ) );
+      step[i]  = 1;
+      }
+    else
+      {
+      index[i] = static_cast<long>( std::ceil( entry ) ) - 1;
+      step[i]  = -1;
+      }
+    index[i] = std::min( std::max( index[i], 0L ), m_Size[i] - 1 );
+
+    if ( direction[i] == 0.0 )
+      {
+      alphaNext[i] = NumericTraits<double>::max();
+      alphaStep[i] = 0.0;
+      }
+    else
+      {
+      const long plane = ( step[i] > 0 ) ? index[i] + 1 : index[i];
+      alphaNext[i] = ( m_FirstPlane[i] + plane * m_Spacing[i] - source[i] )
+                     / direction[i];
+      alphaStep[i] = m_Spacing[i] / std::fabs( direction[i] );
+      }
+    offset += index[i] * m_Stride[i];
+    }
+
+  double integral = 0.0;
+  double alpha = alphaMin;
+  while ( alpha < alphaMax )
+    {
+    const unsigned int axis =
+      ( alphaNext[0] < alphaNext[1] )
+        ? ( ( alphaNext[0] < alphaNext[2] ) ? 0 : 2 )
+        : ( ( alphaNext[1] < alphaNext[2] ) ? 1 : 2 );
+
+    const double alphaEnd = std::min( alphaNext[axis], alphaMax );
+    const double value = static_cast<double>( m_Buffer[offset] );
+    if ( value > m_Threshold )
+      {
+      integral += ( value - m_Threshold ) * ( alphaEnd - alpha );
+      }
+    alpha = alphaEnd;
+
+    index[axis] += step[axis];
+    if ( index[axis] < 0 || index[axis] >= m_Size[axis] )
+      {
+      break;
+      }
+    offset += step[axis] * m_Stride[axis];
+    alphaNext[axis] += alphaStep[axis];
+    }
+
+  return static_cast<OutputType>( integral * rayLength );
+}
+
+
+template<class TInputImage, class TCoordRep>
+typename SiddonJacobsRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::OutputType
+SiddonJacobsRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::EvaluateAtContinuousIndex( const ContinuousIndexType& index ) const
+{
+  PointType point;
+  this->GetInputImage()->TransformContinuousIndexToPhysicalPoint( index, point );
+
+  return this->Evaluate( point );
+}
+
+} // namespace itk
+
+#endif
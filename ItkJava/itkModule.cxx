@@ -17,6 +17,11 @@
 
 
 #include "itkModule.h"
+#include "itkTimeProbe.h"
+#include "itkExceptionObject.h"
+
+#include <string.h>
+#include <iostream>
 
 itkModule::itkModule()
 {
@@ -26,6 +31,17 @@ itkModule::itkModule()
 
   m_Filter->SetInput( m_Reader->GetOutput() );
   m_Writer->SetInput( m_Filter->GetOutput() );
+
+  m_Import = ImportType::New();
+  m_BufferFilter = FilterType::New();
+  m_BufferFilter->SetInput( m_Import->GetOutput() );
+
+  m_Threader = itk::MultiThreader::New();
+  m_NumberOfWorkers = m_Threader->GetNumberOfThreads();
+  m_NextFile = 0;
+  m_NumberOfProcessedFiles = 0;
+  m_NumberOfFailedFiles = 0;
+  m_FilesPerSecond = 0.0;
 }
 
 
@@ -51,6 +67,222 @@ itkModule::SetOutputFileName( const char * filename )
 void
 itkModule::RunPipeline()
 {
+  try
+    {
+    m_Writer->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << "Error running the pipeline" << std::endl;
+    std::cerr << excp << std::endl;
+    }
+}
+
+
+
+void
+itkModule::AddFiles( const char * inputFileName, const char * outputFileName )
+{
+  m_InputFileNames.push_back( inputFileName );
+  m_OutputFileNames.push_back( outputFileName );
+}
+
+
+void
+itkModule::ClearFiles()
+{
+  m_InputFileNames.clear();
+  m_OutputFileNames.clear();
+}
+
+
+void
+itkModule::SetNumberOfWorkers( unsigned int numberOfWorkers )
+{
+  m_NumberOfWorkers = numberOfWorkers > 0 ? numberOfWorkers : 1;
+}
+
+
+unsigned int
+itkModule::GetNumberOfWorkers() const
+{
+  return m_NumberOfWorkers;
+}
+
+
+unsigned int
+itkModule::GetNumberOfProcessedFiles() const
+{
+  return m_NumberOfProcessedFiles;
+}
+
+
+unsigned int
+itkModule::GetNumberOfFailedFiles() const
+{
+  return m_NumberOfFailedFiles;
+}
+
+
+double
+itkModule::GetFilesPerSecond() const
+{
+  return m_FilesPerSecond;
+}
+
+
+
+void
+itkModule::RunBatch()
+{
+  m_NextFile = 0;
+  m_NumberOfProcessedFiles = 0;
+  m_NumberOfFailedFiles = 0;
+  m_FilesPerSecond = 0.0;
+
+  const unsigned int numberOfFiles = m_InputFileNames.size();
+  if( numberOfFiles == 0 )
+    {
+    return;
+    }
+
+  unsigned int numberOfWorkers = m_NumberOfWorkers;
+  if( numberOfWorkers > numberOfFiles )
+    {
+    numberOfWorkers = numberOfFiles;
+    }
+
+  // The pipelines of previous batches are kept, new ones are only
+  // created when more workers are requested.
+  while( m_Workers.size() < numberOfWorkers )
+    {
+    WorkerPipeline pipeline;
+    pipeline.Reader = ReaderType::New();
+    pipeline.Filter = FilterType::New();
+    pipeline.Writer = WriterType::New();
+    pipeline.Filter->SetInput( pipeline.Reader->GetOutput() );
+    pipeline.Writer->SetInput( pipeline.Filter->GetOutput() );
+    m_Workers.push_back( pipeline );
+    }
+
+  // Parallelism comes from the workers; with several of them, each
+  // filter runs on a single thread.
+  for( unsigned int w = 0; w < numberOfWorkers; w++ )
+    {
+    m_Workers[w].Filter->SetNumberOfThreads( numberOfWorkers > 1 ? 1 :
+      itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+    }
+
+  itk::TimeProbe probe;
+  probe.Start();
+
+  m_Threader->SetNumberOfThreads( numberOfWorkers );
+  m_Threader->SetSingleMethod( BatchThreaderCallback, this );
+  m_Threader->SingleMethodExecute();
+
+  probe.Stop();
+
+  const double seconds = probe.GetMeanTime();
+  if( seconds > 0.0 )
+    {
+    m_FilesPerSecond = m_NumberOfProcessedFiles / seconds;
+    }
+}
+
+
+ITK_THREAD_RETURN_TYPE
+itkModule::BatchThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info =
+    static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  itkModule * module = static_cast<itkModule *>( info->UserData );
+
+  module->ProcessFiles( info->ThreadID );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+void
+itkModule::ProcessFiles( unsigned int worker )
+{
+  WorkerPipeline & pipeline = m_Workers[worker];
+
+  while( true )
+    {
+    m_BatchLock.Lock();
+    const unsigned int file = m_NextFile++;
+    m_BatchLock.Unlock();
+
+    if( file >= m_InputFileNames.size() )
+      {
+      return;
+      }
+
+    pipeline.Reader->SetFileName( m_InputFileNames[file].c_str() );
+    pipeline.Writer->SetFileName( m_OutputFileNames[file].c_str() );
+
+    bool failed = false;
+    try
+      {
+      pipeline.Writer->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << "Error processing " << m_InputFileNames[file] << std::endl;
+      std::cerr << excp << std::endl;
+      failed = true;
+      }
+
+    m_BatchLock.Lock();
+    if( failed )
+      {
+      m_NumberOfFailedFiles++;
+      }
+    else
+      {
+      m_NumberOfProcessedFiles++;
+      }
+    m_BatchLock.Unlock();
+    }
+}
+
+
+
+void
+itkModule::RunBuffer( unsigned char * buffer, unsigned int width, unsigned int height )
+{
+  ImportType::SizeType size;
+  size[0] = width;
+  size[1] = height;
+
+  ImportType::IndexType start;
+  start.Fill( 0 );
+
+  ImportType::RegionType region;
+  region.SetIndex( start );
+  region.SetSize( size );
+
+  // The import filter only refers to the buffer, the result is copied
+  // back into it once the filter has run.
+  const unsigned long numberOfPixels = static_cast<unsigned long>( width ) * height;
+  m_Import->SetRegion( region );
+  m_Import->SetImportPointer( buffer, numberOfPixels, false );
+  m_Import->Modified();
+
+  try
+    {
+    m_BufferFilter->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << "Error filtering the buffer" << std::endl;
+    std::cerr << excp << std::endl;
+    return;
+    }
+
+  memcpy( buffer, m_BufferFilter->GetOutput()->GetBufferPointer(),
+          numberOfPixels * sizeof( unsigned char ) );
 }
 
 
@@ -20,15 +20,48 @@
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkMeanImageFilter.h"
+#include "itkImportImageFilter.h"
 #include "itkImage.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 
+#include <string>
+#include <vector>
 
+
+/** itkModule runs a reader -> MeanImageFilter -> writer pipeline.
+ *
+ * RunPipeline() processes the single pair of files given by
+ * SetInputFileName() and SetOutputFileName().
+ *
+ * For many images, the pairs are queued with AddFiles() and processed by
+ * RunBatch() on NumberOfWorkers threads. Each worker owns a pipeline that
+ * is kept, with its buffers, from one file and one batch to the next, so
+ * reading, filtering and writing of different files overlap across the
+ * workers. GetFilesPerSecond() reports the throughput of the last batch.
+ *
+ * RunBuffer() filters, in place, an image already in memory as a byte
+ * array of width * height pixels, through a pipeline also kept alive
+ * between calls. */
 class itkModule
 {
 public:
   void SetInputFileName( const char * filename );
   void SetOutputFileName( const char * filename );
   void RunPipeline(); 
+
+  /** Batch processing of files. */
+  void AddFiles( const char * inputFileName, const char * outputFileName );
+  void ClearFiles();
+  void SetNumberOfWorkers( unsigned int numberOfWorkers );
+  unsigned int GetNumberOfWorkers() const;
+  void RunBatch();
+  unsigned int GetNumberOfProcessedFiles() const;
+  unsigned int GetNumberOfFailedFiles() const;
+  double GetFilesPerSecond() const;
+
+  /** Filter an image held in memory, in place. */
+  void RunBuffer( unsigned char * buffer, unsigned int width, unsigned int height );
  
   itkModule();
   ~itkModule();
@@ -38,14 +71,39 @@ private:
   typedef itk::ImageFileReader< ImageType > ReaderType;
   typedef itk::ImageFileWriter< ImageType > WriterType;
   typedef itk::MeanImageFilter< ImageType, ImageType > FilterType;
+  typedef itk::ImportImageFilter< unsigned char, 2 > ImportType;
+
+  /** Pipeline owned by one batch worker. */
+  struct WorkerPipeline
+    {
+    ReaderType::Pointer Reader;
+    FilterType::Pointer Filter;
+    WriterType::Pointer Writer;
+    };
+
+  static ITK_THREAD_RETURN_TYPE BatchThreaderCallback( void * arg );
+  void ProcessFiles( unsigned int worker );
 
-  
 private:
 
   ReaderType::Pointer m_Reader;
   WriterType::Pointer m_Writer;
   FilterType::Pointer m_Filter;
 
+  ImportType::Pointer m_Import;
+  FilterType::Pointer m_BufferFilter;
+
+  std::vector<std::string>     m_InputFileNames;
+  std::vector<std::string>     m_OutputFileNames;
+  std::vector<WorkerPipeline>  m_Workers;
+  unsigned int                 m_NumberOfWorkers;
+  itk::MultiThreader::Pointer  m_Threader;
+  itk::SimpleFastMutexLock     m_BatchLock;
+  unsigned int                 m_NextFile;
+  unsigned int                 m_NumberOfProcessedFiles;
+  unsigned int                 m_NumberOfFailedFiles;
+  double                       m_FilesPerSecond;
+
 };
 
 
@@ -25,7 +25,14 @@ public class myApp
     
     myApp app = new myApp();
 
-    app.Run( argv[0], argv[1] );
+    if( argv.length > 2 )
+      {
+      app.RunBatch( argv );
+      }
+    else
+      {
+      app.Run( argv[0], argv[1] );
+      }
 
 
     System.out.println("Enjoy ITK from Java without wrapping everything !");
@@ -53,6 +60,24 @@ public class myApp
     module.RunPipeline();
   }
 
+  // Execution of the pipeline on a list of input/output pairs
+  public void RunBatch( String [] filenames )
+  {
+    for( int i = 0; i + 1 < filenames.length; i += 2 )
+      {
+      module.AddFiles( filenames[i], filenames[i+1] );
+      }
+
+    System.out.println("Running the pipeline on "+(filenames.length/2)+" images with "
+                       +module.GetNumberOfWorkers()+" workers");
+    module.RunBatch();
+    module.ClearFiles();
+
+    System.out.println("Processed = "+module.GetNumberOfProcessedFiles()
+                       +"  Failed = "+module.GetNumberOfFailedFiles()
+                       +"  Files/s = "+module.GetFilesPerSecond() );
+  }
+
 
   
   itkModuleJava module;
@@ -29,6 +29,7 @@
 #include "itkLandmarkDisplacementFieldSource.h"
 #endif
 #include "itkMattesMutualInformationImageToImageMetric.h"
+#include "itkCachedBSplineMutualInformationImageToImageMetric.h"
 
 #include "itkOnePlusOneEvolutionaryOptimizer.h"
 
@@ -75,6 +76,9 @@ class DeformableRegistrator : public ImageRegistrationMethod < TImage, TImage >
                                                 InterpolatorType ;
     typedef MattesMutualInformationImageToImageMetric< TImage, TImage >
                                                 MetricType ;
+    typedef CachedBSplineMutualInformationImageToImageMetric< TImage, TImage,
+                                                 TransformType >
+                                                CachedMetricType ;
 
     typedef typename Superclass::OptimizerType  OptimizerType;
     typedef typename OptimizerType::Pointer     OptimizerPointer;
@@ -103,14 +107,25 @@ class DeformableRegistrator : public ImageRegistrationMethod < TImage, TImage >
     itkSetMacro(NumberOfControlPoints, unsigned int);
     itkGetConstMacro(NumberOfControlPoints, unsigned int);
 
+    /** Mattes metric, used unless UseCachedBSplineWeights is on */
     MetricType * GetTypedMetric(void)
       {
-      return static_cast<MetricType *>(Superclass::GetMetric());
+      return m_MattesMetric.GetPointer();
       }
 
     itkSetMacro(MetricNumberOfSpatialSamples, unsigned int) ;
     itkGetConstMacro(MetricNumberOfSpatialSamples, unsigned int) ;
 
+    /** Use CachedBSplineMutualInformationImageToImageMetric, which keeps
+     *  the B-spline weights of every sample, instead of the Mattes metric.
+     *  The weights are recomputed at each evaluation if the cache would
+     *  exceed MaximumWeightCacheSize bytes. */
+    itkSetMacro(UseCachedBSplineWeights, bool) ;
+    itkGetConstMacro(UseCachedBSplineWeights, bool) ;
+    itkBooleanMacro(UseCachedBSplineWeights) ;
+    itkSetMacro(MaximumWeightCacheSize, unsigned long) ;
+    itkGetConstMacro(MaximumWeightCacheSize, unsigned long) ;
+
     itkSetObjectMacro(Observer, Command);
 
   protected:
@@ -132,6 +147,11 @@ class DeformableRegistrator : public ImageRegistrationMethod < TImage, TImage >
     unsigned int            m_OptimizerNumberOfIterations;
 
     unsigned int            m_MetricNumberOfSpatialSamples;
+
+    bool                    m_UseCachedBSplineWeights;
+    unsigned long           m_MaximumWeightCacheSize;
+    typename MetricType::Pointer        m_MattesMetric;
+    typename CachedMetricType::Pointer  m_CachedMetric;
     
     unsigned int            m_NumberOfControlPoints;
     
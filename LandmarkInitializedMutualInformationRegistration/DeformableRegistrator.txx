@@ -32,9 +32,14 @@ DeformableRegistrator< TImage >
   m_OptimizerMethod = LBFGS;
   m_OptimizerNumberOfIterations = 1000 ;
   
-  this->SetMetric(MetricType::New());
+  m_MattesMetric = MetricType::New();
+  m_CachedMetric = 0;
+  this->SetMetric(m_MattesMetric);
   m_MetricNumberOfSpatialSamples = 80000 ;
 
+  m_UseCachedBSplineWeights = false;
+  m_MaximumWeightCacheSize = 512UL * 1024UL * 1024UL;
+
   m_NumberOfControlPoints = 8 ;
   
   m_Observer = 0;
@@ -68,8 +73,23 @@ DeformableRegistrator< TImage >
 ::Initialize() throw(ExceptionObject)
   {
   this->GetInterpolator()->SetInputImage( this->GetMovingImage() ) ;
-  this->GetTypedMetric()->SetNumberOfSpatialSamples( 
-                          m_MetricNumberOfSpatialSamples );
+  if(m_UseCachedBSplineWeights)
+    {
+    if(!m_CachedMetric)
+      {
+      m_CachedMetric = CachedMetricType::New();
+      }
+    m_CachedMetric->SetNumberOfSpatialSamples( 
+                            m_MetricNumberOfSpatialSamples );
+    m_CachedMetric->SetMaximumCacheSize( m_MaximumWeightCacheSize );
+    this->SetMetric( m_CachedMetric );
+    }
+  else
+    {
+    m_MattesMetric->SetNumberOfSpatialSamples( 
+                            m_MetricNumberOfSpatialSamples );
+    this->SetMetric( m_MattesMetric );
+    }
   
 #if ITK_VERSION_MAJOR < 4
     // Definition of the differents objects used by the B Spline Transform
@@ -177,6 +197,23 @@ DeformableRegistrator< TImage >
     {
     throw(e);
     }
+
+  if(m_UseCachedBSplineWeights)
+    {
+    if(m_CachedMetric->GetUseCache())
+      {
+      std::cout << "B-spline weight cache: " 
+                << m_CachedMetric->GetCacheSize() / (1024.0 * 1024.0)
+                << " MB" << std::endl;
+      }
+    else
+      {
+      std::cout << "B-spline weight cache exceeds "
+                << m_MaximumWeightCacheSize / (1024.0 * 1024.0)
+                << " MB, weights are computed at each evaluation" 
+                << std::endl;
+      }
+    }
   }
 
 template< class TImage >
@@ -27,15 +27,20 @@
 #include "DeformableRegistrator.h"
 
 #include "itkAffineTransform.h"
+#include "itkMultiThreader.h"
 
 #include "itkVersor.h"
 
+#include <vector>
+
 // including all the type of transform that could possibly be used
 // as templated type.
 
 namespace itk
 {
 
+class ImageRegistrationAppRace;
+
 template< class TImage >
 class ImageRegistrationApp : public Object
   {
@@ -124,6 +129,12 @@ class ImageRegistrationApp : public Object
                                 LandmarkSetType* movingImageLandmarks) ;
   
     void RegisterUsingRigid() ;
+
+    /** Race a short rigid registration from every available
+     *  initialization (none, centers, mass, moments, and landmarks or a
+     *  loaded transform if set) concurrently, and keep the start reaching
+     *  the best metric value as the rigid result. */
+    void RegisterUsingMultiStart() ;
   
     void RegisterUsingAffine() ;
     
@@ -163,6 +174,24 @@ class ImageRegistrationApp : public Object
     itkGetConstMacro(RigidNumberOfSpatialSamples, unsigned int) ;
     itkSetMacro(RigidScales, RigidScalesType) ;
     itkGetConstMacro(RigidScales, RigidScalesType) ;
+    itkSetMacro(RigidUseBatchedOnePlusOne, bool) ;
+    itkGetConstMacro(RigidUseBatchedOnePlusOne, bool) ;
+    itkSetMacro(RigidPopulationSize, unsigned int) ;
+    itkGetConstMacro(RigidPopulationSize, unsigned int) ;
+    itkSetMacro(RigidOptimizerSeed, int) ;
+    itkGetConstMacro(RigidOptimizerSeed, int) ;
+
+    /** Iterations of each branch of the multi-start race. A branch is
+     *  stopped once both it and a better branch have done
+     *  MultiStartMinimumIterations iterations and its metric value is
+     *  worse than the best by more than MultiStartCancelMargin, relative
+     *  to the best value. */
+    itkSetMacro(MultiStartNumberOfIterations, unsigned int) ;
+    itkGetConstMacro(MultiStartNumberOfIterations, unsigned int) ;
+    itkSetMacro(MultiStartMinimumIterations, unsigned int) ;
+    itkGetConstMacro(MultiStartMinimumIterations, unsigned int) ;
+    itkSetMacro(MultiStartCancelMargin, double) ;
+    itkGetConstMacro(MultiStartCancelMargin, double) ;
   
     itkSetMacro(AffineNumberOfIterations, unsigned int) ;
     itkGetConstMacro(AffineNumberOfIterations, unsigned int) ;
@@ -181,6 +210,10 @@ class ImageRegistrationApp : public Object
     itkGetConstMacro(DeformableNumberOfSpatialSamples, unsigned int);
     itkSetMacro(DeformableNumberOfControlPoints, unsigned int);
     itkGetConstMacro(DeformableNumberOfControlPoints, unsigned int);
+    itkSetMacro(DeformableUseCachedBSplineWeights, bool);
+    itkGetConstMacro(DeformableUseCachedBSplineWeights, bool);
+    itkSetMacro(DeformableMaximumWeightCacheSize, unsigned long);
+    itkGetConstMacro(DeformableMaximumWeightCacheSize, unsigned long);
     
     itkSetMacro(FixedImageRegion, RegionType) ;
     itkGetConstMacro(FixedImageRegion, RegionType) ;
@@ -206,6 +239,15 @@ class ImageRegistrationApp : public Object
 
     void InitRigidParameters(RigidParametersType & p,
                              Point<double, 3> & center);
+
+    /** Branches of RegisterUsingMultiStart and the race between them */
+    struct MultiStartType
+      {
+      std::vector< typename RigidRegistratorType::Pointer > Branches;
+      ImageRegistrationAppRace *                            Race;
+      };
+
+    static ITK_THREAD_RETURN_TYPE MultiStartThreaderCallback( void * arg );
   
     void PrintUncaughtError() ;
   
@@ -278,7 +320,14 @@ class ImageRegistrationApp : public Object
     double              m_RigidMovingImageStandardDeviation ;
     unsigned int        m_RigidNumberOfSpatialSamples ;
     RigidScalesType     m_RigidScales ;
+    bool                m_RigidUseBatchedOnePlusOne ;
+    unsigned int        m_RigidPopulationSize ;
+    int                 m_RigidOptimizerSeed ;
     bool                m_RigidRegValid;
+
+    unsigned int        m_MultiStartNumberOfIterations ;
+    unsigned int        m_MultiStartMinimumIterations ;
+    double              m_MultiStartCancelMargin ;
   
     unsigned int        m_AffineNumberOfIterations ;
     double              m_AffineFixedImageStandardDeviation ;
@@ -289,6 +338,8 @@ class ImageRegistrationApp : public Object
     
     unsigned int        m_DeformableNumberOfIterations;
     unsigned int        m_DeformableNumberOfSpatialSamples;
+    bool                m_DeformableUseCachedBSplineWeights;
+    unsigned long       m_DeformableMaximumWeightCacheSize;
     unsigned int        m_DeformableNumberOfControlPoints;
     bool                m_DeformableRegValid;
   
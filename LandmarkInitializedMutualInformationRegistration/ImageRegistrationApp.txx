@@ -27,6 +27,9 @@
 
 #include "itkCommand.h"
 #include "itkSingleValuedNonLinearOptimizer.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -83,6 +86,145 @@ class ImageRegistrationAppViewer
 
 };
 
+/** Shared state of the multi-start race: the last metric value and
+ *  iteration count of every branch, and which branches were cancelled or
+ *  failed. */
+class ImageRegistrationAppRace
+{
+  public :
+    ImageRegistrationAppRace(unsigned int numberOfBranches,
+                             unsigned int minimumIterations,
+                             double cancelMargin)
+      : m_Values(numberOfBranches, NumericTraits<double>::max()),
+        m_Iterations(numberOfBranches, 0),
+        m_Cancelled(numberOfBranches, false),
+        m_Failed(numberOfBranches, false),
+        m_MinimumIterations(minimumIterations),
+        m_CancelMargin(cancelMargin)
+      {
+      }
+
+    /** Record the current value of a branch (metrics are minimized) and
+     *  return false if the branch should stop. */
+    bool Report(unsigned int branch, double value)
+      {
+      m_Lock.Lock();
+      m_Values[branch] = value;
+      m_Iterations[branch]++;
+      if(!m_Cancelled[branch] && m_Iterations[branch] >= m_MinimumIterations)
+        {
+        double best = NumericTraits<double>::max();
+        for(unsigned int b=0; b<m_Values.size(); b++)
+          {
+          if(b != branch && !m_Cancelled[b] && !m_Failed[b]
+             && m_Iterations[b] >= m_MinimumIterations && m_Values[b] < best)
+            {
+            best = m_Values[b];
+            }
+          }
+        if(best < NumericTraits<double>::max()
+           && value > best + m_CancelMargin * vcl_fabs(best))
+          {
+          m_Cancelled[branch] = true;
+          }
+        }
+      const bool keepGoing = !m_Cancelled[branch];
+      m_Lock.Unlock();
+      return keepGoing;
+      }
+
+    bool IsCancelled(unsigned int branch) const
+      {
+      return m_Cancelled[branch];
+      }
+
+    /** Exclude a branch whose registration threw from the race. */
+    void Fail(unsigned int branch)
+      {
+      m_Lock.Lock();
+      m_Failed[branch] = true;
+      m_Lock.Unlock();
+      }
+
+    bool IsFailed(unsigned int branch) const
+      {
+      return m_Failed[branch];
+      }
+
+  private :
+    std::vector<double>       m_Values;
+    std::vector<unsigned int> m_Iterations;
+    std::vector<bool>         m_Cancelled;
+    std::vector<bool>         m_Failed;
+    unsigned int              m_MinimumIterations;
+    double                    m_CancelMargin;
+    SimpleFastMutexLock       m_Lock;
+};
+
+/** Reports the optimizer value of one branch to the race at every
+ *  iteration, and stops the optimizer when the branch is cancelled. */
+class ImageRegistrationAppRaceObserver
+: public itk::Command
+{
+  public :
+    typedef ImageRegistrationAppRaceObserver  Self;
+    typedef itk::Command                      Superclass;
+    typedef itk::SmartPointer<Self>           Pointer;
+
+    itkNewMacro( ImageRegistrationAppRaceObserver );
+    itkTypeMacro( ImageRegistrationAppRaceObserver, itk::Command );
+
+    void SetBranch(ImageRegistrationAppRace * race, unsigned int branch)
+      {
+      m_Race = race;
+      m_Branch = branch;
+      }
+
+    void Execute( itk::Object * caller, const itk::EventObject & event )
+      {
+      if( typeid( event ) != typeid( itk::IterationEvent ) 
+          || caller == NULL || m_Race == NULL )
+        {
+        return;
+        }
+
+      if( OnePlusOneEvolutionaryOptimizer * opt = 
+            dynamic_cast<OnePlusOneEvolutionaryOptimizer *>(caller) )
+        {
+        if( !m_Race->Report( m_Branch, opt->GetValue() ) )
+          {
+          opt->StopOptimization();
+          }
+        }
+      else if( BatchedOnePlusOneEvolutionaryOptimizer * opt = 
+            dynamic_cast<BatchedOnePlusOneEvolutionaryOptimizer *>(caller) )
+        {
+        if( !m_Race->Report( m_Branch, opt->GetValue() ) )
+          {
+          opt->StopOptimization();
+          }
+        }
+      else if( FRPROptimizer * opt = dynamic_cast<FRPROptimizer *>(caller) )
+        {
+        if( !m_Race->Report( m_Branch, opt->GetValue() ) )
+          {
+          opt->StopOptimization();
+          }
+        }
+      }
+
+    void Execute( const itk::Object * , const itk::EventObject & )
+      {
+      }
+
+  protected:
+    ImageRegistrationAppRace * m_Race;
+    unsigned int               m_Branch;
+    ImageRegistrationAppRaceObserver() { m_Race = NULL; m_Branch = 0; };
+    ~ImageRegistrationAppRaceObserver() {};
+
+};
+
 template< class TImage >
 ImageRegistrationApp< TImage >
 ::ImageRegistrationApp()
@@ -142,6 +284,9 @@ ImageRegistrationApp< TImage >
   m_RigidScales[3] = 1;
   m_RigidScales[4] = 1;
   m_RigidScales[5] = 1;
+  m_RigidUseBatchedOnePlusOne = false;
+  m_RigidPopulationSize = 0;
+  m_RigidOptimizerSeed = 121212;
   m_RigidRegTransform = RigidRegTransformType::New() ;
   m_RigidRegTransform->SetIdentity() ;
   m_RigidAffineTransform = AffineTransformType::New() ;
@@ -149,6 +294,10 @@ ImageRegistrationApp< TImage >
   m_RigidRegValid = false;
   m_RigidMetricValue = 0;
 
+  m_MultiStartNumberOfIterations = 50 ;
+  m_MultiStartMinimumIterations = 10 ;
+  m_MultiStartCancelMargin = 0.1 ;
+
   m_AffineNumberOfIterations = 500 ;
   m_AffineNumberOfSpatialSamples = 40000 ;
   m_AffineScales.set_size(15) ;
@@ -177,6 +326,8 @@ ImageRegistrationApp< TImage >
   m_DeformableNumberOfIterations = 1000 ;
   m_DeformableNumberOfSpatialSamples = 80000 ;
   m_DeformableNumberOfControlPoints = 8 ;
+  m_DeformableUseCachedBSplineWeights = false ;
+  m_DeformableMaximumWeightCacheSize = 512UL * 1024UL * 1024UL ;
   m_DeformableRegTransform = DeformableTransformType::New();
   m_DeformableRegValid = false;
   m_DeformableMetricValue = 0;
@@ -675,6 +826,9 @@ ImageRegistrationApp< TImage >
   registrator->SetFixedImageRegion( m_FixedImageRegion ) ;
   registrator->SetOptimizerScales( m_RigidScales );
   registrator->SetOptimizerNumberOfIterations(m_RigidNumberOfIterations);
+  registrator->SetUseBatchedOnePlusOne(m_RigidUseBatchedOnePlusOne);
+  registrator->SetOptimizerPopulationSize(m_RigidPopulationSize);
+  registrator->SetOptimizerSeed(m_RigidOptimizerSeed);
   switch(m_OptimizerMethod)
     {
     case ONEPLUSONE:
@@ -742,6 +896,177 @@ ImageRegistrationApp< TImage >
   }
 
 
+template< class TImage >
+ITK_THREAD_RETURN_TYPE
+ImageRegistrationApp< TImage >
+::MultiStartThreaderCallback( void * arg )
+  {
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  MultiStartType * multiStart =
+    static_cast< MultiStartType * >( info->UserData );
+
+  // An exception must not leave the thread: the branch is recorded as
+  // failed and left out of the selection.
+  for(unsigned int b = info->ThreadID; b < multiStart->Branches.size();
+      b += info->NumberOfThreads)
+    {
+    try
+      {
+      multiStart->Branches[b]->StartRegistration();
+      }
+    catch(ExceptionObject &e)
+      {
+      std::cerr << "Multi-start branch " << b << " failed: " << e
+                << std::endl;
+      multiStart->Race->Fail( b );
+      }
+    catch(...)
+      {
+      std::cerr << "Multi-start branch " << b << " failed" << std::endl;
+      multiStart->Race->Fail( b );
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+  }
+
+template< class TImage >
+void
+ImageRegistrationApp< TImage >
+::RegisterUsingMultiStart()
+  {
+  static const char * methodNames[] = { "None", "Centers", "Mass", "Moments",
+                                        "Landmarks", "Loaded" };
+  const PriorRegistrationMethodType methods[] = { NONE, CENTER, MASS, MOMENT,
+                                                  LANDMARK, LOADED };
+
+  // Landmarks and loaded transforms must have been set beforehand; the
+  // image based initializers are cheap and always recomputed.
+  const bool loadedRegValid = m_LoadedRegValid;
+  const bool landmarkRegValid = m_LandmarkRegValid;
+  this->RegisterUsingNone();
+  this->RegisterUsingCenters();
+  this->RegisterUsingMass();
+  this->RegisterUsingMoments();
+  const bool valid[] = { true, true, true, true,
+                         landmarkRegValid, loadedRegValid };
+
+  std::vector< typename RigidRegistratorType::Pointer > branches;
+  std::vector< unsigned int > branchMethods;
+  for(unsigned int m=0; m<6; m++)
+    {
+    if(!valid[m])
+      {
+      continue;
+      }
+
+    // Each branch gets its own image objects over the shared pixels, so
+    // that the concurrent metric and interpolator updates do not race on
+    // the requested and buffered regions of one image.
+    ImagePointer fixedImage = TImage::New();
+    fixedImage->Graft( m_FixedImage );
+    ImagePointer movingImage = TImage::New();
+    movingImage->Graft( m_MovingImage );
+
+    typename RigidRegistratorType::Pointer registrator = 
+                                           RigidRegistratorType::New();
+    registrator->SetMovingImage( movingImage ) ;
+    registrator->SetFixedImage( fixedImage ) ;
+    registrator->SetFixedImageRegion( m_FixedImageRegion ) ;
+    registrator->SetOptimizerScales( m_RigidScales );
+    registrator->SetOptimizerNumberOfIterations(
+                                       m_MultiStartNumberOfIterations );
+    registrator->SetOptimizerSeed( m_RigidOptimizerSeed );
+    registrator->SetUseSeededSpatialSamples( true );
+    if(m_OptimizerMethod == GRADIENT)
+      {
+      registrator->SetOptimizerToGradient();
+      }
+    else
+      {
+      registrator->SetOptimizerToOnePlusOne();
+      }
+
+    RigidParametersType params = m_RigidRegTransform->GetParameters();
+    itk::Point<double, 3> center;
+    m_PriorRegistrationMethod = methods[m];
+    this->InitRigidParameters(params, center);
+    registrator->GetTypedTransform()->SetCenter(center);
+    registrator->SetInitialTransformParameters(params);
+
+    branches.push_back( registrator );
+    branchMethods.push_back( m );
+    }
+
+  ImageRegistrationAppRace race( branches.size(),
+                                 m_MultiStartMinimumIterations,
+                                 m_MultiStartCancelMargin );
+  for(unsigned int b=0; b<branches.size(); b++)
+    {
+    ImageRegistrationAppRaceObserver::Pointer observer =
+      ImageRegistrationAppRaceObserver::New();
+    observer->SetBranch( &race, b );
+    branches[b]->SetObserver( observer );
+    }
+
+  MultiStartType multiStart;
+  multiStart.Branches = branches;
+  multiStart.Race = &race;
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( branches.size() );
+  threader->SetSingleMethod( Self::MultiStartThreaderCallback, &multiStart );
+  threader->SingleMethodExecute();
+
+  // Every branch scores on the same seeded samples, so the final values
+  // can be compared directly.
+  int best = -1;
+  double bestValue = 0;
+  for(unsigned int b=0; b<branches.size(); b++)
+    {
+    if(race.IsFailed(b))
+      {
+      std::cout << "Multi-start " << methodNames[branchMethods[b]]
+                << ": failed" << std::endl;
+      continue;
+      }
+    const double value = branches[b]->GetTypedMetric()->GetValue(
+                           branches[b]->GetTypedTransform()->GetParameters());
+    std::cout << "Multi-start " << methodNames[branchMethods[b]] << ": "
+              << value
+              << (race.IsCancelled(b) ? " (cancelled)" : "") << std::endl;
+    if(!race.IsCancelled(b) && (best < 0 || value < bestValue))
+      {
+      best = b;
+      bestValue = value;
+      }
+    }
+
+  if(best < 0)
+    {
+    std::cerr << "Multi-start: every branch failed" << std::endl;
+    return;
+    }
+
+  std::cout << "Multi-start selected " << methodNames[branchMethods[best]]
+            << std::endl;
+
+  typename RigidRegTransformType::Pointer transform = 
+                                    branches[best]->GetTypedTransform();
+  m_RigidRegValid = true;
+  m_RigidRegTransform->SetParameters( transform->GetParameters() );
+  m_RigidRegTransform->SetFixedParameters( transform->GetFixedParameters() );
+  m_RigidMetricValue = bestValue;
+  m_RigidAffineTransform->SetIdentity();
+  m_RigidAffineTransform->SetCenter(m_RigidRegTransform->GetCenter());
+  m_RigidAffineTransform->SetMatrix( m_RigidRegTransform->GetMatrix());
+  m_RigidAffineTransform->SetOffset(m_RigidRegTransform->GetOffset());
+  m_FinalTransform = m_RigidAffineTransform;
+  m_PriorRegistrationMethod = RIGID;
+  }
+
+
 template< class TImage >
 void
 ImageRegistrationApp< TImage >
@@ -841,6 +1166,10 @@ ImageRegistrationApp< TImage >
   registrator->SetFixedImageRegion( m_FixedImageRegion );
   registrator->SetOptimizerNumberOfIterations( m_DeformableNumberOfIterations );
   registrator->SetNumberOfControlPoints( m_DeformableNumberOfControlPoints );
+  registrator->SetUseCachedBSplineWeights( 
+                                   m_DeformableUseCachedBSplineWeights );
+  registrator->SetMaximumWeightCacheSize( 
+                                   m_DeformableMaximumWeightCacheSize );
 
 #if ITK_VERSION_MAJOR < 4
   registrator->GetTypedTransform()->SetBulkTransform( m_FinalTransform );
@@ -878,7 +1207,7 @@ ImageRegistrationApp< TImage >
 #if ITK_VERSION_MAJOR < 4
   m_DeformableRegTransform->SetBulkTransform( m_FinalTransform );
 #endif
-  m_DeformableMetricValue = registrator->GetTypedMetric()->GetValue(
+  m_DeformableMetricValue = registrator->GetMetric()->GetValue(
                                     m_DeformableRegTransform->GetParameters());
                                       
   m_FinalParameters = registrator->GetLastTransformParameters();
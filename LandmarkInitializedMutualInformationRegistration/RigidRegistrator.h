@@ -26,6 +26,7 @@
 #include "itkMattesMutualInformationImageToImageMetric.h"
 
 #include "itkOnePlusOneEvolutionaryOptimizer.h"
+#include "itkBatchedOnePlusOneEvolutionaryOptimizer.h"
 #include "itkNormalVariateGenerator.h"
 #include "itkFRPROptimizer.h"
 
@@ -33,6 +34,13 @@
 #include "itkStatisticsImageFilter.h"
 #include "itkRegionOfInterestImageFilter.h"
 
+// The Mattes metric scores a given list of fixed image indexes only in
+// the optimized registration framework of ITK 3 and in ITK 4. Elsewhere
+// the batched and seeded modes fall back to the serial, unseeded ones.
+#if ITK_VERSION_MAJOR >= 4 || defined(ITK_USE_OPTIMIZED_REGISTRATION_METHODS)
+#define RIGIDREGISTRATOR_USE_FIXED_IMAGE_INDEXES
+#endif
+
 namespace itk
 {
 
@@ -59,6 +67,8 @@ class RigidRegistrator : public ImageRegistrationMethod < TImage, TImage >
                                                 OptimizerMethodType;
 
     typedef OnePlusOneEvolutionaryOptimizer     OnePlusOneOptimizerType ;
+    typedef BatchedOnePlusOneEvolutionaryOptimizer
+                                                BatchedOnePlusOneOptimizerType ;
     typedef FRPROptimizer                     GradientOptimizerType ;
     typedef Statistics::NormalVariateGenerator  OptimizerNormalGeneratorType;
     typedef TransformType::ParametersType       ParametersType ;
@@ -96,6 +106,27 @@ class RigidRegistrator : public ImageRegistrationMethod < TImage, TImage >
     itkSetMacro(MetricNumberOfSpatialSamples, unsigned int) ;
     itkGetConstMacro(MetricNumberOfSpatialSamples, unsigned int) ;
 
+    /** Score OptimizerPopulationSize one plus one candidates per
+     *  generation on OptimizerNumberOfThreads single threaded copies of
+     *  the metric, which share the fixed image mask and one set of spatial
+     *  samples drawn with OptimizerSeed. */
+    itkSetMacro(UseBatchedOnePlusOne, bool) ;
+    itkGetConstMacro(UseBatchedOnePlusOne, bool) ;
+    itkBooleanMacro(UseBatchedOnePlusOne) ;
+    itkSetMacro(OptimizerPopulationSize, unsigned int) ;
+    itkGetConstMacro(OptimizerPopulationSize, unsigned int) ;
+    itkSetMacro(OptimizerNumberOfThreads, unsigned int) ;
+    itkGetConstMacro(OptimizerNumberOfThreads, unsigned int) ;
+    itkSetMacro(OptimizerSeed, int) ;
+    itkGetConstMacro(OptimizerSeed, int) ;
+
+    /** Draw the spatial samples of the metric with OptimizerSeed, so that
+     *  registrators with the same seed and region score on the same
+     *  samples and their metric values can be compared. */
+    itkSetMacro(UseSeededSpatialSamples, bool) ;
+    itkGetConstMacro(UseSeededSpatialSamples, bool) ;
+    itkBooleanMacro(UseSeededSpatialSamples) ;
+
     itkSetObjectMacro(Observer, Command);
 
   protected:
@@ -104,6 +135,21 @@ class RigidRegistrator : public ImageRegistrationMethod < TImage, TImage >
 
     virtual void Initialize() throw(ExceptionObject);
 
+    /** Batched one plus one optimizer configured like the serial one */
+    OptimizerPointer CreateBatchedOnePlusOneOptimizer() ;
+
+#ifdef RIGIDREGISTRATOR_USE_FIXED_IMAGE_INDEXES
+    typedef typename MetricType::FixedImageIndexContainer
+                                                SpatialSamplesType ;
+
+    /** Spatial samples drawn with OptimizerSeed inside the fixed image
+     *  region and mask */
+    SpatialSamplesType GetSeededSpatialSamples() ;
+
+    /** Spatial samples and metric copies for the batched optimizer */
+    void InitializeBatchedMetrics() ;
+#endif
+
     void PrintUncaughtError() ;
 
     void PrintError(ExceptionObject &e) ;
@@ -124,6 +170,15 @@ class RigidRegistrator : public ImageRegistrationMethod < TImage, TImage >
 
     OptimizerPointer        m_SecondaryOptimizer;
 
+    bool                    m_UseBatchedOnePlusOne;
+    unsigned int            m_OptimizerPopulationSize;
+    unsigned int            m_OptimizerNumberOfThreads;
+    int                     m_OptimizerSeed;
+    bool                    m_UseSeededSpatialSamples;
+
+    typename BatchedOnePlusOneOptimizerType::Pointer m_BatchedOptimizer;
+    unsigned int            m_MetricNumberOfThreads;
+
 
 
   } ; // end of class
@@ -21,6 +21,9 @@
 
 #include "RigidRegistrator.h"
 
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkMultiThreader.h"
+
 template< class TImage >
 RigidRegistrator< TImage >
 ::RigidRegistrator()
@@ -48,6 +51,15 @@ RigidRegistrator< TImage >
 
   m_SecondaryOptimizer = 0;
 
+  m_UseBatchedOnePlusOne = false;
+  m_OptimizerPopulationSize = 0;
+  m_OptimizerNumberOfThreads = 
+                    MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_OptimizerSeed = 121212;
+  m_UseSeededSpatialSamples = false;
+  m_BatchedOptimizer = 0;
+  m_MetricNumberOfThreads = 0;
+
   m_Observer = 0;
   }
 
@@ -81,6 +93,134 @@ RigidRegistrator< TImage >
   m_OptimizerMethod = ONEPLUSONEPLUSGRADIENT;
   }
 
+template< class TImage >
+typename RigidRegistrator< TImage >::OptimizerPointer
+RigidRegistrator< TImage >
+::CreateBatchedOnePlusOneOptimizer()
+  {
+  m_BatchedOptimizer = BatchedOnePlusOneOptimizerType::New();
+  m_BatchedOptimizer->SetMaximumIteration( m_OptimizerNumberOfIterations);
+  m_BatchedOptimizer->SetEpsilon(1e-10);
+  m_BatchedOptimizer->Initialize(1.01); // Initial search radius
+  m_BatchedOptimizer->SetScales( m_OptimizerScales );
+  m_BatchedOptimizer->SetSeed( m_OptimizerSeed );
+  if(m_OptimizerPopulationSize > 0)
+    {
+    m_BatchedOptimizer->SetPopulationSize( m_OptimizerPopulationSize );
+    }
+  else
+    {
+    m_BatchedOptimizer->SetPopulationSize( m_OptimizerNumberOfThreads );
+    }
+  return m_BatchedOptimizer.GetPointer();
+  }
+
+#ifdef RIGIDREGISTRATOR_USE_FIXED_IMAGE_INDEXES
+template< class TImage >
+typename RigidRegistrator< TImage >::SpatialSamplesType
+RigidRegistrator< TImage >
+::GetSeededSpatialSamples()
+  {
+  typedef Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+  typename GeneratorType::Pointer generator = GeneratorType::New();
+  generator->SetSeed( m_OptimizerSeed );
+
+  const RegionType region = this->GetFixedImageRegion();
+  const typename MetricType::FixedImageMaskType * mask = 
+                               this->GetTypedMetric()->GetFixedImageMask();
+
+  // Give up on a mask that leaves (almost) nothing of the region, as the
+  // metric does when it draws its own samples
+  const unsigned long maximumNumberOfDraws = 
+                     100 * static_cast<unsigned long>(
+                                         m_MetricNumberOfSpatialSamples );
+  unsigned long numberOfDraws = 0;
+
+  SpatialSamplesType samples( m_MetricNumberOfSpatialSamples );
+  for(unsigned int i=0; i<m_MetricNumberOfSpatialSamples; i++)
+    {
+    do
+      {
+      if(numberOfDraws++ >= maximumNumberOfDraws)
+        {
+        itkExceptionMacro(<< "Too few spatial samples inside the fixed "
+                          << "image mask");
+        }
+      for(unsigned int d=0; d<TImage::ImageDimension; d++)
+        {
+        samples[i][d] = region.GetIndex()[d] + 
+                        generator->GetIntegerVariate( region.GetSize()[d] - 1 );
+        }
+      if(!mask)
+        {
+        break;
+        }
+      typename TImage::PointType point;
+      this->GetFixedImage()->TransformIndexToPhysicalPoint( samples[i], 
+                                                            point );
+      if(mask->IsInside(point))
+        {
+        break;
+        }
+      }
+    while(true);
+    }
+  return samples;
+  }
+
+template< class TImage >
+void
+RigidRegistrator< TImage >
+::InitializeBatchedMetrics()
+  {
+  // One seeded sample set shared by every copy of the metric, so that all
+  // threads score candidates on the same cost function.
+  const RegionType region = this->GetFixedImageRegion();
+  const SpatialSamplesType samples = this->GetSeededSpatialSamples();
+  this->GetTypedMetric()->SetFixedImageIndexes( samples );
+
+  // The optimizer runs one metric per thread, so the metrics themselves
+  // must not start threads of their own. The primary one gets its thread
+  // count back in StartRegistration for the secondary optimizer.
+  m_MetricNumberOfThreads = this->GetTypedMetric()->GetNumberOfThreads();
+  this->GetTypedMetric()->SetNumberOfThreads( 1 );
+
+  typename BatchedOnePlusOneOptimizerType::CostFunctionListType metrics;
+  metrics.push_back( this->GetTypedMetric() );
+
+  for(unsigned int t=1; t<m_OptimizerNumberOfThreads; t++)
+    {
+    typename TransformType::Pointer transform = TransformType::New();
+    transform->SetFixedParameters( 
+                     this->GetTypedTransform()->GetFixedParameters() );
+    transform->SetParameters( this->GetInitialTransformParameters() );
+
+    typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
+    interpolator->SetInputImage( this->GetMovingImage() );
+
+    typename MetricType::Pointer metric = MetricType::New();
+    metric->SetFixedImage( this->GetFixedImage() );
+    metric->SetMovingImage( this->GetMovingImage() );
+    metric->SetFixedImageRegion( region );
+    metric->SetFixedImageMask( this->GetTypedMetric()->GetFixedImageMask() );
+    metric->SetMovingImageMask( 
+                     this->GetTypedMetric()->GetMovingImageMask() );
+    metric->SetNumberOfThreads( 1 );
+    metric->SetTransform( transform );
+    metric->SetInterpolator( interpolator );
+    metric->SetNumberOfHistogramBins( 
+                     this->GetTypedMetric()->GetNumberOfHistogramBins() );
+    metric->SetFixedImageIndexes( samples );
+    metric->Initialize();
+
+    metrics.push_back( metric.GetPointer() );
+    }
+
+  m_BatchedOptimizer->SetCostFunctions( metrics );
+  }
+#endif
+
 template< class TImage >
 void
 RigidRegistrator< TImage >
@@ -91,10 +231,36 @@ RigidRegistrator< TImage >
   this->GetTypedMetric()->SetNumberOfSpatialSamples( 
                           m_MetricNumberOfSpatialSamples );
 
+  m_BatchedOptimizer = 0;
+
+  bool useBatchedOnePlusOne = m_UseBatchedOnePlusOne;
+  bool useSeededSpatialSamples = m_UseSeededSpatialSamples;
+#ifndef RIGIDREGISTRATOR_USE_FIXED_IMAGE_INDEXES
+  if(useBatchedOnePlusOne || useSeededSpatialSamples)
+    {
+    itkWarningMacro(<< "The metric cannot score seeded spatial samples "
+                    << "in this ITK build: using the serial one plus one "
+                    << "optimizer on unseeded samples");
+    useBatchedOnePlusOne = false;
+    useSeededSpatialSamples = false;
+    }
+#endif
+
   switch(m_OptimizerMethod)
     {
     case ONEPLUSONE:
       {
+      if(useBatchedOnePlusOne)
+        {
+        OptimizerPointer opt = this->CreateBatchedOnePlusOneOptimizer();
+        this->SetOptimizer(opt);
+        this->SetSecondaryOptimizer(0);
+        if(m_Observer)
+          {
+          opt->AddObserver(itk::IterationEvent(), m_Observer);
+          }
+        break;
+        }
       OnePlusOneOptimizerType::Pointer opt = OnePlusOneOptimizerType::New();
       opt->SetNormalVariateGenerator( OptimizerNormalGeneratorType::New() );
       opt->SetMaximumIteration( m_OptimizerNumberOfIterations);
@@ -127,12 +293,23 @@ RigidRegistrator< TImage >
       }
     case ONEPLUSONEPLUSGRADIENT:
       {
-      OnePlusOneOptimizerType::Pointer initOpt = OnePlusOneOptimizerType::New();
-      initOpt->SetNormalVariateGenerator( OptimizerNormalGeneratorType::New() );
-      initOpt->SetMaximumIteration( m_OptimizerNumberOfIterations);
-      initOpt->SetEpsilon(1e-10);
-      initOpt->Initialize(1.01); // Initial search radius
-      initOpt->SetScales( m_OptimizerScales );
+      OptimizerPointer initOpt;
+      if(useBatchedOnePlusOne)
+        {
+        initOpt = this->CreateBatchedOnePlusOneOptimizer();
+        }
+      else
+        {
+        OnePlusOneOptimizerType::Pointer onePlusOne = 
+                                         OnePlusOneOptimizerType::New();
+        onePlusOne->SetNormalVariateGenerator( 
+                                     OptimizerNormalGeneratorType::New() );
+        onePlusOne->SetMaximumIteration( m_OptimizerNumberOfIterations);
+        onePlusOne->SetEpsilon(1e-10);
+        onePlusOne->Initialize(1.01); // Initial search radius
+        onePlusOne->SetScales( m_OptimizerScales );
+        initOpt = onePlusOne.GetPointer();
+        }
 
       GradientOptimizerType::Pointer opt = GradientOptimizerType::New();
       opt->SetMaximize(false);
@@ -153,6 +330,18 @@ RigidRegistrator< TImage >
       }
     }
 
+#ifdef RIGIDREGISTRATOR_USE_FIXED_IMAGE_INDEXES
+  if(m_BatchedOptimizer)
+    {
+    this->InitializeBatchedMetrics();
+    }
+  else if(useSeededSpatialSamples)
+    {
+    this->GetTypedMetric()->SetFixedImageIndexes( 
+                                       this->GetSeededSpatialSamples() );
+    }
+#endif
+
   try
     {
     Superclass::Initialize();
@@ -181,6 +370,25 @@ RigidRegistrator< TImage >
     this->PrintUncaughtError() ;
     }
 
+#ifdef RIGIDREGISTRATOR_USE_FIXED_IMAGE_INDEXES
+  if(m_BatchedOptimizer)
+    {
+    this->GetTypedMetric()->SetNumberOfThreads( m_MetricNumberOfThreads );
+    if(m_SecondaryOptimizer)
+      {
+      try
+        {
+        this->GetTypedMetric()->Initialize();
+        }
+      catch(ExceptionObject &e)
+        {
+        this->PrintError(e) ;
+        return;
+        }
+      }
+    }
+#endif
+
   if(m_SecondaryOptimizer)
     {
     m_SecondaryOptimizer->SetCostFunction(this->GetMetric());
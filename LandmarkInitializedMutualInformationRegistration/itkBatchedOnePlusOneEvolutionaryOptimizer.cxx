@@ -0,0 +1,260 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkBatchedOnePlusOneEvolutionaryOptimizer.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "itkBatchedOnePlusOneEvolutionaryOptimizer.h"
+
+#include "vnl/vnl_matrix.h"
+#include "vnl/vnl_vector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+BatchedOnePlusOneEvolutionaryOptimizer
+::BatchedOnePlusOneEvolutionaryOptimizer()
+{
+  m_PopulationSize = 4;
+  m_Seed = 121212;
+  m_Maximize = false;
+  m_MaximumIteration = 100;
+  m_GrowthFactor = 1.05;
+  m_ShrinkFactor = vcl_pow( m_GrowthFactor, -0.25 );
+  m_InitialRadius = 1.01;
+  m_Epsilon = 1.5e-4;
+
+  m_CurrentIteration = 0;
+  m_FrobeniusNorm = 0.0;
+  m_CurrentCost = 0;
+  m_Stop = false;
+  m_NumberOfEvaluationThreads = 1;
+
+  m_Generator = RandomGeneratorType::New();
+  m_Threader = MultiThreader::New();
+}
+
+
+void
+BatchedOnePlusOneEvolutionaryOptimizer
+::Initialize( double initialRadius, double grow, double shrink )
+{
+  m_InitialRadius = initialRadius;
+
+  if ( grow == -1 )
+    {
+    m_GrowthFactor = 1.05;
+    }
+  else
+    {
+    m_GrowthFactor = grow;
+    }
+
+  if ( shrink == -1 )
+    {
+    m_ShrinkFactor = vcl_pow( m_GrowthFactor, -0.25 );
+    }
+  else
+    {
+    m_ShrinkFactor = shrink;
+    }
+}
+
+
+ITK_THREAD_RETURN_TYPE
+BatchedOnePlusOneEvolutionaryOptimizer
+::EvaluateThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+
+  const unsigned int threadId = info->ThreadID;
+  const unsigned int numberOfThreads = info->NumberOfThreads;
+  const CostFunctionType * costFunction =
+    self->m_CostFunctions[threadId].GetPointer();
+
+  for ( unsigned int c = threadId; c < self->m_Candidates.size();
+        c += numberOfThreads )
+    {
+    self->m_CandidateValues[c] =
+      costFunction->GetValue( self->m_Candidates[c] );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+void
+BatchedOnePlusOneEvolutionaryOptimizer
+::EvaluateCandidates()
+{
+  if ( m_NumberOfEvaluationThreads > 1 )
+    {
+    m_Threader->SetNumberOfThreads( m_NumberOfEvaluationThreads );
+    m_Threader->SetSingleMethod( Self::EvaluateThreaderCallback, this );
+    m_Threader->SingleMethodExecute();
+    }
+  else
+    {
+    const CostFunctionType * costFunction = m_CostFunctions.empty()
+      ? this->GetCostFunction() : m_CostFunctions[0].GetPointer();
+    for ( unsigned int c = 0; c < m_Candidates.size(); c++ )
+      {
+      m_CandidateValues[c] = costFunction->GetValue( m_Candidates[c] );
+      }
+    }
+}
+
+
+void
+BatchedOnePlusOneEvolutionaryOptimizer
+::StartOptimization()
+{
+  if ( this->GetCostFunction() == 0 && m_CostFunctions.empty() )
+    {
+    itkExceptionMacro( << "No cost function set" );
+    }
+
+  const CostFunctionType * costFunction = m_CostFunctions.empty()
+    ? this->GetCostFunction() : m_CostFunctions[0].GetPointer();
+  const unsigned int spaceDimension = costFunction->GetNumberOfParameters();
+
+  m_NumberOfEvaluationThreads = std::min(
+    static_cast<unsigned int>( m_CostFunctions.size() ), m_PopulationSize );
+  if ( m_NumberOfEvaluationThreads < 1 )
+    {
+    m_NumberOfEvaluationThreads = 1;
+    }
+
+  m_Generator->SetSeed( m_Seed );
+  m_Stop = false;
+
+  // Search matrix, as in OnePlusOneEvolutionaryOptimizer.
+  vnl_matrix<double> A( spaceDimension, spaceDimension );
+  A.set_identity();
+  const ScalesType & scales = this->GetScales();
+  for ( unsigned int i = 0; i < spaceDimension; i++ )
+    {
+    A( i, i ) = m_InitialRadius / scales[i];
+    }
+
+  ParametersType parent( this->GetInitialPosition() );
+  m_CurrentCost = costFunction->GetValue( parent );
+  this->SetCurrentPosition( parent );
+
+  std::vector< vnl_vector<double> > normals( m_PopulationSize,
+                                             vnl_vector<double>( spaceDimension ) );
+  m_Candidates.assign( m_PopulationSize, parent );
+  m_CandidateValues.assign( m_PopulationSize, 0 );
+
+  this->InvokeEvent( StartEvent() );
+
+  for ( m_CurrentIteration = 0; m_CurrentIteration < m_MaximumIteration;
+        m_CurrentIteration++ )
+    {
+    if ( m_Stop )
+      {
+      break;
+      }
+
+    // All perturbations are drawn before any scoring, in candidate order,
+    // so the sequence does not depend on the threads.
+    for ( unsigned int c = 0; c < m_PopulationSize; c++ )
+      {
+      for ( unsigned int i = 0; i < spaceDimension; i++ )
+        {
+        normals[c][i] = m_Generator->GetNormalVariate();
+        }
+      const vnl_vector<double> delta = A * normals[c];
+      for ( unsigned int i = 0; i < spaceDimension; i++ )
+        {
+        m_Candidates[c][i] = parent[i] + delta[i];
+        }
+      }
+
+    this->EvaluateCandidates();
+
+    unsigned int best = 0;
+    for ( unsigned int c = 1; c < m_PopulationSize; c++ )
+      {
+      const bool better = m_Maximize
+        ? m_CandidateValues[c] > m_CandidateValues[best]
+        : m_CandidateValues[c] < m_CandidateValues[best];
+      if ( better )
+        {
+        best = c;
+        }
+      }
+
+    double adjust = m_ShrinkFactor;
+    const bool improved = m_Maximize
+      ? m_CandidateValues[best] > m_CurrentCost
+      : m_CandidateValues[best] < m_CurrentCost;
+    if ( improved )
+      {
+      parent = m_Candidates[best];
+      m_CurrentCost = m_CandidateValues[best];
+      adjust = m_GrowthFactor;
+      this->SetCurrentPosition( parent );
+      }
+
+    m_FrobeniusNorm = A.fro_norm();
+    if ( m_FrobeniusNorm <= m_Epsilon )
+      {
+      break;
+      }
+
+    // Grow or shrink the search matrix along the best perturbation.
+    const vnl_vector<double> & f = normals[best];
+    const double alpha = ( adjust - 1.0 ) / dot_product( f, f );
+    const vnl_vector<double> Af = A * f;
+    for ( unsigned int c = 0; c < spaceDimension; c++ )
+      {
+      for ( unsigned int r = 0; r < spaceDimension; r++ )
+        {
+        A( r, c ) += alpha * Af[r] * f[c];
+        }
+      }
+
+    this->InvokeEvent( IterationEvent() );
+    }
+
+  this->InvokeEvent( EndEvent() );
+}
+
+
+void
+BatchedOnePlusOneEvolutionaryOptimizer
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "PopulationSize: " << m_PopulationSize << std::endl;
+  os << indent << "NumberOfCostFunctions: " << m_CostFunctions.size() << std::endl;
+  os << indent << "Seed: " << m_Seed << std::endl;
+  os << indent << "Maximize: " << m_Maximize << std::endl;
+  os << indent << "MaximumIteration: " << m_MaximumIteration << std::endl;
+  os << indent << "GrowthFactor: " << m_GrowthFactor << std::endl;
+  os << indent << "ShrinkFactor: " << m_ShrinkFactor << std::endl;
+  os << indent << "InitialRadius: " << m_InitialRadius << std::endl;
+  os << indent << "Epsilon: " << m_Epsilon << std::endl;
+  os << indent << "CurrentIteration: " << m_CurrentIteration << std::endl;
+  os << indent << "FrobeniusNorm: " << m_FrobeniusNorm << std::endl;
+}
+
+} // end namespace itk
@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkBatchedOnePlusOneEvolutionaryOptimizer.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __itkBatchedOnePlusOneEvolutionaryOptimizer_h
+#define __itkBatchedOnePlusOneEvolutionaryOptimizer_h
+
+#include <vector>
+
+#include "itkSingleValuedNonLinearOptimizer.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkMultiThreader.h"
+
+namespace itk
+{
+
+/** \class BatchedOnePlusOneEvolutionaryOptimizer
+ *
+ * (1+k) variant of OnePlusOneEvolutionaryOptimizer. Each generation draws
+ * PopulationSize normal perturbations of the parent through the same
+ * adaptive search matrix, scores all of them concurrently and keeps the
+ * best child if it improves on the parent. The search matrix is then
+ * grown or shrunk along the best child's perturbation exactly as the
+ * (1+1) strategy does for its single child; a population of one is the
+ * (1+1) strategy.
+ *
+ * Cost functions are generally not thread safe, so one cost function per
+ * thread is given with SetCostFunctions(); they must all compute the same
+ * value (e.g. copies of a metric sharing the same samples). Thread t
+ * scores candidates t, t + T, t + 2T... Perturbations come from a seeded
+ * generator owned by the optimizer and ties are broken by candidate
+ * order, so results do not depend on the number of threads.
+ *
+ * If no list is given, the cost function set with SetCostFunction() scores
+ * the candidates one after the other.
+ *
+ * \ingroup Numerics Optimizers
+ */
+class BatchedOnePlusOneEvolutionaryOptimizer :
+    public SingleValuedNonLinearOptimizer
+{
+public:
+  /** Standard "Self" typedef. */
+  typedef BatchedOnePlusOneEvolutionaryOptimizer Self;
+  typedef SingleValuedNonLinearOptimizer         Superclass;
+  typedef SmartPointer<Self>                     Pointer;
+  typedef SmartPointer<const Self>               ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(BatchedOnePlusOneEvolutionaryOptimizer,
+               SingleValuedNonLinearOptimizer);
+
+  typedef Superclass::CostFunctionType         CostFunctionType;
+  typedef CostFunctionType::Pointer            CostFunctionPointer;
+  typedef std::vector<CostFunctionPointer>     CostFunctionListType;
+  typedef Statistics::MersenneTwisterRandomVariateGenerator
+                                               RandomGeneratorType;
+
+  /** One cost function per thread. */
+  void SetCostFunctions( const CostFunctionListType & costFunctions )
+    {
+    m_CostFunctions = costFunctions;
+    this->Modified();
+    }
+
+  /** Set/Get the number of candidates scored per generation. */
+  itkSetClampMacro( PopulationSize, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( PopulationSize, unsigned int );
+
+  /** Set/Get the seed of the perturbation generator. */
+  itkSetMacro( Seed, int );
+  itkGetConstMacro( Seed, int );
+
+  itkSetMacro( Maximize, bool );
+  itkBooleanMacro( Maximize );
+  itkGetConstMacro( Maximize, bool );
+
+  itkSetMacro( MaximumIteration, unsigned int );
+  itkGetConstMacro( MaximumIteration, unsigned int );
+
+  itkSetMacro( GrowthFactor, double );
+  itkGetConstMacro( GrowthFactor, double );
+
+  itkSetMacro( ShrinkFactor, double );
+  itkGetConstMacro( ShrinkFactor, double );
+
+  itkSetMacro( InitialRadius, double );
+  itkGetConstMacro( InitialRadius, double );
+
+  itkSetMacro( Epsilon, double );
+  itkGetConstMacro( Epsilon, double );
+
+  /** Same meaning as OnePlusOneEvolutionaryOptimizer::Initialize. */
+  void Initialize( double initialRadius, double grow = -1, double shrink = -1 );
+
+  itkGetConstMacro( CurrentIteration, unsigned int );
+  itkGetConstMacro( FrobeniusNorm, double );
+
+  /** Value at the current position. */
+  MeasureType GetValue() const
+    {
+    return m_CurrentCost;
+    }
+
+  void StartOptimization();
+
+  void StopOptimization()
+    {
+    m_Stop = true;
+    }
+
+protected:
+  BatchedOnePlusOneEvolutionaryOptimizer();
+  virtual ~BatchedOnePlusOneEvolutionaryOptimizer() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+private:
+  BatchedOnePlusOneEvolutionaryOptimizer( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  /** Score m_Candidates into m_CandidateValues. */
+  void EvaluateCandidates();
+  static ITK_THREAD_RETURN_TYPE EvaluateThreaderCallback( void * arg );
+
+  CostFunctionListType        m_CostFunctions;
+  unsigned int                m_PopulationSize;
+  int                         m_Seed;
+  bool                        m_Maximize;
+  unsigned int                m_MaximumIteration;
+  double                      m_GrowthFactor;
+  double                      m_ShrinkFactor;
+  double                      m_InitialRadius;
+  double                      m_Epsilon;
+
+  unsigned int                m_CurrentIteration;
+  double                      m_FrobeniusNorm;
+  MeasureType                 m_CurrentCost;
+  bool                        m_Stop;
+
+  std::vector<ParametersType> m_Candidates;
+  std::vector<MeasureType>    m_CandidateValues;
+  unsigned int                m_NumberOfEvaluationThreads;
+
+  RandomGeneratorType::Pointer m_Generator;
+  MultiThreader::Pointer      m_Threader;
+};
+
+} // end namespace itk
+
+#endif
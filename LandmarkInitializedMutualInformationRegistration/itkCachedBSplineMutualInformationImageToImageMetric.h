@@ -0,0 +1,200 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkCachedBSplineMutualInformationImageToImageMetric.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __itkCachedBSplineMutualInformationImageToImageMetric_h
+#define __itkCachedBSplineMutualInformationImageToImageMetric_h
+
+#include <vector>
+
+#include "itkImageToImageMetric.h"
+#include "itkCentralDifferenceImageFunction.h"
+#include "itkMultiThreader.h"
+
+namespace itk
+{
+
+/** \class CachedBSplineMutualInformationImageToImageMetric
+ *
+ * Mattes mutual information (negated, so that it is minimized) between a
+ * fixed image and a moving image mapped through a B-spline transform,
+ * specialized for the case where the fixed image samples and the
+ * transform grid do not change during an optimization.
+ *
+ * Initialize() draws NumberOfSpatialSamples seeded samples in the fixed
+ * image region, inside the fixed image mask if there is one, and, for
+ * each of them, stores once the B-spline weights and
+ * the parameter indices of its support nodes (as float and unsigned int)
+ * together with the bulk mapped point. A metric evaluation then only sums
+ * the weighted coefficients of each sample. The derivative is accumulated
+ * sparsely: each sample only updates the parameters of its support nodes.
+ * Both passes over the samples are threaded, with one joint histogram and
+ * one derivative array per thread.
+ *
+ * If the cache would take more than MaximumCacheSize bytes, the weights
+ * are computed by the transform at every evaluation instead, as the Mattes
+ * metric does. GetCacheSize() reports the memory taken by the cache.
+ *
+ * The Parzen windowing follows MattesMutualInformationImageToImageMetric:
+ * zero order kernel for the fixed image, cubic B-spline kernel for the
+ * moving image. The transform must be a TBSplineTransform, that is a
+ * BSplineDeformableTransform or BSplineTransform.
+ *
+ * \ingroup RegistrationMetrics
+ */
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+class ITK_EXPORT CachedBSplineMutualInformationImageToImageMetric :
+    public ImageToImageMetric< TFixedImage, TMovingImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef CachedBSplineMutualInformationImageToImageMetric  Self;
+  typedef ImageToImageMetric< TFixedImage, TMovingImage >   Superclass;
+  typedef SmartPointer<Self>                                Pointer;
+  typedef SmartPointer<const Self>                          ConstPointer;
+
+  itkNewMacro(Self);
+
+  itkTypeMacro(CachedBSplineMutualInformationImageToImageMetric,
+               ImageToImageMetric);
+
+  typedef typename Superclass::MeasureType              MeasureType;
+  typedef typename Superclass::DerivativeType           DerivativeType;
+  typedef typename Superclass::ParametersType           ParametersType;
+  typedef typename Superclass::FixedImageType           FixedImageType;
+  typedef typename Superclass::MovingImageType          MovingImageType;
+  typedef typename Superclass::FixedImageRegionType     FixedImageRegionType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      FixedImageType::ImageDimension);
+
+  typedef TBSplineTransform                             BSplineTransformType;
+  typedef typename BSplineTransformType::WeightsType    WeightsType;
+  typedef typename BSplineTransformType::ParameterIndexArrayType
+                                                        IndexArrayType;
+  typedef typename BSplineTransformType::InputPointType PointType;
+
+  typedef CentralDifferenceImageFunction< MovingImageType, double >
+                                                        GradientCalculatorType;
+
+  /** Number of bins of the joint histogram. */
+  itkSetClampMacro( NumberOfHistogramBins, unsigned int, 5,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfHistogramBins, unsigned int );
+
+  /** Number of fixed image samples, drawn with Seed. */
+  itkSetMacro( NumberOfSpatialSamples, unsigned int );
+  itkGetConstMacro( NumberOfSpatialSamples, unsigned int );
+  itkSetMacro( Seed, int );
+  itkGetConstMacro( Seed, int );
+
+  /** Largest cache, in bytes, before falling back to computing the
+   *  weights at every evaluation. */
+  itkSetMacro( MaximumCacheSize, unsigned long );
+  itkGetConstMacro( MaximumCacheSize, unsigned long );
+
+  /** Bytes taken by the weight cache, 0 when it is not used. */
+  itkGetConstMacro( CacheSize, unsigned long );
+  itkGetConstMacro( UseCache, bool );
+
+  itkSetClampMacro( NumberOfEvaluationThreads, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfEvaluationThreads, unsigned int );
+
+  virtual void Initialize(void) throw ( ExceptionObject );
+
+  unsigned int GetNumberOfParameters(void) const
+    {
+    return this->m_Transform->GetNumberOfParameters();
+    }
+
+  MeasureType GetValue( const ParametersType & parameters ) const;
+
+  void GetDerivative( const ParametersType & parameters,
+                      DerivativeType & derivative ) const;
+
+  void GetValueAndDerivative( const ParametersType & parameters,
+                              MeasureType & value,
+                              DerivativeType & derivative ) const;
+
+protected:
+  CachedBSplineMutualInformationImageToImageMetric();
+  virtual ~CachedBSplineMutualInformationImageToImageMetric() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+private:
+  CachedBSplineMutualInformationImageToImageMetric( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  /** Value at parameters, and the derivative if derivative is not null. */
+  MeasureType Evaluate( const ParametersType & parameters,
+                        DerivativeType * derivative ) const;
+
+  /** First of the four moving bins a moving value falls in. */
+  int GetMovingBin( double movingTerm ) const;
+
+  static ITK_THREAD_RETURN_TYPE HistogramThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE DerivativeThreaderCallback( void * arg );
+
+  static double CubicKernel( double u );
+  static double CubicKernelDerivative( double u );
+
+  unsigned int                 m_NumberOfHistogramBins;
+  unsigned int                 m_NumberOfSpatialSamples;
+  int                          m_Seed;
+  unsigned long                m_MaximumCacheSize;
+  unsigned long                m_CacheSize;
+  bool                         m_UseCache;
+  unsigned int                 m_NumberOfEvaluationThreads;
+
+  BSplineTransformType *       m_BSplineTransform;
+  unsigned int                 m_NumberOfWeights;
+  unsigned int                 m_NumberOfParametersPerDimension;
+  ParametersType               m_ZeroParameters;
+  ParametersType               m_TransformParameters;
+
+  /** Per sample state, fixed during an optimization. */
+  std::vector<PointType>       m_SamplePoints;
+  std::vector<unsigned int>    m_SampleFixedBins;
+  std::vector<float>           m_SampleBulkPoints;
+  std::vector<float>           m_SampleWeights;
+  std::vector<unsigned int>    m_SampleIndices;
+  std::vector<unsigned char>   m_SampleInside;
+
+  double                       m_FixedBinSize;
+  double                       m_FixedNormalizedMin;
+  double                       m_MovingBinSize;
+  double                       m_MovingNormalizedMin;
+
+  typename GradientCalculatorType::Pointer m_GradientCalculator;
+  MultiThreader::Pointer       m_Threader;
+
+  /** Per evaluation state, shared with the threads. */
+  mutable const ParametersType *            m_Parameters;
+  mutable std::vector<double>               m_SampleMovingTerms;
+  mutable std::vector<PointType>            m_SampleMappedPoints;
+  mutable std::vector< std::vector<double> > m_ThreadJointPDF;
+  mutable std::vector< std::vector<double> > m_ThreadDerivative;
+  mutable std::vector<double>               m_PRatio;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkCachedBSplineMutualInformationImageToImageMetric.txx"
+#endif
+
+#endif
@@ -0,0 +1,643 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkCachedBSplineMutualInformationImageToImageMetric.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __itkCachedBSplineMutualInformationImageToImageMetric_txx
+#define __itkCachedBSplineMutualInformationImageToImageMetric_txx
+
+#include "itkCachedBSplineMutualInformationImageToImageMetric.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::CachedBSplineMutualInformationImageToImageMetric()
+{
+  m_NumberOfHistogramBins = 50;
+  m_NumberOfSpatialSamples = 80000;
+  m_Seed = 121212;
+  m_MaximumCacheSize = 512UL * 1024UL * 1024UL;
+  m_CacheSize = 0;
+  m_UseCache = false;
+  m_NumberOfEvaluationThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  m_BSplineTransform = 0;
+  m_NumberOfWeights = 0;
+  m_NumberOfParametersPerDimension = 0;
+
+  m_FixedBinSize = 1.0;
+  m_FixedNormalizedMin = 0.0;
+  m_MovingBinSize = 1.0;
+  m_MovingNormalizedMin = 0.0;
+
+  m_GradientCalculator = GradientCalculatorType::New();
+  m_Threader = MultiThreader::New();
+  m_Parameters = 0;
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+void
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::Initialize(void) throw ( ExceptionObject )
+{
+  if ( !this->m_Transform )
+    {
+    itkExceptionMacro( << "Transform is not present" );
+    }
+  m_BSplineTransform =
+    dynamic_cast<BSplineTransformType *>( this->m_Transform.GetPointer() );
+  if ( !m_BSplineTransform )
+    {
+    itkExceptionMacro( << "Transform is not a B-spline transform" );
+    }
+  if ( !this->m_Interpolator )
+    {
+    itkExceptionMacro( << "Interpolator is not present" );
+    }
+  if ( !this->m_FixedImage || !this->m_MovingImage )
+    {
+    itkExceptionMacro( << "Fixed or moving image is not present" );
+    }
+
+  this->m_Interpolator->SetInputImage( this->m_MovingImage );
+  m_GradientCalculator->SetInputImage( this->m_MovingImage );
+
+  const unsigned int bins = m_NumberOfHistogramBins;
+  const double padding = 2.0;
+  const FixedImageRegionType region = this->GetFixedImageRegion();
+
+  // Intensity ranges, as in the Mattes metric.
+  double fixedMin = NumericTraits<double>::max();
+  double fixedMax = NumericTraits<double>::NonpositiveMin();
+  ImageRegionConstIterator<FixedImageType> fit( this->m_FixedImage, region );
+  for ( fit.GoToBegin(); !fit.IsAtEnd(); ++fit )
+    {
+    const double value = static_cast<double>( fit.Get() );
+    fixedMin = std::min( fixedMin, value );
+    fixedMax = std::max( fixedMax, value );
+    }
+  double movingMin = NumericTraits<double>::max();
+  double movingMax = NumericTraits<double>::NonpositiveMin();
+  ImageRegionConstIterator<MovingImageType> mit( this->m_MovingImage,
+                              this->m_MovingImage->GetBufferedRegion() );
+  for ( mit.GoToBegin(); !mit.IsAtEnd(); ++mit )
+    {
+    const double value = static_cast<double>( mit.Get() );
+    movingMin = std::min( movingMin, value );
+    movingMax = std::max( movingMax, value );
+    }
+
+  m_FixedBinSize = ( fixedMax - fixedMin ) / ( bins - 2 * padding );
+  if ( m_FixedBinSize <= 0.0 )
+    {
+    m_FixedBinSize = 1.0;
+    }
+  m_FixedNormalizedMin = fixedMin / m_FixedBinSize - padding;
+  m_MovingBinSize = ( movingMax - movingMin ) / ( bins - 2 * padding );
+  if ( m_MovingBinSize <= 0.0 )
+    {
+    m_MovingBinSize = 1.0;
+    }
+  m_MovingNormalizedMin = movingMin / m_MovingBinSize - padding;
+
+  // Seeded samples and their fixed image bins.
+  typedef Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  typename GeneratorType::Pointer generator = GeneratorType::New();
+  generator->SetSeed( m_Seed );
+
+  // Samples outside the mask are drawn again, up to a hundred draws per
+  // sample on average.
+  const unsigned int numberOfSamples = m_NumberOfSpatialSamples;
+  const unsigned long maximumNumberOfDraws =
+    100 * static_cast<unsigned long>( numberOfSamples );
+  unsigned long numberOfDraws = 0;
+  m_SamplePoints.resize( numberOfSamples );
+  m_SampleFixedBins.resize( numberOfSamples );
+  for ( unsigned int s = 0; s < numberOfSamples; s++ )
+    {
+    typename FixedImageType::IndexType index;
+    do
+      {
+      if ( numberOfDraws++ >= maximumNumberOfDraws )
+        {
+        m_SamplePoints.clear();
+        itkExceptionMacro( << "Too few samples inside the fixed image mask" );
+        }
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        index[d] = region.GetIndex()[d] +
+                   generator->GetIntegerVariate( region.GetSize()[d] - 1 );
+        }
+      this->m_FixedImage->TransformIndexToPhysicalPoint( index,
+                                                         m_SamplePoints[s] );
+      }
+    while ( this->m_FixedImageMask &&
+            !this->m_FixedImageMask->IsInside( m_SamplePoints[s] ) );
+
+    const double value =
+      static_cast<double>( this->m_FixedImage->GetPixel( index ) );
+    int bin = static_cast<int>( value / m_FixedBinSize - m_FixedNormalizedMin );
+    bin = std::max( bin, 2 );
+    bin = std::min( bin, static_cast<int>( bins ) - 3 );
+    m_SampleFixedBins[s] = bin;
+    }
+
+  // Weight cache, if it fits in the budget.
+  m_NumberOfWeights = m_BSplineTransform->GetNumberOfWeights();
+  m_NumberOfParametersPerDimension =
+    m_BSplineTransform->GetNumberOfParametersPerDimension();
+
+  const unsigned long bytesPerSample =
+    ImageDimension * sizeof( float ) +
+    m_NumberOfWeights * ( sizeof( float ) + sizeof( unsigned int ) ) +
+    sizeof( unsigned char );
+  const unsigned long cacheSize = bytesPerSample * numberOfSamples;
+
+  m_UseCache = ( cacheSize <= m_MaximumCacheSize );
+  m_CacheSize = m_UseCache ? cacheSize : 0;
+
+  m_SampleBulkPoints.clear();
+  m_SampleWeights.clear();
+  m_SampleIndices.clear();
+  m_SampleInside.clear();
+  if ( m_UseCache )
+    {
+    m_SampleBulkPoints.resize( numberOfSamples * ImageDimension );
+    m_SampleWeights.resize( numberOfSamples * m_NumberOfWeights );
+    m_SampleIndices.resize( numberOfSamples * m_NumberOfWeights );
+    m_SampleInside.resize( numberOfSamples );
+
+    // With all coefficients at zero the transform only applies its bulk
+    // part, which is what is cached. The parameters of the caller are
+    // put back afterwards, from a copy since the transform may only keep
+    // a pointer to the array it was given.
+    m_TransformParameters = m_BSplineTransform->GetParameters();
+    m_ZeroParameters.SetSize( m_BSplineTransform->GetNumberOfParameters() );
+    m_ZeroParameters.Fill( 0.0 );
+    m_BSplineTransform->SetParameters( m_ZeroParameters );
+
+    WeightsType weights( m_NumberOfWeights );
+    IndexArrayType indices( m_NumberOfWeights );
+    for ( unsigned int s = 0; s < numberOfSamples; s++ )
+      {
+      PointType bulk;
+      bool inside;
+      m_BSplineTransform->TransformPoint( m_SamplePoints[s], bulk,
+                                          weights, indices, inside );
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        m_SampleBulkPoints[s * ImageDimension + d] =
+          static_cast<float>( bulk[d] );
+        }
+      for ( unsigned int k = 0; k < m_NumberOfWeights; k++ )
+        {
+        m_SampleWeights[s * m_NumberOfWeights + k] =
+          static_cast<float>( weights[k] );
+        m_SampleIndices[s * m_NumberOfWeights + k] =
+          static_cast<unsigned int>( indices[k] );
+        }
+      m_SampleInside[s] = inside ? 1 : 0;
+      }
+
+    m_BSplineTransform->SetParameters( m_TransformParameters );
+    }
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+double
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::CubicKernel( double u )
+{
+  const double absU = vcl_fabs( u );
+  if ( absU < 1.0 )
+    {
+    return ( 4.0 - 6.0 * absU * absU + 3.0 * absU * absU * absU ) / 6.0;
+    }
+  if ( absU < 2.0 )
+    {
+    const double t = 2.0 - absU;
+    return t * t * t / 6.0;
+    }
+  return 0.0;
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+double
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::CubicKernelDerivative( double u )
+{
+  const double absU = vcl_fabs( u );
+  if ( absU < 1.0 )
+    {
+    return -2.0 * u + 1.5 * u * absU;
+    }
+  if ( absU < 2.0 )
+    {
+    const double t = 2.0 - absU;
+    return ( u < 0.0 ) ? 0.5 * t * t : -0.5 * t * t;
+    }
+  return 0.0;
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+int
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::GetMovingBin( double movingTerm ) const
+{
+  int bin = static_cast<int>( movingTerm );
+  bin = std::max( bin, 2 );
+  bin = std::min( bin, static_cast<int>( m_NumberOfHistogramBins ) - 3 );
+  return bin - 1;
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+ITK_THREAD_RETURN_TYPE
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::HistogramThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const Self * self = static_cast<const Self *>( info->UserData );
+
+  const unsigned int numberOfSamples = self->m_SamplePoints.size();
+  const unsigned int chunk =
+    ( numberOfSamples + info->NumberOfThreads - 1 ) / info->NumberOfThreads;
+  const unsigned int first = info->ThreadID * chunk;
+  const unsigned int last = std::min( numberOfSamples, first + chunk );
+
+  const unsigned int bins = self->m_NumberOfHistogramBins;
+  const unsigned int numberOfWeights = self->m_NumberOfWeights;
+  const unsigned int perDimension = self->m_NumberOfParametersPerDimension;
+  const ParametersType & parameters = *self->m_Parameters;
+  std::vector<double> & jointPDF = self->m_ThreadJointPDF[info->ThreadID];
+
+  WeightsType weights( numberOfWeights );
+  IndexArrayType indices( numberOfWeights );
+
+  for ( unsigned int s = first; s < last; s++ )
+    {
+    PointType mapped;
+    if ( self->m_UseCache )
+      {
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        mapped[d] = self->m_SampleBulkPoints[s * ImageDimension + d];
+        }
+      if ( self->m_SampleInside[s] )
+        {
+        const float * w = &self->m_SampleWeights[s * numberOfWeights];
+        const unsigned int * idx = &self->m_SampleIndices[s * numberOfWeights];
+        for ( unsigned int k = 0; k < numberOfWeights; k++ )
+          {
+          for ( unsigned int d = 0; d < ImageDimension; d++ )
+            {
+            mapped[d] += w[k] * parameters[d * perDimension + idx[k]];
+            }
+          }
+        }
+      }
+    else
+      {
+      bool inside;
+      self->m_BSplineTransform->TransformPoint( self->m_SamplePoints[s],
+                                                mapped, weights, indices,
+                                                inside );
+      }
+    self->m_SampleMappedPoints[s] = mapped;
+
+    if ( !self->m_Interpolator->IsInsideBuffer( mapped ) )
+      {
+      self->m_SampleMovingTerms[s] = -1.0;
+      continue;
+      }
+
+    const double movingValue = self->m_Interpolator->Evaluate( mapped );
+    const double movingTerm = movingValue / self->m_MovingBinSize
+                              - self->m_MovingNormalizedMin;
+    self->m_SampleMovingTerms[s] = movingTerm;
+
+    const int movingBin = self->GetMovingBin( movingTerm );
+    double * row = &jointPDF[self->m_SampleFixedBins[s] * bins];
+    for ( int m = movingBin; m < movingBin + 4; m++ )
+      {
+      row[m] += CubicKernel( m - movingTerm );
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+ITK_THREAD_RETURN_TYPE
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::DerivativeThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const Self * self = static_cast<const Self *>( info->UserData );
+
+  const unsigned int numberOfSamples = self->m_SamplePoints.size();
+  const unsigned int chunk =
+    ( numberOfSamples + info->NumberOfThreads - 1 ) / info->NumberOfThreads;
+  const unsigned int first = info->ThreadID * chunk;
+  const unsigned int last = std::min( numberOfSamples, first + chunk );
+
+  const unsigned int bins = self->m_NumberOfHistogramBins;
+  const unsigned int numberOfWeights = self->m_NumberOfWeights;
+  const unsigned int perDimension = self->m_NumberOfParametersPerDimension;
+  std::vector<double> & derivative = self->m_ThreadDerivative[info->ThreadID];
+
+  WeightsType weights( numberOfWeights );
+  IndexArrayType indices( numberOfWeights );
+
+  for ( unsigned int s = first; s < last; s++ )
+    {
+    const double movingTerm = self->m_SampleMovingTerms[s];
+    if ( movingTerm < 0.0 )
+      {
+      continue;
+      }
+
+    // Derivative of the joint histogram entries of the sample with respect
+    // to its moving term, weighted by the log ratios.
+    const int movingBin = self->GetMovingBin( movingTerm );
+    const double * pRatio = &self->m_PRatio[self->m_SampleFixedBins[s] * bins];
+    double factor = 0.0;
+    for ( int m = movingBin; m < movingBin + 4; m++ )
+      {
+      factor += pRatio[m] * CubicKernelDerivative( m - movingTerm );
+      }
+    if ( factor == 0.0 )
+      {
+      continue;
+      }
+
+    typename MovingImageType::IndexType index;
+    if ( !self->m_MovingImage->TransformPhysicalPointToIndex(
+                                 self->m_SampleMappedPoints[s], index ) )
+      {
+      continue;
+      }
+    const typename GradientCalculatorType::OutputType gradient =
+      self->m_GradientCalculator->EvaluateAtIndex( index );
+
+    // Only the parameters of the support nodes of the sample are touched.
+    if ( self->m_UseCache )
+      {
+      if ( !self->m_SampleInside[s] )
+        {
+        continue;
+        }
+      const float * w = &self->m_SampleWeights[s * numberOfWeights];
+      const unsigned int * idx = &self->m_SampleIndices[s * numberOfWeights];
+      for ( unsigned int k = 0; k < numberOfWeights; k++ )
+        {
+        const double weight = factor * w[k];
+        for ( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          derivative[d * perDimension + idx[k]] += weight * gradient[d];
+          }
+        }
+      }
+    else
+      {
+      PointType mapped;
+      bool inside;
+      self->m_BSplineTransform->TransformPoint( self->m_SamplePoints[s],
+                                                mapped, weights, indices,
+                                                inside );
+      if ( !inside )
+        {
+        continue;
+        }
+      for ( unsigned int k = 0; k < numberOfWeights; k++ )
+        {
+        const double weight = factor * weights[k];
+        for ( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          derivative[d * perDimension + indices[k]] += weight * gradient[d];
+          }
+        }
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+typename CachedBSplineMutualInformationImageToImageMetric<TFixedImage,
+                                      TMovingImage, TBSplineTransform>
+::MeasureType
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::Evaluate( const ParametersType & parameters,
+            DerivativeType * derivative ) const
+{
+  if ( m_SamplePoints.empty() )
+    {
+    itkExceptionMacro( << "Metric not initialized" );
+    }
+
+  this->m_Transform->SetParameters( parameters );
+  m_Parameters = &parameters;
+
+  const unsigned int bins = m_NumberOfHistogramBins;
+  const unsigned int threads = m_NumberOfEvaluationThreads;
+
+  m_SampleMovingTerms.resize( m_SamplePoints.size() );
+  m_SampleMappedPoints.resize( m_SamplePoints.size() );
+  m_ThreadJointPDF.resize( threads );
+  for ( unsigned int t = 0; t < threads; t++ )
+    {
+    m_ThreadJointPDF[t].assign( bins * bins, 0.0 );
+    }
+
+  m_Threader->SetNumberOfThreads( threads );
+  m_Threader->SetSingleMethod( Self::HistogramThreaderCallback,
+                               const_cast<Self *>( this ) );
+  m_Threader->SingleMethodExecute();
+
+  std::vector<double> jointPDF( m_ThreadJointPDF[0] );
+  for ( unsigned int t = 1; t < threads; t++ )
+    {
+    for ( unsigned int b = 0; b < bins * bins; b++ )
+      {
+      jointPDF[b] += m_ThreadJointPDF[t][b];
+      }
+    }
+
+  double jointPDFSum = 0.0;
+  for ( unsigned int b = 0; b < bins * bins; b++ )
+    {
+    jointPDFSum += jointPDF[b];
+    }
+  if ( jointPDFSum <= 0.0 )
+    {
+    itkExceptionMacro( << "All the samples map outside the moving image" );
+    }
+
+  std::vector<double> fixedPDF( bins, 0.0 );
+  std::vector<double> movingPDF( bins, 0.0 );
+  for ( unsigned int f = 0; f < bins; f++ )
+    {
+    for ( unsigned int m = 0; m < bins; m++ )
+      {
+      double & p = jointPDF[f * bins + m];
+      p /= jointPDFSum;
+      fixedPDF[f] += p;
+      movingPDF[m] += p;
+      }
+    }
+
+  const double epsilon = 1e-16;
+  double mutualInformation = 0.0;
+  for ( unsigned int f = 0; f < bins; f++ )
+    {
+    for ( unsigned int m = 0; m < bins; m++ )
+      {
+      const double p = jointPDF[f * bins + m];
+      const double pf = fixedPDF[f];
+      const double pm = movingPDF[m];
+      if ( p > epsilon && pf > epsilon && pm > epsilon )
+        {
+        mutualInformation += p * vcl_log( p / ( pf * pm ) );
+        }
+      }
+    }
+
+  if ( derivative )
+    {
+    const unsigned int numberOfParameters = this->GetNumberOfParameters();
+
+    m_PRatio.assign( bins * bins, 0.0 );
+    for ( unsigned int f = 0; f < bins; f++ )
+      {
+      for ( unsigned int m = 0; m < bins; m++ )
+        {
+        const double p = jointPDF[f * bins + m];
+        if ( p > epsilon && movingPDF[m] > epsilon )
+          {
+          m_PRatio[f * bins + m] = vcl_log( p / movingPDF[m] );
+          }
+        }
+      }
+
+    m_ThreadDerivative.resize( threads );
+    for ( unsigned int t = 0; t < threads; t++ )
+      {
+      m_ThreadDerivative[t].assign( numberOfParameters, 0.0 );
+      }
+
+    m_Threader->SetSingleMethod( Self::DerivativeThreaderCallback,
+                                 const_cast<Self *>( this ) );
+    m_Threader->SingleMethodExecute();
+
+    const double normalization = 1.0 / ( jointPDFSum * m_MovingBinSize );
+    derivative->SetSize( numberOfParameters );
+    for ( unsigned int i = 0; i < numberOfParameters; i++ )
+      {
+      double sum = 0.0;
+      for ( unsigned int t = 0; t < threads; t++ )
+        {
+        sum += m_ThreadDerivative[t][i];
+        }
+      (*derivative)[i] = sum * normalization;
+      }
+    }
+
+  return -mutualInformation;
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+typename CachedBSplineMutualInformationImageToImageMetric<TFixedImage,
+                                      TMovingImage, TBSplineTransform>
+::MeasureType
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::GetValue( const ParametersType & parameters ) const
+{
+  return this->Evaluate( parameters, 0 );
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+void
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::GetDerivative( const ParametersType & parameters,
+                 DerivativeType & derivative ) const
+{
+  this->Evaluate( parameters, &derivative );
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+void
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::GetValueAndDerivative( const ParametersType & parameters,
+                         MeasureType & value,
+                         DerivativeType & derivative ) const
+{
+  value = this->Evaluate( parameters, &derivative );
+}
+
+
+template <class TFixedImage, class TMovingImage, class TBSplineTransform>
+void
+CachedBSplineMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                 TBSplineTransform>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfHistogramBins: " << m_NumberOfHistogramBins
+     << std::endl;
+  os << indent << "NumberOfSpatialSamples: " << m_NumberOfSpatialSamples
+     << std::endl;
+  os << indent << "Seed: " << m_Seed << std::endl;
+  os << indent << "MaximumCacheSize: " << m_MaximumCacheSize << std::endl;
+  os << indent << "CacheSize: " << m_CacheSize << std::endl;
+  os << indent << "UseCache: " << m_UseCache << std::endl;
+  os << indent << "NumberOfEvaluationThreads: "
+     << m_NumberOfEvaluationThreads << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -45,6 +45,10 @@ int main(int argc, char **argv)
                     "Initialize using inverse of the transforms <numberOfTransforms> <ListOfTransforms>*");
     command.AddOptionField("InitInvTransform", "ListOfInvTransforms",
                            MetaCommand::LIST, true);
+    command.SetOption("InitMultiStart", "InitMultiStart", false,
+      "Race a short rigid registration from every initialization <Iterations>");
+    command.AddOptionField("InitMultiStart", "Iterations",
+                           MetaCommand::INT, true, "50");
     command.SetOption("InitLandmarks", "InitLandmarks", false,
       "Initialize using landmarks <fixedLandmarksfile> <movingLandmarksfile>");
     command.AddOptionField("InitLandmarks", "FixedLandmarksFile",
@@ -69,6 +73,14 @@ int main(int argc, char **argv)
                       "Use gradient (with powell line search) optimizer");
     command.SetOption("OptOnePlusOneGradient", "OptOnePlusOneGradient", false,
                       "Use One plus One and then gradient optimizers");
+    command.SetOption("OptBatch", "OptBatch", false,
+       "Score <PopulationSize> One plus One candidates in parallel (rigid)");
+    command.AddOptionField("OptBatch", "PopulationSize",
+                           MetaCommand::INT, true, "0");
+    command.SetOption("OptSeed", "OptSeed", false,
+                      "Seed of the batched One plus One optimizer");
+    command.AddOptionField("OptSeed", "Number",
+                           MetaCommand::INT, true, "121212");
     command.SetOption("OptIterations", "OptIterations", false,
                       "# of iterations for optimizer");
     command.AddOptionField("OptIterations", "Number",
@@ -80,6 +92,11 @@ int main(int argc, char **argv)
                            MetaCommand::INT, true, "20000");
 
 
+    command.SetOption("MetricCacheWeights", "MetricCacheWeights", false,
+      "Cache the B-spline weights of the deformable metric <MaximumMB>");
+    command.AddOptionField("MetricCacheWeights", "MaximumMB",
+                           MetaCommand::INT, true, "512");
+
     command.SetOption("SaveTransform", "SaveTransform", false,
                       "Save registration transform <Filename>");
     command.AddOptionField("SaveTransform", "Filename",
@@ -171,6 +188,23 @@ int main(int argc, char **argv)
                            command.GetValueAsInt("MetricSamples","Number") );
     imageRegistrationApp->SetAffineNumberOfSpatialSamples(
                            command.GetValueAsInt("MetricSamples","Number") );
+    if( command.GetOptionWasSet("OptBatch") )
+      {
+      imageRegistrationApp->SetRigidUseBatchedOnePlusOne( true );
+      imageRegistrationApp->SetRigidPopulationSize(
+                           command.GetValueAsInt("OptBatch","PopulationSize") );
+      imageRegistrationApp->SetRigidOptimizerSeed(
+                           command.GetValueAsInt("OptSeed","Number") );
+      }
+
+    if( command.GetOptionWasSet("MetricCacheWeights") )
+      {
+      imageRegistrationApp->SetDeformableUseCachedBSplineWeights( true );
+      imageRegistrationApp->SetDeformableMaximumWeightCacheSize(
+        static_cast<unsigned long>(
+          command.GetValueAsInt("MetricCacheWeights","MaximumMB") )
+        * 1024UL * 1024UL );
+      }
 
 
     if( command.GetOptionWasSet("InitMass") )
@@ -377,6 +411,13 @@ int main(int argc, char **argv)
       imageRegistrationApp->SetOptimizerToOnePlusOnePlusGradient();
       }
 
+    if( command.GetOptionWasSet("InitMultiStart") )
+      {
+      imageRegistrationApp->SetMultiStartNumberOfIterations(
+                       command.GetValueAsInt("InitMultiStart","Iterations") );
+      imageRegistrationApp->RegisterUsingMultiStart();
+      }
+
     clock_t timeInitEnd = clock();
 
     double finalMetricValue = 0;
@@ -0,0 +1,150 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    BrickedLevelSetEvolutionTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+// Grows a small sphere into a ball of the feature image much larger than
+// the first region of interest, so that the region grows over several
+// rounds, and checks the output of the last round.
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkThresholdSegmentationLevelSetImageFilter.h"
+#include "itkBrickedLevelSetEvolution.h"
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+
+typedef itk::Image< float, 3 >                                ImageType;
+typedef itk::ThresholdSegmentationLevelSetImageFilter<
+                                  ImageType, ImageType >      FilterType;
+typedef itk::BrickedLevelSetEvolution< FilterType, ImageType > EvolutionType;
+
+
+static double DistanceToCenter( const ImageType::IndexType & index,
+                                double center )
+{
+  double distance = 0.0;
+  for ( unsigned int d = 0; d < 3; d++ )
+    {
+    distance += ( index[d] - center ) * ( index[d] - center );
+    }
+  return std::sqrt( distance );
+}
+
+
+int main( int, char *[] )
+{
+  const unsigned int n = 64;
+  const double center = 32.0;
+  const double radius = 24.0;
+
+  ImageType::SizeType size;
+  size.Fill( n );
+  ImageType::RegionType region;
+  region.SetSize( size );
+
+  // ball of 100 in a background of 0, and a sphere of radius 4 inside
+  ImageType::Pointer feature = ImageType::New();
+  feature->SetRegions( region );
+  feature->Allocate();
+  ImageType::Pointer initial = ImageType::New();
+  initial->SetRegions( region );
+  initial->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > fit( feature, region );
+  itk::ImageRegionIteratorWithIndex< ImageType > iit( initial, region );
+  for ( ; !fit.IsAtEnd(); ++fit, ++iit )
+    {
+    const double distance = DistanceToCenter( fit.GetIndex(), center );
+    fit.Set( distance < radius ? 100.0 : 0.0 );
+    iit.Set( distance - 4.0 );
+    }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetLowerThreshold( 50.0 );
+  filter->SetUpperThreshold( 150.0 );
+  filter->SetPropagationScaling( 1.0 );
+  filter->SetCurvatureScaling( 0.2 );
+  filter->SetMaximumRMSError( 0.0 );
+  filter->SetNumberOfIterations( 300 );
+
+  // the first region is the bricks 2 to 5, the ball goes from 8 to 56
+  EvolutionType::Pointer evolution = EvolutionType::New();
+  evolution->SetFilter( filter );
+  evolution->SetInitialImage( initial );
+  evolution->SetIsoSurfaceValue( 0.0 );
+  evolution->SetFeatureImage( feature );
+  evolution->SetBrickSize( 8 );
+  evolution->SetMargin( 1 );
+  evolution->SetCheckInterval( 5 );
+
+  ImageType::Pointer volume;
+  try
+    {
+    evolution->Update();
+    volume = evolution->MakeVolumeOutput();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Region " << evolution->GetRegion()
+            << "Rounds: " << evolution->GetNumberOfRounds()
+            << ", iterations: " << evolution->GetElapsedIterations()
+            << std::endl;
+
+  int status = EXIT_SUCCESS;
+
+  if ( evolution->GetNumberOfRounds() < 3 )
+    {
+    std::cerr << "The region should have grown at least twice" << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  if ( evolution->GetOutput()->GetBufferedRegion() != evolution->GetRegion() )
+    {
+    std::cerr << "The output covers " << evolution->GetOutput()->GetBufferedRegion()
+              << " instead of the last region" << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  // inside near the edge of the ball, outside beyond it, on every axis
+  for ( unsigned int d = 0; d < 3; d++ )
+    {
+    for ( int side = -1; side <= 1; side += 2 )
+      {
+      ImageType::IndexType inside;
+      ImageType::IndexType outside;
+      inside.Fill( static_cast<long>( center ) );
+      outside.Fill( static_cast<long>( center ) );
+      inside[d] += side * static_cast<long>( radius - 4.0 );
+      outside[d] += side * static_cast<long>( radius + 4.0 );
+      if ( volume->GetPixel( inside ) >= 0.0 ||
+           volume->GetPixel( outside ) <= 0.0 )
+        {
+        std::cerr << "The front did not stop on the ball at " << inside
+                  << " / " << outside << std::endl;
+        status = EXIT_FAILURE;
+        }
+      }
+    }
+
+  return status;
+}
@@ -0,0 +1,821 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    LevelSetParameterSweep.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "LevelSetParameterSweep.h"
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+
+/************************************
+ *
+ *  Constructor
+ *
+ ***********************************/
+LevelSetParameterSweep
+::LevelSetParameterSweep()
+{
+  m_Method = GeodesicActiveContour;
+
+  // Defaults of the applications
+  m_Defaults["sigma"]       = 1.0;
+  m_Defaults["alpha"]       = -1.0;
+  m_Defaults["beta"]        = 5.0;
+  m_Defaults["distance"]    = 5.0;
+  m_Defaults["stopping"]    = 100.0;
+  m_Defaults["curvature"]   = 0.1;
+  m_Defaults["propagation"] = 1.0;
+  m_Defaults["advection"]   = 1.0;
+  m_Defaults["iterations"]  = 100.0;
+  m_Defaults["rms"]         = 0.02;
+  m_Defaults["threshold"]   = 0.0;
+  m_Defaults["variance"]    = 1.0;
+  m_Defaults["lower"]       = 50.0;
+  m_Defaults["upper"]       = 63.0;
+  m_Defaults["isovalue"]    = 0.5;
+
+  m_SeedImage = SeedImageType::New();
+
+  m_NumberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  m_NextConfiguration = 0;
+}
+
+
+
+/************************************
+ *
+ *  Destructor
+ *
+ ***********************************/
+LevelSetParameterSweep
+::~LevelSetParameterSweep()
+{
+}
+
+
+
+/************************************
+ *
+ *  Select the method
+ *
+ ***********************************/
+bool
+LevelSetParameterSweep
+::SetMethod( const char * name )
+{
+  const std::string method( name );
+  if( method == "gac" )
+    {
+    m_Method = GeodesicActiveContour;
+    }
+  else if( method == "shape" )
+    {
+    m_Method = ShapeDetection;
+    }
+  else if( method == "canny" )
+    {
+    m_Method = Canny;
+    }
+  else if( method == "threshold" )
+    {
+    m_Method = Threshold;
+    }
+  else
+    {
+    return false;
+    }
+  m_Grid.clear();
+  return true;
+}
+
+
+
+/************************************
+ *
+ *  Load Input Image
+ *
+ ***********************************/
+void
+LevelSetParameterSweep
+::LoadInputImage( const char * filename )
+{
+  typedef itk::ImageFileReader< InternalImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( filename );
+  reader->Update();
+
+  m_InputImage = reader->GetOutput();
+  m_InputImage->DisconnectPipeline();
+
+  m_SeedImage->CopyInformation( m_InputImage );
+  m_SeedImage->SetRegions( m_InputImage->GetBufferedRegion() );
+  m_SeedImage->Allocate();
+  m_SeedImage->FillBuffer( itk::NumericTraits<SeedPixelType>::Zero );
+
+  m_Seeds.clear();
+}
+
+
+
+/************************************
+ *
+ *  Add a seed
+ *
+ ***********************************/
+void
+LevelSetParameterSweep
+::AddSeed( const IndexType & seed )
+{
+  if( !m_InputImage ||
+      !m_InputImage->GetBufferedRegion().IsInside( seed ) )
+    {
+    itk::ExceptionObject excp;
+    excp.SetDescription("Seeds must be inside of the input image.");
+    throw excp;
+    }
+  m_Seeds.push_back( seed );
+  m_SeedImage->SetPixel( seed, 1 );
+}
+
+
+
+/************************************
+ *
+ *  Parameters of the current method
+ *
+ ***********************************/
+void
+LevelSetParameterSweep
+::GetParameterNames( std::vector<std::string> & names ) const
+{
+  names.clear();
+
+  // shared stages first, so that consecutive configurations share them
+  if( m_Method != Threshold )
+    {
+    names.push_back("sigma");
+    names.push_back("alpha");
+    names.push_back("beta");
+    names.push_back("distance");
+    names.push_back("stopping");
+    }
+
+  switch( m_Method )
+    {
+    case Canny:
+      names.push_back("threshold");
+      names.push_back("variance");
+      names.push_back("advection");
+      break;
+    case Threshold:
+      names.push_back("lower");
+      names.push_back("upper");
+      names.push_back("isovalue");
+      break;
+    case GeodesicActiveContour:
+      names.push_back("advection");
+      break;
+    case ShapeDetection:
+      break;
+    }
+
+  names.push_back("curvature");
+  names.push_back("propagation");
+  names.push_back("iterations");
+  names.push_back("rms");
+}
+
+
+
+/************************************
+ *
+ *  Set the values of a parameter
+ *
+ ***********************************/
+bool
+LevelSetParameterSweep
+::SetParameterValues( const std::string & name,
+                      const std::vector<double> & values )
+{
+  std::vector<std::string> names;
+  this->GetParameterNames( names );
+  for( unsigned int i = 0; i < names.size(); i++ )
+    {
+    if( names[i] == name )
+      {
+      m_Grid[name] = values;
+      return true;
+      }
+    }
+  return false;
+}
+
+
+
+/************************************
+ *
+ *  Read the parameter grid
+ *
+ ***********************************/
+void
+LevelSetParameterSweep
+::ReadParameterGrid( const char * filename )
+{
+  std::ifstream input( filename );
+  if( !input )
+    {
+    itk::ExceptionObject excp;
+    excp.SetDescription("The parameter grid file could not be opened.");
+    throw excp;
+    }
+
+  std::string line;
+  while( std::getline( input, line ) )
+    {
+    std::istringstream fields( line );
+    std::string name;
+    if( !( fields >> name ) || name[0] == '#' )
+      {
+      continue;
+      }
+    std::vector<double> values;
+    double value;
+    while( fields >> value )
+      {
+      values.push_back( value );
+      }
+    if( values.empty() )
+      {
+      continue;
+      }
+    if( !this->SetParameterValues( name, values ) )
+      {
+      std::cerr << "Parameter " << name
+                << " is not used by this method, ignored." << std::endl;
+      }
+    }
+}
+
+
+
+void
+LevelSetParameterSweep
+::SetNumberOfThreads( unsigned int number )
+{
+  m_NumberOfThreads = ( number > 0 ) ? number : 1;
+}
+
+
+
+void
+LevelSetParameterSweep
+::SetOutputPrefix( const char * prefix )
+{
+  m_OutputPrefix = prefix ? prefix : "";
+}
+
+
+
+/************************************
+ *
+ *  Build the grid of configurations
+ *
+ ***********************************/
+void
+LevelSetParameterSweep
+::BuildConfigurations()
+{
+  std::vector<std::string> names;
+  this->GetParameterNames( names );
+
+  std::vector< std::vector<double> > values( names.size() );
+  unsigned long numberOfConfigurations = 1;
+  for( unsigned int i = 0; i < names.size(); i++ )
+    {
+    std::map< std::string, std::vector<double> >::const_iterator grid =
+                                                     m_Grid.find( names[i] );
+    if( grid != m_Grid.end() )
+      {
+      values[i] = grid->second;
+      }
+    else
+      {
+      values[i].push_back( m_Defaults.find( names[i] )->second );
+      }
+    numberOfConfigurations *= values[i].size();
+    }
+
+  // The last parameter varies fastest
+  m_Configurations.clear();
+  m_Configurations.resize( numberOfConfigurations );
+  for( unsigned long c = 0; c < numberOfConfigurations; c++ )
+    {
+    Configuration & configuration = m_Configurations[c];
+    unsigned long rest = c;
+    for( int i = names.size() - 1; i >= 0; i-- )
+      {
+      configuration.Parameters[ names[i] ] = values[i][ rest % values[i].size() ];
+      rest /= values[i].size();
+      }
+    configuration.SharedTime   = 0.0;
+    configuration.LevelSetTime = 0.0;
+    configuration.Iterations   = 0;
+    configuration.RMSChange    = 0.0;
+    configuration.InsideVoxels = 0;
+    }
+}
+
+
+
+/************************************
+ *
+ *  Key of a shared stage
+ *
+ ***********************************/
+std::string
+LevelSetParameterSweep
+::GetStageKey( const ParametersType & parameters, unsigned int level ) const
+{
+  static const char * names[] = { "sigma", "alpha", "beta",
+                                  "distance", "stopping" };
+  static const unsigned int count[] = { 1, 3, 5 };
+
+  std::ostringstream key;
+  key << std::setprecision( 10 );
+  for( unsigned int i = 0; i < count[level]; i++ )
+    {
+    key << ( i ? " " : "" ) << names[i] << "="
+        << parameters.find( names[i] )->second;
+    }
+  return key.str();
+}
+
+
+
+/************************************
+ *
+ *  Compute the shared stages once
+ *
+ ***********************************/
+void
+LevelSetParameterSweep
+::ComputeSharedStages()
+{
+  m_StageImages.clear();
+  m_StageTimes.clear();
+
+  if( m_Method == Threshold )
+    {
+    return;
+    }
+
+  const InternalImageType::RegionType region = m_InputImage->GetBufferedRegion();
+
+  for( unsigned int c = 0; c < m_Configurations.size(); c++ )
+    {
+    Configuration & configuration = m_Configurations[c];
+    const ParametersType & parameters = configuration.Parameters;
+
+    for( unsigned int level = 0; level < 3; level++ )
+      {
+      const std::string key = this->GetStageKey( parameters, level );
+      if( m_StageTimes.find( key ) != m_StageTimes.end() )
+        {
+        continue;
+        }
+
+      itk::TimeProbe probe;
+      InternalImageType::Pointer output;
+      if( level == 0 )
+        {
+        std::cout << "Computing gradient magnitude, " << key << std::endl;
+        DerivativeFilterType::Pointer derivative = DerivativeFilterType::New();
+        derivative->SetInput( m_InputImage );
+        derivative->SetSigma( parameters.find("sigma")->second );
+        probe.Start();
+        derivative->Update();
+        probe.Stop();
+        output = derivative->GetOutput();
+        }
+      else if( level == 1 )
+        {
+        std::cout << "Computing speed image, " << key << std::endl;
+        SigmoidFilterType::Pointer sigmoid = SigmoidFilterType::New();
+        sigmoid->SetInput( m_StageImages[ this->GetStageKey( parameters, 0 ) ] );
+        sigmoid->SetOutputMinimum( 0.0 );
+        sigmoid->SetOutputMaximum( 1.0 );
+        sigmoid->SetAlpha( parameters.find("alpha")->second );
+        sigmoid->SetBeta( parameters.find("beta")->second );
+        probe.Start();
+        sigmoid->Update();
+        probe.Stop();
+        output = sigmoid->GetOutput();
+        }
+      else
+        {
+        std::cout << "Computing initial level set, " << key << std::endl;
+        NodeContainer::Pointer trialPoints = NodeContainer::New();
+        trialPoints->Initialize();
+        NodeType node;
+        node.SetValue( - parameters.find("distance")->second );
+        for( unsigned int s = 0; s < m_Seeds.size(); s++ )
+          {
+          node.SetIndex( m_Seeds[s] );
+          trialPoints->InsertElement( s, node );
+          }
+        FastMarchingFilterType::Pointer fastMarching = FastMarchingFilterType::New();
+        fastMarching->SetInput( m_StageImages[ this->GetStageKey( parameters, 1 ) ] );
+        fastMarching->SetTrialPoints( trialPoints );
+        fastMarching->SetStoppingValue( parameters.find("stopping")->second );
+        fastMarching->SetOutputSize( region.GetSize() );
+        fastMarching->SetOutputSpacing( m_InputImage->GetSpacing() );
+        fastMarching->SetOutputOrigin( m_InputImage->GetOrigin() );
+        probe.Start();
+        fastMarching->Update();
+        probe.Stop();
+        output = fastMarching->GetOutput();
+        }
+
+      output->DisconnectPipeline();
+      m_StageImages[ key ] = output;
+      m_StageTimes[ key ]  = probe.GetMeanTime();
+      }
+
+    configuration.SharedTime = 0.0;
+    for( unsigned int level = 0; level < 3; level++ )
+      {
+      configuration.SharedTime +=
+                    m_StageTimes[ this->GetStageKey( parameters, level ) ];
+      }
+    }
+
+  // Only the speed images and the initial level sets are used downstream
+  for( unsigned int c = 0; c < m_Configurations.size(); c++ )
+    {
+    m_StageImages.erase(
+         this->GetStageKey( m_Configurations[c].Parameters, 0 ) );
+    }
+}
+
+
+
+/************************************
+ *
+ *  Output of a shared stage
+ *
+ ***********************************/
+const LevelSetParameterSweep::InternalImageType *
+LevelSetParameterSweep
+::GetStageImage( const ParametersType & parameters, unsigned int level ) const
+{
+  return m_StageImages.find( this->GetStageKey( parameters, level ) )
+                                                      ->second.GetPointer();
+}
+
+
+
+/************************************
+ *
+ *  Share the pixels of an image
+ *
+ ***********************************/
+template < class TImage >
+typename TImage::Pointer
+LevelSetParameterSweep
+::ShareImage( const TImage * image )
+{
+  typename TImage::Pointer shared = TImage::New();
+  shared->CopyInformation( image );
+  shared->SetRegions( image->GetBufferedRegion() );
+  shared->SetPixelContainer(
+    const_cast< typename TImage::PixelContainer * >(
+                                         image->GetPixelContainer() ) );
+  return shared;
+}
+
+
+
+/************************************
+ *
+ *  Evolve one level set
+ *
+ ***********************************/
+template < class TFilter >
+void
+LevelSetParameterSweep
+::Evolve( TFilter * filter, Configuration & configuration )
+{
+  const ParametersType & parameters = configuration.Parameters;
+
+  filter->SetCurvatureScaling( parameters.find("curvature")->second );
+  filter->SetPropagationScaling( parameters.find("propagation")->second );
+  filter->SetNumberOfIterations(
+     static_cast<unsigned int>( parameters.find("iterations")->second ) );
+  filter->SetMaximumRMSError( parameters.find("rms")->second );
+  filter->UseImageSpacingOn();
+
+  itk::TimeProbe probe;
+  probe.Start();
+  filter->Update();
+  probe.Stop();
+
+  const InternalImageType * output = filter->GetOutput();
+
+  configuration.LevelSetTime = probe.GetMeanTime();
+  configuration.Iterations   = filter->GetElapsedIterations();
+  configuration.RMSChange    = filter->GetRMSChange();
+
+  // voxels on the same side of the zero set as the first seed
+  const bool seedSide = output->GetPixel( m_Seeds[0] ) <= 0.0;
+  configuration.InsideVoxels = 0;
+  itk::ImageRegionConstIterator< InternalImageType >
+                         it( output, output->GetBufferedRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if( ( it.Get() <= 0.0 ) == seedSide )
+      {
+      configuration.InsideVoxels++;
+      }
+    }
+
+  if( !m_OutputPrefix.empty() )
+    {
+    typedef itk::ImageFileWriter< InternalImageType > WriterType;
+    m_Lock.Lock();
+    try
+      {
+      WriterType::Pointer writer = WriterType::New();
+      writer->SetInput( output );
+      writer->SetFileName( configuration.OutputFileName.c_str() );
+      writer->Update();
+      }
+    catch( itk::ExceptionObject & )
+      {
+      m_Lock.Unlock();
+      throw;
+      }
+    m_Lock.Unlock();
+    }
+}
+
+
+
+/************************************
+ *
+ *  Run one configuration
+ *
+ ***********************************/
+void
+LevelSetParameterSweep
+::RunConfiguration( unsigned int c )
+{
+  Configuration & configuration = m_Configurations[c];
+  const ParametersType & parameters = configuration.Parameters;
+
+  if( !m_OutputPrefix.empty() )
+    {
+    std::ostringstream name;
+    name << m_OutputPrefix << "_" << std::setw(4) << std::setfill('0')
+         << c << ".mha";
+    configuration.OutputFileName = name.str();
+    }
+
+  try
+    {
+    switch( m_Method )
+      {
+      case GeodesicActiveContour:
+        {
+        GeodesicActiveContourFilterType::Pointer filter =
+                                    GeodesicActiveContourFilterType::New();
+        filter->SetInput( ShareImage( this->GetStageImage( parameters, 2 ) ) );
+        filter->SetFeatureImage( ShareImage( this->GetStageImage( parameters, 1 ) ) );
+        filter->SetAdvectionScaling( parameters.find("advection")->second );
+        this->Evolve( filter.GetPointer(), configuration );
+        break;
+        }
+      case ShapeDetection:
+        {
+        ShapeDetectionFilterType::Pointer filter =
+                                    ShapeDetectionFilterType::New();
+        filter->SetInput( ShareImage( this->GetStageImage( parameters, 2 ) ) );
+        filter->SetFeatureImage( ShareImage( this->GetStageImage( parameters, 1 ) ) );
+        this->Evolve( filter.GetPointer(), configuration );
+        break;
+        }
+      case Canny:
+        {
+        CannyFilterType::Pointer filter = CannyFilterType::New();
+        filter->SetInput( ShareImage( this->GetStageImage( parameters, 2 ) ) );
+        filter->SetFeatureImage( ShareImage( m_InputImage.GetPointer() ) );
+        filter->SetThreshold( parameters.find("threshold")->second );
+        filter->SetVariance( parameters.find("variance")->second );
+        filter->SetAdvectionScaling( parameters.find("advection")->second );
+        this->Evolve( filter.GetPointer(), configuration );
+        break;
+        }
+      case Threshold:
+        {
+        ThresholdFilterType::Pointer filter = ThresholdFilterType::New();
+        filter->SetInput( ShareImage( m_SeedImage.GetPointer() ) );
+        filter->SetFeatureImage( ShareImage( m_InputImage.GetPointer() ) );
+        filter->SetLowerThreshold( parameters.find("lower")->second );
+        filter->SetUpperThreshold( parameters.find("upper")->second );
+        filter->SetIsoSurfaceValue( parameters.find("isovalue")->second );
+        this->Evolve( filter.GetPointer(), configuration );
+        break;
+        }
+      }
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    configuration.Error = excp.GetDescription();
+    }
+}
+
+
+
+/************************************
+ *
+ *  Thread callback: take the next
+ *  configuration until none is left
+ *
+ ***********************************/
+ITK_THREAD_RETURN_TYPE
+LevelSetParameterSweep
+::RunThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info =
+    static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  LevelSetParameterSweep * self =
+    static_cast<LevelSetParameterSweep *>( info->UserData );
+
+  while( true )
+    {
+    self->m_Lock.Lock();
+    const unsigned int c = self->m_NextConfiguration++;
+    self->m_Lock.Unlock();
+    if( c >= self->m_Configurations.size() )
+      {
+      break;
+      }
+
+    self->RunConfiguration( c );
+
+    const Configuration & configuration = self->m_Configurations[c];
+    self->m_Lock.Lock();
+    std::cout << "Configuration " << c + 1 << "/"
+              << self->m_Configurations.size() << ": ";
+    if( configuration.Error.empty() )
+      {
+      std::cout << configuration.LevelSetTime << " s, "
+                << configuration.Iterations << " iterations";
+      }
+    else
+      {
+      std::cout << configuration.Error;
+      }
+    std::cout << std::endl;
+    self->m_Lock.Unlock();
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+
+void
+LevelSetParameterSweep
+::RunConfigurations()
+{
+  m_NextConfiguration = 0;
+
+  unsigned int numberOfThreads = m_NumberOfThreads;
+  if( numberOfThreads > m_Configurations.size() )
+    {
+    numberOfThreads = m_Configurations.size();
+    }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( RunThreaderCallback, this );
+  threader->SingleMethodExecute();
+}
+
+
+
+/************************************
+ *
+ *  Run the sweep
+ *
+ ***********************************/
+void
+LevelSetParameterSweep
+::Run()
+{
+  if( !m_InputImage || m_Seeds.empty() )
+    {
+    itk::ExceptionObject excp;
+    excp.SetDescription("An input image and at least one seed are needed.");
+    throw excp;
+    }
+
+  this->BuildConfigurations();
+  std::cout << m_Configurations.size() << " configurations" << std::endl;
+
+  this->ComputeSharedStages();
+  this->RunConfigurations();
+
+  m_StageImages.clear();
+}
+
+
+
+/************************************
+ *
+ *  Write the results table
+ *
+ ***********************************/
+void
+LevelSetParameterSweep
+::WriteResults( std::ostream & os ) const
+{
+  static const char * methods[] = { "gac", "shape", "canny", "threshold" };
+
+  os << "# method " << methods[ m_Method ] << std::endl;
+  os << "# seeds";
+  for( unsigned int s = 0; s < m_Seeds.size(); s++ )
+    {
+    os << " " << m_Seeds[s];
+    }
+  os << std::endl;
+
+  // each shared stage is paid once, whatever the number of users
+  std::map< std::string, double >::const_iterator stage = m_StageTimes.begin();
+  for( ; stage != m_StageTimes.end(); ++stage )
+    {
+    os << "# shared stage " << stage->first << "\t"
+       << stage->second << " s" << std::endl;
+    }
+
+  std::vector<std::string> names;
+  this->GetParameterNames( names );
+
+  os << "configuration";
+  for( unsigned int i = 0; i < names.size(); i++ )
+    {
+    os << "\t" << names[i];
+    }
+  os << "\tshared_time\tlevel_set_time\titerations\trms_change"
+     << "\tinside_voxels\toutput" << std::endl;
+
+  for( unsigned int c = 0; c < m_Configurations.size(); c++ )
+    {
+    const Configuration & configuration = m_Configurations[c];
+    os << c;
+    for( unsigned int i = 0; i < names.size(); i++ )
+      {
+      os << "\t" << configuration.Parameters.find( names[i] )->second;
+      }
+    os << "\t" << configuration.SharedTime
+       << "\t" << configuration.LevelSetTime
+       << "\t" << configuration.Iterations
+       << "\t" << configuration.RMSChange
+       << "\t" << configuration.InsideVoxels
+       << "\t";
+    if( !configuration.Error.empty() )
+      {
+      os << "error: " << configuration.Error;
+      }
+    else if( !configuration.OutputFileName.empty() )
+      {
+      os << configuration.OutputFileName;
+      }
+    else
+      {
+      os << "-";
+      }
+    os << std::endl;
+    }
+}
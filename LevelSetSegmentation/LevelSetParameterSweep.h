@@ -0,0 +1,231 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    LevelSetParameterSweep.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef LEVELSETPARAMETERSWEEP
+#define LEVELSETPARAMETERSWEEP
+
+#include "itkImage.h"
+#include "itkGradientMagnitudeRecursiveGaussianImageFilter.h"
+#include "itkSigmoidImageFilter.h"
+#include "itkFastMarchingImageFilter.h"
+#include "itkGeodesicActiveContourLevelSetImageFilter.h"
+#include "itkShapeDetectionLevelSetImageFilter.h"
+#include "itkCannySegmentationLevelSetImageFilter.h"
+#include "itkThresholdSegmentationLevelSetImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+
+/**
+ * \brief Runs one of the level set segmentations of the GeodesicActiveContour,
+ * ShapeDetectionLevelSet, CannyLevelSet or ThresholdSegmentationLevelSet
+ * applications over a grid of parameters.
+ *
+ * The pipeline is the one of the application: gradient magnitude, sigmoid,
+ * fast marching from the seeds, and level set evolution (the threshold
+ * method starts from the seed image instead). Each parameter takes a list
+ * of values and every combination is run.
+ *
+ * The upstream stages are computed once for each distinct value of the
+ * parameters they depend on (sigma for the gradient magnitude, sigma,
+ * alpha and beta for the speed image, and in addition the zero set
+ * distance and the stopping value for the initial level set). Their
+ * outputs are shared read-only by all the configurations that use them.
+ * The level set evolutions, which run on a single thread, are then spread
+ * over the threads, and a results table gives for each configuration its
+ * parameters, the time of its shared stages, the time of its evolution,
+ * the number of iterations, the RMS change and the size of the segmented
+ * region.
+ */
+class LevelSetParameterSweep
+{
+public:
+
+  /** Dimension of the images */
+  enum { ImageDimension = 3 };
+
+  /** Level set methods of the applications */
+  typedef enum { GeodesicActiveContour, ShapeDetection,
+                 Canny, Threshold }                       MethodType;
+
+  /** Pixel type to be used internally */
+  typedef   float                                        InternalPixelType;
+
+  /** Pixel type of the seed image of the threshold method */
+  typedef   unsigned char                                SeedPixelType;
+
+  typedef   itk::Image<InternalPixelType,ImageDimension> InternalImageType;
+  typedef   itk::Image<SeedPixelType,ImageDimension>     SeedImageType;
+  typedef   InternalImageType::IndexType                 IndexType;
+
+  typedef itk::GradientMagnitudeRecursiveGaussianImageFilter<
+                                    InternalImageType>  DerivativeFilterType;
+
+  typedef   itk::SigmoidImageFilter<
+                    InternalImageType,
+                    InternalImageType >                   SigmoidFilterType;
+
+  typedef   itk::FastMarchingImageFilter<
+                               InternalImageType >     FastMarchingFilterType;
+
+  typedef FastMarchingFilterType::NodeType                NodeType;
+  typedef FastMarchingFilterType::NodeContainer           NodeContainer;
+
+  typedef   itk::GeodesicActiveContourLevelSetImageFilter<
+                                   InternalImageType,
+                                   InternalImageType,
+                                   InternalPixelType >  GeodesicActiveContourFilterType;
+
+  typedef   itk::ShapeDetectionLevelSetImageFilter<
+                                   InternalImageType,
+                                   InternalImageType,
+                                   InternalPixelType >  ShapeDetectionFilterType;
+
+  typedef   itk::CannySegmentationLevelSetImageFilter<
+                                   InternalImageType,
+                                   InternalImageType,
+                                   InternalPixelType >  CannyFilterType;
+
+  typedef   itk::ThresholdSegmentationLevelSetImageFilter<
+                                   SeedImageType,
+                                   InternalImageType >  ThresholdFilterType;
+
+  /** Values of the parameters of one configuration, by name */
+  typedef   std::map< std::string, double >              ParametersType;
+
+public:
+  LevelSetParameterSweep();
+  virtual ~LevelSetParameterSweep();
+
+  /** Select the method by name: gac, shape, canny or threshold. Returns
+   * false if the name is unknown. */
+  bool SetMethod( const char * name );
+
+  void LoadInputImage( const char * filename );
+
+  void AddSeed( const IndexType & seed );
+
+  /** Values taken by a parameter. A parameter without values keeps the
+   * default of the application. Returns false if the method does not use
+   * the parameter. */
+  bool SetParameterValues( const std::string & name,
+                           const std::vector<double> & values );
+
+  /** Read the grid from a file with one parameter per line, its name
+   * followed by its values. Lines starting with # are ignored. */
+  void ReadParameterGrid( const char * filename );
+
+  /** Number of level set evolutions run at the same time */
+  void SetNumberOfThreads( unsigned int number );
+
+  /** When set, the level set of each configuration is written to
+   * prefix_<configuration>.mha */
+  void SetOutputPrefix( const char * prefix );
+
+  /** Compute the shared stages, then the configurations. */
+  void Run();
+
+  /** Tab separated table with one line per configuration */
+  void WriteResults( std::ostream & os ) const;
+
+  unsigned int GetNumberOfConfigurations() const
+    { return m_Configurations.size(); }
+
+protected:
+
+  /** Parameters used by the current method, in table order */
+  void GetParameterNames( std::vector<std::string> & names ) const;
+
+  /** Key of the shared stage of the given level for a configuration:
+   * 0 gradient magnitude, 1 speed image, 2 initial level set. */
+  std::string GetStageKey( const ParametersType & parameters,
+                           unsigned int level ) const;
+
+  void BuildConfigurations();
+
+  void ComputeSharedStages();
+
+  /** Output of a shared stage, read only from the threads */
+  const InternalImageType * GetStageImage( const ParametersType & parameters,
+                                           unsigned int level ) const;
+
+  /** Image sharing the pixels of the given one, so that each level set
+   * filter owns the data objects of its inputs. */
+  template < class TImage >
+  static typename TImage::Pointer ShareImage( const TImage * image );
+
+  static ITK_THREAD_RETURN_TYPE RunThreaderCallback( void * arg );
+
+  void RunConfigurations();
+
+  void RunConfiguration( unsigned int configuration );
+
+private:
+
+  /** One point of the grid and its results */
+  struct Configuration
+    {
+    ParametersType                  Parameters;
+    double                          SharedTime;
+    double                          LevelSetTime;
+    unsigned int                    Iterations;
+    double                          RMSChange;
+    unsigned long                   InsideVoxels;
+    std::string                     OutputFileName;
+    std::string                     Error;
+    };
+
+  /** Run a level set filter, whose inputs are connected, with the common
+   * SegmentationLevelSetImageFilter parameters and record its results. */
+  template < class TFilter >
+  void Evolve( TFilter * filter, Configuration & configuration );
+
+  MethodType                                      m_Method;
+
+  InternalImageType::Pointer                      m_InputImage;
+
+  SeedImageType::Pointer                          m_SeedImage;
+
+  std::vector< IndexType >                        m_Seeds;
+
+  ParametersType                                  m_Defaults;
+
+  std::map< std::string, std::vector<double> >    m_Grid;
+
+  std::vector< Configuration >                    m_Configurations;
+
+  /** Outputs and times of the shared stages, by key */
+  std::map< std::string, InternalImageType::Pointer >   m_StageImages;
+  std::map< std::string, double >                       m_StageTimes;
+
+  unsigned int                                    m_NumberOfThreads;
+
+  std::string                                     m_OutputPrefix;
+
+  /** Next configuration to run, and lock on it and on the writers */
+  unsigned int                                    m_NextConfiguration;
+  itk::SimpleFastMutexLock                        m_Lock;
+
+};
+
+
+
+#endif
@@ -0,0 +1,99 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itk3DLevelSetParameterSweep.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "LevelSetParameterSweep.h"
+
+#include <fstream>
+#include <cstdlib>
+#include <string>
+
+
+void usage( const char * name )
+{
+  std::cerr << "Usage: " << name
+            << " method input_image parameter_grid results_table"
+            << " -seed x y z [-seed x y z ...]"
+            << " [-threads n] [-output prefix]" << std::endl;
+  std::cerr << "  method is one of gac, shape, canny, threshold" << std::endl;
+  exit(1);
+}
+
+
+int main( int argc, char *argv[] )
+{
+  if( argc < 5 )
+    {
+    usage( argv[0] );
+    }
+
+  LevelSetParameterSweep sweep;
+
+  if( !sweep.SetMethod( argv[1] ) )
+    {
+    std::cerr << "Unknown method " << argv[1] << std::endl;
+    usage( argv[0] );
+    }
+
+  try
+    {
+    sweep.LoadInputImage( argv[2] );
+    sweep.ReadParameterGrid( argv[3] );
+
+    for( int i = 5; i < argc; i++ )
+      {
+      const std::string option( argv[i] );
+      if( option == "-seed" && i + 3 < argc )
+        {
+        LevelSetParameterSweep::IndexType seed;
+        for( unsigned int d = 0; d < 3; d++ )
+          {
+          seed[d] = atoi( argv[++i] );
+          }
+        sweep.AddSeed( seed );
+        }
+      else if( option == "-threads" && i + 1 < argc )
+        {
+        sweep.SetNumberOfThreads( atoi( argv[++i] ) );
+        }
+      else if( option == "-output" && i + 1 < argc )
+        {
+        sweep.SetOutputPrefix( argv[++i] );
+        }
+      else
+        {
+        usage( argv[0] );
+        }
+      }
+
+    sweep.Run();
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << "Caught ITK exception: " << e << std::endl;
+    return 1;
+    }
+
+  std::ofstream table( argv[4] );
+  if( !table )
+    {
+    std::cerr << "Cannot write " << argv[4] << std::endl;
+    return 1;
+    }
+  sweep.WriteResults( table );
+
+  return 0;
+}
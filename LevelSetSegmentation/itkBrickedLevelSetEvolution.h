@@ -0,0 +1,237 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkBrickedLevelSetEvolution.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkBrickedLevelSetEvolution_h
+#define _itkBrickedLevelSetEvolution_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkCommand.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class BrickedLevelSetEvolution
+ *
+ * Runs a segmentation level set filter (ThresholdSegmentationLevelSet,
+ * CannySegmentationLevelSet, ...) only on the part of a large volume that
+ * the front reaches.
+ *
+ * The volume is divided in bricks of BrickSize pixels along each axis. The
+ * bricks where the initial level set crosses IsoSurfaceValue are found,
+ * and the filter is run on the bounding box of these bricks enlarged by
+ * Margin bricks. Its level set, feature image, speed image and status
+ * image are then allocated on this region only.
+ *
+ * The feature image is pulled from its pipeline one brick at a time, by
+ * setting its requested region, and the bricks are kept in a cache that
+ * grows with the region, so that each brick is computed once. Streaming
+ * readers then only read the bricks that are used.
+ *
+ * Every CheckInterval iterations the outer layer of bricks of the region
+ * is checked. When the front has entered it on a side that is not the
+ * border of the volume, the evolution is stopped, the region is enlarged
+ * around the bricks crossed by the front and the evolution goes on from
+ * the current level set, until NumberOfIterations iterations are done or
+ * the filter converges. The sparse field layers are rebuilt from the
+ * level set each time the region grows.
+ *
+ * The front is expected to stay close to the object: the memory used is
+ * that of the bounding box of the segmented object and its margin, not of
+ * the volume. The initial level set has to be given over the whole volume;
+ * a thresholded or binary image keeps it small.
+ *
+ * GetOutput() is the output of the filter, whose region starts at the
+ * index of the region of interest. The input image type of the filter has
+ * to hold the signed values of the level set, a float image.
+ *
+ * \ingroup LevelSetSegmentation
+ */
+template <class TLevelSetFilter, class TInitialImage>
+class ITK_EXPORT BrickedLevelSetEvolution : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef BrickedLevelSetEvolution    Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer<Self>          Pointer;
+  typedef SmartPointer<const Self>    ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(BrickedLevelSetEvolution, Object);
+
+  typedef TLevelSetFilter                              FilterType;
+  typedef TInitialImage                                InitialImageType;
+  typedef typename FilterType::InputImageType          InputImageType;
+  typedef typename FilterType::FeatureImageType        FeatureImageType;
+  typedef typename FilterType::OutputImageType         OutputImageType;
+  typedef typename OutputImageType::RegionType         RegionType;
+  typedef typename OutputImageType::IndexType          IndexType;
+  typedef typename OutputImageType::SizeType           SizeType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      OutputImageType::ImageDimension);
+
+  /** Level set filter with its parameters set. Its input and feature image
+   * are replaced by images of the region of interest. */
+  itkSetObjectMacro(Filter, FilterType);
+  itkGetObjectMacro(Filter, FilterType);
+
+  /** Initial level set over the whole volume, up to date */
+  itkSetConstObjectMacro(InitialImage, InitialImageType);
+
+  /** Isosurface of the initial level set */
+  itkSetMacro(IsoSurfaceValue, double);
+  itkGetConstMacro(IsoSurfaceValue, double);
+
+  /** Feature image, usually the output of a filter, over the whole volume.
+   * It does not need to be up to date. */
+  itkSetObjectMacro(FeatureImage, FeatureImageType);
+
+  itkSetMacro(BrickSize, unsigned int);
+  itkGetConstMacro(BrickSize, unsigned int);
+
+  /** Bricks added around the front on each side of the region */
+  itkSetMacro(Margin, unsigned int);
+  itkGetConstMacro(Margin, unsigned int);
+
+  /** Iterations for the whole evolution, 0 for those of the filter. The
+   * parameters of the filter are restored after Update(). */
+  itkSetMacro(NumberOfIterations, unsigned int);
+  itkGetConstMacro(NumberOfIterations, unsigned int);
+
+  /** Iterations between two checks of the border of the region */
+  itkSetMacro(CheckInterval, unsigned int);
+  itkGetConstMacro(CheckInterval, unsigned int);
+
+  /** Run the evolution. */
+  void Update();
+
+  /** Level set over the region of interest */
+  OutputImageType * GetOutput()
+    { return m_Filter->GetOutput(); }
+
+  /** New image of the whole volume with the output over the region of
+   * interest. Outside of it the level set has the sign of the initial
+   * level set and the value of the background of the sparse field. */
+  typename OutputImageType::Pointer MakeVolumeOutput() const;
+
+  /** Current region of interest */
+  const RegionType & GetRegion() const
+    { return m_Region; }
+
+  /** Iterations done over all the rounds */
+  itkGetConstMacro(ElapsedIterations, unsigned int);
+
+  /** Times the filter was run, one more each time the region grows */
+  itkGetConstMacro(NumberOfRounds, unsigned int);
+
+  /** Bricks of the feature image computed and cached */
+  itkGetConstMacro(NumberOfFeatureBricks, unsigned long);
+
+  /** Bricks of the whole volume */
+  unsigned long GetNumberOfBricks() const;
+
+  /** Drop the cached feature bricks, when the feature image changed */
+  void ReleaseFeatureCache();
+
+protected:
+  BrickedLevelSetEvolution();
+  virtual ~BrickedLevelSetEvolution() {}
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Range of bricks, as brick indices from first to last included */
+  typedef std::vector< IndexType >     BrickListType;
+
+  /** Pixels of a brick, clipped to the volume */
+  RegionType GetBrickRegion( const IndexType & brick ) const;
+
+  /** Bricks of the region, which is aligned on bricks */
+  void GetBricksOfRegion( const RegionType & region,
+                          IndexType & first, IndexType & last ) const;
+
+  /** True if the image crosses the value inside the region, including the
+   * pairs of pixels across its upper faces. */
+  template <class TImage>
+  static bool CrossesValue( const TImage * image, const RegionType & region,
+                            double value );
+
+  /** Bricks of the region where the image crosses the value */
+  template <class TImage>
+  void FindFrontBricks( const TImage * image, const RegionType & region,
+                        double value, BrickListType & bricks ) const;
+
+  /** Bounding box of the bricks, enlarged by Margin and clipped */
+  RegionType GetRegionOfBricks( const BrickListType & bricks ) const;
+
+  /** True if the front is in the outer bricks of the region on a side
+   * that is not the border of the volume. */
+  bool FrontReachesBorder( const OutputImageType * levelSet ) const;
+
+  /** Feature image over the region, from the cache and the pipeline */
+  void UpdateFeatureCache( const RegionType & region );
+
+  /** Initial level set of a round over the region: the previous level set
+   * where there is one, otherwise the initial level set of the volume. */
+  typename InputImageType::Pointer
+  MakeLevelSet( const RegionType & region, const OutputImageType * previous,
+                bool shift ) const;
+
+  /** Observer of the iterations of the filter */
+  void CheckFront();
+
+private:
+  BrickedLevelSetEvolution(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  typename FilterType::Pointer              m_Filter;
+  typename InitialImageType::ConstPointer   m_InitialImage;
+  typename FeatureImageType::Pointer        m_FeatureImage;
+
+  double                                    m_IsoSurfaceValue;
+  unsigned int                              m_BrickSize;
+  unsigned int                              m_Margin;
+  unsigned int                              m_NumberOfIterations;
+  unsigned int                              m_CheckInterval;
+
+  RegionType                                m_LargestRegion;
+  SizeType                                  m_GridSize;
+  RegionType                                m_Region;
+
+  /** Cached feature image over m_FeatureRegion, and the bricks of the
+   * volume it holds */
+  typename FeatureImageType::Pointer        m_FeatureCache;
+  RegionType                                m_FeatureRegion;
+  std::vector<bool>                         m_FeatureBricks;
+  unsigned long                             m_NumberOfFeatureBricks;
+
+  bool                                      m_FrontReachedBorder;
+  unsigned int                              m_ElapsedIterations;
+  unsigned int                              m_NumberOfRounds;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBrickedLevelSetEvolution.txx"
+#endif
+
+#endif
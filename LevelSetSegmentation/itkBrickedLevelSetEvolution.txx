@@ -0,0 +1,635 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkBrickedLevelSetEvolution.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkBrickedLevelSetEvolution_txx
+#define _itkBrickedLevelSetEvolution_txx
+
+#include "itkBrickedLevelSetEvolution.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+
+namespace BrickedLevelSetEvolutionHelpers
+{
+/** Next index of the box from first to last, in the order of the image
+ * iterators. Returns false after the last one. */
+template <class TIndex>
+inline bool NextIndex( TIndex & index, const TIndex & first,
+                       const TIndex & last, unsigned int dimension )
+{
+  for ( unsigned int d = 0; d < dimension; d++ )
+    {
+    if ( index[d] < last[d] )
+      {
+      index[d]++;
+      return true;
+      }
+    index[d] = first[d];
+    }
+  return false;
+}
+} // end namespace BrickedLevelSetEvolutionHelpers
+
+
+template <class TLevelSetFilter, class TInitialImage>
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::BrickedLevelSetEvolution()
+{
+  m_IsoSurfaceValue = 0.0;
+  m_BrickSize = 32;
+  m_Margin = 1;
+  m_NumberOfIterations = 0;
+  m_CheckInterval = 10;
+  m_GridSize.Fill( 0 );
+  m_NumberOfFeatureBricks = 0;
+  m_FrontReachedBorder = false;
+  m_ElapsedIterations = 0;
+  m_NumberOfRounds = 0;
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+unsigned long
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::GetNumberOfBricks() const
+{
+  unsigned long number = 1;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    number *= m_GridSize[d];
+    }
+  return number;
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+void
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::ReleaseFeatureCache()
+{
+  m_FeatureCache = 0;
+  m_FeatureRegion = RegionType();
+  m_FeatureBricks.assign( this->GetNumberOfBricks(), false );
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+typename BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>::RegionType
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::GetBrickRegion( const IndexType & brick ) const
+{
+  IndexType start;
+  SizeType  size;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const long offset = brick[d] * static_cast<long>( m_BrickSize );
+    const long length = static_cast<long>( m_LargestRegion.GetSize()[d] ) - offset;
+    start[d] = m_LargestRegion.GetIndex()[d] + offset;
+    size[d] = vnl_math_min( length, static_cast<long>( m_BrickSize ) );
+    }
+  RegionType region;
+  region.SetIndex( start );
+  region.SetSize( size );
+  return region;
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+void
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::GetBricksOfRegion( const RegionType & region,
+                     IndexType & first, IndexType & last ) const
+{
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const long start = region.GetIndex()[d] - m_LargestRegion.GetIndex()[d];
+    const long end = start + static_cast<long>( region.GetSize()[d] ) - 1;
+    first[d] = start / static_cast<long>( m_BrickSize );
+    last[d] = end / static_cast<long>( m_BrickSize );
+    }
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+template <class TImage>
+bool
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::CrossesValue( const TImage * image, const RegionType & region, double value )
+{
+  // one more pixel on the upper sides catches the crossings between bricks
+  RegionType extended = region;
+  SizeType size = region.GetSize();
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    size[d]++;
+    }
+  extended.SetSize( size );
+  extended.Crop( image->GetBufferedRegion() );
+
+  bool below = false;
+  bool above = false;
+  ImageRegionConstIterator< TImage > it( image, extended );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if ( static_cast<double>( it.Get() ) < value )
+      {
+      below = true;
+      }
+    else
+      {
+      above = true;
+      }
+    if ( below && above )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+template <class TImage>
+void
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::FindFrontBricks( const TImage * image, const RegionType & region,
+                   double value, BrickListType & bricks ) const
+{
+  bricks.clear();
+
+  IndexType first;
+  IndexType last;
+  this->GetBricksOfRegion( region, first, last );
+
+  IndexType brick = first;
+  do
+    {
+    RegionType brickRegion = this->GetBrickRegion( brick );
+    if ( brickRegion.Crop( region ) &&
+         CrossesValue( image, brickRegion, value ) )
+      {
+      bricks.push_back( brick );
+      }
+    }
+  while ( BrickedLevelSetEvolutionHelpers::NextIndex(
+                               brick, first, last, ImageDimension ) );
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+typename BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>::RegionType
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::GetRegionOfBricks( const BrickListType & bricks ) const
+{
+  IndexType first = bricks[0];
+  IndexType last = bricks[0];
+  for ( unsigned int b = 1; b < bricks.size(); b++ )
+    {
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      first[d] = vnl_math_min( first[d], bricks[b][d] );
+      last[d] = vnl_math_max( last[d], bricks[b][d] );
+      }
+    }
+
+  const long margin = m_Margin;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    first[d] = vnl_math_max( first[d] - margin, 0L );
+    last[d] = vnl_math_min( last[d] + margin,
+                            static_cast<long>( m_GridSize[d] ) - 1 );
+    }
+
+  RegionType region = this->GetBrickRegion( first );
+  const RegionType lastRegion = this->GetBrickRegion( last );
+  SizeType size;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    size[d] = lastRegion.GetIndex()[d] + lastRegion.GetSize()[d]
+                                       - region.GetIndex()[d];
+    }
+  region.SetSize( size );
+  return region;
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+bool
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::FrontReachesBorder( const OutputImageType * levelSet ) const
+{
+  IndexType first;
+  IndexType last;
+  this->GetBricksOfRegion( m_Region, first, last );
+
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    for ( unsigned int side = 0; side < 2; side++ )
+      {
+      // the border of the volume stops the front anyway
+      const long layer = side ? last[d] : first[d];
+      if ( layer == ( side ? static_cast<long>( m_GridSize[d] ) - 1 : 0 ) )
+        {
+        continue;
+        }
+
+      IndexType layerFirst = first;
+      IndexType layerLast = last;
+      layerFirst[d] = layer;
+      layerLast[d] = layer;
+
+      IndexType brick = layerFirst;
+      do
+        {
+        // only inside the brick: the margin bricks start without the front
+        const RegionType brickRegion = this->GetBrickRegion( brick );
+        ImageRegionConstIterator< OutputImageType > it( levelSet, brickRegion );
+        bool below = false;
+        bool above = false;
+        for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+          {
+          if ( it.Get() < 0.0 )
+            {
+            below = true;
+            }
+          else
+            {
+            above = true;
+            }
+          if ( below && above )
+            {
+            return true;
+            }
+          }
+        }
+      while ( BrickedLevelSetEvolutionHelpers::NextIndex(
+                            brick, layerFirst, layerLast, ImageDimension ) );
+      }
+    }
+  return false;
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+void
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::UpdateFeatureCache( const RegionType & region )
+{
+  if ( m_FeatureCache && m_FeatureRegion == region )
+    {
+    return;
+    }
+
+  typename FeatureImageType::Pointer cache = FeatureImageType::New();
+  cache->CopyInformation( m_FeatureImage );
+  cache->SetRegions( region );
+  cache->Allocate();
+
+  // keep the bricks already computed
+  if ( m_FeatureCache )
+    {
+    RegionType kept = m_FeatureRegion;
+    if ( kept.Crop( region ) )
+      {
+      ImageRegionConstIterator< FeatureImageType > in( m_FeatureCache, kept );
+      ImageRegionIterator< FeatureImageType > out( cache, kept );
+      for ( ; !in.IsAtEnd(); ++in, ++out )
+        {
+        out.Set( in.Get() );
+        }
+      }
+    }
+
+  IndexType first;
+  IndexType last;
+  this->GetBricksOfRegion( region, first, last );
+
+  std::vector<bool> cached( m_FeatureBricks.size(), false );
+  IndexType brick = first;
+  do
+    {
+    unsigned long offset = 0;
+    for ( int d = ImageDimension - 1; d >= 0; d-- )
+      {
+      offset = offset * m_GridSize[d] + brick[d];
+      }
+
+    const RegionType brickRegion = this->GetBrickRegion( brick );
+    if ( !m_FeatureBricks[offset] ||
+         !m_FeatureRegion.IsInside( brickRegion ) )
+      {
+      // pull the brick through the pipeline of the feature image
+      m_FeatureImage->SetRequestedRegion( brickRegion );
+      m_FeatureImage->Update();
+
+      ImageRegionConstIterator< FeatureImageType > in( m_FeatureImage, brickRegion );
+      ImageRegionIterator< FeatureImageType > out( cache, brickRegion );
+      for ( ; !in.IsAtEnd(); ++in, ++out )
+        {
+        out.Set( in.Get() );
+        }
+      m_NumberOfFeatureBricks++;
+      }
+    cached[offset] = true;
+    }
+  while ( BrickedLevelSetEvolutionHelpers::NextIndex(
+                               brick, first, last, ImageDimension ) );
+
+  // later updates of the pipeline compute the whole volume again
+  m_FeatureImage->SetRequestedRegionToLargestPossibleRegion();
+
+  m_FeatureCache = cache;
+  m_FeatureRegion = region;
+  m_FeatureBricks.swap( cached );
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+typename BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+                                               ::InputImageType::Pointer
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::MakeLevelSet( const RegionType & region, const OutputImageType * previous,
+                bool shift ) const
+{
+  typedef typename InputImageType::PixelType InputPixelType;
+
+  typename InputImageType::Pointer levelSet = InputImageType::New();
+  levelSet->CopyInformation( m_InitialImage );
+  levelSet->SetRegions( region );
+  levelSet->Allocate();
+
+  const double offset = shift ? m_IsoSurfaceValue : 0.0;
+  ImageRegionConstIterator< InitialImageType > in( m_InitialImage, region );
+  ImageRegionIterator< InputImageType > out( levelSet, region );
+  for ( ; !in.IsAtEnd(); ++in, ++out )
+    {
+    out.Set( static_cast<InputPixelType>(
+                          static_cast<double>( in.Get() ) - offset ) );
+    }
+
+  if ( previous )
+    {
+    const RegionType previousRegion = previous->GetBufferedRegion();
+    ImageRegionConstIterator< OutputImageType > pin( previous, previousRegion );
+    ImageRegionIterator< InputImageType > pout( levelSet, previousRegion );
+    for ( ; !pin.IsAtEnd(); ++pin, ++pout )
+      {
+      pout.Set( static_cast<InputPixelType>( pin.Get() ) );
+      }
+    }
+
+  return levelSet;
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+void
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::CheckFront()
+{
+  if ( m_CheckInterval == 0 ||
+       m_Filter->GetElapsedIterations() % m_CheckInterval != 0 )
+    {
+    return;
+    }
+
+  if ( this->FrontReachesBorder( m_Filter->GetOutput() ) )
+    {
+    // stop this round, the region is enlarged for the next one
+    m_FrontReachedBorder = true;
+    m_Filter->SetNumberOfIterations( m_Filter->GetElapsedIterations() );
+    }
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+void
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::Update()
+{
+  if ( !m_Filter || !m_InitialImage || !m_FeatureImage )
+    {
+    itkExceptionMacro( << "Filter, initial image and feature image must be set" );
+    }
+  if ( m_BrickSize == 0 )
+    {
+    itkExceptionMacro( << "BrickSize must be positive" );
+    }
+  m_Margin = vnl_math_max( m_Margin, 1U );
+
+  m_FeatureImage->UpdateOutputInformation();
+  const RegionType largestRegion = m_FeatureImage->GetLargestPossibleRegion();
+  if ( !m_InitialImage->GetBufferedRegion().IsInside( largestRegion ) )
+    {
+    itkExceptionMacro( << "The initial level set must be up to date over the volume" );
+    }
+
+  SizeType gridSize;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    gridSize[d] = ( largestRegion.GetSize()[d] + m_BrickSize - 1 ) / m_BrickSize;
+    }
+  if ( largestRegion != m_LargestRegion || gridSize != m_GridSize )
+    {
+    m_LargestRegion = largestRegion;
+    m_GridSize = gridSize;
+    this->ReleaseFeatureCache();
+    }
+
+  BrickListType bricks;
+  this->FindFrontBricks( m_InitialImage.GetPointer(), m_LargestRegion,
+                         m_IsoSurfaceValue, bricks );
+  if ( bricks.empty() )
+    {
+    itkExceptionMacro( << "The initial level set does not cross "
+                       << m_IsoSurfaceValue );
+    }
+  m_Region = this->GetRegionOfBricks( bricks );
+
+  // the filter gets its own parameters back at the end
+  const unsigned int filterIterations = m_Filter->GetNumberOfIterations();
+  const double filterIsoSurfaceValue = m_Filter->GetIsoSurfaceValue();
+  const unsigned int totalIterations =
+          m_NumberOfIterations ? m_NumberOfIterations : filterIterations;
+
+  typedef SimpleMemberCommand< Self > CommandType;
+  typename CommandType::Pointer command = CommandType::New();
+  command->SetCallbackFunction( this, &Self::CheckFront );
+  const unsigned long tag = m_Filter->AddObserver( IterationEvent(), command );
+  const unsigned int checkInterval = m_CheckInterval;
+
+  m_ElapsedIterations = 0;
+  m_NumberOfRounds = 0;
+  typename OutputImageType::Pointer previous;
+
+  try
+    {
+    while ( true )
+      {
+      this->UpdateFeatureCache( m_Region );
+
+      m_Filter->SetInput( this->MakeLevelSet( m_Region, previous,
+                                              m_NumberOfRounds > 0 ) );
+      m_Filter->SetFeatureImage( m_FeatureCache );
+      m_Filter->SetIsoSurfaceValue( m_NumberOfRounds > 0 ? 0.0 : m_IsoSurfaceValue );
+      m_Filter->SetNumberOfIterations( totalIterations - m_ElapsedIterations );
+      m_FrontReachedBorder = false;
+      // the requested region of the output is left from the previous
+      // round, smaller than the new region
+      m_Filter->UpdateLargestPossibleRegion();
+
+      m_ElapsedIterations += m_Filter->GetElapsedIterations();
+      m_NumberOfRounds++;
+
+      if ( !m_FrontReachedBorder || m_ElapsedIterations >= totalIterations )
+        {
+        break;
+        }
+
+      this->FindFrontBricks( m_Filter->GetOutput(), m_Region, 0.0, bricks );
+      RegionType region = bricks.empty() ? m_Region : this->GetRegionOfBricks( bricks );
+
+      // the region only grows
+      IndexType start;
+      SizeType size;
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        const long end = vnl_math_max(
+          region.GetIndex()[d] + static_cast<long>( region.GetSize()[d] ),
+          m_Region.GetIndex()[d] + static_cast<long>( m_Region.GetSize()[d] ) );
+        start[d] = vnl_math_min( region.GetIndex()[d], m_Region.GetIndex()[d] );
+        size[d] = end - start[d];
+        }
+      region.SetIndex( start );
+      region.SetSize( size );
+
+      if ( region == m_Region )
+        {
+        // nowhere to grow: finish without checking the border
+        m_CheckInterval = 0;
+        }
+
+      // keep the level set, the filter overwrites its output
+      previous = OutputImageType::New();
+      previous->CopyInformation( m_Filter->GetOutput() );
+      previous->SetRegions( m_Region );
+      previous->Allocate();
+      ImageRegionConstIterator< OutputImageType > in( m_Filter->GetOutput(), m_Region );
+      ImageRegionIterator< OutputImageType > out( previous, m_Region );
+      for ( ; !in.IsAtEnd(); ++in, ++out )
+        {
+        out.Set( in.Get() );
+        }
+
+      m_Region = region;
+      }
+    }
+  catch( ... )
+    {
+    m_CheckInterval = checkInterval;
+    m_Filter->RemoveObserver( tag );
+    m_Filter->SetNumberOfIterations( filterIterations );
+    m_Filter->SetIsoSurfaceValue( filterIsoSurfaceValue );
+    throw;
+    }
+
+  m_CheckInterval = checkInterval;
+  m_Filter->RemoveObserver( tag );
+  m_Filter->SetNumberOfIterations( filterIterations );
+  m_Filter->SetIsoSurfaceValue( filterIsoSurfaceValue );
+
+  // restoring the parameters modified the filter: its output is still the
+  // result of this evolution and must not be recomputed by the pipeline
+  m_Filter->GetOutput()->DataHasBeenGenerated();
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+typename BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+                                               ::OutputImageType::Pointer
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::MakeVolumeOutput() const
+{
+  typedef typename OutputImageType::PixelType OutputPixelType;
+
+  const OutputImageType * output = m_Filter->GetOutput();
+
+  typename OutputImageType::Pointer volume = OutputImageType::New();
+  volume->CopyInformation( output );
+  volume->SetRegions( m_LargestRegion );
+  volume->Allocate();
+
+  // a corner of the volume outside of the region, where the initial level
+  // set has the sign of everything outside of the region
+  IndexType corner = m_LargestRegion.GetIndex();
+  bool outside = false;
+  for ( unsigned int d = 0; d < ImageDimension && !outside; d++ )
+    {
+    const long end = m_LargestRegion.GetIndex()[d]
+                   + static_cast<long>( m_LargestRegion.GetSize()[d] );
+    if ( m_Region.GetIndex()[d] > m_LargestRegion.GetIndex()[d] )
+      {
+      outside = true;
+      }
+    else if ( m_Region.GetIndex()[d] + static_cast<long>( m_Region.GetSize()[d] ) < end )
+      {
+      corner[d] = end - 1;
+      outside = true;
+      }
+    }
+
+  if ( outside )
+    {
+    const double background = m_Filter->GetNumberOfLayers() + 1.0;
+    const bool below =
+      static_cast<double>( m_InitialImage->GetPixel( corner ) ) < m_IsoSurfaceValue;
+    volume->FillBuffer( static_cast<OutputPixelType>( below ? -background : background ) );
+    }
+
+  ImageRegionConstIterator< OutputImageType > in( output, m_Region );
+  ImageRegionIterator< OutputImageType > out( volume, m_Region );
+  for ( ; !in.IsAtEnd(); ++in, ++out )
+    {
+    out.Set( in.Get() );
+    }
+
+  return volume;
+}
+
+
+template <class TLevelSetFilter, class TInitialImage>
+void
+BrickedLevelSetEvolution<TLevelSetFilter, TInitialImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+  os << indent << "IsoSurfaceValue: " << m_IsoSurfaceValue << std::endl;
+  os << indent << "BrickSize: " << m_BrickSize << std::endl;
+  os << indent << "Margin: " << m_Margin << std::endl;
+  os << indent << "NumberOfIterations: " << m_NumberOfIterations << std::endl;
+  os << indent << "CheckInterval: " << m_CheckInterval << std::endl;
+  os << indent << "Region: " << m_Region << std::endl;
+  os << indent << "ElapsedIterations: " << m_ElapsedIterations << std::endl;
+  os << indent << "NumberOfRounds: " << m_NumberOfRounds << std::endl;
+  os << indent << "NumberOfFeatureBricks: " << m_NumberOfFeatureBricks << std::endl;
+}
+
+} // end namespace itk
+
+#endif
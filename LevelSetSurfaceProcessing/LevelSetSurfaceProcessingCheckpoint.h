@@ -0,0 +1,126 @@
+#ifndef _LevelSetSurfaceProcessingCheckpoint_h
+#define _LevelSetSurfaceProcessingCheckpoint_h
+
+// Checkpoint options shared by the surface processing examples:
+//
+//   -checkpoint file period   write the level set to file every period
+//                             iterations (0: only at the end)
+//   -resume file              start from the level set of a checkpoint
+//                             instead of the input volume
+//
+// number_of_iterations counts from the original input, so resuming with a
+// larger number continues the evolution by the difference.
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkLevelSetCheckpoint.h"
+#include "itkLevelSetCheckpointCommand.h"
+
+struct LevelSetSurfaceProcessingCheckpoint
+{
+  std::string  CheckpointFileName;
+  unsigned int Period;
+  std::string  ResumeFileName;
+
+  LevelSetSurfaceProcessingCheckpoint() : Period( 0 ) {}
+
+  static const char * Usage()
+    {
+    return " [-checkpoint file period] [-resume file]";
+    }
+
+  // Parse the options from argv[first] on, false on an unknown option.
+  bool Parse( int argc, char **argv, int first )
+    {
+    for ( int i = first; i < argc; i++ )
+      {
+      const std::string option( argv[i] );
+      if ( option == "-checkpoint" && i + 2 < argc )
+        {
+        CheckpointFileName = argv[++i];
+        Period = ::atoi( argv[++i] );
+        }
+      else if ( option == "-resume" && i + 1 < argc )
+        {
+        ResumeFileName = argv[++i];
+        }
+      else
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+
+  // Run the filter, whose parameters are set, from the input volume or the
+  // checkpoint to resume, and write the output volume.
+  template <class TFilter>
+  int Run( TFilter * filter, const char * inputFileName,
+           const char * outputFileName, unsigned int numberOfIterations )
+    {
+    typedef typename TFilter::OutputImageType        ImageType;
+    typedef itk::ImageFileReader < ImageType >       FileReaderType;
+    typedef itk::ImageFileWriter < ImageType >       FileWriterType;
+    typedef itk::LevelSetCheckpoint < ImageType >    CheckpointType;
+    typedef itk::LevelSetCheckpointCommand < TFilter > CommandType;
+
+    typename CommandType::Pointer command = CommandType::New();
+    command->SetFileName( CheckpointFileName.c_str() );
+    command->SetPeriod( Period );
+    filter->AddObserver( itk::StartEvent(), command );
+    filter->AddObserver( itk::IterationEvent(), command );
+
+    typename FileReaderType::Pointer reader = FileReaderType::New();
+    typename CheckpointType::Pointer checkpoint = CheckpointType::New();
+    unsigned long elapsedIterations = 0;
+
+    try
+      {
+      if ( ResumeFileName.empty() )
+        {
+        reader->SetFileName( inputFileName );
+        filter->SetInput( reader->GetOutput() );
+        }
+      else
+        {
+        // the saved level set has its isosurface at 0
+        checkpoint->Read( ResumeFileName );
+        elapsedIterations = checkpoint->GetElapsedIterations();
+        filter->SetInput( checkpoint->GetLevelSet() );
+        filter->SetIsoSurfaceValue( 0.0 );
+        std::cout << "Resuming from iteration " << elapsedIterations
+                  << " of " << ResumeFileName << std::endl;
+        }
+
+      command->SetIterationOffset( elapsedIterations );
+      filter->SetMaxFilterIteration( numberOfIterations > elapsedIterations ?
+                                     numberOfIterations - elapsedIterations : 0 );
+
+      typename FileWriterType::Pointer writer = FileWriterType::New();
+      writer->SetFileName( outputFileName );
+      writer->SetInput( filter->GetOutput() );
+      writer->Update();
+
+      // the last state, to continue with more iterations later
+      if ( !CheckpointFileName.empty() )
+        {
+        command->WriteCheckpoint( filter );
+        }
+      }
+    catch (itk::ExceptionObject &e)
+      {
+      std::cerr << e << std::endl;
+      return 1;
+      }
+
+    std::cout << "Iterations: "
+              << elapsedIterations + filter->GetElapsedIterations() << std::endl;
+    command->Report( std::cout );
+    return 0;
+    }
+};
+
+#endif
@@ -1,6 +1,5 @@
 #include <iostream>
-#include "itkImageFileReader.h"
-#include "itkImageFileWriter.h"
+#include "LevelSetSurfaceProcessingCheckpoint.h"
 #include "itkUnsharpMaskLevelSetImageFilter.h"
 
 int main( int argc, char **argv )
@@ -11,40 +10,26 @@ int main( int argc, char **argv )
       std::cerr << "Usage: " << argv[0];
       std::cerr <<
         " inputVolume outputVolume isosurface_value number_of_iterations unsharp_mask_weight"
-                << std::endl;
+                << LevelSetSurfaceProcessingCheckpoint::Usage() << std::endl;
       return 1;
     }
  
   typedef float PixelType;
   typedef itk::Image < PixelType, 3 >  ImageType;
-  typedef itk::ImageFileReader < ImageType > FileReaderType;
-  typedef itk::ImageFileWriter < ImageType > FileWriterType;
   typedef itk::UnsharpMaskLevelSetImageFilter
     <ImageType, ImageType> FilterType;
   
   FilterType::Pointer filter = FilterType::New();
 
   filter->SetIsoSurfaceValue( atof(argv[3]) );
-  filter->SetMaxFilterIteration( atoi(argv[4]) );
   filter->SetNormalProcessUnsharpWeight( ::atof (argv[5]) );
   
-  FileReaderType::Pointer reader = FileReaderType::New();
-  reader->SetFileName(argv[1]);
-   
-  FileWriterType::Pointer writer = FileWriterType::New();
-  writer->SetFileName(argv[2]);
-  
-  filter->SetInput(reader->GetOutput());
-  writer->SetInput(filter->GetOutput());
-  
-  try {
-    writer->Update();
-  }
-  catch (itk::ExceptionObject &e)
+  LevelSetSurfaceProcessingCheckpoint checkpoint;
+  if ( !checkpoint.Parse( argc, argv, 6 ) )
     {
-      std::cerr << e << std::endl;
+      std::cerr << "Unknown option" << std::endl;
+      return 1;
     }
- 
- 
-  return 0;
+
+  return checkpoint.Run( filter.GetPointer(), argv[1], argv[2], ::atoi(argv[4]) );
 }
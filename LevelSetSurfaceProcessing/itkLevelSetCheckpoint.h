@@ -0,0 +1,135 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkLevelSetCheckpoint.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkLevelSetCheckpoint_h
+#define _itkLevelSetCheckpoint_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <string>
+
+namespace itk
+{
+
+/** \class LevelSetCheckpoint
+ *
+ * Saves and restores the state of a sparse field level set evolution in a
+ * compact file.
+ *
+ * The output of a SparseFieldLevelSetImageFilter holds meaningful values
+ * only in its layers, the pixels whose absolute value is below
+ * (NumberOfLayers + 1/2) ConstantGradientValue; the other pixels only
+ * carry the sign of the level set. The file therefore stores the image
+ * information, the number of elapsed iterations, the sign of every pixel
+ * as run lengths, and the offset and value of the pixels of the layers.
+ * The layer of a pixel is the nearest integer of its value divided by
+ * ConstantGradientValue. For a surface in a volume this is a small
+ * fraction of the dense image.
+ *
+ * Read() rebuilds a dense level set with the layer values and, outside of
+ * them, -(NumberOfLayers + 1) ConstantGradientValue inside and
+ * (NumberOfLayers + 1) ConstantGradientValue outside, which is what the
+ * filter itself assigns to its background. Feeding it back to
+ * a filter of the same kind, with an isosurface value of 0, restarts the
+ * evolution from the saved zero set; the filter rebuilds its layers from
+ * it instead of from the original initial level set.
+ *
+ * The file is first written next to the requested one and then renamed, so
+ * that an interrupted write leaves the previous checkpoint intact.
+ *
+ * \ingroup LevelSetSegmentation
+ */
+template <class TLevelSet>
+class ITK_EXPORT LevelSetCheckpoint : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef LevelSetCheckpoint          Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer<Self>          Pointer;
+  typedef SmartPointer<const Self>    ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(LevelSetCheckpoint, Object);
+
+  typedef TLevelSet                               LevelSetType;
+  typedef typename LevelSetType::Pointer          LevelSetPointer;
+  typedef typename LevelSetType::PixelType        PixelType;
+  typedef typename LevelSetType::RegionType       RegionType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      LevelSetType::ImageDimension);
+
+  /** Half width of the band that is stored, in layers. Set it to the
+   * NumberOfLayers of the filter before writing; it is read back from the
+   * file. */
+  itkSetMacro(NumberOfLayers, unsigned int);
+  itkGetConstMacro(NumberOfLayers, unsigned int);
+
+  /** Distance between two layers: 1 for a filter that does not use the
+   * image spacing, the smallest spacing otherwise. Set it like the filter
+   * before writing; it is read back from the file. */
+  itkSetMacro(ConstantGradientValue, double);
+  itkGetConstMacro(ConstantGradientValue, double);
+
+  /** Iterations done to reach the saved level set */
+  itkSetMacro(ElapsedIterations, unsigned long);
+  itkGetConstMacro(ElapsedIterations, unsigned long);
+
+  /** Write the level set, whose isosurface is at 0, to the file. */
+  void Write( const LevelSetType * levelSet, const std::string & fileName );
+
+  /** Read the file and rebuild the level set. */
+  void Read( const std::string & fileName );
+
+  /** Level set rebuilt by the last Read() */
+  LevelSetType * GetLevelSet()
+    { return m_LevelSet.GetPointer(); }
+
+  /** Number of pixels of the layers in the last file written or read */
+  itkGetConstMacro(NumberOfBandPixels, unsigned long);
+
+  /** Size in bytes of the last file written or read */
+  itkGetConstMacro(FileSize, unsigned long);
+
+protected:
+  LevelSetCheckpoint();
+  virtual ~LevelSetCheckpoint() {}
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+private:
+  LevelSetCheckpoint(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  unsigned int        m_NumberOfLayers;
+  double              m_ConstantGradientValue;
+  unsigned long       m_ElapsedIterations;
+  unsigned long       m_NumberOfBandPixels;
+  unsigned long       m_FileSize;
+  LevelSetPointer     m_LevelSet;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetCheckpoint.txx"
+#endif
+
+#endif
@@ -0,0 +1,325 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkLevelSetCheckpoint.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkLevelSetCheckpoint_txx
+#define _itkLevelSetCheckpoint_txx
+
+#include "itkLevelSetCheckpoint.h"
+
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+namespace itk
+{
+
+namespace LevelSetCheckpointFile
+{
+const char         Magic[8] = { 'I', 'T', 'K', 'L', 'S', 'C', 'P', '2' };
+const unsigned int ByteOrderMark = 0x01020304;
+
+template <class T>
+inline void WriteValue( std::ostream & os, const T & value )
+{
+  os.write( reinterpret_cast<const char *>( &value ), sizeof(T) );
+}
+
+template <class T>
+inline void ReadValue( std::istream & is, T & value )
+{
+  is.read( reinterpret_cast<char *>( &value ), sizeof(T) );
+}
+
+template <class T>
+inline void WriteArray( std::ostream & os, const std::vector<T> & values )
+{
+  const unsigned int n = values.size();
+  WriteValue( os, n );
+  if ( n > 0 )
+    {
+    os.write( reinterpret_cast<const char *>( &values[0] ), n * sizeof(T) );
+    }
+}
+
+template <class T>
+inline void ReadArray( std::istream & is, std::vector<T> & values )
+{
+  unsigned int n = 0;
+  ReadValue( is, n );
+  values.resize( n );
+  if ( n > 0 )
+    {
+    is.read( reinterpret_cast<char *>( &values[0] ), n * sizeof(T) );
+    }
+}
+} // end namespace LevelSetCheckpointFile
+
+
+template <class TLevelSet>
+LevelSetCheckpoint<TLevelSet>
+::LevelSetCheckpoint()
+{
+  m_NumberOfLayers = 2;
+  m_ConstantGradientValue = 1.0;
+  m_ElapsedIterations = 0;
+  m_NumberOfBandPixels = 0;
+  m_FileSize = 0;
+}
+
+
+template <class TLevelSet>
+void
+LevelSetCheckpoint<TLevelSet>
+::Write( const LevelSetType * levelSet, const std::string & fileName )
+{
+  using namespace LevelSetCheckpointFile;
+
+  if ( !levelSet )
+    {
+    itkExceptionMacro( << "No level set to write" );
+    }
+
+  const RegionType region = levelSet->GetBufferedRegion();
+  const unsigned long numberOfPixels = region.GetNumberOfPixels();
+  const PixelType * buffer = levelSet->GetBufferPointer();
+  const double bandLimit = ( m_NumberOfLayers + 0.5 ) * m_ConstantGradientValue;
+
+  // Sign of the pixels as alternate runs of outside and inside pixels,
+  // starting with outside, and the pixels of the layers with the offset
+  // from the previous one.
+  std::vector<unsigned int> runs;
+  std::vector<unsigned int> offsets;
+  std::vector<float>        values;
+
+  bool inside = false;
+  unsigned int run = 0;
+  unsigned long previous = 0;
+  for ( unsigned long i = 0; i < numberOfPixels; ++i )
+    {
+    const double value = static_cast<double>( buffer[i] );
+    if ( ( value < 0.0 ) != inside )
+      {
+      runs.push_back( run );
+      run = 0;
+      inside = !inside;
+      }
+    ++run;
+
+    if ( value <= bandLimit && value >= -bandLimit )
+      {
+      offsets.push_back( static_cast<unsigned int>( i - previous ) );
+      values.push_back( static_cast<float>( value ) );
+      previous = i;
+      }
+    }
+  runs.push_back( run );
+
+  const std::string partName = fileName + ".part";
+  std::ofstream os( partName.c_str(), std::ios::out | std::ios::binary );
+  if ( !os )
+    {
+    itkExceptionMacro( << "Cannot write checkpoint " << partName );
+    }
+
+  os.write( Magic, sizeof(Magic) );
+  WriteValue( os, ByteOrderMark );
+  WriteValue( os, static_cast<unsigned int>( ImageDimension ) );
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    WriteValue( os, static_cast<int>( region.GetIndex()[d] ) );
+    WriteValue( os, static_cast<unsigned int>( region.GetSize()[d] ) );
+    WriteValue( os, static_cast<double>( levelSet->GetSpacing()[d] ) );
+    WriteValue( os, static_cast<double>( levelSet->GetOrigin()[d] ) );
+    for ( unsigned int e = 0; e < ImageDimension; e++ )
+      {
+      WriteValue( os, static_cast<double>( levelSet->GetDirection()[d][e] ) );
+      }
+    }
+  WriteValue( os, m_NumberOfLayers );
+  WriteValue( os, m_ConstantGradientValue );
+  WriteValue( os, static_cast<unsigned int>( m_ElapsedIterations ) );
+  WriteArray( os, runs );
+  WriteArray( os, offsets );
+  WriteArray( os, values );
+
+  m_FileSize = os.tellp();
+  const bool failed = os.fail();
+  os.close();
+  if ( failed )
+    {
+    std::remove( partName.c_str() );
+    itkExceptionMacro( << "Error while writing checkpoint " << partName );
+    }
+
+  // rename() does not replace an existing file on every platform
+  std::remove( fileName.c_str() );
+  if ( std::rename( partName.c_str(), fileName.c_str() ) != 0 )
+    {
+    itkExceptionMacro( << "Cannot rename " << partName << " to " << fileName );
+    }
+
+  m_NumberOfBandPixels = values.size();
+}
+
+
+template <class TLevelSet>
+void
+LevelSetCheckpoint<TLevelSet>
+::Read( const std::string & fileName )
+{
+  using namespace LevelSetCheckpointFile;
+
+  std::ifstream is( fileName.c_str(), std::ios::in | std::ios::binary );
+  if ( !is )
+    {
+    itkExceptionMacro( << "Cannot read checkpoint " << fileName );
+    }
+
+  char magic[sizeof(Magic)];
+  is.read( magic, sizeof(magic) );
+  unsigned int byteOrderMark = 0;
+  ReadValue( is, byteOrderMark );
+  unsigned int dimension = 0;
+  ReadValue( is, dimension );
+  if ( !is || std::memcmp( magic, Magic, sizeof(Magic) ) != 0 )
+    {
+    itkExceptionMacro( << fileName << " is not a level set checkpoint" );
+    }
+  if ( byteOrderMark != ByteOrderMark )
+    {
+    itkExceptionMacro( << fileName << " was written with another byte order" );
+    }
+  if ( dimension != ImageDimension )
+    {
+    itkExceptionMacro( << fileName << " holds a level set of dimension "
+                       << dimension << " instead of " << ImageDimension );
+    }
+
+  typename RegionType::IndexType index;
+  typename RegionType::SizeType  size;
+  typename LevelSetType::SpacingType   spacing;
+  typename LevelSetType::PointType     origin;
+  typename LevelSetType::DirectionType direction;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    int start = 0;
+    unsigned int length = 0;
+    double value = 0.0;
+    ReadValue( is, start );
+    ReadValue( is, length );
+    index[d] = start;
+    size[d] = length;
+    ReadValue( is, value );
+    spacing[d] = value;
+    ReadValue( is, value );
+    origin[d] = value;
+    for ( unsigned int e = 0; e < ImageDimension; e++ )
+      {
+      ReadValue( is, value );
+      direction[d][e] = value;
+      }
+    }
+  unsigned int elapsedIterations = 0;
+  ReadValue( is, m_NumberOfLayers );
+  ReadValue( is, m_ConstantGradientValue );
+  ReadValue( is, elapsedIterations );
+  m_ElapsedIterations = elapsedIterations;
+
+  std::vector<unsigned int> runs;
+  std::vector<unsigned int> offsets;
+  std::vector<float>        values;
+  ReadArray( is, runs );
+  ReadArray( is, offsets );
+  ReadArray( is, values );
+  if ( !is || offsets.size() != values.size() )
+    {
+    itkExceptionMacro( << "Checkpoint " << fileName << " is truncated" );
+    }
+  m_FileSize = is.tellg();
+
+  RegionType region;
+  region.SetIndex( index );
+  region.SetSize( size );
+
+  m_LevelSet = LevelSetType::New();
+  m_LevelSet->SetRegions( region );
+  m_LevelSet->SetSpacing( spacing );
+  m_LevelSet->SetOrigin( origin );
+  m_LevelSet->SetDirection( direction );
+  m_LevelSet->Allocate();
+
+  const unsigned long numberOfPixels = region.GetNumberOfPixels();
+  PixelType * buffer = m_LevelSet->GetBufferPointer();
+
+  // background of the sparse field filters
+  const PixelType outsideValue = static_cast<PixelType>(
+                          ( m_NumberOfLayers + 1 ) * m_ConstantGradientValue );
+  const PixelType insideValue = -outsideValue;
+
+  unsigned long i = 0;
+  bool inside = false;
+  for ( unsigned int r = 0; r < runs.size(); r++ )
+    {
+    const unsigned long end = i + runs[r];
+    if ( end > numberOfPixels )
+      {
+      itkExceptionMacro( << "Checkpoint " << fileName << " is corrupted" );
+      }
+    const PixelType value = inside ? insideValue : outsideValue;
+    for ( ; i < end; ++i )
+      {
+      buffer[i] = value;
+      }
+    inside = !inside;
+    }
+  if ( i != numberOfPixels )
+    {
+    itkExceptionMacro( << "Checkpoint " << fileName << " is corrupted" );
+    }
+
+  unsigned long offset = 0;
+  for ( unsigned int p = 0; p < offsets.size(); p++ )
+    {
+    offset += offsets[p];
+    if ( offset >= numberOfPixels )
+      {
+      itkExceptionMacro( << "Checkpoint " << fileName << " is corrupted" );
+      }
+    buffer[offset] = static_cast<PixelType>( values[p] );
+    }
+
+  m_NumberOfBandPixels = values.size();
+}
+
+
+template <class TLevelSet>
+void
+LevelSetCheckpoint<TLevelSet>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+  os << indent << "NumberOfLayers: " << m_NumberOfLayers << std::endl;
+  os << indent << "ConstantGradientValue: " << m_ConstantGradientValue
+     << std::endl;
+  os << indent << "ElapsedIterations: " << m_ElapsedIterations << std::endl;
+  os << indent << "NumberOfBandPixels: " << m_NumberOfBandPixels << std::endl;
+  os << indent << "FileSize: " << m_FileSize << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,124 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkLevelSetCheckpointCommand.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkLevelSetCheckpointCommand_h
+#define _itkLevelSetCheckpointCommand_h
+
+#include "itkCommand.h"
+#include "itkRealTimeClock.h"
+#include "itkLevelSetCheckpoint.h"
+
+#include <iostream>
+#include <string>
+
+namespace itk
+{
+
+/** \class LevelSetCheckpointCommand
+ *
+ * Observer of a sparse field level set filter that writes a
+ * LevelSetCheckpoint of its output every Period iterations, and times the
+ * iterations and the checkpoints.
+ *
+ * Add it to the filter for the StartEvent and the IterationEvent. The
+ * iteration time runs from one IterationEvent to the next, without the
+ * initialization of the filter and without the checkpoints, so that
+ * Report() gives the cost of a checkpoint against the cost of an
+ * iteration. IterationOffset is added to the elapsed iterations of the
+ * filter, for evolutions resumed from a checkpoint.
+ *
+ * A checkpoint that fails during the evolution is reported on std::cerr
+ * and does not stop the filter; WriteCheckpoint() called directly throws.
+ *
+ * \ingroup LevelSetSegmentation
+ */
+template <class TFilter>
+class ITK_EXPORT LevelSetCheckpointCommand : public Command
+{
+public:
+  /** Standard class typedefs. */
+  typedef LevelSetCheckpointCommand   Self;
+  typedef Command                     Superclass;
+  typedef SmartPointer<Self>          Pointer;
+  typedef SmartPointer<const Self>    ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(LevelSetCheckpointCommand, Command);
+
+  typedef TFilter                                   FilterType;
+  typedef typename FilterType::OutputImageType      LevelSetType;
+  typedef LevelSetCheckpoint<LevelSetType>          CheckpointType;
+
+  void Execute(Object *caller, const EventObject & event);
+  void Execute(const Object *caller, const EventObject & event);
+
+  /** File the checkpoints are written to. Each one replaces the previous. */
+  itkSetStringMacro(FileName);
+  itkGetStringMacro(FileName);
+
+  /** Iterations between two checkpoints; 0 writes none. */
+  itkSetMacro(Period, unsigned int);
+  itkGetConstMacro(Period, unsigned int);
+
+  /** Iterations done before the filter started */
+  itkSetMacro(IterationOffset, unsigned long);
+  itkGetConstMacro(IterationOffset, unsigned long);
+
+  /** Write a checkpoint of the current output of the filter now. */
+  void WriteCheckpoint( FilterType * filter );
+
+  itkGetConstMacro(NumberOfCheckpoints, unsigned long);
+
+  /** Mean times in seconds, 0 when nothing was timed */
+  double GetMeanIterationTime() const;
+  double GetMeanCheckpointTime() const;
+
+  /** Iteration and checkpoint times, and size of the last checkpoint */
+  void Report( std::ostream & os ) const;
+
+protected:
+  LevelSetCheckpointCommand();
+  virtual ~LevelSetCheckpointCommand() {}
+
+private:
+  LevelSetCheckpointCommand(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  std::string                       m_FileName;
+  unsigned int                      m_Period;
+  unsigned long                     m_IterationOffset;
+
+  typename CheckpointType::Pointer  m_Checkpoint;
+  RealTimeClock::Pointer            m_Clock;
+
+  bool                              m_Timing;
+  double                            m_LastTime;
+  double                            m_IterationTime;
+  unsigned long                     m_NumberOfTimedIterations;
+  double                            m_CheckpointTime;
+  unsigned long                     m_NumberOfCheckpoints;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLevelSetCheckpointCommand.txx"
+#endif
+
+#endif
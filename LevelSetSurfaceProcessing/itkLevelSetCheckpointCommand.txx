@@ -0,0 +1,193 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkLevelSetCheckpointCommand.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkLevelSetCheckpointCommand_txx
+#define _itkLevelSetCheckpointCommand_txx
+
+#include "itkLevelSetCheckpointCommand.h"
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+
+template <class TFilter>
+LevelSetCheckpointCommand<TFilter>
+::LevelSetCheckpointCommand()
+{
+  m_Period = 0;
+  m_IterationOffset = 0;
+  m_Checkpoint = CheckpointType::New();
+  m_Clock = RealTimeClock::New();
+  m_Timing = false;
+  m_LastTime = 0.0;
+  m_IterationTime = 0.0;
+  m_NumberOfTimedIterations = 0;
+  m_CheckpointTime = 0.0;
+  m_NumberOfCheckpoints = 0;
+}
+
+
+template <class TFilter>
+void
+LevelSetCheckpointCommand<TFilter>
+::Execute(Object *caller, const EventObject & event)
+{
+  FilterType * filter = dynamic_cast<FilterType *>( caller );
+  if ( !filter )
+    {
+    return;
+    }
+
+  const double now = m_Clock->GetTimeStamp();
+
+  // the first iteration would include the initialization of the filter
+  if ( StartEvent().CheckEvent( &event ) )
+    {
+    m_Timing = false;
+    return;
+    }
+
+  if ( !IterationEvent().CheckEvent( &event ) )
+    {
+    return;
+    }
+
+  if ( m_Timing )
+    {
+    m_IterationTime += now - m_LastTime;
+    m_NumberOfTimedIterations++;
+    }
+
+  const unsigned long iteration =
+                          m_IterationOffset + filter->GetElapsedIterations();
+  if ( m_Period > 0 && !m_FileName.empty() && iteration % m_Period == 0 )
+    {
+    try
+      {
+      this->WriteCheckpoint( filter );
+      }
+    catch( ExceptionObject & excep )
+      {
+      std::cerr << "Checkpoint at iteration " << iteration
+                << " failed: " << excep << std::endl;
+      }
+    }
+
+  m_LastTime = m_Clock->GetTimeStamp();
+  m_Timing = true;
+}
+
+
+template <class TFilter>
+void
+LevelSetCheckpointCommand<TFilter>
+::Execute(const Object *, const EventObject &)
+{
+  // the output of a const filter cannot be reached
+}
+
+
+template <class TFilter>
+void
+LevelSetCheckpointCommand<TFilter>
+::WriteCheckpoint( FilterType * filter )
+{
+  const double start = m_Clock->GetTimeStamp();
+
+  m_Checkpoint->SetNumberOfLayers( filter->GetNumberOfLayers() );
+
+  // layer spacing of the filter, see SparseFieldLevelSetImageFilter
+  double constantGradientValue = 1.0;
+  if ( filter->GetUseImageSpacing() )
+    {
+    const typename LevelSetType::SpacingType & spacing =
+                                          filter->GetOutput()->GetSpacing();
+    constantGradientValue = spacing[0];
+    for ( unsigned int d = 1; d < spacing.Size(); d++ )
+      {
+      constantGradientValue = vnl_math_min( constantGradientValue,
+                                            static_cast<double>( spacing[d] ) );
+      }
+    }
+  m_Checkpoint->SetConstantGradientValue( constantGradientValue );
+  m_Checkpoint->SetElapsedIterations(
+                          m_IterationOffset + filter->GetElapsedIterations() );
+  m_Checkpoint->Write( filter->GetOutput(), m_FileName );
+
+  m_CheckpointTime += m_Clock->GetTimeStamp() - start;
+  m_NumberOfCheckpoints++;
+}
+
+
+template <class TFilter>
+double
+LevelSetCheckpointCommand<TFilter>
+::GetMeanIterationTime() const
+{
+  if ( m_NumberOfTimedIterations == 0 )
+    {
+    return 0.0;
+    }
+  return m_IterationTime / m_NumberOfTimedIterations;
+}
+
+
+template <class TFilter>
+double
+LevelSetCheckpointCommand<TFilter>
+::GetMeanCheckpointTime() const
+{
+  if ( m_NumberOfCheckpoints == 0 )
+    {
+    return 0.0;
+    }
+  return m_CheckpointTime / m_NumberOfCheckpoints;
+}
+
+
+template <class TFilter>
+void
+LevelSetCheckpointCommand<TFilter>
+::Report( std::ostream & os ) const
+{
+  const double iterationTime = this->GetMeanIterationTime();
+  const double checkpointTime = this->GetMeanCheckpointTime();
+
+  os << "Iterations timed: " << m_NumberOfTimedIterations
+     << ", mean " << iterationTime << " s" << std::endl;
+  os << "Checkpoints: " << m_NumberOfCheckpoints;
+  if ( m_NumberOfCheckpoints > 0 )
+    {
+    os << ", mean " << checkpointTime << " s";
+    if ( iterationTime > 0.0 )
+      {
+      os << " (" << checkpointTime / iterationTime << " iterations";
+      if ( m_Period > 0 )
+        {
+        os << ", " << 100.0 * checkpointTime / ( m_Period * iterationTime )
+           << "% overhead every " << m_Period << " iterations";
+        }
+      os << ")";
+      }
+    os << ", last one " << m_Checkpoint->GetFileSize() << " bytes with "
+       << m_Checkpoint->GetNumberOfBandPixels() << " pixels in the layers";
+    }
+  os << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -26,10 +26,6 @@ ConfidenceConnectedModule
 
   m_SmoothingFilter             =   SmoothingFilterType::New();
 
-  m_ConfidenceConnectedFilter   =   ConnectedFilterType::New();
-
-  m_ConfidenceConnectedFilter->SetInput( m_SmoothingFilter->GetOutput() );
-
 
   /*  Define reasonable defaults for the parameters */
   m_SmoothingIterations = 20 ;
@@ -38,13 +34,11 @@ ConfidenceConnectedModule
   m_NumberOfIterations = 10;
   m_InitialNeighborhoodRadius = 2;
 
-  m_ConfidenceConnectedFilter->SetReplaceValue( 255 );
+  m_RegionGrowing.SetReplaceValue( 255 );
 
-  // Allow filter to release data as the execution of
-  // pipeline progresses from filter to filter.
-  // This reduces memory consumption
-  m_SmoothingFilter->ReleaseDataFlagOn();
-  m_ConfidenceConnectedFilter->ReleaseDataFlagOn();
+  // The smoothed image is kept between executions, it is only
+  // computed again when the input or the smoothing parameters change.
+  m_SmoothingFilter->ReleaseDataFlagOff();
 
 }
 
@@ -73,7 +67,7 @@ const ConfidenceConnectedModule::OutputImageType *
 ConfidenceConnectedModule
 ::GetOutput()
 {
-   return m_ConfidenceConnectedFilter->GetOutput();
+   return m_RegionGrowing.GetOutput();
 }
 
 
@@ -88,7 +82,22 @@ ConfidenceConnectedModule
    SeedPoint[0] = x;
    SeedPoint[1] = y;
    SeedPoint[2] = z;
-   m_ConfidenceConnectedFilter->SetSeed( SeedPoint );
+   m_Seeds.clear();
+   m_Seeds.push_back( SeedPoint );
+}
+
+
+
+void
+ConfidenceConnectedModule
+::AddSeedPoint( int x, int y, int z )
+{
+   typedef InternalImageType::IndexType   IndexType;
+   IndexType SeedPoint;
+   SeedPoint[0] = x;
+   SeedPoint[1] = y;
+   SeedPoint[2] = z;
+   m_Seeds.push_back( SeedPoint );
 }
 
 
@@ -123,9 +132,10 @@ ConfidenceConnectedModule
     m_SmoothingFilter->SetNumberOfIterations( m_SmoothingIterations );
     m_SmoothingFilter->SetTimeStep( m_SmoothingTimeStep );
     
-    m_ConfidenceConnectedFilter->SetMultiplier( m_Multiplier );
-    m_ConfidenceConnectedFilter->SetNumberOfIterations( m_NumberOfIterations );
-    m_ConfidenceConnectedFilter->SetInitialNeighborhoodRadius( m_InitialNeighborhoodRadius );
+    m_RegionGrowing.SetMultiplier( m_Multiplier );
+    m_RegionGrowing.SetNumberOfIterations( m_NumberOfIterations );
+    m_RegionGrowing.SetInitialNeighborhoodRadius( m_InitialNeighborhoodRadius );
+    m_RegionGrowing.SetSeeds( m_Seeds );
     
     std::cout << "Initiating segmentation..." << std::endl;
     
@@ -133,9 +143,13 @@ ConfidenceConnectedModule
     
     std::cout << "Image smoothed" << std::endl;
     
-    m_ConfidenceConnectedFilter->Update();
+    m_RegionGrowing.SetInput( m_SmoothingFilter->GetOutput() );
+    m_RegionGrowing.Update();
     
-    std::cout << "Image Segmentation Completed." << std::endl;
+    std::cout << "Image Segmentation Completed, " 
+              << m_RegionGrowing.GetNumberOfPixels() << " pixels"
+              << ( m_RegionGrowing.GetLastUpdateWasIncremental() ?
+                   " (incremental)" : "" ) << std::endl;
 
     }
     catch( itk::ExceptionObject & excep )
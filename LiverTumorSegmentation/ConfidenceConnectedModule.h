@@ -18,8 +18,8 @@
 #ifndef __ConfidenceConnectedModule_h__
 #define __ConfidenceConnectedModule_h__
 
-#include "itkConfidenceConnectedImageFilter.h"
 #include "itkCurvatureFlowImageFilter.h"
+#include "IncrementalConfidenceConnected.h"
 #include "itkImage.h"
 
 #include "macros.h"
@@ -101,19 +101,22 @@ public:
                              InternalImageType >  SmoothingFilterType;
 
 
-  /**  This filter is the heart of this segmentation method. It applies
+  /**  This is the heart of this segmentation method. It applies
        a flood fill approach based on a statistical criteria for adding
        pixels to the region being grown. A nominal mean and variance are
        computed in an initial step. Then, starting from a set of seed points,
        all the neighbors having intensities in a range defined around the
        nominal mean are included in the region. The intensity range is defined
        using a multiplicative factor and the nominal standard deviation.
-       The output of this filter is a binary image in which the segmented 
-       region is hightlighted.
+       The output is a binary image in which the segmented region is 
+       hightlighted. The region is kept between executions: added seeds 
+       and wider ranges only grow it further.
     */
-  typedef  itk::ConfidenceConnectedImageFilter< 
+  typedef  IncrementalConfidenceConnected< 
                                   InternalImageType, 
-                                  OutputImageType > ConnectedFilterType;
+                                  OutputImageType > RegionGrowingType;
+
+  typedef  RegionGrowingType::SeedContainer       SeedContainer;
 
 
 
@@ -128,6 +131,9 @@ public:
   const OutputImageType * GetOutput();
 
   void SetSeedPoint( int x, int y, int z );
+
+  /** One more seed, grown into the current region */
+  void AddSeedPoint( int x, int y, int z );
   
   void Execute();
   
@@ -150,7 +156,9 @@ private:
   
   SmoothingFilterType::Pointer            m_SmoothingFilter;
   
-  ConnectedFilterType::Pointer            m_ConfidenceConnectedFilter;
+  RegionGrowingType                       m_RegionGrowing;
+
+  SeedContainer                           m_Seeds;
   
   /** Parameters for the Smoothing filter */
   unsigned int   m_SmoothingIterations;
@@ -25,9 +25,6 @@ ConnectedThresholdModule
 {
 
   m_SmoothingFilter             =   SmoothingFilterType::New();
-  m_ConnectedThresholdFilter    =   ConnectedFilterType::New();
-
-  m_ConnectedThresholdFilter->SetInput( m_SmoothingFilter->GetOutput() );
 
   /*  Define reasonable defaults for the parameters */
    m_SmoothingIterations = 20;
@@ -35,13 +32,11 @@ ConnectedThresholdModule
    m_LowerThreshold = 0;
    m_UpperThreshold = 255;
   
-   m_ConnectedThresholdFilter->SetReplaceValue( 255 );
+   m_RegionGrowing.SetReplaceValue( 255 );
 
-  // Allow filter to release data as the execution of
-  // pipeline progresses from filter to filter.
-  // This allows to reduce memory consumption
-  m_SmoothingFilter->ReleaseDataFlagOn();
-  m_ConnectedThresholdFilter->ReleaseDataFlagOn();
+  // The smoothed image is kept between executions, it is only
+  // computed again when the input or the smoothing parameters change.
+  m_SmoothingFilter->ReleaseDataFlagOff();
 
 }
 
@@ -70,7 +65,7 @@ const ConnectedThresholdModule::OutputImageType *
 ConnectedThresholdModule
 ::GetOutput()
 {
-   return m_ConnectedThresholdFilter->GetOutput();
+   return m_RegionGrowing.GetOutput();
 }
 
 
@@ -84,7 +79,22 @@ ConnectedThresholdModule
    SeedPoint[0] = x;
    SeedPoint[1] = y;
    SeedPoint[2] = z;
-   m_ConnectedThresholdFilter->SetSeed( SeedPoint );
+   m_Seeds.clear();
+   m_Seeds.push_back( SeedPoint );
+}
+
+
+
+void
+ConnectedThresholdModule
+::AddSeedPoint( int x, int y, int z )
+{
+   typedef InternalImageType::IndexType   IndexType;
+   IndexType SeedPoint;
+   SeedPoint[0] = x;
+   SeedPoint[1] = y;
+   SeedPoint[2] = z;
+   m_Seeds.push_back( SeedPoint );
 }
 
 
@@ -99,14 +109,18 @@ ConnectedThresholdModule
 
     m_SmoothingFilter->SetNumberOfIterations( m_SmoothingIterations );
     m_SmoothingFilter->SetTimeStep( m_SmoothingTimeStep );
-    m_ConnectedThresholdFilter->SetLower( m_LowerThreshold );
-    m_ConnectedThresholdFilter->SetUpper( m_UpperThreshold );
+    m_RegionGrowing.SetInterval( m_LowerThreshold, m_UpperThreshold );
+    m_RegionGrowing.SetSeeds( m_Seeds );
 
     std::cout << "Initiating segmentation..." << std::endl;
     m_SmoothingFilter->Update();
     std::cout << "Image smoothed" << std::endl;
-    m_ConnectedThresholdFilter->Update();
-    std::cout << "Image Segmentation Completed." << std::endl;
+    m_RegionGrowing.SetInput( m_SmoothingFilter->GetOutput() );
+    m_RegionGrowing.Update();
+    std::cout << "Image Segmentation Completed, " 
+              << m_RegionGrowing.GetNumberOfPixels() << " pixels"
+              << ( m_RegionGrowing.GetLastUpdateWasIncremental() ?
+                   " (incremental)" : "" ) << std::endl;
     }
   catch( itk::ExceptionObject & excep )
     {
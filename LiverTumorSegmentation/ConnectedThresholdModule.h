@@ -18,8 +18,8 @@
 #ifndef __ConnectedThresholdModule_h__
 #define __ConnectedThresholdModule_h__
 
-#include "itkConnectedThresholdImageFilter.h"
 #include "itkCurvatureFlowImageFilter.h"
+#include "IncrementalRegionGrowing.h"
 #include "itkImage.h"
 
 #include "macros.h"
@@ -101,17 +101,20 @@ public:
                              InternalImageType >  SmoothingFilterType;
 
 
-  /**  This filter is the heart of this segmentation method. It applies
+  /**  This is the heart of this segmentation method. It applies
        a flood fill approach based on a statistical criteria for adding
        pixels to the region being grown. The criteria is an intensity
        range provided by the user. Only pixels whose intensities are in
        the user-provided interval will be accepted as part of the region.
-       The output of this filter is a binary image in which the segmented 
-       region is hightlighted.
+       The output is a binary image in which the segmented region is
+       hightlighted. The region is kept between executions: added seeds
+       and a wider range only grow it further.
     */
-  typedef  itk::ConnectedThresholdImageFilter< 
+  typedef  IncrementalRegionGrowing< 
                                   InternalImageType, 
-                                  OutputImageType > ConnectedFilterType;
+                                  OutputImageType > RegionGrowingType;
+
+  typedef  RegionGrowingType::SeedContainer       SeedContainer;
 
 
 
@@ -125,6 +128,9 @@ public:
   void Execute();
   
   void SetSeedPoint( int x, int y, int z );
+
+  /** One more seed, grown into the current region */
+  void AddSeedPoint( int x, int y, int z );
   
   GetMacro( SmoothingTimeStep, double );
   GetMacro( SmoothingIterations, unsigned int );
@@ -142,7 +148,9 @@ private:
 
   SmoothingFilterType::Pointer            m_SmoothingFilter;
   
-  ConnectedFilterType::Pointer            m_ConnectedThresholdFilter;
+  RegionGrowingType                       m_RegionGrowing;
+
+  SeedContainer                           m_Seeds;
   
   /** Parameters for the Smoothing filter */
   unsigned int   m_SmoothingIterations;
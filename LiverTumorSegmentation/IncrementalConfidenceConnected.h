@@ -0,0 +1,101 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    IncrementalConfidenceConnected.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __ISIS_IncrementalConfidenceConnected_h__
+#define __ISIS_IncrementalConfidenceConnected_h__
+
+#include "IncrementalRegionGrowing.h"
+
+/**
+  \class IncrementalConfidenceConnected
+  \brief Confidence connected region growing that keeps its region
+  between updates.
+
+  As itk::ConfidenceConnectedImageFilter, the interval starts as the
+  average of the means plus or minus Multiplier times the square root of
+  the average of the variances of the neighborhoods of radius
+  InitialNeighborhoodRadius around the seeds, and is then computed
+  NumberOfIterations times from the statistics of the region grown. The
+  bounds are cast to the input pixel type, so that a from-scratch update
+  grows the same region as the ITK filter. An
+  interval that contains the previous one continues the flood from the
+  border of the region instead of growing it again.
+
+  Seeds appended after an update are grown alone: the interval is widened
+  to include the one of their neighborhoods and the flood goes on from the
+  new seeds and the border, without new iterations.
+
+*/
+namespace ISIS
+{
+
+template< class TInputImage, class TOutputImage >
+class IncrementalConfidenceConnected :
+               public IncrementalRegionGrowing< TInputImage, TOutputImage >
+{
+public:
+
+  typedef IncrementalRegionGrowing< TInputImage, TOutputImage > Superclass;
+  typedef typename Superclass::InputImageType     InputImageType;
+  typedef typename Superclass::OutputImageType    OutputImageType;
+  typedef typename Superclass::IndexType          IndexType;
+  typedef typename Superclass::RegionType         RegionType;
+
+public:
+  IncrementalConfidenceConnected( void );
+
+  virtual ~IncrementalConfidenceConnected( void );
+
+  void SetMultiplier( double value );
+  void SetNumberOfIterations( unsigned int value );
+  void SetInitialNeighborhoodRadius( unsigned int value );
+
+  /** Grow the region, incrementally when possible */
+  virtual void Update( void );
+
+protected:
+
+  /** Interval from the neighborhoods of the seeds from first on */
+  void ComputeSeedInterval( unsigned int first,
+                            double & lower, double & upper ) const;
+
+  /** Interval from the statistics of the region */
+  void ComputeRegionInterval( double & lower, double & upper ) const;
+
+  /** Clamp the interval to the range of the input pixels and cast it to
+      their type, as the thresholds of the ITK filter */
+  void CastInterval( double & lower, double & upper ) const;
+
+  double          m_Multiplier;
+  unsigned int    m_NumberOfIterations;
+  unsigned int    m_InitialNeighborhoodRadius;
+
+  /** Parameters the current region was grown with */
+  double          m_GrownMultiplier;
+  unsigned int    m_GrownNumberOfIterations;
+  unsigned int    m_GrownInitialNeighborhoodRadius;
+};
+
+
+}  // end namespace ISIS
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "IncrementalConfidenceConnected.txx"
+#endif
+
+#endif
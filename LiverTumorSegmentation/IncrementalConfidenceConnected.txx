@@ -0,0 +1,242 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    IncrementalConfidenceConnected.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __ISIS_IncrementalConfidenceConnected_txx__
+#define __ISIS_IncrementalConfidenceConnected_txx__
+
+#include "IncrementalConfidenceConnected.h"
+#include "itkMeanImageFunction.h"
+#include "itkVarianceImageFunction.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+#include "vcl_cmath.h"
+
+namespace ISIS
+{
+
+
+template < class TInputImage, class TOutputImage >
+IncrementalConfidenceConnected<TInputImage,TOutputImage>
+::IncrementalConfidenceConnected()
+{
+  m_Multiplier = 2.5;
+  m_NumberOfIterations = 4;
+  m_InitialNeighborhoodRadius = 1;
+  m_GrownMultiplier = m_Multiplier;
+  m_GrownNumberOfIterations = m_NumberOfIterations;
+  m_GrownInitialNeighborhoodRadius = m_InitialNeighborhoodRadius;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+IncrementalConfidenceConnected<TInputImage,TOutputImage>
+::~IncrementalConfidenceConnected()
+{
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalConfidenceConnected<TInputImage,TOutputImage>
+::SetMultiplier( double value )
+{
+  m_Multiplier = value;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalConfidenceConnected<TInputImage,TOutputImage>
+::SetNumberOfIterations( unsigned int value )
+{
+  m_NumberOfIterations = value;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalConfidenceConnected<TInputImage,TOutputImage>
+::SetInitialNeighborhoodRadius( unsigned int value )
+{
+  m_InitialNeighborhoodRadius = value;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalConfidenceConnected<TInputImage,TOutputImage>
+::ComputeSeedInterval( unsigned int first, double & lower, double & upper ) const
+{
+  typedef itk::MeanImageFunction< InputImageType, double >      MeanFunctionType;
+  typedef itk::VarianceImageFunction< InputImageType, double >  VarianceFunctionType;
+
+  typename MeanFunctionType::Pointer meanFunction = MeanFunctionType::New();
+  meanFunction->SetInputImage( this->m_Input );
+  meanFunction->SetNeighborhoodRadius( m_InitialNeighborhoodRadius );
+
+  typename VarianceFunctionType::Pointer varianceFunction = 
+                                              VarianceFunctionType::New();
+  varianceFunction->SetInputImage( this->m_Input );
+  varianceFunction->SetNeighborhoodRadius( m_InitialNeighborhoodRadius );
+
+  // averages of the statistics of each neighborhood, seeds outside of the
+  // image count for zero, as in itk::ConfidenceConnectedImageFilter
+  double mean = 0.0;
+  double variance = 0.0;
+  for( unsigned int s = first; s < this->m_Seeds.size(); s++ )
+    {
+    if( this->m_Input->GetBufferedRegion().IsInside( this->m_Seeds[s] ) )
+      {
+      mean += meanFunction->EvaluateAtIndex( this->m_Seeds[s] );
+      variance += varianceFunction->EvaluateAtIndex( this->m_Seeds[s] );
+      }
+    }
+
+  const unsigned int numberOfSeeds = this->m_Seeds.size() - first;
+  if( numberOfSeeds == 0 )
+    {
+    // empty interval, nothing grows
+    lower = 1.0;
+    upper = 0.0;
+    return;
+    }
+  mean /= numberOfSeeds;
+  variance /= numberOfSeeds;
+
+  const double deviation = m_Multiplier * vcl_sqrt( vnl_math_max( variance, 0.0 ) );
+  lower = mean - deviation;
+  upper = mean + deviation;
+  this->CastInterval( lower, upper );
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalConfidenceConnected<TInputImage,TOutputImage>
+::ComputeRegionInterval( double & lower, double & upper ) const
+{
+  const double mean = this->GetMean();
+  const double deviation = 
+        m_Multiplier * vcl_sqrt( vnl_math_max( this->GetVariance(), 0.0 ) );
+  lower = mean - deviation;
+  upper = mean + deviation;
+  this->CastInterval( lower, upper );
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalConfidenceConnected<TInputImage,TOutputImage>
+::CastInterval( double & lower, double & upper ) const
+{
+  typedef typename Superclass::InputPixelType        InputPixelType;
+  typedef itk::NumericTraits< InputPixelType >       TraitsType;
+
+  const double minimum = static_cast< double >( TraitsType::NonpositiveMin() );
+  const double maximum = static_cast< double >( TraitsType::max() );
+  lower = static_cast< double >( static_cast< InputPixelType >( 
+                                        vnl_math_max( lower, minimum ) ) );
+  upper = static_cast< double >( static_cast< InputPixelType >( 
+                                        vnl_math_min( upper, maximum ) ) );
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalConfidenceConnected<TInputImage,TOutputImage>
+::Update()
+{
+  if( !this->m_Input )
+    {
+    return;
+    }
+
+  double lower;
+  double upper;
+
+  const bool parametersChanged = 
+        m_Multiplier != m_GrownMultiplier ||
+        m_NumberOfIterations != m_GrownNumberOfIterations ||
+        m_InitialNeighborhoodRadius != m_GrownInitialNeighborhoodRadius;
+
+  if( parametersChanged || this->MustRestart() )
+    {
+    this->Restart();
+    this->ComputeSeedInterval( 0, lower, upper );
+    this->SetInterval( lower, upper );
+    this->m_GrownLower = lower;
+    this->m_GrownUpper = upper;
+    this->Grow( false );
+
+    for( unsigned int i = 0; i < m_NumberOfIterations; i++ )
+      {
+      if( this->GetNumberOfPixels() == 0 )
+        {
+        break;
+        }
+      this->ComputeRegionInterval( lower, upper );
+      const bool loosen = ( lower <= this->m_GrownLower &&
+                            upper >= this->m_GrownUpper );
+      if( !loosen )
+        {
+        // the region loses pixels, grow it again
+        this->Restart();
+        }
+      this->SetInterval( lower, upper );
+      this->m_GrownLower = lower;
+      this->m_GrownUpper = upper;
+      this->Grow( loosen );
+      }
+
+    m_GrownMultiplier = m_Multiplier;
+    m_GrownNumberOfIterations = m_NumberOfIterations;
+    m_GrownInitialNeighborhoodRadius = m_InitialNeighborhoodRadius;
+    this->m_Incremental = false;
+    }
+  else 
+    {
+    this->m_Incremental = true;
+    if( this->m_NumberOfGrownSeeds == this->m_Seeds.size() )
+      {
+      return;
+      }
+    this->ComputeSeedInterval( this->m_NumberOfGrownSeeds, lower, upper );
+    lower = vnl_math_min( lower, this->m_GrownLower );
+    upper = vnl_math_max( upper, this->m_GrownUpper );
+    const bool loosen = ( lower < this->m_GrownLower ||
+                          upper > this->m_GrownUpper );
+    this->SetInterval( lower, upper );
+    this->m_GrownLower = lower;
+    this->m_GrownUpper = upper;
+    this->Grow( loosen );
+    }
+
+  this->m_Output->Modified();
+}
+
+
+}  // end namespace ISIS
+
+#endif
@@ -0,0 +1,392 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    IncrementalConfidenceConnectedTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+// Grows a noisy ball from scratch with ISIS::IncrementalConfidenceConnected
+// and with itk::ConfidenceConnectedImageFilter, for a float and an integer
+// input, and checks that the regions are the same. Then checks the two
+// incremental updates: a loosened interval continued from the border of
+// ISIS::IncrementalRegionGrowing against itk::ConnectedThresholdImageFilter,
+// and a seed appended to ISIS::IncrementalConfidenceConnected.
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkConfidenceConnectedImageFilter.h"
+#include "itkConnectedThresholdImageFilter.h"
+#include "IncrementalConfidenceConnected.h"
+
+#include <iostream>
+#include <cstdlib>
+
+
+typedef itk::Image< unsigned char, 3 >   OutputImageType;
+
+
+// balls of 180 of radius 12 around the centers in a background of 100,
+// both with noise of +/- 20
+template < class TInputImage >
+typename TInputImage::Pointer MakeImage( const double centers[][3],
+                                         unsigned int numberOfCenters )
+{
+  typedef typename TInputImage::PixelType InputPixelType;
+
+  typename TInputImage::SizeType size;
+  size.Fill( 40 );
+  typename TInputImage::RegionType region;
+  region.SetSize( size );
+
+  typename TInputImage::Pointer image = TInputImage::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  unsigned long random = 12345;
+  itk::ImageRegionIteratorWithIndex< TInputImage > it( image, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    random = random * 1103515245ul + 12345ul;
+    const double noise = ( ( random >> 16 ) % 4001 ) / 100.0 - 20.0;
+    bool inside = false;
+    for( unsigned int c = 0; c < numberOfCenters; c++ )
+      {
+      double distance = 0.0;
+      for( unsigned int d = 0; d < 3; d++ )
+        {
+        const double offset = it.GetIndex()[d] - centers[c][d];
+        distance += offset * offset;
+        }
+      inside = inside || distance < 12.0 * 12.0;
+      }
+    it.Set( static_cast< InputPixelType >(
+                  ( inside ? 180.0 : 100.0 ) + noise ) );
+    }
+
+  return image;
+}
+
+
+// number of pixels that differ between the two outputs, and number of
+// pixels in the second one
+unsigned long CountDifferences( const OutputImageType * output,
+                                const OutputImageType * reference,
+                                unsigned long & grown )
+{
+  unsigned long different = 0;
+  grown = 0;
+  itk::ImageRegionConstIterator< OutputImageType >
+                  oit( output, reference->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< OutputImageType >
+                  rit( reference, reference->GetBufferedRegion() );
+  for( ; !rit.IsAtEnd(); ++oit, ++rit )
+    {
+    if( oit.Get() != rit.Get() )
+      {
+      different++;
+      }
+    if( rit.Get() )
+      {
+      grown++;
+      }
+    }
+  return different;
+}
+
+
+template < class TInputImage >
+int CompareWithITK( const char * name )
+{
+  typedef TInputImage                                    InputImageType;
+  typedef typename InputImageType::PixelType             InputPixelType;
+  typedef ISIS::IncrementalConfidenceConnected<
+                        InputImageType, OutputImageType > IncrementalType;
+  typedef itk::ConfidenceConnectedImageFilter<
+                        InputImageType, OutputImageType > FilterType;
+
+  const double centers[1][3] = { { 20.0, 20.0, 20.0 } };
+  typename InputImageType::Pointer image =
+                                 MakeImage< InputImageType >( centers, 1 );
+
+  typename IncrementalType::SeedContainer seeds;
+  typename InputImageType::IndexType seed;
+  seed.Fill( 20 );
+  seeds.push_back( seed );
+  seed[0] = 14;
+  seed[2] = 25;
+  seeds.push_back( seed );
+
+  int status = EXIT_SUCCESS;
+
+  for( unsigned int iterations = 0; iterations < 4; iterations += 3 )
+    {
+    IncrementalType incremental;
+    incremental.SetInput( image );
+    incremental.SetSeeds( seeds );
+    incremental.SetMultiplier( 2.0 );
+    incremental.SetNumberOfIterations( iterations );
+    incremental.SetInitialNeighborhoodRadius( 2 );
+    incremental.SetReplaceValue( 255 );
+    incremental.Update();
+
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    for( unsigned int s = 0; s < seeds.size(); s++ )
+      {
+      filter->AddSeed( seeds[s] );
+      }
+    filter->SetMultiplier( 2.0 );
+    filter->SetNumberOfIterations( iterations );
+    filter->SetInitialNeighborhoodRadius( 2 );
+    filter->SetReplaceValue( 255 );
+    try
+      {
+      filter->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    unsigned long grown = 0;
+    const unsigned long different = CountDifferences(
+                    incremental.GetOutput(), filter->GetOutput(), grown );
+
+    std::cout << name << ", " << iterations << " iterations: "
+              << grown << " pixels grown by the ITK filter, "
+              << different << " different" << std::endl;
+
+    if( different != 0 || grown == 0 )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+
+  return status;
+}
+
+
+// Grows the ball with a narrow interval, then loosens it so that the flood
+// goes on from the border into the background, and compares the result
+// with a from-scratch itk::ConnectedThresholdImageFilter.
+template < class TInputImage >
+int CheckLoosenedInterval( const char * name )
+{
+  typedef TInputImage                                    InputImageType;
+  typedef typename InputImageType::PixelType             InputPixelType;
+  typedef ISIS::IncrementalRegionGrowing<
+                        InputImageType, OutputImageType > GrowingType;
+  typedef itk::ConnectedThresholdImageFilter<
+                        InputImageType, OutputImageType > FilterType;
+
+  const double centers[1][3] = { { 20.0, 20.0, 20.0 } };
+  typename InputImageType::Pointer image =
+                                 MakeImage< InputImageType >( centers, 1 );
+
+  typename GrowingType::SeedContainer seeds;
+  typename InputImageType::IndexType seed;
+  seed.Fill( 20 );
+  seeds.push_back( seed );
+
+  GrowingType growing;
+  growing.SetInput( image );
+  growing.SetSeeds( seeds );
+  growing.SetReplaceValue( 255 );
+  growing.SetInterval( 150.0, 210.0 );
+  growing.Update();
+  const unsigned long narrow = growing.GetNumberOfPixels();
+
+  growing.SetInterval( 115.0, 215.0 );
+  growing.Update();
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->AddSeed( seed );
+  filter->SetLower( static_cast< InputPixelType >( 115 ) );
+  filter->SetUpper( static_cast< InputPixelType >( 215 ) );
+  filter->SetReplaceValue( 255 );
+  try
+    {
+    filter->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  unsigned long grown = 0;
+  const unsigned long different =
+          CountDifferences( growing.GetOutput(), filter->GetOutput(), grown );
+
+  std::cout << name << ", loosened interval: " << narrow << " then "
+            << grown << " pixels grown by the ITK filter, "
+            << different << " different"
+            << ( growing.GetLastUpdateWasIncremental() ? "" :
+                                                 ", not incremental" )
+            << std::endl;
+
+  if( different != 0 || grown <= narrow ||
+      !growing.GetLastUpdateWasIncremental() )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+
+// Grows one of two separate balls, appends a seed in the other, and checks
+// that the first region is kept and that the second ball is added, as a
+// from-scratch itk::ConnectedThresholdImageFilter with both seeds and the
+// final interval grows them.
+template < class TInputImage >
+int CheckAppendedSeed( const char * name )
+{
+  typedef TInputImage                                    InputImageType;
+  typedef typename InputImageType::PixelType             InputPixelType;
+  typedef ISIS::IncrementalConfidenceConnected<
+                        InputImageType, OutputImageType > IncrementalType;
+  typedef itk::ConnectedThresholdImageFilter<
+                        InputImageType, OutputImageType > FilterType;
+
+  // the balls are 29 pixels apart, more than twice their radius
+  const double centers[2][3] = { { 12.0, 20.0, 8.0 },
+                                 { 28.0, 20.0, 32.0 } };
+  typename InputImageType::Pointer image =
+                                 MakeImage< InputImageType >( centers, 2 );
+
+  typename IncrementalType::SeedContainer seeds;
+  typename InputImageType::IndexType first;
+  first[0] = 12;
+  first[1] = 20;
+  first[2] = 8;
+  typename InputImageType::IndexType second;
+  second[0] = 28;
+  second[1] = 20;
+  second[2] = 32;
+  seeds.push_back( first );
+
+  IncrementalType incremental;
+  incremental.SetInput( image );
+  incremental.SetSeeds( seeds );
+  incremental.SetMultiplier( 2.0 );
+  incremental.SetNumberOfIterations( 0 );
+  incremental.SetInitialNeighborhoodRadius( 2 );
+  incremental.SetReplaceValue( 255 );
+  incremental.Update();
+
+  // copy of the first region
+  OutputImageType::Pointer previous = OutputImageType::New();
+  previous->SetRegions( incremental.GetOutput()->GetBufferedRegion() );
+  previous->Allocate();
+  itk::ImageRegionConstIterator< OutputImageType > cit(
+    incremental.GetOutput(), previous->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< OutputImageType > pit(
+    previous, previous->GetBufferedRegion() );
+  for( ; !cit.IsAtEnd(); ++cit, ++pit )
+    {
+    pit.Set( cit.Get() );
+    }
+  const unsigned long firstPixels = incremental.GetNumberOfPixels();
+
+  seeds.push_back( second );
+  incremental.SetSeeds( seeds );
+  incremental.Update();
+
+  int status = EXIT_SUCCESS;
+
+  unsigned long lost = 0;
+  itk::ImageRegionConstIterator< OutputImageType > oit(
+    incremental.GetOutput(), previous->GetBufferedRegion() );
+  for( pit.GoToBegin(); !pit.IsAtEnd(); ++pit, ++oit )
+    {
+    if( pit.Get() && !oit.Get() )
+      {
+      lost++;
+      }
+    }
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->AddSeed( first );
+  filter->AddSeed( second );
+  filter->SetLower( static_cast< InputPixelType >( incremental.GetLower() ) );
+  filter->SetUpper( static_cast< InputPixelType >( incremental.GetUpper() ) );
+  filter->SetReplaceValue( 255 );
+  try
+    {
+    filter->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  unsigned long grown = 0;
+  const unsigned long different = CountDifferences(
+                    incremental.GetOutput(), filter->GetOutput(), grown );
+
+  std::cout << name << ", appended seed: " << firstPixels << " then "
+            << incremental.GetNumberOfPixels() << " pixels, "
+            << lost << " lost, " << different
+            << " different from the ITK filter"
+            << ( incremental.GetLastUpdateWasIncremental() ? "" :
+                                                   ", not incremental" )
+            << std::endl;
+
+  if( lost != 0 || different != 0 ||
+      !incremental.GetLastUpdateWasIncremental() ||
+      !incremental.GetOutput()->GetPixel( second ) ||
+      incremental.GetNumberOfPixels() <= firstPixels )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
+
+
+int main( int, char *[] )
+{
+  int status = EXIT_SUCCESS;
+  if( CompareWithITK< itk::Image< float, 3 > >( "float" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if( CompareWithITK< itk::Image< short, 3 > >( "short" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if( CheckLoosenedInterval< itk::Image< float, 3 > >( "float" )
+      != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if( CheckLoosenedInterval< itk::Image< short, 3 > >( "short" )
+      != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if( CheckAppendedSeed< itk::Image< float, 3 > >( "float" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if( CheckAppendedSeed< itk::Image< short, 3 > >( "short" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  return status;
+}
@@ -0,0 +1,150 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    IncrementalRegionGrowing.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __ISIS_IncrementalRegionGrowing_h__
+#define __ISIS_IncrementalRegionGrowing_h__
+
+#include "itkImage.h"
+
+#include <vector>
+
+/**
+  \class IncrementalRegionGrowing
+  \brief Connected threshold region growing that keeps its region
+  between updates.
+
+  The region is grown from the seeds over the face connected pixels whose
+  intensity is in [Lower, Upper], like itk::ConnectedThresholdImageFilter.
+  The pixels rejected at the border of the region are kept, so that the
+  next Update() only does the work that changed:
+
+  - seeds appended to the previous ones are grown alone, into the region
+    already found;
+  - an interval that contains the previous one continues the flood from
+    the rejected border pixels;
+  - another input, fewer or other seeds, or a narrower interval grow the
+    region again from scratch.
+
+  The output is an image of the input size with ReplaceValue in the region
+  and 0 elsewhere. It is the same image object from one update to the next,
+  modified in place.
+
+*/
+namespace ISIS
+{
+
+template< class TInputImage, class TOutputImage >
+class IncrementalRegionGrowing
+{
+public:
+
+  typedef TInputImage                              InputImageType;
+  typedef typename InputImageType::PixelType       InputPixelType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename OutputImageType::PixelType      OutputPixelType;
+  typedef typename OutputImageType::IndexType      IndexType;
+  typedef typename OutputImageType::RegionType     RegionType;
+  typedef std::vector< IndexType >                 SeedContainer;
+
+  itkStaticConstMacro( Dimension, unsigned int, OutputImageType::ImageDimension );
+
+public:
+  IncrementalRegionGrowing( void );
+
+  virtual ~IncrementalRegionGrowing( void );
+
+  /** The input must be up to date over its whole region */
+  void SetInput( const InputImageType * image );
+
+  const InputImageType * GetInput( void ) const;
+
+  OutputImageType * GetOutput( void );
+
+  /** Seeds of the region. Seeds appended to those of the last update are
+      grown incrementally. */
+  void SetSeeds( const SeedContainer & seeds );
+
+  const SeedContainer & GetSeeds( void ) const;
+
+  void SetInterval( double lower, double upper );
+
+  void SetReplaceValue( OutputPixelType value );
+
+  /** Grow the region, incrementally when possible */
+  virtual void Update( void );
+
+  /** Interval the current region was grown with */
+  double GetLower( void ) const;
+  double GetUpper( void ) const;
+
+  /** Statistics of the input over the current region */
+  unsigned long GetNumberOfPixels( void ) const;
+  double GetMean( void ) const;
+  double GetVariance( void ) const;
+
+  /** True if the last update did not start over */
+  bool GetLastUpdateWasIncremental( void ) const;
+
+protected:
+
+  /** True if the region must be grown again from scratch whatever the
+      interval: new input, changed seeds or nothing grown yet */
+  bool MustRestart( void ) const;
+
+  /** Empty the region, allocating the output for the input if needed */
+  void Restart( void );
+
+  /** Grow with the current interval, from the new seeds and, if
+      loosen is true, from the rejected pixels of the border. */
+  void Grow( bool loosen );
+
+  /** Add the pixel if it is in the interval, else remember it */
+  bool Accept( const IndexType & index, std::vector< IndexType > & stack );
+
+  typename InputImageType::ConstPointer   m_Input;
+  unsigned long                           m_InputTime;
+  typename OutputImageType::Pointer       m_Output;
+  OutputPixelType                         m_ReplaceValue;
+
+  SeedContainer                           m_Seeds;
+  unsigned int                            m_NumberOfGrownSeeds;
+  bool                                    m_SeedsChanged;
+
+  double                                  m_Lower;
+  double                                  m_Upper;
+  double                                  m_GrownLower;
+  double                                  m_GrownUpper;
+  bool                                    m_Grown;
+  bool                                    m_Incremental;
+
+  /** Pixels outside of the interval next to the region, may repeat */
+  std::vector< IndexType >                m_Border;
+
+  unsigned long                           m_NumberOfPixels;
+  double                                  m_Sum;
+  double                                  m_SumOfSquares;
+};
+
+
+}  // end namespace ISIS
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "IncrementalRegionGrowing.txx"
+#endif
+
+#endif
@@ -0,0 +1,369 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    IncrementalRegionGrowing.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __ISIS_IncrementalRegionGrowing_txx__
+#define __ISIS_IncrementalRegionGrowing_txx__
+
+#include "IncrementalRegionGrowing.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+
+namespace ISIS
+{
+
+
+template < class TInputImage, class TOutputImage >
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::IncrementalRegionGrowing()
+{
+  m_Output = OutputImageType::New();
+  m_InputTime = 0;
+  m_ReplaceValue = itk::NumericTraits< OutputPixelType >::One;
+  m_NumberOfGrownSeeds = 0;
+  m_SeedsChanged = false;
+  m_Lower = itk::NumericTraits< InputPixelType >::NonpositiveMin();
+  m_Upper = itk::NumericTraits< InputPixelType >::max();
+  m_GrownLower = m_Lower;
+  m_GrownUpper = m_Upper;
+  m_Grown = false;
+  m_Incremental = false;
+  m_NumberOfPixels = 0;
+  m_Sum = 0.0;
+  m_SumOfSquares = 0.0;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::~IncrementalRegionGrowing()
+{
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::SetInput( const InputImageType * image )
+{
+  m_Input = image;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+const typename IncrementalRegionGrowing<TInputImage,TOutputImage>::InputImageType *
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::GetInput() const
+{
+  return m_Input;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+typename IncrementalRegionGrowing<TInputImage,TOutputImage>::OutputImageType *
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::GetOutput()
+{
+  return m_Output;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::SetSeeds( const SeedContainer & seeds )
+{
+  // The seeds already grown must come first, unchanged
+  bool appended = ( seeds.size() >= m_NumberOfGrownSeeds );
+  for( unsigned int i = 0; appended && i < m_NumberOfGrownSeeds; i++ )
+    {
+    appended = ( seeds[i] == m_Seeds[i] );
+    }
+  if( !appended )
+    {
+    m_SeedsChanged = true;
+    }
+  m_Seeds = seeds;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+const typename IncrementalRegionGrowing<TInputImage,TOutputImage>::SeedContainer &
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::GetSeeds() const
+{
+  return m_Seeds;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::SetInterval( double lower, double upper )
+{
+  m_Lower = lower;
+  m_Upper = upper;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::SetReplaceValue( OutputPixelType value )
+{
+  if( value != m_ReplaceValue )
+    {
+    m_ReplaceValue = value;
+    m_Grown = false;
+    }
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+double
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::GetLower() const
+{
+  return m_GrownLower;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+double
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::GetUpper() const
+{
+  return m_GrownUpper;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+unsigned long
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::GetNumberOfPixels() const
+{
+  return m_NumberOfPixels;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+double
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::GetMean() const
+{
+  if( m_NumberOfPixels == 0 )
+    {
+    return 0.0;
+    }
+  return m_Sum / m_NumberOfPixels;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+double
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::GetVariance() const
+{
+  if( m_NumberOfPixels < 2 )
+    {
+    return 0.0;
+    }
+  return ( m_SumOfSquares - m_Sum * m_Sum / m_NumberOfPixels )
+                                              / ( m_NumberOfPixels - 1 );
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+bool
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::GetLastUpdateWasIncremental() const
+{
+  return m_Incremental;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+bool
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::MustRestart() const
+{
+  if( !m_Grown || m_SeedsChanged )
+    {
+    return true;
+    }
+  // the data of the same image object may have been replaced
+  const unsigned long inputTime =
+      vnl_math_max( m_Input->GetMTime(), m_Input->GetUpdateMTime() );
+  return ( inputTime != m_InputTime ||
+           m_Input->GetBufferedRegion() != m_Output->GetBufferedRegion() );
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::Restart()
+{
+  const RegionType region = m_Input->GetBufferedRegion();
+  if( region != m_Output->GetBufferedRegion() )
+    {
+    m_Output->CopyInformation( m_Input );
+    m_Output->SetRegions( region );
+    m_Output->Allocate();
+    }
+  m_Output->FillBuffer( itk::NumericTraits< OutputPixelType >::Zero );
+
+  m_Border.clear();
+  m_NumberOfGrownSeeds = 0;
+  m_SeedsChanged = false;
+  m_NumberOfPixels = 0;
+  m_Sum = 0.0;
+  m_SumOfSquares = 0.0;
+  m_InputTime = vnl_math_max( m_Input->GetMTime(), m_Input->GetUpdateMTime() );
+  m_Grown = true;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::Update()
+{
+  if( !m_Input )
+    {
+    return;
+    }
+
+  // a narrower interval removes pixels
+  bool loosen = false;
+  m_Incremental = !this->MustRestart() &&
+                  m_Lower <= m_GrownLower && m_Upper >= m_GrownUpper;
+  if( !m_Incremental )
+    {
+    this->Restart();
+    }
+  else
+    {
+    loosen = ( m_Lower < m_GrownLower || m_Upper > m_GrownUpper );
+    if( !loosen && m_NumberOfGrownSeeds == m_Seeds.size() )
+      {
+      return;
+      }
+    }
+
+  m_GrownLower = m_Lower;
+  m_GrownUpper = m_Upper;
+  this->Grow( loosen );
+  m_Output->Modified();
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+bool
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::Accept( const IndexType & index, std::vector< IndexType > & stack )
+{
+  if( m_Output->GetPixel( index ) == m_ReplaceValue )
+    {
+    return false;
+    }
+
+  const double value = static_cast< double >( m_Input->GetPixel( index ) );
+  if( value < m_GrownLower || value > m_GrownUpper )
+    {
+    m_Border.push_back( index );
+    return false;
+    }
+
+  m_Output->SetPixel( index, m_ReplaceValue );
+  m_NumberOfPixels++;
+  m_Sum += value;
+  m_SumOfSquares += value * value;
+  stack.push_back( index );
+  return true;
+}
+
+
+
+template < class TInputImage, class TOutputImage >
+void
+IncrementalRegionGrowing<TInputImage,TOutputImage>
+::Grow( bool loosen )
+{
+  const RegionType region = m_Output->GetBufferedRegion();
+  std::vector< IndexType > stack;
+
+  if( loosen )
+    {
+    // the border pixels still rejected are stored again by Accept()
+    std::vector< IndexType > border;
+    border.swap( m_Border );
+    for( unsigned int i = 0; i < border.size(); i++ )
+      {
+      this->Accept( border[i], stack );
+      }
+    }
+
+  for( unsigned int s = m_NumberOfGrownSeeds; s < m_Seeds.size(); s++ )
+    {
+    if( region.IsInside( m_Seeds[s] ) )
+      {
+      this->Accept( m_Seeds[s], stack );
+      }
+    }
+  m_NumberOfGrownSeeds = m_Seeds.size();
+
+  while( !stack.empty() )
+    {
+    const IndexType index = stack.back();
+    stack.pop_back();
+    for( unsigned int d = 0; d < Dimension; d++ )
+      {
+      for( int step = -1; step <= 1; step += 2 )
+        {
+        IndexType neighbor = index;
+        neighbor[d] += step;
+        if( region.IsInside( neighbor ) )
+          {
+          this->Accept( neighbor, stack );
+          }
+        }
+      }
+    }
+}
+
+
+}  // end namespace ISIS
+
+#endif
@@ -92,6 +92,55 @@ LiverTumorSegmentationBase::GetSeedPoint(double data[3])
   }
 }
 
+void 
+LiverTumorSegmentationBase::AddSeedPoint( void )
+{
+  if (!m_LoadedVolume) return;
+
+  SeedIndexType index;
+  for(int i=0; i<3; i++)
+  {
+    index[i] = m_SeedIndex[i];
+  }
+  if( m_AddedSeeds.empty() || m_AddedSeeds.back() != index )
+  {
+    m_AddedSeeds.push_back( index );
+  }
+}
+
+
+void 
+LiverTumorSegmentationBase::ClearSeedPoints( void )
+{
+  m_AddedSeeds.clear();
+}
+
+
+/** Pass the added seeds and the current seed point to a module, in the
+    order they were given, so that the module grows the new ones only. */
+template < class TModule >
+static void SetSeedsOfModule( TModule & module, 
+                              const std::vector< LiverTumorSegmentationBase::SeedIndexType > & seeds,
+                              const int current[3] )
+{
+  if( seeds.empty() )
+  {
+    module.SetSeedPoint( current[0], current[1], current[2] );
+    return;
+  }
+  module.SetSeedPoint( seeds[0][0], seeds[0][1], seeds[0][2] );
+  for( unsigned int i = 1; i < seeds.size(); i++ )
+  {
+    module.AddSeedPoint( seeds[i][0], seeds[i][1], seeds[i][2] );
+  }
+  const LiverTumorSegmentationBase::SeedIndexType & last = seeds.back();
+  if( last[0] != current[0] || last[1] != current[1] || last[2] != current[2] )
+  {
+    module.AddSeedPoint( current[0], current[1], current[2] );
+  }
+}
+
+
 bool  LiverTumorSegmentationBase::DoSegmentation( SegmentationModuleType sType )
   {
   if (!m_LoadedVolume) return false;
@@ -113,7 +162,7 @@ bool  LiverTumorSegmentationBase::DoSegmentation( SegmentationModuleType sType )
       case CONFIDENCE_CONNECTED:
         m_ConfidenceConnectedModule.SetInput( m_LoadedVolume );
         printf("Seed Index -> ( %d  %d  %d )\n", m_SeedIndex[0], m_SeedIndex[1], m_SeedIndex[2] );
-        m_ConfidenceConnectedModule.SetSeedPoint( m_SeedIndex[0], m_SeedIndex[1], m_SeedIndex[2] );
+        SetSeedsOfModule( m_ConfidenceConnectedModule, m_AddedSeeds, m_SeedIndex );
         m_ConfidenceConnectedModule.Execute();
         m_SegmentedVolume = m_ConfidenceConnectedModule.GetOutput(); 
        break;
@@ -121,7 +170,7 @@ bool  LiverTumorSegmentationBase::DoSegmentation( SegmentationModuleType sType )
       case CONNECTED_THRESHOLD:
         m_ConnectedThresholdModule.SetInput( m_LoadedVolume );
         printf("Seed Index -> ( %d  %d  %d )\n", m_SeedIndex[0], m_SeedIndex[1], m_SeedIndex[2] );
-        m_ConnectedThresholdModule.SetSeedPoint( m_SeedIndex[0], m_SeedIndex[1], m_SeedIndex[2] );
+        SetSeedsOfModule( m_ConnectedThresholdModule, m_AddedSeeds, m_SeedIndex );
         m_ConnectedThresholdModule.Execute();
         m_SegmentedVolume = m_ConnectedThresholdModule.GetOutput(); 
         break;
@@ -129,7 +178,7 @@ bool  LiverTumorSegmentationBase::DoSegmentation( SegmentationModuleType sType )
       case THRESHOLD_LEVEL_SET:
         m_ThresholdLevelSetModule.SetInput( m_LoadedVolume );
         printf("Seed Index -> ( %d  %d  %d )\n", m_SeedIndex[0], m_SeedIndex[1], m_SeedIndex[2] );
-        m_ThresholdLevelSetModule.SetSeedPoint( m_SeedIndex[0], m_SeedIndex[1], m_SeedIndex[2] );
+        SetSeedsOfModule( m_ThresholdLevelSetModule, m_AddedSeeds, m_SeedIndex );
         m_ThresholdLevelSetModule.Execute();
         m_SegmentedVolume = m_ThresholdLevelSetModule.GetOutput(); 
         break;
@@ -13,6 +13,8 @@
 #include "ConnectedThresholdModule.h"
 #include "ThresholdLevelSetSegmentationModule.h"
 
+#include <vector>
+
 /** 
   \class LiverTumorSegmentationBase 
   \brief This class is the base class for the Liver Tumor Segmentation. 
@@ -27,6 +29,8 @@
   any input data from CT modality needs to be preprocessed. The ResampleVolume
   code may be used for converting a CT volume data to a "unsigned char" volume
   data. The resampling code also does resampling for homogenizing the data. 
+  The region growing modules keep their region between segmentations: seeds
+  added with AddSeedPoint() are grown into the current region alone.
 */
 
 const int NUMBER_OF_ALGORITHMS = 7;
@@ -71,6 +75,8 @@ public:
 
   typedef  itk::ImageFileWriter<  OutputImageType  > WriterType;
 
+  typedef  VolumeType::IndexType                       SeedIndexType;
+
 public:
   
   LiverTumorSegmentationBase();
@@ -84,6 +90,16 @@ public:
   /** GetSeedPoint gets the seed point chosen for segmentation.
   */
   virtual void GetSeedPoint(double data[3]); 
+
+  /** AddSeedPoint adds the current seed point to the seeds of the next 
+  segmentations. The seed point is then used after the added ones.
+  */
+  virtual void AddSeedPoint( void );
+
+  /** ClearSeedPoints removes the added seeds, only the current seed point
+  is used.
+  */
+  virtual void ClearSeedPoints( void );
   
   /** DoSegmentation method does the segmentation of data. The input parameter 
   is the module id of the segmentation module to be used for segmentation. The
@@ -118,6 +134,8 @@ protected:
 
   double                                    m_SeedValue;
 
+  std::vector< SeedIndexType >              m_AddedSeeds;
+
   VolumeReaderType::Pointer               m_VolumeReader;
   
   RescaleIntensityFilterType::Pointer     m_RescaleIntensity;
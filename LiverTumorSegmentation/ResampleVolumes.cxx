@@ -19,19 +19,24 @@
 #include "itkImage.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkResampleImageFilter.h"
-#include "itkIdentityTransform.h"
-#include "itkLinearInterpolateImageFunction.h"
 #include "itkRecursiveGaussianImageFilter.h"
 #include "itkIntensityWindowingImageFilter.h"
+#include "itkMultiPhaseResampleImageFilter.h"
 
+#include <vector>
+
+
+// The phases of a study are co-registered volumes on the same grid. They
+// are resampled together: the interpolation weights are computed once for
+// all of them.
 
 int main( int argc, char * argv[] )
 {
-  if( argc < 5 )
+  if( argc < 5 || ( argc - 5 ) % 2 != 0 )
     {
     std::cerr << "Usage: " << std::endl;
-    std::cerr << argv[0] << "  inputImageFile  outputImageFile  lower upper " << std::endl; 
+    std::cerr << argv[0] << "  inputImageFile  outputImageFile  lower upper " 
+              << " [inputImageFile  outputImageFile ...]" << std::endl; 
     return 1;
     }
 
@@ -48,11 +53,32 @@ int main( int argc, char * argv[] )
   typedef itk::ImageFileReader< InputImageType  >  ReaderType;
   typedef itk::ImageFileWriter< OutputImageType >  WriterType;
 
+  typedef itk::IntensityWindowingImageFilter< 
+                                  InputImageType, 
+                                  InternalImageType >  IntensityFilterType;
+
+  typedef itk::RecursiveGaussianImageFilter< 
+                                  InternalImageType,
+                                  InternalImageType > GaussianFilterType;
+
+  typedef itk::MultiPhaseResampleImageFilter<
+                  InternalImageType, OutputImageType >  ResampleFilterType;
+
+  std::vector< const char * > inputFileNames;
+  std::vector< const char * > outputFileNames;
+  inputFileNames.push_back( argv[1] );
+  outputFileNames.push_back( argv[2] );
+  for( int i = 5; i + 1 < argc; i += 2 )
+    {
+    inputFileNames.push_back( argv[i] );
+    outputFileNames.push_back( argv[i+1] );
+    }
+
+  const unsigned int numberOfPhases = inputFileNames.size();
+
   ReaderType::Pointer reader = ReaderType::New();
-  WriterType::Pointer writer = WriterType::New();
 
-  reader->SetFileName( argv[1] );
-  writer->SetFileName( argv[2] );
+  reader->SetFileName( inputFileNames[0] );
 
   try 
     {
@@ -75,66 +101,60 @@ int main( int argc, char * argv[] )
 
   const double isoSpacing = sqrt( inputSpacing[2] * inputSpacing[0] );
 
-  typedef itk::IntensityWindowingImageFilter< 
-                                  InputImageType, 
-                                  InternalImageType >  IntensityFilterType;
-
-  IntensityFilterType::Pointer intensityWindowing = IntensityFilterType::New();
-
-  intensityWindowing->SetWindowMinimum( atoi( argv[3] ) );
-  intensityWindowing->SetWindowMaximum( atoi( argv[4] ) );
-
-  intensityWindowing->SetOutputMinimum(   0.0 );
-  intensityWindowing->SetOutputMaximum( 255.0 ); // floats but in the range of chars.
-
-
-  typedef itk::RecursiveGaussianImageFilter< 
-                                  InternalImageType,
-                                  InternalImageType > GaussianFilterType;
-
-  GaussianFilterType::Pointer smootherX = GaussianFilterType::New();
-  GaussianFilterType::Pointer smootherY = GaussianFilterType::New();
-
-  intensityWindowing->SetInput( reader->GetOutput() );
-  smootherX->SetInput( intensityWindowing->GetOutput() );
-  smootherY->SetInput( smootherX->GetOutput() );
+  ResampleFilterType::Pointer resampler = ResampleFilterType::New();
 
-  smootherX->SetSigma( isoSpacing );
-  smootherY->SetSigma( isoSpacing );
+  // highlight regions without source
+  const OutputPixelType defaultPixelValue = 100;
+  resampler->SetDefaultPixelValue( defaultPixelValue ); 
 
-  smootherX->SetNormalizeAcrossScale( true );
-  smootherY->SetNormalizeAcrossScale( true );
+  std::vector< GaussianFilterType::Pointer > smoothers;
 
-  try 
+  for( unsigned int phase = 0; phase < numberOfPhases; phase++ )
     {
-    smootherY->Update();
-    }
-  catch( itk::ExceptionObject & excep )
-    {
-    std::cerr << "Exception catched !" << std::endl;
-    std::cerr << excep << std::endl;
-    }
+    if( phase > 0 )
+      {
+      reader = ReaderType::New();
+      reader->SetFileName( inputFileNames[phase] );
+      }
 
+    IntensityFilterType::Pointer intensityWindowing = IntensityFilterType::New();
 
-  InternalImageType::ConstPointer smoothedImage = smootherY->GetOutput();
+    intensityWindowing->SetWindowMinimum( atoi( argv[3] ) );
+    intensityWindowing->SetWindowMaximum( atoi( argv[4] ) );
 
-  typedef itk::ResampleImageFilter<
-                  InternalImageType, OutputImageType >  ResampleFilterType;
+    intensityWindowing->SetOutputMinimum(   0.0 );
+    intensityWindowing->SetOutputMaximum( 255.0 ); // floats but in the range of chars.
 
-  ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+    GaussianFilterType::Pointer smootherX = GaussianFilterType::New();
+    GaussianFilterType::Pointer smootherY = GaussianFilterType::New();
 
-  typedef itk::IdentityTransform< double, Dimension >  TransformType;
+    intensityWindowing->SetInput( reader->GetOutput() );
+    smootherX->SetInput( intensityWindowing->GetOutput() );
+    smootherY->SetInput( smootherX->GetOutput() );
 
-  typedef itk::LinearInterpolateImageFunction< 
-                                   InternalImageType, double >  InterpolatorType;
+    smootherX->SetSigma( isoSpacing );
+    smootherY->SetSigma( isoSpacing );
 
-  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+    smootherX->SetNormalizeAcrossScale( true );
+    smootherY->SetNormalizeAcrossScale( true );
 
-  resampler->SetInterpolator( interpolator );
+    // only the smoothed phases are kept until they are resampled
+    intensityWindowing->ReleaseDataFlagOn();
+    smootherX->ReleaseDataFlagOn();
 
-  // highlight regions without source
-  const OutputPixelType defaultPixelValue = 100;
-  resampler->SetDefaultPixelValue( defaultPixelValue ); 
+    try 
+      {
+      smootherY->Update();
+      }
+    catch( itk::ExceptionObject & excep )
+      {
+      std::cerr << "Exception catched !" << std::endl;
+      std::cerr << excep << std::endl;
+      }
+
+    smoothers.push_back( smootherY );
+    resampler->SetInput( phase, smootherY->GetOutput() );
+    }
 
 
   double spacing[ Dimension ];
@@ -158,20 +178,17 @@ int main( int argc, char * argv[] )
 
   resampler->SetSize( size );
 
-  resampler->SetInput( smoothedImage );
-
-  writer->SetInput( resampler->GetOutput() );
-
-  TransformType::Pointer transform = TransformType::New();
-
-  transform->SetIdentity();
-
-  resampler->SetTransform( transform );
-
-  
   try 
     {
-    writer->Update();
+    resampler->Update();
+
+    for( unsigned int phase = 0; phase < numberOfPhases; phase++ )
+      {
+      WriterType::Pointer writer = WriterType::New();
+      writer->SetFileName( outputFileNames[phase] );
+      writer->SetInput( resampler->GetOutput( phase ) );
+      writer->Update();
+      }
     }
   catch( itk::ExceptionObject & excep )
     {
@@ -182,4 +199,3 @@ int main( int argc, char * argv[] )
 
   return 0;
 }
-
@@ -17,25 +17,29 @@
 
 
 #include "ThresholdLevelSetSegmentationModule.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "vnl/vnl_math.h"
 
 namespace ISIS {
   
   ThresholdLevelSetSegmentationModule::ThresholdLevelSetSegmentationModule()
   {  
     m_RescaleIntensityFilter      =   RescaleIntensityFilterType::New();
-    m_ConfidenceConnectedFilter   =   ConnectedFilterType::New();
     m_ThresholdLevelSetFilter     =   ThresholdLevelSetFilterType::New();
     m_RescaleOutputFilter         =   OutputRescaleIntensityFilterType::New();  
     m_CastFeatureFilter           =   CastFeatureFilterType::New();
+    m_BrickedEvolution            =   BrickedEvolutionType::New();
+    m_FeatureCacheInputTime       =   0;
     
     m_Multiplier = 1.5f;
     m_NumberOfIterations = 5;
     m_InitialNeighborhoodRadius = 2;
 
-    m_ConfidenceConnectedFilter->SetReplaceValue( 255 );
-    //m_ConfidenceConnectedFilter->SetMultiplier( m_Multiplier ); 
-    //m_ConfidenceConnectedFilter->SetNumberOfIterations( m_NumberOfIterations ); 
-    //m_ConfidenceConnectedFilter->SetInitialNeighborhoodRadius( m_InitialNeighborhoodRadius ); 
+    m_UseBrickedLevelSet = true;
+    m_BrickSize = 32;
+
+    m_RegionGrowing.SetReplaceValue( 255 );
     
     m_RescaleIntensityFilter->SetOutputMinimum( -4.0 ); 
     m_RescaleIntensityFilter->SetOutputMaximum(  4.0 ); 
@@ -44,15 +48,22 @@ namespace ISIS {
     m_RescaleOutputFilter->SetOutputMaximum( 255 );
     
     m_ThresholdLevelSetFilter->SetFeatureImage( m_CastFeatureFilter->GetOutput() );  
-    m_RescaleIntensityFilter->SetInput( m_ConfidenceConnectedFilter->GetOutput() );
+    m_RescaleIntensityFilter->SetInput( m_RegionGrowing.GetOutput() );
     m_ThresholdLevelSetFilter->SetInput( m_RescaleIntensityFilter->GetOutput() );
     m_RescaleOutputFilter->SetInput( m_ThresholdLevelSetFilter->GetOutput() );
+
+    // The bricked evolution starts from the confidence connected region
+    // itself, whose isosurface is between 0 and 255, and pulls the feature
+    // image brick by brick from the cast filter.
+    m_BrickedEvolution->SetFilter( m_ThresholdLevelSetFilter );
+    m_BrickedEvolution->SetInitialImage( m_RegionGrowing.GetOutput() );
+    m_BrickedEvolution->SetIsoSurfaceValue( 127.5 );
+    m_BrickedEvolution->SetFeatureImage( m_CastFeatureFilter->GetOutput() );
     
-    // Allow filter to release data as the execution of
-    // pipeline progresses from filter to filter.
-    // This reduces memory consumption
-    m_ConfidenceConnectedFilter->ReleaseDataFlagOn();
-    m_RescaleIntensityFilter->ReleaseDataFlagOn();
+    // The level set filter releases its output once rescaled. The
+    // rescaled region and the feature image are kept between executions,
+    // they are only computed again when the region or the input change.
+    m_RescaleIntensityFilter->ReleaseDataFlagOff();
     m_ThresholdLevelSetFilter->ReleaseDataFlagOn();
     
     
@@ -63,10 +74,9 @@ namespace ISIS {
     m_ProgressAccumulator->SetMiniPipelineFilter( m_Notifier );
     
     // Register the filters with the progress accumulator
-    m_ProgressAccumulator->RegisterInternalFilter(m_ConfidenceConnectedFilter,0.1f);
     m_ProgressAccumulator->RegisterInternalFilter(m_RescaleIntensityFilter,0.2f);
     m_ProgressAccumulator->RegisterInternalFilter(m_CastFeatureFilter,0.2f);
-    m_ProgressAccumulator->RegisterInternalFilter(m_ThresholdLevelSetFilter,  0.5f);
+    m_ProgressAccumulator->RegisterInternalFilter(m_ThresholdLevelSetFilter,  0.6f);
     m_ProgressAccumulator->ResetProgress();
 
     m_LowerThreshold = 80.0f; 
@@ -94,7 +104,7 @@ namespace ISIS {
     ThresholdLevelSetSegmentationModule
     ::SetInput( const InputImageType * image )
   {
-    m_ConfidenceConnectedFilter->SetInput( image );
+    m_RegionGrowing.SetInput( image );
     m_CastFeatureFilter->SetInput( image );  
   }
   
@@ -104,6 +114,10 @@ namespace ISIS {
     ThresholdLevelSetSegmentationModule
     ::GetOutput()
   {
+    if( m_BrickedOutput )
+      {
+      return m_BrickedOutput;
+      }
     return m_RescaleOutputFilter->GetOutput();
   }
   
@@ -113,7 +127,7 @@ namespace ISIS {
     ThresholdLevelSetSegmentationModule
     ::GetInitialSegmentationOutput()
   {
-    return m_ConfidenceConnectedFilter->GetOutput();
+    return m_RegionGrowing.GetOutput();
   }
 
   
@@ -126,7 +140,21 @@ namespace ISIS {
     SeedPoint[0] = x;
     SeedPoint[1] = y;
     SeedPoint[2] = z;
-    m_ConfidenceConnectedFilter->SetSeed( SeedPoint );
+    m_Seeds.clear();
+    m_Seeds.push_back( SeedPoint );
+  }
+  
+  
+  void
+    ThresholdLevelSetSegmentationModule
+    ::AddSeedPoint( int x, int y, int z )
+  {
+    typedef InternalImageType::IndexType   IndexType;
+    IndexType SeedPoint;
+    SeedPoint[0] = x;
+    SeedPoint[1] = y;
+    SeedPoint[2] = z;
+    m_Seeds.push_back( SeedPoint );
   }
   
   
@@ -143,9 +171,10 @@ namespace ISIS {
       std::cout << "Initiating Threshold Level Set parameters..." << std::endl;
       
       // Set the variable values into itk Objects
-      m_ConfidenceConnectedFilter->SetMultiplier( m_Multiplier ); 
-      m_ConfidenceConnectedFilter->SetNumberOfIterations( m_NumberOfIterations ); 
-      m_ConfidenceConnectedFilter->SetInitialNeighborhoodRadius( m_InitialNeighborhoodRadius ); 
+      m_RegionGrowing.SetMultiplier( m_Multiplier ); 
+      m_RegionGrowing.SetNumberOfIterations( m_NumberOfIterations ); 
+      m_RegionGrowing.SetInitialNeighborhoodRadius( m_InitialNeighborhoodRadius ); 
+      m_RegionGrowing.SetSeeds( m_Seeds );
 
       m_ThresholdLevelSetFilter->SetLowerThreshold( m_LowerThreshold );
       m_ThresholdLevelSetFilter->SetUpperThreshold( m_UpperThreshold );
@@ -158,23 +187,39 @@ namespace ISIS {
       // Initialize the progress counter
       m_ProgressAccumulator->ResetProgress();
       
-      m_ConfidenceConnectedFilter->Update();
+      m_RegionGrowing.Update();
       
-      std::cout << "Region growing initialization for level set" << std::endl;
+      std::cout << "Region growing initialization for level set, "
+                << m_RegionGrowing.GetNumberOfPixels() << " pixels"
+                << ( m_RegionGrowing.GetLastUpdateWasIncremental() ?
+                     " (incremental)" : "" ) << std::endl;
       
-      m_RescaleIntensityFilter->Update();
+      if( m_UseBrickedLevelSet )
+        {
+        this->ExecuteBricked();
+        }
+      else
+        {
+        m_BrickedOutput = 0;
+        m_ThresholdLevelSetFilter->SetInput( m_RescaleIntensityFilter->GetOutput() );
+        m_ThresholdLevelSetFilter->SetFeatureImage( m_CastFeatureFilter->GetOutput() );
+
+        m_RescaleIntensityFilter->Update();
       
-      std::cout << "Input rescaled" << std::endl;
+        std::cout << "Input rescaled" << std::endl;
       
-      m_CastFeatureFilter->Update();
+        // the bricked evolution leaves brick-sized requested regions in the
+        // feature pipeline and on the outputs
+        m_CastFeatureFilter->UpdateLargestPossibleRegion();
       
-      std::cout << "Input casted for feature image" << std::endl;
+        std::cout << "Input casted for feature image" << std::endl;
       
-      m_ThresholdLevelSetFilter->Update();
+        m_ThresholdLevelSetFilter->UpdateLargestPossibleRegion();
       
-      std::cout << "Threshold Segmentation Level Set done" << std::endl;
+        std::cout << "Threshold Segmentation Level Set done" << std::endl;
       
-      m_RescaleOutputFilter->Update();
+        m_RescaleOutputFilter->UpdateLargestPossibleRegion();
+        }
       
       std::cout << "Output rescaled" << std::endl;
     }
@@ -186,8 +231,60 @@ namespace ISIS {
   }
 
 
+  void ThresholdLevelSetSegmentationModule::ExecuteBricked()
+  {
+    // The cached feature bricks stay valid for the same volume. A reader
+    // gives a new volume through the same image object, so the data are
+    // told apart by their time, as IncrementalRegionGrowing does.
+    const InputImageType * input = m_CastFeatureFilter->GetInput();
+    const unsigned long inputTime =
+        vnl_math_max( input->GetMTime(), input->GetUpdateMTime() );
+    if( inputTime != m_FeatureCacheInputTime )
+      {
+      m_BrickedEvolution->ReleaseFeatureCache();
+      m_FeatureCacheInputTime = inputTime;
+      }
+
+    m_BrickedEvolution->SetBrickSize( m_BrickSize );
+    m_BrickedEvolution->Update();
+
+    std::cout << "Threshold Segmentation Level Set done on "
+              << m_BrickedEvolution->GetRegion().GetSize()
+              << " pixels in " << m_BrickedEvolution->GetNumberOfRounds()
+              << " rounds, " << m_BrickedEvolution->GetNumberOfFeatureBricks()
+              << " of " << m_BrickedEvolution->GetNumberOfBricks()
+              << " feature bricks computed" << std::endl;
+
+    // the region changes from one run to the next
+    m_RescaleOutputFilter->UpdateLargestPossibleRegion();
+
+    // Paste the region into a mask of the whole volume, outside is 0
+    const OutputImageType * region = m_RescaleOutputFilter->GetOutput();
+    const MaskImageType * mask = m_RegionGrowing.GetOutput();
+
+    m_BrickedOutput = OutputImageType::New();
+    m_BrickedOutput->CopyInformation( mask );
+    m_BrickedOutput->SetRegions( mask->GetLargestPossibleRegion() );
+    m_BrickedOutput->Allocate();
+    m_BrickedOutput->FillBuffer( 0 );
+
+    typedef itk::ImageRegionConstIterator< OutputImageType > InputIteratorType;
+    typedef itk::ImageRegionIterator< OutputImageType >      OutputIteratorType;
+    InputIteratorType  in( region, region->GetBufferedRegion() );
+    OutputIteratorType out( m_BrickedOutput, region->GetBufferedRegion() );
+    for( ; !in.IsAtEnd(); ++in, ++out )
+      {
+      out.Set( in.Get() );
+      }
+  }
+
+
   int ThresholdLevelSetSegmentationModule::GetElapsedIterations( void )
   {
+    if( m_BrickedOutput )
+      {
+      return m_BrickedEvolution->GetElapsedIterations();
+      }
     return m_ThresholdLevelSetFilter->GetElapsedIterations();
   }
 
@@ -18,7 +18,6 @@
 #ifndef __ThresholdLevelSetSegmentationModule_h__
 #define __ThresholdLevelSetSegmentationModule_h__
 
-#include "itkConfidenceConnectedImageFilter.h"
 #include "itkMedianImageFilter.h"
 #include "itkThresholdSegmentationLevelSetImageFilter.h"
 #include "itkAntiAliasBinaryImageFilter.h"
@@ -27,6 +26,8 @@
 #include "itkImage.h"
 #include "itkProgressAccumulator.h"
 #include "itkProcessObject.h"
+#include "itkBrickedLevelSetEvolution.h"
+#include "IncrementalConfidenceConnected.h"
 
 
 #include "macros.h"
@@ -42,6 +43,17 @@
   intensity levels be windowed for the range of intensities of the
   liver and the tumor.
 
+  By default the level set only runs on the bricks of the volume around
+  the region found by the confidence connected filter, see
+  itk::BrickedLevelSetEvolution. The region grows with the front, and the
+  feature image is only computed on it. The output is still a mask of the
+  whole volume.
+
+  The confidence connected region, the rescaled level set and the feature
+  image are kept between executions. A seed added with AddSeedPoint() is
+  grown into the current region alone, and the feature image is only
+  computed again for a new input.
+
 
 */
 
@@ -103,14 +115,16 @@ public:
   typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
 
 
-  /** Image Type for the output of the Confidence Connected filter */
+  /** Image Type for the output of the Confidence Connected region */
   typedef itk::Image< MaskPixelType,   Dimension > MaskImageType;
 
 
 
-  typedef  itk::ConfidenceConnectedImageFilter< 
+  typedef  IncrementalConfidenceConnected< 
                                   InputImageType, 
-                                  MaskImageType > ConnectedFilterType;
+                                  MaskImageType > RegionGrowingType;
+
+  typedef  RegionGrowingType::SeedContainer       SeedContainer;
 
 
   typedef  itk::RescaleIntensityImageFilter<
@@ -131,6 +145,11 @@ public:
                                   ThresholdLevelSetFilterType::OutputImageType,
                                   OutputImageType > OutputRescaleIntensityFilterType;
 
+  /** Runs the level set on the bricks around the front only */
+  typedef  itk::BrickedLevelSetEvolution<
+                                  ThresholdLevelSetFilterType,
+                                  MaskImageType > BrickedEvolutionType;
+
   /** Progress accumulator object */
   typedef itk::ProgressAccumulator::Pointer           AccumulatorPointer;
 
@@ -149,6 +168,9 @@ public:
 
     void SetSeedPoint( int x, int y, int z );
 
+    /** One more seed, grown into the current region */
+    void AddSeedPoint( int x, int y, int z );
+
     void Execute();
 
    int GetElapsedIterations( void );
@@ -181,10 +203,20 @@ public:
   SetMacro( InitialNeighborhoodRadius, unsigned int );
   SetMacro( NumberOfIterations, unsigned int );
 
+  GetMacro( UseBrickedLevelSet, bool );
+  GetMacro( BrickSize, unsigned int );
+  SetMacro( UseBrickedLevelSet, bool );
+  SetMacro( BrickSize, unsigned int );
+
 
 private:
 
-    ConnectedFilterType::Pointer                  m_ConfidenceConnectedFilter;
+    /** Level set on the bricks around the mask, output over the volume */
+    void ExecuteBricked();
+
+    RegionGrowingType                             m_RegionGrowing;
+
+    SeedContainer                                 m_Seeds;
 
     RescaleIntensityFilterType::Pointer           m_RescaleIntensityFilter;
 
@@ -193,6 +225,14 @@ private:
     OutputRescaleIntensityFilterType::Pointer     m_RescaleOutputFilter;
 
     CastFeatureFilterType::Pointer                m_CastFeatureFilter;
+
+    BrickedEvolutionType::Pointer                 m_BrickedEvolution;
+
+    /** Time of the input data from which the feature bricks were cached */
+    unsigned long                                 m_FeatureCacheInputTime;
+
+    /** Mask of the whole volume when the level set ran on bricks */
+    OutputImageType::Pointer                      m_BrickedOutput;
        
    /** Progress tracking object */
    AccumulatorPointer        m_ProgressAccumulator;
@@ -210,6 +250,9 @@ private:
    float          m_Multiplier;
    unsigned int   m_NumberOfIterations;
    unsigned int   m_InitialNeighborhoodRadius;
+   /** Parameters for the bricked evolution */
+   bool           m_UseBrickedLevelSet;
+   unsigned int   m_BrickSize;
 
 };
 
@@ -0,0 +1,166 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMultiPhaseResampleImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkMultiPhaseResampleImageFilter_h
+#define _itkMultiPhaseResampleImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkImage.h"
+#include "itkFixedArray.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class MultiPhaseResampleImageFilter
+ *
+ * Resamples several co-registered volumes, the phases of a study, to the
+ * same output grid with linear interpolation. Input i gives output i.
+ *
+ * The inputs must share their size, origin, spacing and direction. The
+ * output has the direction of the inputs, and the transform from the
+ * output to the inputs is limited to a scaling along the image axes,
+ * by Scale around the physical point Center; the identity by default.
+ * The position of an output pixel in the inputs is then separable: along
+ * each axis the input indices and the interpolation weights are computed
+ * once for all the output pixels, and each output row is interpolated
+ * from at most 2^(N-1) input rows with a single weight per axis.
+ *
+ * The rows are shared by the phases: their offsets and weights are
+ * computed once per output row and applied to every input in turn. Rows
+ * with a zero weight are skipped, so that resampling along the last axes
+ * only, or to the input grid, reads each input pixel once.
+ *
+ * The output is computed by the threads of the filter on slabs along the
+ * last axis. Pixels mapped outside of the inputs are set to
+ * DefaultPixelValue.
+ *
+ * \ingroup IntensityImageFilters
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT MultiPhaseResampleImageFilter :
+    public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiPhaseResampleImageFilter                  Self;
+  typedef ImageToImageFilter<TInputImage, TOutputImage>  Superclass;
+  typedef SmartPointer<Self>                             Pointer;
+  typedef SmartPointer<const Self>                       ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MultiPhaseResampleImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TOutputImage::ImageDimension);
+
+  typedef TInputImage                              InputImageType;
+  typedef typename InputImageType::PixelType       InputPixelType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename OutputImageType::PixelType      OutputPixelType;
+  typedef typename OutputImageType::RegionType     RegionType;
+  typedef typename OutputImageType::SizeType       SizeType;
+  typedef typename OutputImageType::IndexType      IndexType;
+  typedef typename OutputImageType::SpacingType    SpacingType;
+  typedef typename OutputImageType::PointType      PointType;
+  typedef FixedArray<double, itkGetStaticConstMacro(ImageDimension)>
+                                                   ScaleType;
+
+  /** Phase i of the study, resampled into GetOutput( i ). */
+  void SetInput( unsigned int phase, const InputImageType * image );
+  void SetInput( const InputImageType * image )
+    { this->SetInput( 0, image ); }
+
+  unsigned int GetNumberOfPhases() const
+    { return this->GetNumberOfInputs(); }
+
+  /** Output grid */
+  itkSetMacro( Size, SizeType );
+  itkGetConstReferenceMacro( Size, SizeType );
+  itkSetMacro( OutputSpacing, SpacingType );
+  virtual void SetOutputSpacing( const double * spacing );
+  itkGetConstReferenceMacro( OutputSpacing, SpacingType );
+  itkSetMacro( OutputOrigin, PointType );
+  virtual void SetOutputOrigin( const double * origin );
+  itkGetConstReferenceMacro( OutputOrigin, PointType );
+
+  /** Scaling along the image axes from the output to the inputs */
+  itkSetMacro( Scale, ScaleType );
+  itkGetConstReferenceMacro( Scale, ScaleType );
+  itkSetMacro( Center, PointType );
+  itkGetConstReferenceMacro( Center, PointType );
+
+  itkSetMacro( DefaultPixelValue, OutputPixelType );
+  itkGetConstMacro( DefaultPixelValue, OutputPixelType );
+
+protected:
+  MultiPhaseResampleImageFilter();
+  virtual ~MultiPhaseResampleImageFilter() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** The whole inputs are needed and the whole outputs are produced. */
+  virtual void GenerateOutputInformation();
+  virtual void GenerateInputRequestedRegion();
+  virtual void EnlargeOutputRequestedRegion( DataObject * );
+
+  void GenerateData();
+
+private:
+  MultiPhaseResampleImageFilter( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  /** Input indices and weights of the output pixels along one axis: the
+   * output pixel i is (1 - w) input[i0] + w input[i0 + step], with step
+   * 0 on the last input pixel. Pixels outside of the input are marked by
+   * a negative index. */
+  struct AxisWeights
+    {
+    std::vector<long>   Index;
+    std::vector<long>   Step;
+    std::vector<float>  Weight;
+    };
+
+  /** Fill the weights of each axis for the current inputs and grid. */
+  void ComputeAxisWeights();
+
+  static ITK_THREAD_RETURN_TYPE ResampleThreaderCallback( void * arg );
+
+  /** Resample the slices of the slab for all the phases. */
+  void ThreadedResample( unsigned int slab );
+
+  SizeType                     m_Size;
+  SpacingType                  m_OutputSpacing;
+  PointType                    m_OutputOrigin;
+  ScaleType                    m_Scale;
+  PointType                    m_Center;
+  OutputPixelType              m_DefaultPixelValue;
+
+  AxisWeights                  m_Axes[ImageDimension];
+  unsigned long                m_InputStrides[ImageDimension];
+  std::vector<unsigned long>   m_SlabStart;
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiPhaseResampleImageFilter.txx"
+#endif
+
+#endif
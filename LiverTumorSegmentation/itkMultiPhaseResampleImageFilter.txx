@@ -0,0 +1,486 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMultiPhaseResampleImageFilter.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkMultiPhaseResampleImageFilter_txx
+#define _itkMultiPhaseResampleImageFilter_txx
+
+#include "itkMultiPhaseResampleImageFilter.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+
+#include <cmath>
+
+namespace itk
+{
+
+template <class TInputImage, class TOutputImage>
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::MultiPhaseResampleImageFilter()
+{
+  m_Size.Fill( 0 );
+  m_OutputSpacing.Fill( 1.0 );
+  m_OutputOrigin.Fill( 0.0 );
+  m_Scale.Fill( 1.0 );
+  m_Center.Fill( 0.0 );
+  m_DefaultPixelValue = NumericTraits<OutputPixelType>::Zero;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    m_InputStrides[d] = 0;
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::SetInput( unsigned int phase, const InputImageType * image )
+{
+  this->ProcessObject::SetNthInput( phase,
+                                    const_cast<InputImageType *>( image ) );
+
+  // one output per phase
+  for ( unsigned int i = this->GetNumberOfOutputs(); i <= phase; i++ )
+    {
+    typename OutputImageType::Pointer output = OutputImageType::New();
+    this->ProcessObject::SetNthOutput( i, output.GetPointer() );
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::SetOutputSpacing( const double * spacing )
+{
+  SpacingType s;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    s[d] = spacing[d];
+    }
+  this->SetOutputSpacing( s );
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::SetOutputOrigin( const double * origin )
+{
+  PointType p;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    p[d] = origin[d];
+    }
+  this->SetOutputOrigin( p );
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::GenerateOutputInformation()
+{
+  const InputImageType * first = this->GetInput( 0 );
+  if ( !first )
+    {
+    return;
+    }
+
+  // the phases must be on the same grid to share the weights
+  for ( unsigned int i = 1; i < this->GetNumberOfInputs(); i++ )
+    {
+    const InputImageType * input = this->GetInput( i );
+    if ( !input ||
+         input->GetLargestPossibleRegion() != first->GetLargestPossibleRegion() ||
+         input->GetSpacing() != first->GetSpacing() ||
+         input->GetOrigin() != first->GetOrigin() ||
+         input->GetDirection() != first->GetDirection() )
+      {
+      itkExceptionMacro( << "Phase " << i
+                         << " is missing or not on the grid of phase 0" );
+      }
+    }
+
+  RegionType region;
+  region.SetSize( m_Size );
+  for ( unsigned int i = 0; i < this->GetNumberOfOutputs(); i++ )
+    {
+    OutputImageType * output = this->GetOutput( i );
+    if ( !output )
+      {
+      continue;
+      }
+    output->SetLargestPossibleRegion( region );
+    output->SetSpacing( m_OutputSpacing );
+    output->SetOrigin( m_OutputOrigin );
+    output->SetDirection( first->GetDirection() );
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+  for ( unsigned int i = 0; i < this->GetNumberOfInputs(); i++ )
+    {
+    InputImageType * input =
+      const_cast<InputImageType *>( this->GetInput( i ) );
+    if ( input )
+      {
+      input->SetRequestedRegionToLargestPossibleRegion();
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::ComputeAxisWeights()
+{
+  const InputImageType * input = this->GetInput( 0 );
+  const RegionType inputRegion = input->GetBufferedRegion();
+  const SpacingType & inputSpacing = input->GetSpacing();
+  const PointType & inputOrigin = input->GetOrigin();
+  const typename InputImageType::DirectionType & direction =
+    input->GetDirection();
+
+  m_InputStrides[0] = 1;
+  for ( unsigned int d = 1; d < ImageDimension; d++ )
+    {
+    m_InputStrides[d] = m_InputStrides[d-1] * inputRegion.GetSize()[d-1];
+    }
+
+  // Center and output origin along the image axes, relative to the input
+  // origin and to the center
+  double centerOffset[ImageDimension];
+  double originOffset[ImageDimension];
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    centerOffset[d] = 0.0;
+    originOffset[d] = 0.0;
+    for ( unsigned int k = 0; k < ImageDimension; k++ )
+      {
+      centerOffset[d] += direction[k][d] * ( m_Center[k] - inputOrigin[k] );
+      originOffset[d] += direction[k][d] * ( m_OutputOrigin[k] - m_Center[k] );
+      }
+    }
+
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    AxisWeights & axis = m_Axes[d];
+    const unsigned long size = m_Size[d];
+    const long inputSize = inputRegion.GetSize()[d];
+    const long stride = m_InputStrides[d];
+    axis.Index.resize( size );
+    axis.Step.resize( size );
+    axis.Weight.resize( size );
+
+    for ( unsigned long i = 0; i < size; i++ )
+      {
+      const double position = centerOffset[d] + m_Scale[d] *
+        ( originOffset[d] + m_OutputSpacing[d] * i );
+      double x = position / inputSpacing[d] - inputRegion.GetIndex()[d];
+
+      // on an input pixel up to rounding, so that resampling to the input
+      // grid copies the pixels instead of blending two of them
+      const double nearest = std::floor( x + 0.5 );
+      if ( std::fabs( x - nearest ) < 1e-6 )
+        {
+        x = nearest;
+        }
+
+      if ( x < -0.5 || x >= inputSize - 0.5 )
+        {
+        axis.Index[i] = -1;
+        axis.Step[i] = 0;
+        axis.Weight[i] = 0.0f;
+        continue;
+        }
+
+      long i0 = static_cast<long>( std::floor( x ) );
+      double w = x - i0;
+      if ( i0 < 0 )
+        {
+        i0 = 0;
+        w = 0.0;
+        }
+      if ( i0 >= inputSize - 1 )
+        {
+        i0 = inputSize - 1;
+        w = 0.0;
+        }
+      axis.Index[i] = i0 * stride;
+      axis.Step[i] = ( w > 0.0 ) ? stride : 0;
+      axis.Weight[i] = static_cast<float>( w );
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::GenerateData()
+{
+  for ( unsigned int i = 0; i < this->GetNumberOfInputs(); i++ )
+    {
+    if ( !this->GetInput( i ) )
+      {
+      itkExceptionMacro( << "Phase " << i << " is not set" );
+      }
+    }
+
+  this->AllocateOutputs();
+  this->ComputeAxisWeights();
+
+  const unsigned long slices = m_Size[ImageDimension - 1];
+  if ( slices == 0 )
+    {
+    return;
+    }
+  const unsigned int numberOfSlabs = vnl_math_min(
+    static_cast<unsigned long>( this->GetNumberOfThreads() ), slices );
+
+  m_SlabStart.resize( numberOfSlabs + 1 );
+  for ( unsigned int s = 0; s <= numberOfSlabs; s++ )
+    {
+    m_SlabStart[s] = ( slices * s ) / numberOfSlabs;
+    }
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfSlabs );
+  this->GetMultiThreader()->SetSingleMethod( Self::ResampleThreaderCallback,
+                                             this );
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::ResampleThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+  self->ThreadedResample( info->ThreadID );
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::ThreadedResample( unsigned int slab )
+{
+  const unsigned int numberOfPhases = this->GetNumberOfInputs();
+  const unsigned long rowLength = m_Size[0];
+  const unsigned int numberOfCorners = 1 << ( ImageDimension - 1 );
+
+  const double minimum =
+    static_cast<double>( NumericTraits<OutputPixelType>::NonpositiveMin() );
+  const double maximum =
+    static_cast<double>( NumericTraits<OutputPixelType>::max() );
+
+  std::vector<const InputPixelType *> inputs( numberOfPhases );
+  std::vector<OutputPixelType *> outputs( numberOfPhases );
+  for ( unsigned int p = 0; p < numberOfPhases; p++ )
+    {
+    inputs[p] = this->GetInput( p )->GetBufferPointer();
+    outputs[p] = this->GetOutput( p )->GetBufferPointer();
+    }
+
+  // Output pixels of a row that fall inside the inputs
+  const AxisWeights & row = m_Axes[0];
+  unsigned long begin = 0;
+  while ( begin < rowLength && row.Index[begin] < 0 )
+    {
+    begin++;
+    }
+  unsigned long end = begin;
+  while ( end < rowLength && row.Index[end] >= 0 )
+    {
+    end++;
+    }
+
+  // Rows read straight from the inputs, without interpolation along them
+  bool contiguous = ( end > begin );
+  for ( unsigned long x = begin; contiguous && x < end; x++ )
+    {
+    contiguous = ( row.Step[x] == 0 &&
+                   row.Index[x] == row.Index[begin] + static_cast<long>( x - begin ) );
+    }
+
+  std::vector<long>  cornerOffsets( numberOfCorners );
+  std::vector<float> cornerWeights( numberOfCorners );
+  std::vector<float> accumulator( rowLength );
+
+  // Index of the row along the axes above the first one
+  IndexType index;
+  index.Fill( 0 );
+  index[ImageDimension - 1] = m_SlabStart[slab];
+
+  unsigned long rowsPerSlice = 1;
+  for ( unsigned int d = 1; d + 1 < ImageDimension; d++ )
+    {
+    rowsPerSlice *= m_Size[d];
+    }
+  const unsigned long numberOfRows = rowsPerSlice *
+    ( m_SlabStart[slab + 1] - m_SlabStart[slab] );
+  unsigned long outputOffset = rowLength * rowsPerSlice * m_SlabStart[slab];
+
+  for ( unsigned long r = 0; r < numberOfRows; r++, outputOffset += rowLength )
+    {
+    bool inside = true;
+    for ( unsigned int d = 1; d < ImageDimension; d++ )
+      {
+      inside = inside && ( m_Axes[d].Index[ index[d] ] >= 0 );
+      }
+
+    // Input rows of the corners and their weights, shared by the phases
+    unsigned int numberOfUsedCorners = 0;
+    for ( unsigned int c = 0; inside && c < numberOfCorners; c++ )
+      {
+      long offset = 0;
+      float weight = 1.0f;
+      for ( unsigned int d = 1; d < ImageDimension; d++ )
+        {
+        const AxisWeights & axis = m_Axes[d];
+        const unsigned long i = index[d];
+        if ( c & ( 1 << ( d - 1 ) ) )
+          {
+          offset += axis.Index[i] + axis.Step[i];
+          weight *= axis.Weight[i];
+          }
+        else
+          {
+          offset += axis.Index[i];
+          weight *= 1.0f - axis.Weight[i];
+          }
+        }
+      if ( weight > 0.0f )
+        {
+        cornerOffsets[numberOfUsedCorners] = offset;
+        cornerWeights[numberOfUsedCorners] = weight;
+        numberOfUsedCorners++;
+        }
+      }
+
+    for ( unsigned int p = 0; p < numberOfPhases; p++ )
+      {
+      OutputPixelType * out = outputs[p] + outputOffset;
+      if ( !inside )
+        {
+        for ( unsigned long x = 0; x < rowLength; x++ )
+          {
+          out[x] = m_DefaultPixelValue;
+          }
+        continue;
+        }
+
+      for ( unsigned long x = 0; x < begin; x++ )
+        {
+        out[x] = m_DefaultPixelValue;
+        }
+      for ( unsigned long x = end; x < rowLength; x++ )
+        {
+        out[x] = m_DefaultPixelValue;
+        }
+
+      if ( contiguous && numberOfUsedCorners == 1 )
+        {
+        // a copy of the input row
+        const InputPixelType * in =
+          inputs[p] + cornerOffsets[0] + row.Index[begin];
+        for ( unsigned long x = begin; x < end; x++ )
+          {
+          const double value = static_cast<double>( in[x - begin] );
+          out[x] = static_cast<OutputPixelType>(
+            vnl_math_max( minimum, vnl_math_min( maximum, value ) ) );
+          }
+        continue;
+        }
+
+      for ( unsigned long x = begin; x < end; x++ )
+        {
+        accumulator[x] = 0.0f;
+        }
+      for ( unsigned int c = 0; c < numberOfUsedCorners; c++ )
+        {
+        const InputPixelType * in = inputs[p] + cornerOffsets[c];
+        const float weight = cornerWeights[c];
+        for ( unsigned long x = begin; x < end; x++ )
+          {
+          const InputPixelType * pixel = in + row.Index[x];
+          const float w = row.Weight[x];
+          accumulator[x] += weight *
+            ( ( 1.0f - w ) * static_cast<float>( pixel[0] ) +
+              w * static_cast<float>( pixel[ row.Step[x] ] ) );
+          }
+        }
+      for ( unsigned long x = begin; x < end; x++ )
+        {
+        const double value = accumulator[x];
+        out[x] = static_cast<OutputPixelType>(
+          vnl_math_max( minimum, vnl_math_min( maximum, value ) ) );
+        }
+      }
+
+    // next row
+    for ( unsigned int d = 1; d < ImageDimension; d++ )
+      {
+      if ( ++index[d] < static_cast<long>( m_Size[d] ) || d + 1 == ImageDimension )
+        {
+        break;
+        }
+      index[d] = 0;
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+MultiPhaseResampleImageFilter<TInputImage,TOutputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Size: " << m_Size << std::endl;
+  os << indent << "OutputSpacing: " << m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << m_OutputOrigin << std::endl;
+  os << indent << "Scale: " << m_Scale << std::endl;
+  os << indent << "Center: " << m_Center << std::endl;
+  os << indent << "DefaultPixelValue: "
+     << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(
+          m_DefaultPixelValue ) << std::endl;
+}
+
+} // namespace itk
+
+#endif
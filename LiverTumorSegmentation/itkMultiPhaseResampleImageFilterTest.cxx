@@ -0,0 +1,285 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMultiPhaseResampleImageFilterTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+// Resamples two phases with itk::MultiPhaseResampleImageFilter on several
+// threads and compares each of them with itk::ResampleImageFilter, a
+// linear interpolator and an itk::ScaleTransform: once with a non integer
+// scale on every axis and an output grid that goes past the inputs, and
+// once on the input grid, where the phases must be copied.
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkResampleImageFilter.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkScaleTransform.h"
+#include "itkMultiPhaseResampleImageFilter.h"
+#include "vnl/vnl_math.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+
+typedef itk::Image< short, 3 >                          InputImageType;
+typedef itk::Image< float, 3 >                          OutputImageType;
+typedef itk::MultiPhaseResampleImageFilter<
+                         InputImageType, OutputImageType > MultiPhaseType;
+typedef itk::ResampleImageFilter<
+                         InputImageType, OutputImageType > ResampleType;
+typedef itk::LinearInterpolateImageFunction<
+                         InputImageType, double >         InterpolatorType;
+typedef itk::ScaleTransform< double, 3 >                 TransformType;
+
+const unsigned int NumberOfPhases = 2;
+const float        DefaultValue = -7.0f;
+
+
+// noisy ramp, different for each phase
+InputImageType::Pointer MakePhase( unsigned int phase )
+{
+  InputImageType::SizeType size;
+  size[0] = 20;
+  size[1] = 18;
+  size[2] = 16;
+  InputImageType::RegionType region;
+  region.SetSize( size );
+
+  InputImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 1.5;
+  spacing[2] = 2.0;
+  InputImageType::PointType origin;
+  origin[0] = 2.0;
+  origin[1] = -3.0;
+  origin[2] = 1.0;
+
+  InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions( region );
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+  image->Allocate();
+
+  unsigned long random = 12345 + phase;
+  itk::ImageRegionIteratorWithIndex< InputImageType > it( image, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    random = random * 1103515245ul + 12345ul;
+    const InputImageType::IndexType index = it.GetIndex();
+    it.Set( static_cast< short >( ( phase + 1 ) * 10 * index[0]
+                                  + 7 * index[1] - 5 * index[2]
+                                  + ( random >> 16 ) % 200 - 100 ) );
+    }
+  return image;
+}
+
+
+// 1 if the continuous index is inside the input, 0 if it is outside, and
+// -1 in the half pixel at the border where ITK versions disagree
+int Classify( const InputImageType * image,
+              const OutputImageType::PointType & point )
+{
+  itk::ContinuousIndex< double, 3 > index;
+  image->TransformPhysicalPointToContinuousIndex( point, index );
+  int inside = 1;
+  for( unsigned int d = 0; d < 3; d++ )
+    {
+    const double last = image->GetBufferedRegion().GetSize()[d] - 1.0;
+    if( index[d] < -0.5 || index[d] >= last + 0.5 )
+      {
+      return 0;
+      }
+    if( index[d] < 0.0 || index[d] > last )
+      {
+      inside = -1;
+      }
+    }
+  return inside;
+}
+
+
+int Compare( const char * name,
+             const InputImageType::Pointer phases[],
+             const MultiPhaseType::SizeType & size,
+             const MultiPhaseType::SpacingType & spacing,
+             const MultiPhaseType::PointType & origin,
+             const MultiPhaseType::ScaleType & scale,
+             const MultiPhaseType::PointType & center,
+             bool copy )
+{
+  MultiPhaseType::Pointer multiPhase = MultiPhaseType::New();
+  for( unsigned int p = 0; p < NumberOfPhases; p++ )
+    {
+    multiPhase->SetInput( p, phases[p] );
+    }
+  multiPhase->SetSize( size );
+  multiPhase->SetOutputSpacing( spacing );
+  multiPhase->SetOutputOrigin( origin );
+  multiPhase->SetScale( scale );
+  multiPhase->SetCenter( center );
+  multiPhase->SetDefaultPixelValue( DefaultValue );
+  multiPhase->SetNumberOfThreads( 3 );
+
+  TransformType::Pointer transform = TransformType::New();
+  TransformType::ScaleType transformScale;
+  for( unsigned int d = 0; d < 3; d++ )
+    {
+    transformScale[d] = scale[d];
+    }
+  transform->SetScale( transformScale );
+  transform->SetCenter( center );
+
+  try
+    {
+    multiPhase->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  int status = EXIT_SUCCESS;
+
+  for( unsigned int p = 0; p < NumberOfPhases; p++ )
+    {
+    ResampleType::Pointer resample = ResampleType::New();
+    resample->SetInput( phases[p] );
+    resample->SetTransform( transform );
+    resample->SetInterpolator( InterpolatorType::New() );
+    resample->SetSize( size );
+    resample->SetOutputSpacing( spacing );
+    resample->SetOutputOrigin( origin );
+    resample->SetDefaultPixelValue( DefaultValue );
+    try
+      {
+      resample->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const OutputImageType * output = multiPhase->GetOutput( p );
+    const OutputImageType * reference = resample->GetOutput();
+
+    unsigned long inside = 0;
+    unsigned long outside = 0;
+    unsigned long different = 0;
+    double maximumError = 0.0;
+    itk::ImageRegionConstIteratorWithIndex< OutputImageType >
+                        it( output, output->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      OutputImageType::PointType point;
+      output->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+      OutputImageType::PointType mapped = transform->TransformPoint( point );
+
+      const int where = Classify( phases[p], mapped );
+      if( where < 0 )
+        {
+        continue;
+        }
+
+      const double value = it.Get();
+      const double expected = reference->GetPixel( it.GetIndex() );
+      double error = vcl_fabs( value - expected );
+      if( where == 0 )
+        {
+        outside++;
+        error = vcl_fabs( value - DefaultValue );
+        }
+      else
+        {
+        inside++;
+        }
+      maximumError = vnl_math_max( maximumError, error );
+      if( error > 1e-2 )
+        {
+        different++;
+        }
+      if( copy && where == 1 &&
+          value != phases[p]->GetPixel( it.GetIndex() ) )
+        {
+        // not exactly the input pixel at the same index
+        different++;
+        }
+      }
+
+    std::cout << name << ", phase " << p << ": " << inside << " inside and "
+              << outside << " outside compared, " << different
+              << " different, largest error " << maximumError << std::endl;
+
+    if( different != 0 || inside == 0 || ( !copy && outside == 0 ) )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+
+  return status;
+}
+
+
+int main( int, char *[] )
+{
+  InputImageType::Pointer phases[NumberOfPhases];
+  for( unsigned int p = 0; p < NumberOfPhases; p++ )
+    {
+    phases[p] = MakePhase( p );
+    }
+
+  int status = EXIT_SUCCESS;
+
+  // non integer scale on every axis, on a grid larger than the inputs
+  MultiPhaseType::SizeType size;
+  size[0] = 27;
+  size[1] = 23;
+  size[2] = 19;
+  MultiPhaseType::SpacingType spacing;
+  spacing[0] = 0.9;
+  spacing[1] = 1.3;
+  spacing[2] = 1.7;
+  MultiPhaseType::PointType origin;
+  origin[0] = -1.3;
+  origin[1] = -5.1;
+  origin[2] = -2.2;
+  MultiPhaseType::ScaleType scale;
+  scale[0] = 0.83;
+  scale[1] = 1.27;
+  scale[2] = 0.71;
+  MultiPhaseType::PointType center;
+  center[0] = 11.4;
+  center[1] = 9.8;
+  center[2] = 15.3;
+  if( Compare( "scaled", phases, size, spacing, origin, scale, center,
+               false ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  // the input grid, without scaling
+  scale.Fill( 1.0 );
+  if( Compare( "copied", phases, phases[0]->GetBufferedRegion().GetSize(),
+               phases[0]->GetSpacing(), phases[0]->GetOrigin(), scale,
+               center, true ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
@@ -23,9 +23,11 @@
 
 #include "itkQuaternionRigidTransform.h"
 #include "itkMutualInformationImageToImageMetric.h"
+#include "itkParallelMutualInformationImageToImageMetric.h"
 #include "itkLinearInterpolateImageFunction.h"
 #include "itkQuaternionRigidTransformGradientDescentOptimizer.h"
 #include "itkRecursiveMultiResolutionPyramidImageFilter.h"
+#include "itkCachedMultiResolutionPyramidImageFilter.h"
 
 #include "itkArray.h"
 
@@ -47,6 +49,16 @@ namespace itk
  * The registration is done using a multiresolution strategy.
  * At each resolution level, the downsampled images are obtained
  * using a RecursiveMultiResolutionPyramidImageFilter.
+ * With UseParallelMetric on, the metric is a
+ * ParallelMutualInformationImageToImageMetric, which reuses its samples
+ * for SampleRefreshPeriod iterations and evaluates the Parzen sums on
+ * several threads, so that many more spatial samples can be used.
+ *
+ * With UsePyramidCache on, a CachedMultiResolutionPyramidImageFilter
+ * is used instead: pyramids of images already seen are reused, the fixed
+ * image pyramid is also stored in PyramidCacheDirectory for later runs,
+ * and registration starts at the coarsest level while the finer levels
+ * are still being computed.
  * 
  * \warning This class requires both images to be 3D and with
  * pixels of a real type.
@@ -109,12 +121,20 @@ public:
   typedef MutualInformationImageToImageMetric< 
                                     FixedImageType, 
                                     MovingImageType >    MetricType;
+  typedef ParallelMutualInformationImageToImageMetric<
+                                    FixedImageType,
+                                    MovingImageType >    ParallelMetricType;
 
   /** Interpolation Type. */
   typedef LinearInterpolateImageFunction< 
                                     MovingImageType,
                                     double          >    InterpolatorType;
 
+  /** Base of the fixed image pyramids. */
+  typedef MultiResolutionPyramidImageFilter<
+                                    FixedImageType,
+                                    FixedImageType  >    FixedImagePyramidBaseType;
+
   /** Fixed Image Pyramid Type. */
   typedef RecursiveMultiResolutionPyramidImageFilter<
                                     FixedImageType,
@@ -125,6 +145,14 @@ public:
                                     MovingImageType,
                                     MovingImageType  >   MovingImagePyramidType;
 
+  /** Cached pyramid types. */
+  typedef CachedMultiResolutionPyramidImageFilter<
+                                    FixedImageType,
+                                    FixedImageType  >    FixedImagePyramidCacheType;
+  typedef CachedMultiResolutionPyramidImageFilter<
+                                    MovingImageType,
+                                    MovingImageType  >   MovingImagePyramidCacheType;
+
   /** Registration Method. */
   typedef MultiResolutionImageRegistrationMethod< 
                                     FixedImageType, 
@@ -170,6 +198,21 @@ public:
   itkSetClampMacro( NumberOfSpatialSamples, unsigned short, 1,
     NumericTraits<unsigned short>::max() );
 
+  /** Use the parallel metric, drawing new samples every
+   * SampleRefreshPeriod iterations. */
+  itkSetMacro( UseParallelMetric, bool );
+  itkGetMacro( UseParallelMetric, bool );
+  itkBooleanMacro( UseParallelMetric );
+  itkSetClampMacro( SampleRefreshPeriod, unsigned int, 1,
+    NumericTraits<unsigned int>::max() );
+
+  /** Set the number of threads of the moving image pyramid and of the
+   * parallel metric. The fixed image pyramid keeps its own, so that it
+   * is not recomputed when only the moving image changes between runs. */
+  itkSetClampMacro( NumberOfThreads, unsigned int, 1,
+    NumericTraits<unsigned int>::max() );
+  itkGetMacro( NumberOfThreads, unsigned int );
+
   /** Set the number of iterations per level. */
   itkSetMacro( NumberOfIterations, UnsignedIntArray );
 
@@ -183,6 +226,15 @@ public:
   itkSetMacro( FixedImageShrinkFactors, ShrinkFactorsArray );
   itkSetMacro( MovingImageShrinkFactors, ShrinkFactorsArray );
 
+  /** Reuse image pyramids across runs. */
+  itkSetMacro( UsePyramidCache, bool );
+  itkGetMacro( UsePyramidCache, bool );
+  itkBooleanMacro( UsePyramidCache );
+
+  /** Set the directory where the fixed image pyramid is stored. */
+  itkSetStringMacro( PyramidCacheDirectory );
+  itkGetStringMacro( PyramidCacheDirectory );
+
   /** Method to execute the registration. */
   virtual void Execute();
 
@@ -199,6 +251,10 @@ public:
   /** Initialize registration at the start of new level. */
   void StartNewLevel();
 
+  /** Fixed image pyramid used by Execute(), the cached one when
+   * UsePyramidCache is on. */
+  FixedImagePyramidBaseType * GetFixedImagePyramid();
+
 protected:
   MIMRegistrator();
   ~MIMRegistrator();
@@ -207,14 +263,21 @@ private:
   MIMRegistrator( const Self& ); //purposely not implemented
   void operator=( const Self& ); //purposely not implemented
 
+  /** Set the levels and the shrink factors of a fixed image pyramid,
+   * without modifying it when they did not change. */
+  void SetUpFixedImagePyramid( FixedImagePyramidBaseType * pyramid );
+
   typename FixedImageType::Pointer            m_FixedImage;
   typename MovingImageType::Pointer           m_MovingImage;
   typename TransformType::Pointer             m_Transform;
   typename OptimizerType::Pointer             m_Optimizer;
   typename MetricType::Pointer                m_Metric;
+  typename ParallelMetricType::Pointer        m_ParallelMetric;
   typename InterpolatorType::Pointer          m_Interpolator;
   typename FixedImagePyramidType::Pointer     m_FixedImagePyramid;
   typename MovingImagePyramidType::Pointer    m_MovingImagePyramid;
+  typename FixedImagePyramidCacheType::Pointer  m_CachedFixedImagePyramid;
+  typename MovingImagePyramidCacheType::Pointer m_CachedMovingImagePyramid;
   typename RegistrationType::Pointer          m_Registration;
 
   unsigned short                              m_NumberOfLevels;
@@ -222,6 +285,9 @@ private:
   double                                      m_MovingImageStandardDeviation;
   double                                      m_FixedImageStandardDeviation;
   unsigned short                              m_NumberOfSpatialSamples;
+  bool                                        m_UseParallelMetric;
+  unsigned int                                m_SampleRefreshPeriod;
+  unsigned int                                m_NumberOfThreads;
 
   UnsignedIntArray                            m_NumberOfIterations;
   DoubleArray                                 m_LearningRates;
@@ -229,6 +295,9 @@ private:
   ShrinkFactorsArray                          m_MovingImageShrinkFactors;
   ShrinkFactorsArray                          m_FixedImageShrinkFactors;
 
+  bool                                        m_UsePyramidCache;
+  std::string                                 m_PyramidCacheDirectory;
+
   ParametersType                              m_InitialParameters;
   AffineTransformPointer                      m_AffineTransform;
 
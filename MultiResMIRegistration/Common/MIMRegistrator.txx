@@ -38,9 +38,12 @@ MIMRegistrator<TFixedImage,TMovingImage>
   m_Transform          = TransformType::New();
   m_Optimizer          = OptimizerType::New();
   m_Metric             = MetricType::New();
+  m_ParallelMetric     = ParallelMetricType::New();
   m_Interpolator       = InterpolatorType::New();
   m_FixedImagePyramid  = FixedImagePyramidType::New();
   m_MovingImagePyramid = MovingImagePyramidType::New();
+  m_CachedFixedImagePyramid  = FixedImagePyramidCacheType::New();
+  m_CachedMovingImagePyramid = MovingImagePyramidCacheType::New();
   m_Registration       = RegistrationType::New();
 
   m_Registration->SetTransform( m_Transform );
@@ -65,10 +68,16 @@ MIMRegistrator<TFixedImage,TMovingImage>
   m_MovingImageStandardDeviation = 0.4;
   m_FixedImageStandardDeviation = 0.4;
   m_NumberOfSpatialSamples = 50;
+  m_UseParallelMetric = false;
+  m_SampleRefreshPeriod = 1;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
 
   m_FixedImageShrinkFactors.Fill( 1 );
   m_MovingImageShrinkFactors.Fill( 1 );
 
+  m_UsePyramidCache = false;
+  m_PyramidCacheDirectory = "";
+
   m_NumberOfIterations = UnsignedIntArray(1);
   m_NumberOfIterations.Fill( 10 );
 
@@ -115,14 +124,51 @@ MIMRegistrator<TFixedImage,TMovingImage>
   m_Metric->SetFixedImageStandardDeviation( m_FixedImageStandardDeviation );
   m_Metric->SetNumberOfSpatialSamples( m_NumberOfSpatialSamples );
 
+  if ( m_UseParallelMetric )
+    {
+    m_ParallelMetric->SetMovingImageStandardDeviation(
+      m_MovingImageStandardDeviation );
+    m_ParallelMetric->SetFixedImageStandardDeviation(
+      m_FixedImageStandardDeviation );
+    m_ParallelMetric->SetNumberOfSpatialSamples( m_NumberOfSpatialSamples );
+    m_ParallelMetric->SetSampleRefreshPeriod( m_SampleRefreshPeriod );
+    m_ParallelMetric->SetNumberOfThreads( m_NumberOfThreads );
+    m_Registration->SetMetric( m_ParallelMetric );
+    }
+  else
+    {
+    m_Registration->SetMetric( m_Metric );
+    }
+
   // Setup the image pyramids
-  m_FixedImagePyramid->SetNumberOfLevels( m_NumberOfLevels );
-  m_FixedImagePyramid->SetStartingShrinkFactors( 
-    m_FixedImageShrinkFactors.GetDataPointer() );
+  this->SetUpFixedImagePyramid( m_FixedImagePyramid );
 
   m_MovingImagePyramid->SetNumberOfLevels( m_NumberOfLevels );
   m_MovingImagePyramid->SetStartingShrinkFactors(
     m_MovingImageShrinkFactors.GetDataPointer() );
+  m_MovingImagePyramid->SetNumberOfThreads( m_NumberOfThreads );
+
+  if ( m_UsePyramidCache )
+    {
+    // Only the fixed image is expected to recur across runs, so only its
+    // pyramid is written to disk.
+    this->SetUpFixedImagePyramid( m_CachedFixedImagePyramid );
+    m_CachedFixedImagePyramid->SetCacheDirectory( m_PyramidCacheDirectory );
+    m_CachedFixedImagePyramid->AsynchronousLevelsOn();
+
+    m_CachedMovingImagePyramid->SetNumberOfLevels( m_NumberOfLevels );
+    m_CachedMovingImagePyramid->SetStartingShrinkFactors(
+      m_MovingImageShrinkFactors.GetDataPointer() );
+    m_CachedMovingImagePyramid->AsynchronousLevelsOn();
+
+    m_Registration->SetFixedImagePyramid( m_CachedFixedImagePyramid );
+    m_Registration->SetMovingImagePyramid( m_CachedMovingImagePyramid );
+    }
+  else
+    {
+    m_Registration->SetFixedImagePyramid( m_FixedImagePyramid );
+    m_Registration->SetMovingImagePyramid( m_MovingImagePyramid );
+    }
 
   // Setup the registrator
   m_Registration->SetFixedImage( m_FixedImage );
@@ -174,6 +220,43 @@ MIMRegistrator<TFixedImage,TMovingImage>
 
 
 
+template <typename TFixedImage, typename TMovingImage>
+void
+MIMRegistrator<TFixedImage,TMovingImage>
+::SetUpFixedImagePyramid( FixedImagePyramidBaseType * pyramid )
+{
+  // SetNumberOfLevels returns early when the number does not change, but
+  // SetStartingShrinkFactors always modifies the pyramid, which would then
+  // be recomputed by every Execute() for the same fixed image.
+  pyramid->SetNumberOfLevels( m_NumberOfLevels );
+
+  const unsigned int * factors = pyramid->GetStartingShrinkFactors();
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    if ( factors[d] != m_FixedImageShrinkFactors[d] )
+      {
+      pyramid->SetStartingShrinkFactors(
+        m_FixedImageShrinkFactors.GetDataPointer() );
+      return;
+      }
+    }
+}
+
+
+template <typename TFixedImage, typename TMovingImage>
+typename MIMRegistrator<TFixedImage,TMovingImage>
+::FixedImagePyramidBaseType *
+MIMRegistrator<TFixedImage,TMovingImage>
+::GetFixedImagePyramid()
+{
+  if ( m_UsePyramidCache )
+    {
+    return m_CachedFixedImagePyramid.GetPointer();
+    }
+  return m_FixedImagePyramid.GetPointer();
+}
+
+
 template <typename TFixedImage, typename TMovingImage>
 void
 MIMRegistrator<TFixedImage,TMovingImage>
@@ -183,6 +266,13 @@ MIMRegistrator<TFixedImage,TMovingImage>
             << std::endl;
 
   unsigned int level = m_Registration->GetCurrentLevel();
+
+  if ( m_UsePyramidCache )
+    {
+    m_CachedFixedImagePyramid->WaitForLevel( level );
+    m_CachedMovingImagePyramid->WaitForLevel( level );
+    }
+
   if ( m_NumberOfIterations.Size() >= level + 1 )
     {
     m_Optimizer->SetNumberOfIterations( m_NumberOfIterations[level] );
@@ -16,18 +16,63 @@
 =========================================================================*/
 
 #include <fstream>
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
 
 #include "SimpleApp.h"
 #include "itkExceptionObject.h"
 
 
+static void PrintUsage()
+{
+  std::cout << "Usage: MultiResMIRegistration param.file";
+  std::cout << " [numberOfSamples [sampleRefreshPeriod]]" << std::endl;
+  std::cout << "  numberOfSamples: 1 to 65535" << std::endl;
+  std::cout << "  sampleRefreshPeriod: 1 or more iterations" << std::endl;
+}
+
+
+/** Parse a whole decimal argument within [minimum, maximum]. */
+static bool ParseArgument( const char * text, long minimum, long maximum,
+                           long & value )
+{
+  char * end = 0;
+  errno = 0;
+  value = strtol( text, &end, 10 );
+  if ( end == text || *end != '\0' || errno == ERANGE )
+    {
+    return false;
+    }
+  return value >= minimum && value <= maximum;
+}
+
+
 int main(int argc, char *argv[])
 {
   if ( argc < 2 )
     {
     std::cout << "Parameter file name missing" << std::endl;
     std::cout << std::endl;
-    std::cout << "Usage: MultiResMIRegistration param.file" << std::endl;
+    PrintUsage();
+    return 1;
+    }
+
+  long numberOfSamples = 0;
+  if ( argc > 2 && !ParseArgument( argv[2], 1, 65535, numberOfSamples ) )
+    {
+    std::cout << "Invalid number of samples: " << argv[2] << std::endl;
+    std::cout << std::endl;
+    PrintUsage();
+    return 1;
+    }
+
+  long sampleRefreshPeriod = 1;
+  if ( argc > 3 && !ParseArgument( argv[3], 1, INT_MAX, sampleRefreshPeriod ) )
+    {
+    std::cout << "Invalid sample refresh period: " << argv[3] << std::endl;
+    std::cout << std::endl;
+    PrintUsage();
     return 1;
     }
 
@@ -37,6 +82,16 @@ int main(int argc, char *argv[])
     typedef itk::SimpleApp<signed short> AppType;
     AppType::Pointer theApp = AppType::New();
     theApp->SetParameterFileName( argv[1] );
+    if ( argc > 2 )
+      {
+      theApp->SetNumberOfSpatialSamples(
+        static_cast<unsigned short>( numberOfSamples ) );
+      }
+    if ( argc > 3 )
+      {
+      theApp->SetSampleRefreshPeriod(
+        static_cast<unsigned int>( sampleRefreshPeriod ) );
+      }
     theApp->Execute();
 
     }
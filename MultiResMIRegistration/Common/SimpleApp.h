@@ -70,11 +70,18 @@ public:
   /** Set input parameter file */
   itkSetStringMacro( ParameterFileName );
 
+  /** Set the number of spatial samples. When set, the parallel metric
+   * is used, drawing new samples every SampleRefreshPeriod iterations. */
+  itkSetMacro( NumberOfSpatialSamples, unsigned short );
+  itkSetMacro( SampleRefreshPeriod, unsigned int );
+
 protected:
 
   SimpleApp()
     { 
     m_ParameterFileName = ""; 
+    m_NumberOfSpatialSamples = 0;
+    m_SampleRefreshPeriod = 1;
     }
 
   virtual ~SimpleApp(){};
@@ -85,6 +92,25 @@ protected:
     this->m_Parser->SetParameterFileName( m_ParameterFileName.c_str() );
     }
 
+  /** Initialize the registrator, turning on the pyramid cache when the
+   * parameter file names a cache directory. */
+  virtual void InitializeRegistrator()
+    {
+    Superclass::InitializeRegistrator();
+    std::string cacheDirectory = this->m_Parser->GetPyramidCacheDirectory();
+    if ( !cacheDirectory.empty() )
+      {
+      this->m_Registrator->SetPyramidCacheDirectory( cacheDirectory.c_str() );
+      this->m_Registrator->UsePyramidCacheOn();
+      }
+    if ( m_NumberOfSpatialSamples > 0 )
+      {
+      this->m_Registrator->SetNumberOfSpatialSamples( m_NumberOfSpatialSamples );
+      this->m_Registrator->SetSampleRefreshPeriod( m_SampleRefreshPeriod );
+      this->m_Registrator->UseParallelMetricOn();
+      }
+    }
+
   /*** Initialize the output generator. */
   virtual void InitializeGenerator()
     {
@@ -100,6 +126,10 @@ private:
    /*** Input parameter filename. */
    std::string          m_ParameterFileName;
 
+   /*** Parallel metric settings. */
+   unsigned short       m_NumberOfSpatialSamples;
+   unsigned int         m_SampleRefreshPeriod;
+
 };
 
 
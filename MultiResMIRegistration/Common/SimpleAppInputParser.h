@@ -49,6 +49,7 @@ namespace itk
  *  - scaling factor applied to translation parameters during optimization
  *
  *  - the output resampled file name
+ *  - optionally, a pyramid cache directory
  */
 template <typename TImage>
 class ITK_EXPORT SimpleAppInputParser : public Object
@@ -130,6 +131,9 @@ public:
   /** Get the output filename. */
   itkGetStringMacro( OutputFileName );
 
+  /** Get the pyramid cache directory, empty if not given. */
+  itkGetStringMacro( PyramidCacheDirectory );
+
 protected:
   SimpleAppInputParser();
   ~SimpleAppInputParser(){};
@@ -150,6 +154,7 @@ private:
   RatesArrayType                m_LearningRates;
   double                        m_TranslationScale;
   std::string                   m_OutputFileName;
+  std::string                   m_PyramidCacheDirectory;
 
 };
 
@@ -51,6 +51,7 @@ SimpleAppInputParser<TImage>
   m_TranslationScale = 100.0;
 
   m_OutputFileName = "";
+  m_PyramidCacheDirectory = "";
 
 }
 
@@ -218,6 +219,15 @@ SimpleAppInputParser<TImage>
   m_OutputFileName = currentLine;
 
   std::cout << "Output filename: " << m_OutputFileName << std::endl;
+
+  // optional pyramid cache directory
+  m_PyramidCacheDirectory = "";
+  if( fscanf( paramFile, "%s", currentLine ) == 1 )
+    {
+    m_PyramidCacheDirectory = currentLine;
+    std::cout << "Pyramid cache directory: " << m_PyramidCacheDirectory;
+    std::cout << std::endl;
+    }
   std::cout << std::endl;
 
 
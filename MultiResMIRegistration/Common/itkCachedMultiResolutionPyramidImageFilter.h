@@ -0,0 +1,251 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkCachedMultiResolutionPyramidImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkCachedMultiResolutionPyramidImageFilter_h
+#define _itkCachedMultiResolutionPyramidImageFilter_h
+
+#include "itkMultiResolutionPyramidImageFilter.h"
+#include "itkImportImageContainer.h"
+#include "itkMultiThreader.h"
+#include "itkMutexLock.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkConditionVariable.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class MappedImportImageContainer
+ *
+ * Pixel container over a private mapping of a cache file. The mapping is
+ * released with the container, when the last image sharing it goes away.
+ */
+template <typename TElementIdentifier, typename TElement>
+class ITK_EXPORT MappedImportImageContainer :
+    public ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MappedImportImageContainer  Self;
+  typedef ImportImageContainer<TElementIdentifier, TElement>  Superclass;
+  typedef SmartPointer<Self>  Pointer;
+  typedef SmartPointer<const Self>  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MappedImportImageContainer, ImportImageContainer);
+
+  /** Use the mapping of length bytes as the elements; it is unmapped by
+   * the container. */
+  void SetMapping( void * mapping, unsigned long length,
+                   TElementIdentifier size );
+
+protected:
+  MappedImportImageContainer();
+  ~MappedImportImageContainer();
+
+private:
+  MappedImportImageContainer(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  void *          m_Mapping;
+  unsigned long   m_MappingLength;
+};
+
+
+/** \class CachedMultiResolutionPyramidImageFilter
+ *
+ * Multi-resolution pyramid whose levels are kept between runs.
+ *
+ * Each level is computed directly from the input: Gaussian smoothing with
+ * a standard deviation of half the shrink factor (in voxels), followed by
+ * linear resampling onto the level grid. Levels are computed from the
+ * coarsest to the finest.
+ *
+ * Pyramids are identified by a key made of a hash of the input pixels,
+ * the input geometry and the schedule. Finished pyramids are kept in a
+ * process wide table of at most MaximumMemoryCacheSize bytes, from which
+ * the least recently used pyramids are dropped; ClearMemoryCache() empties
+ * it. The table is shared by the filters of the same image types. When
+ * CacheDirectory is set, each level is also
+ * written to CacheDirectory as a raw file named after the key. Later
+ * runs on the same input map these files instead of filtering (on
+ * systems without mmap the files are read). A mapping is released when
+ * no output nor the table uses its level anymore.
+ *
+ * With AsynchronousLevels on, Update() returns as soon as the level
+ * buffers are allocated and the levels are computed in a separate thread.
+ * The consumer must then call WaitForLevel() before using a level, so
+ * that a registration can run at the coarsest level while the finer ones
+ * are still being built.
+ *
+ * This class is templated over the input image type and the output image
+ * type, like MultiResolutionPyramidImageFilter.
+ *
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT CachedMultiResolutionPyramidImageFilter :
+    public MultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef CachedMultiResolutionPyramidImageFilter  Self;
+  typedef MultiResolutionPyramidImageFilter<TInputImage,TOutputImage>  Superclass;
+  typedef SmartPointer<Self>  Pointer;
+  typedef SmartPointer<const Self>  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(CachedMultiResolutionPyramidImageFilter,
+               MultiResolutionPyramidImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+
+  typedef TInputImage                             InputImageType;
+  typedef typename InputImageType::Pointer        InputImagePointer;
+  typedef TOutputImage                            OutputImageType;
+  typedef typename OutputImageType::Pointer       OutputImagePointer;
+  typedef typename OutputImageType::PixelType     OutputPixelType;
+
+  /** Directory of the on-disk cache. Empty (the default) keeps the
+   * pyramids in memory only. */
+  itkSetStringMacro( CacheDirectory );
+  itkGetStringMacro( CacheDirectory );
+
+  /** Return from Update() before the levels are computed. */
+  itkSetMacro( AsynchronousLevels, bool );
+  itkGetConstMacro( AsynchronousLevels, bool );
+  itkBooleanMacro( AsynchronousLevels );
+
+  /** Block until a level is available. Throws if computing it failed. */
+  void WaitForLevel( unsigned int level );
+
+  /** Whether the last update was served from the memory or disk cache. */
+  itkGetConstMacro( LoadedFromCache, bool );
+
+  /** Key of the last updated pyramid. */
+  const std::string & GetKey() const
+    {
+    return m_Key;
+    }
+
+  /** Size in bytes of the process wide table of pyramids, 512 MB by
+   * default, 0 to disable it. Outputs that still use a dropped pyramid
+   * keep it. */
+  static void SetMaximumMemoryCacheSize( unsigned long size );
+  static unsigned long GetMaximumMemoryCacheSize();
+
+  /** Drop all the pyramids of the process wide table. */
+  static void ClearMemoryCache();
+
+protected:
+  CachedMultiResolutionPyramidImageFilter();
+  ~CachedMultiResolutionPyramidImageFilter();
+  void PrintSelf(std::ostream&os, Indent indent) const;
+
+  /** All the levels are produced at their largest possible region, from
+   * the whole input. */
+  virtual void GenerateOutputRequestedRegion(DataObject *output);
+  virtual void GenerateInputRequestedRegion();
+
+  void GenerateData();
+
+private:
+  CachedMultiResolutionPyramidImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  typedef std::vector<OutputImagePointer>             LevelListType;
+  typedef MappedImportImageContainer<unsigned long, OutputPixelType>
+                                                      MappedContainerType;
+
+  struct MemoryCacheEntry
+    {
+    LevelListType   Levels;
+    unsigned long   Size;
+    unsigned long   LastUse;
+    };
+
+  struct MemoryCacheType
+    {
+    std::map<std::string, MemoryCacheEntry>  Entries;
+    unsigned long                            Size;
+    unsigned long                            MaximumSize;
+    unsigned long                            Clock;
+    };
+
+  /** Process wide table of finished pyramids. */
+  static MemoryCacheType & GetMemoryCache();
+  static SimpleFastMutexLock & GetMemoryCacheLock();
+
+  /** Add the levels of the outputs to the table under the current key. */
+  void AddOutputsToMemoryCache();
+
+  /** Drop the least recently used pyramids above the maximum size. The
+   * lock is held by the caller. */
+  static void TrimMemoryCache( MemoryCacheType & cache );
+
+  std::string ComputeKey() const;
+  std::string GetLevelFileName( unsigned int level ) const;
+
+  /** Fill an allocated level. */
+  void ComputeLevel( unsigned int level );
+
+  /** Map or read a level file into the output, false if not found. */
+  bool ReadLevel( unsigned int level );
+  void WriteLevel( unsigned int level ) const;
+
+  void ComputeLevels();
+  static ITK_THREAD_RETURN_TYPE ComputeLevelsThreaderCallback( void * arg );
+
+  /** Wait for the level thread to finish, stopping it first if asked. */
+  void JoinWorker( bool stop );
+
+  std::string                       m_CacheDirectory;
+  bool                              m_AsynchronousLevels;
+  bool                              m_LoadedFromCache;
+  std::string                       m_Key;
+
+  /** Input shared with the level thread, outside of the pipeline. */
+  InputImagePointer                 m_WorkerInput;
+  MultiThreader::Pointer            m_Threader;
+  int                               m_WorkerId;
+
+  /** Set by the caller and read by the level thread under m_LevelLock. */
+  bool                              m_StopWorker;
+
+  std::vector<bool>                 m_LevelReady;
+  bool                              m_Failed;
+  std::string                       m_ErrorMessage;
+  SimpleMutexLock                   m_LevelLock;
+  ConditionVariable::Pointer        m_LevelCondition;
+};
+
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkCachedMultiResolutionPyramidImageFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,688 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkCachedMultiResolutionPyramidImageFilter.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkCachedMultiResolutionPyramidImageFilter_txx
+#define _itkCachedMultiResolutionPyramidImageFilter_txx
+
+#include "itkCachedMultiResolutionPyramidImageFilter.h"
+#include "itkCastImageFilter.h"
+#include "itkRecursiveGaussianImageFilter.h"
+#include "itkResampleImageFilter.h"
+#include "itkIdentityTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define ITK_PYRAMID_CACHE_USE_MMAP
+#endif
+
+namespace itk
+{
+
+namespace
+{
+/** Two 32 bit string hashes (FNV-1a and sdbm) run side by side. */
+inline void PyramidCacheHash( const unsigned char * data, unsigned long length,
+                              unsigned int & fnv, unsigned int & sdbm )
+{
+  for ( unsigned long i = 0; i < length; i++ )
+    {
+    fnv = ( fnv ^ data[i] ) * 16777619u;
+    sdbm = data[i] + ( sdbm << 6 ) + ( sdbm << 16 ) - sdbm;
+    }
+}
+}
+
+template <typename TElementIdentifier, typename TElement>
+MappedImportImageContainer<TElementIdentifier, TElement>
+::MappedImportImageContainer()
+{
+  m_Mapping = NULL;
+  m_MappingLength = 0;
+}
+
+
+template <typename TElementIdentifier, typename TElement>
+MappedImportImageContainer<TElementIdentifier, TElement>
+::~MappedImportImageContainer()
+{
+#ifdef ITK_PYRAMID_CACHE_USE_MMAP
+  if ( m_Mapping )
+    {
+    munmap( m_Mapping, m_MappingLength );
+    }
+#endif
+}
+
+
+template <typename TElementIdentifier, typename TElement>
+void
+MappedImportImageContainer<TElementIdentifier, TElement>
+::SetMapping( void * mapping, unsigned long length, TElementIdentifier size )
+{
+  m_Mapping = mapping;
+  m_MappingLength = length;
+  this->SetImportPointer( static_cast<TElement *>( mapping ), size, false );
+}
+
+
+template <class TInputImage, class TOutputImage>
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::CachedMultiResolutionPyramidImageFilter()
+{
+  m_CacheDirectory = "";
+  m_AsynchronousLevels = false;
+  m_LoadedFromCache = false;
+  m_Key = "";
+
+  m_WorkerInput = NULL;
+  m_Threader = MultiThreader::New();
+  m_WorkerId = -1;
+  m_StopWorker = false;
+
+  m_Failed = false;
+  m_LevelCondition = ConditionVariable::New();
+}
+
+
+template <class TInputImage, class TOutputImage>
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::~CachedMultiResolutionPyramidImageFilter()
+{
+  this->JoinWorker( true );
+}
+
+
+template <class TInputImage, class TOutputImage>
+typename CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::MemoryCacheType &
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::GetMemoryCache()
+{
+  static MemoryCacheType cache = { std::map<std::string, MemoryCacheEntry>(),
+                                   0, 512ul * 1024ul * 1024ul, 0 };
+  return cache;
+}
+
+
+template <class TInputImage, class TOutputImage>
+SimpleFastMutexLock &
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::GetMemoryCacheLock()
+{
+  static SimpleFastMutexLock lock;
+  return lock;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::TrimMemoryCache( MemoryCacheType & cache )
+{
+  while ( cache.Size > cache.MaximumSize && !cache.Entries.empty() )
+    {
+    typename std::map<std::string, MemoryCacheEntry>::iterator oldest =
+      cache.Entries.begin();
+    typename std::map<std::string, MemoryCacheEntry>::iterator it;
+    for ( it = cache.Entries.begin(); it != cache.Entries.end(); ++it )
+      {
+      if ( it->second.LastUse < oldest->second.LastUse )
+        {
+        oldest = it;
+        }
+      }
+    cache.Size -= oldest->second.Size;
+    cache.Entries.erase( oldest );
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::SetMaximumMemoryCacheSize( unsigned long size )
+{
+  GetMemoryCacheLock().Lock();
+  GetMemoryCache().MaximumSize = size;
+  TrimMemoryCache( GetMemoryCache() );
+  GetMemoryCacheLock().Unlock();
+}
+
+
+template <class TInputImage, class TOutputImage>
+unsigned long
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::GetMaximumMemoryCacheSize()
+{
+  GetMemoryCacheLock().Lock();
+  const unsigned long size = GetMemoryCache().MaximumSize;
+  GetMemoryCacheLock().Unlock();
+  return size;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::ClearMemoryCache()
+{
+  GetMemoryCacheLock().Lock();
+  GetMemoryCache().Entries.clear();
+  GetMemoryCache().Size = 0;
+  GetMemoryCacheLock().Unlock();
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::AddOutputsToMemoryCache()
+{
+  const unsigned int numberOfLevels = this->GetNumberOfLevels();
+
+  MemoryCacheEntry entry;
+  entry.Levels.resize( numberOfLevels );
+  entry.Size = 0;
+  for ( unsigned int level = 0; level < numberOfLevels; level++ )
+    {
+    entry.Levels[level] = OutputImageType::New();
+    entry.Levels[level]->Graft( this->GetOutput( level ) );
+    entry.Size += this->GetOutput( level )->GetLargestPossibleRegion()
+                    .GetNumberOfPixels() * sizeof( OutputPixelType );
+    }
+
+  GetMemoryCacheLock().Lock();
+  MemoryCacheType & cache = GetMemoryCache();
+  typename std::map<std::string, MemoryCacheEntry>::iterator previous =
+    cache.Entries.find( m_Key );
+  if ( previous != cache.Entries.end() )
+    {
+    cache.Size -= previous->second.Size;
+    cache.Entries.erase( previous );
+    }
+  entry.LastUse = ++cache.Clock;
+  cache.Entries[m_Key] = entry;
+  cache.Size += entry.Size;
+  TrimMemoryCache( cache );
+  GetMemoryCacheLock().Unlock();
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::GenerateOutputRequestedRegion( DataObject * itkNotUsed(output) )
+{
+  for ( unsigned int level = 0; level < this->GetNumberOfOutputs(); level++ )
+    {
+    if ( this->GetOutput( level ) )
+      {
+      this->GetOutput( level )->SetRequestedRegionToLargestPossibleRegion();
+      }
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  InputImagePointer input = const_cast<InputImageType *>( this->GetInput() );
+  if ( input )
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+std::string
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::ComputeKey() const
+{
+  const InputImageType * input = this->GetInput();
+
+  unsigned int dataFnv = 2166136261u;
+  unsigned int dataSdbm = 0;
+  PyramidCacheHash(
+    reinterpret_cast<const unsigned char *>( input->GetBufferPointer() ),
+    input->GetBufferedRegion().GetNumberOfPixels()
+      * sizeof( typename InputImageType::PixelType ),
+    dataFnv, dataSdbm );
+
+  std::ostringstream description;
+  description.precision( 17 );
+  description << input->GetBufferedRegion().GetSize() << " "
+              << input->GetSpacing() << " "
+              << input->GetOrigin() << " "
+              << input->GetDirection() << " "
+              << sizeof( typename InputImageType::PixelType ) << " "
+              << sizeof( OutputPixelType ) << " "
+              << this->GetMaximumError() << " "
+              << this->GetSchedule();
+  const std::string text = description.str();
+
+  unsigned int infoFnv = 2166136261u;
+  unsigned int infoSdbm = 0;
+  PyramidCacheHash( reinterpret_cast<const unsigned char *>( text.c_str() ),
+                    text.size(), infoFnv, infoSdbm );
+
+  char key[40];
+  sprintf( key, "%08x%08x%08x%08x", dataFnv, dataSdbm, infoFnv, infoSdbm );
+  return std::string( key );
+}
+
+
+template <class TInputImage, class TOutputImage>
+std::string
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::GetLevelFileName( unsigned int level ) const
+{
+  std::ostringstream name;
+  name << m_CacheDirectory << "/" << m_Key << "_L" << level << ".raw";
+  return name.str();
+}
+
+
+template <class TInputImage, class TOutputImage>
+bool
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::ReadLevel( unsigned int level )
+{
+  OutputImagePointer output = this->GetOutput( level );
+  const std::string fileName = this->GetLevelFileName( level );
+  const unsigned long numberOfPixels =
+    output->GetLargestPossibleRegion().GetNumberOfPixels();
+  const unsigned long length = numberOfPixels * sizeof( OutputPixelType );
+
+  output->SetBufferedRegion( output->GetLargestPossibleRegion() );
+
+#ifdef ITK_PYRAMID_CACHE_USE_MMAP
+  const int fd = open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    {
+    return false;
+    }
+  struct stat status;
+  if ( fstat( fd, &status ) != 0
+       || static_cast<unsigned long>( status.st_size ) != length )
+    {
+    close( fd );
+    return false;
+    }
+
+  // Private copy on write mapping: the level can be modified downstream
+  // without touching the file. The container unmaps it when the output
+  // and the memory cache no longer share it.
+  void * data = mmap( NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                      fd, 0 );
+  close( fd );
+  if ( data == MAP_FAILED )
+    {
+    return false;
+    }
+  typename MappedContainerType::Pointer container = MappedContainerType::New();
+  container->SetMapping( data, length, numberOfPixels );
+  output->SetPixelContainer( container );
+  return true;
+#else
+  std::ifstream file( fileName.c_str(), std::ios::in | std::ios::binary );
+  if ( !file )
+    {
+    return false;
+    }
+  file.seekg( 0, std::ios::end );
+  if ( static_cast<unsigned long>( file.tellg() ) != length )
+    {
+    return false;
+    }
+  file.seekg( 0, std::ios::beg );
+  output->Allocate();
+  file.read( reinterpret_cast<char *>( output->GetBufferPointer() ), length );
+  return !file.fail();
+#endif
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::WriteLevel( unsigned int level ) const
+{
+  const OutputImageType * output = this->GetOutput( level );
+  const std::string fileName = this->GetLevelFileName( level );
+
+  // Written aside and renamed, so that a concurrent run never maps a
+  // partial file.
+  std::ostringstream temporaryName;
+  temporaryName << fileName << "." << static_cast<const void *>( this )
+                << "." << static_cast<unsigned long>( time( NULL ) ) << ".tmp";
+
+  std::ofstream file( temporaryName.str().c_str(),
+                      std::ios::out | std::ios::binary );
+  if ( !file )
+    {
+    itkWarningMacro( << "Cannot write pyramid cache file "
+                     << temporaryName.str() );
+    return;
+    }
+  file.write( reinterpret_cast<const char *>( output->GetBufferPointer() ),
+              output->GetLargestPossibleRegion().GetNumberOfPixels()
+                * sizeof( OutputPixelType ) );
+  file.close();
+
+  if ( file.fail()
+       || rename( temporaryName.str().c_str(), fileName.c_str() ) != 0 )
+    {
+    itkWarningMacro( << "Cannot write pyramid cache file " << fileName );
+    remove( temporaryName.str().c_str() );
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::ComputeLevel( unsigned int level )
+{
+  typedef CastImageFilter<InputImageType, OutputImageType> CasterType;
+  typedef RecursiveGaussianImageFilter<OutputImageType, OutputImageType>
+                                                           SmootherType;
+  typedef ResampleImageFilter<OutputImageType, OutputImageType>
+                                                           ResamplerType;
+  typedef IdentityTransform<double, ImageDimension>        TransformType;
+  typedef LinearInterpolateImageFunction<OutputImageType, double>
+                                                           InterpolatorType;
+
+  OutputImagePointer output = this->GetOutput( level );
+  const typename Superclass::ScheduleType & schedule = this->GetSchedule();
+
+  typename CasterType::Pointer caster = CasterType::New();
+  caster->SetInput( m_WorkerInput );
+
+  // Same smoothing as MultiResolutionPyramidImageFilter, a variance of
+  // (0.5 * factor)^2 voxels, but recursive so that its cost does not grow
+  // with the shrink factor.
+  typename OutputImageType::Pointer smoothed;
+  caster->Update();
+  smoothed = caster->GetOutput();
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    if ( m_WorkerInput->GetLargestPossibleRegion().GetSize()[d] < 4 )
+      {
+      continue;
+      }
+    typename SmootherType::Pointer smoother = SmootherType::New();
+    smoother->SetInput( smoothed );
+    smoother->SetDirection( d );
+    smoother->SetZeroOrder();
+    smoother->SetSigma( 0.5 * schedule[level][d]
+                        * m_WorkerInput->GetSpacing()[d] );
+    smoother->Update();
+    smoothed = smoother->GetOutput();
+    smoothed->DisconnectPipeline();
+    }
+
+  typename ResamplerType::Pointer resampler = ResamplerType::New();
+  resampler->SetInput( smoothed );
+  resampler->SetTransform( TransformType::New() );
+  resampler->SetInterpolator( InterpolatorType::New() );
+  resampler->SetSize( output->GetLargestPossibleRegion().GetSize() );
+  resampler->SetOutputStartIndex( output->GetLargestPossibleRegion().GetIndex() );
+  resampler->SetOutputSpacing( output->GetSpacing() );
+  resampler->SetOutputOrigin( output->GetOrigin() );
+  resampler->SetOutputDirection( output->GetDirection() );
+  resampler->SetDefaultPixelValue( 0 );
+  resampler->Update();
+
+  const OutputPixelType * result = resampler->GetOutput()->GetBufferPointer();
+  std::copy( result,
+             result + output->GetLargestPossibleRegion().GetNumberOfPixels(),
+             output->GetBufferPointer() );
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::ComputeLevels()
+{
+  const unsigned int numberOfLevels = this->GetNumberOfLevels();
+  try
+    {
+    for ( unsigned int level = 0; level < numberOfLevels; level++ )
+      {
+      m_LevelLock.Lock();
+      const bool stop = m_StopWorker;
+      m_LevelLock.Unlock();
+      if ( stop )
+        {
+        return;
+        }
+
+      this->ComputeLevel( level );
+      if ( !m_CacheDirectory.empty() )
+        {
+        this->WriteLevel( level );
+        }
+
+      m_LevelLock.Lock();
+      m_LevelReady[level] = true;
+      m_LevelCondition->Broadcast();
+      m_LevelLock.Unlock();
+      }
+    }
+  catch( ExceptionObject & err )
+    {
+    m_LevelLock.Lock();
+    m_Failed = true;
+    m_ErrorMessage = err.GetDescription();
+    m_LevelCondition->Broadcast();
+    m_LevelLock.Unlock();
+    return;
+    }
+
+  this->AddOutputsToMemoryCache();
+}
+
+
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::ComputeLevelsThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+
+  self->ComputeLevels();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::JoinWorker( bool stop )
+{
+  if ( m_WorkerId < 0 )
+    {
+    return;
+    }
+  if ( stop )
+    {
+    m_LevelLock.Lock();
+    m_StopWorker = true;
+    m_LevelLock.Unlock();
+    }
+  m_Threader->TerminateThread( m_WorkerId );
+  m_WorkerId = -1;
+  m_WorkerInput = NULL;
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::WaitForLevel( unsigned int level )
+{
+  if ( level >= m_LevelReady.size() )
+    {
+    return;
+    }
+
+  m_LevelLock.Lock();
+  while ( !m_LevelReady[level] && !m_Failed )
+    {
+    m_LevelCondition->Wait( &m_LevelLock );
+    }
+  const bool failed = m_Failed;
+  m_LevelLock.Unlock();
+
+  if ( failed )
+    {
+    this->JoinWorker( true );
+    itkExceptionMacro( << "Computing pyramid level " << level
+                       << " failed: " << m_ErrorMessage );
+    }
+
+  if ( level + 1 == m_LevelReady.size() )
+    {
+    this->JoinWorker( false );
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  // A previous update may still be filling the outputs.
+  this->JoinWorker( true );
+
+  const unsigned int numberOfLevels = this->GetNumberOfLevels();
+  m_Key = this->ComputeKey();
+  m_LevelLock.Lock();
+  m_LevelReady.assign( numberOfLevels, false );
+  m_Failed = false;
+  m_ErrorMessage = "";
+  m_StopWorker = false;
+  m_LevelLock.Unlock();
+  m_LoadedFromCache = true;
+
+  // The outputs of a previous update may share their buffers with the
+  // memory cache.
+  for ( unsigned int level = 0; level < numberOfLevels; level++ )
+    {
+    this->GetOutput( level )->SetPixelContainer(
+      OutputImageType::PixelContainer::New() );
+    }
+
+  // Pyramid already built by this process.
+  GetMemoryCacheLock().Lock();
+  MemoryCacheType & cache = GetMemoryCache();
+  typename std::map<std::string, MemoryCacheEntry>::iterator cached =
+    cache.Entries.find( m_Key );
+  const bool inMemory = ( cached != cache.Entries.end() );
+  if ( inMemory )
+    {
+    cached->second.LastUse = ++cache.Clock;
+    for ( unsigned int level = 0; level < numberOfLevels; level++ )
+      {
+      this->GetOutput( level )->Graft( cached->second.Levels[level] );
+      }
+    }
+  GetMemoryCacheLock().Unlock();
+  if ( inMemory )
+    {
+    m_LevelReady.assign( numberOfLevels, true );
+    return;
+    }
+
+  // Pyramid written by an earlier run.
+  if ( !m_CacheDirectory.empty() )
+    {
+    bool onDisk = true;
+    for ( unsigned int level = 0; level < numberOfLevels && onDisk; level++ )
+      {
+      onDisk = this->ReadLevel( level );
+      }
+    if ( onDisk )
+      {
+      this->AddOutputsToMemoryCache();
+      m_LevelReady.assign( numberOfLevels, true );
+      return;
+      }
+
+    // Unmap the levels read before the missing one.
+    for ( unsigned int level = 0; level < numberOfLevels; level++ )
+      {
+      this->GetOutput( level )->SetPixelContainer(
+        OutputImageType::PixelContainer::New() );
+      }
+    }
+
+  m_LoadedFromCache = false;
+  for ( unsigned int level = 0; level < numberOfLevels; level++ )
+    {
+    OutputImagePointer output = this->GetOutput( level );
+    output->SetBufferedRegion( output->GetLargestPossibleRegion() );
+    output->Allocate();
+    }
+
+  // The level thread reads the input outside of the pipeline.
+  m_WorkerInput = InputImageType::New();
+  m_WorkerInput->Graft( this->GetInput() );
+
+  m_WorkerId = m_Threader->SpawnThread( Self::ComputeLevelsThreaderCallback,
+                                        this );
+
+  if ( !m_AsynchronousLevels )
+    {
+    this->WaitForLevel( numberOfLevels - 1 );
+    }
+}
+
+
+template <class TInputImage, class TOutputImage>
+void
+CachedMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "CacheDirectory: " << m_CacheDirectory << std::endl;
+  os << indent << "AsynchronousLevels: " << m_AsynchronousLevels << std::endl;
+  os << indent << "LoadedFromCache: " << m_LoadedFromCache << std::endl;
+  os << indent << "Key: " << m_Key << std::endl;
+}
+
+
+} // namespace itk
+
+#endif
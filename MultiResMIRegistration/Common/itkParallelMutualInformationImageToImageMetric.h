@@ -0,0 +1,193 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelMutualInformationImageToImageMetric.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkParallelMutualInformationImageToImageMetric_h
+#define _itkParallelMutualInformationImageToImageMetric_h
+
+#include "itkImageToImageMetric.h"
+#include "itkCovariantVector.h"
+#include "itkGradientImageFilter.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class ParallelMutualInformationImageToImageMetric
+ *
+ * Viola and Wells mutual information between a fixed and a moving image,
+ * computed as MutualInformationImageToImageMetric does (Parzen windows
+ * with a Gaussian kernel over two sets of spatial samples A and B), but
+ * meant for thousands of samples.
+ *
+ * - The sample positions and fixed image values are drawn once every
+ *   SampleRefreshPeriod calls to GetValueAndDerivative(), with a seeded
+ *   generator. In between, only the moving values are updated. A period
+ *   of one draws new samples at every iteration, as the ITK metric does.
+ * - The fixed image kernel between every pair of samples depends only on
+ *   the fixed values, so it is tabulated when the samples are drawn,
+ *   as long as the table fits in MaximumFixedKernelTableSize bytes.
+ * - The moving image gradient is computed once per Initialize(), with a
+ *   GradientImageFilter, and looked up at the nearest pixel.
+ * - The O(|A| |B|) pair sums are split over the samples of B between
+ *   NumberOfThreads threads, and the values are kept in flat float
+ *   arrays so that the kernel loop can be vectorized by the compiler.
+ *
+ * The metric returns the mutual information, which must be maximized.
+ *
+ * \ingroup RegistrationMetrics
+ */
+template <class TFixedImage, class TMovingImage>
+class ITK_EXPORT ParallelMutualInformationImageToImageMetric :
+    public ImageToImageMetric< TFixedImage, TMovingImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParallelMutualInformationImageToImageMetric      Self;
+  typedef ImageToImageMetric< TFixedImage, TMovingImage > Superclass;
+  typedef SmartPointer<Self>                              Pointer;
+  typedef SmartPointer<const Self>                        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ParallelMutualInformationImageToImageMetric,
+               ImageToImageMetric);
+
+  typedef typename Superclass::MeasureType              MeasureType;
+  typedef typename Superclass::DerivativeType           DerivativeType;
+  typedef typename Superclass::ParametersType           ParametersType;
+  typedef typename Superclass::FixedImageType           FixedImageType;
+  typedef typename Superclass::MovingImageType          MovingImageType;
+  typedef typename Superclass::FixedImageRegionType     FixedImageRegionType;
+  typedef typename Superclass::InputPointType           PointType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      MovingImageType::ImageDimension);
+
+  typedef CovariantVector<float, itkGetStaticConstMacro(ImageDimension)>
+                                                        GradientType;
+  typedef Image<GradientType, itkGetStaticConstMacro(ImageDimension)>
+                                                        GradientImageType;
+  typedef GradientImageFilter<MovingImageType, float, float>
+                                                        GradientFilterType;
+  typedef Statistics::MersenneTwisterRandomVariateGenerator
+                                                        RandomGeneratorType;
+
+  /** Number of samples in each of the two sets. */
+  itkSetClampMacro( NumberOfSpatialSamples, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfSpatialSamples, unsigned int );
+
+  /** Parzen window widths. */
+  itkSetClampMacro( MovingImageStandardDeviation, double,
+                    NumericTraits<double>::NonpositiveMin(),
+                    NumericTraits<double>::max() );
+  itkGetConstMacro( MovingImageStandardDeviation, double );
+  itkSetClampMacro( FixedImageStandardDeviation, double,
+                    NumericTraits<double>::NonpositiveMin(),
+                    NumericTraits<double>::max() );
+  itkGetConstMacro( FixedImageStandardDeviation, double );
+
+  /** Number of GetValueAndDerivative() calls sharing the same samples. */
+  itkSetClampMacro( SampleRefreshPeriod, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( SampleRefreshPeriod, unsigned int );
+
+  itkSetMacro( Seed, int );
+  itkGetConstMacro( Seed, int );
+
+  /** Largest fixed kernel table, in bytes. */
+  itkSetMacro( MaximumFixedKernelTableSize, unsigned long );
+  itkGetConstMacro( MaximumFixedKernelTableSize, unsigned long );
+
+  itkSetClampMacro( NumberOfThreads, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfThreads, unsigned int );
+
+  virtual void Initialize(void) throw ( ExceptionObject );
+
+  MeasureType GetValue( const ParametersType & parameters ) const;
+
+  void GetDerivative( const ParametersType & parameters,
+                      DerivativeType & derivative ) const;
+
+  void GetValueAndDerivative( const ParametersType & parameters,
+                              MeasureType & value,
+                              DerivativeType & derivative ) const;
+
+protected:
+  ParallelMutualInformationImageToImageMetric();
+  virtual ~ParallelMutualInformationImageToImageMetric() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+private:
+  ParallelMutualInformationImageToImageMetric( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  /** Draw the sample positions and fixed values of A and B. */
+  void DrawSamples() const;
+
+  /** Map the samples and update their moving values, and their moving
+   * value derivatives if derivatives is true. */
+  void MapSamples( bool derivatives ) const;
+
+  /** Value, and derivative if derivative is not null, of the mapped
+   * samples. */
+  MeasureType Evaluate( DerivativeType * derivative ) const;
+
+  static ITK_THREAD_RETURN_TYPE EvaluateThreaderCallback( void * arg );
+
+  unsigned int                 m_NumberOfSpatialSamples;
+  double                       m_MovingImageStandardDeviation;
+  double                       m_FixedImageStandardDeviation;
+  unsigned int                 m_SampleRefreshPeriod;
+  int                          m_Seed;
+  unsigned long                m_MaximumFixedKernelTableSize;
+  unsigned int                 m_NumberOfThreads;
+  double                       m_MinProbability;
+
+  typename GradientImageType::Pointer   m_GradientImage;
+  RandomGeneratorType::Pointer          m_Generator;
+  MultiThreader::Pointer                m_Threader;
+
+  /** Samples of A followed by the samples of B. */
+  mutable unsigned int                  m_Calls;
+  mutable std::vector<PointType>        m_SamplePoints;
+  mutable std::vector<float>            m_FixedValues;
+  mutable std::vector<float>            m_MovingValues;
+  mutable std::vector<double>           m_MovingDerivatives;
+
+  /** Fixed kernel of sample pairs (b, a), and its sum over A. */
+  mutable std::vector<float>            m_FixedKernel;
+  mutable std::vector<double>           m_FixedKernelSums;
+
+  /** Per thread results of Evaluate(). */
+  mutable bool                          m_ComputeDerivative;
+  mutable std::vector<double>           m_ThreadLogSums;
+  mutable std::vector< std::vector<double> > m_ThreadDerivatives;
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkParallelMutualInformationImageToImageMetric.txx"
+#endif
+
+#endif
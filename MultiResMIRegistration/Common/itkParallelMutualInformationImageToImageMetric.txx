@@ -0,0 +1,412 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkParallelMutualInformationImageToImageMetric.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkParallelMutualInformationImageToImageMetric_txx
+#define _itkParallelMutualInformationImageToImageMetric_txx
+
+#include "itkParallelMutualInformationImageToImageMetric.h"
+#include "vnl/vnl_math.h"
+
+#include <cmath>
+
+namespace itk
+{
+
+template <class TFixedImage, class TMovingImage>
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::ParallelMutualInformationImageToImageMetric()
+{
+  m_NumberOfSpatialSamples = 50;
+  m_MovingImageStandardDeviation = 0.4;
+  m_FixedImageStandardDeviation = 0.4;
+  m_SampleRefreshPeriod = 1;
+  m_Seed = 121212;
+  m_MaximumFixedKernelTableSize = 64 * 1024 * 1024;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_MinProbability = 0.0001;
+
+  m_GradientImage = NULL;
+  m_Generator = RandomGeneratorType::New();
+  m_Threader = MultiThreader::New();
+
+  m_Calls = 0;
+  m_ComputeDerivative = false;
+}
+
+
+template <class TFixedImage, class TMovingImage>
+void
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::Initialize(void) throw ( ExceptionObject )
+{
+  Superclass::Initialize();
+
+  typename GradientFilterType::Pointer gradientFilter =
+    GradientFilterType::New();
+  gradientFilter->SetInput( this->m_MovingImage );
+  gradientFilter->Update();
+  m_GradientImage = gradientFilter->GetOutput();
+
+  m_Generator->SetSeed( m_Seed );
+  m_Calls = 0;
+  m_SamplePoints.clear();
+}
+
+
+template <class TFixedImage, class TMovingImage>
+void
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::DrawSamples() const
+{
+  const unsigned int numberOfSamples = 2 * m_NumberOfSpatialSamples;
+  const FixedImageRegionType & region = this->GetFixedImageRegion();
+
+  m_SamplePoints.resize( numberOfSamples );
+  m_FixedValues.resize( numberOfSamples );
+  m_MovingValues.resize( numberOfSamples );
+
+  typename FixedImageType::IndexType index;
+  for ( unsigned int i = 0; i < numberOfSamples; i++ )
+    {
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      index[d] = region.GetIndex()[d] + static_cast<long>(
+        m_Generator->GetIntegerVariate( region.GetSize()[d] - 1 ) );
+      }
+    this->m_FixedImage->TransformIndexToPhysicalPoint( index,
+                                                       m_SamplePoints[i] );
+    m_FixedValues[i] = this->m_FixedImage->GetPixel( index );
+    }
+
+  // Tabulate the fixed image kernel between the samples of B (rows) and
+  // A (columns), with its row sums.
+  const unsigned int n = m_NumberOfSpatialSamples;
+  if ( static_cast<double>( n ) * n * sizeof( float )
+       > static_cast<double>( m_MaximumFixedKernelTableSize ) )
+    {
+    m_FixedKernel.clear();
+    m_FixedKernelSums.clear();
+    return;
+    }
+
+  const float norm = 1.0 / vcl_sqrt( 2.0 * vnl_math::pi );
+  const float invSigma = 1.0 / m_FixedImageStandardDeviation;
+  m_FixedKernel.resize( n * n );
+  m_FixedKernelSums.resize( n );
+  for ( unsigned int b = 0; b < n; b++ )
+    {
+    const float fixedB = m_FixedValues[n + b];
+    float * row = &m_FixedKernel[b * n];
+    double sum = 0.0;
+    for ( unsigned int a = 0; a < n; a++ )
+      {
+      const float u = ( fixedB - m_FixedValues[a] ) * invSigma;
+      row[a] = norm * vcl_exp( -0.5f * u * u );
+      sum += row[a];
+      }
+    m_FixedKernelSums[b] = sum;
+    }
+}
+
+
+template <class TFixedImage, class TMovingImage>
+void
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::MapSamples( bool derivatives ) const
+{
+  const unsigned int numberOfSamples = m_SamplePoints.size();
+  const unsigned int numberOfParameters =
+    this->m_Transform->GetNumberOfParameters();
+
+  if ( derivatives )
+    {
+    m_MovingDerivatives.assign( numberOfSamples * numberOfParameters, 0.0 );
+    }
+
+  bool allOutside = true;
+  typename GradientImageType::IndexType index;
+  for ( unsigned int i = 0; i < numberOfSamples; i++ )
+    {
+    const PointType mappedPoint =
+      this->m_Transform->TransformPoint( m_SamplePoints[i] );
+
+    if ( !this->m_Interpolator->IsInsideBuffer( mappedPoint ) )
+      {
+      m_MovingValues[i] = 0;
+      continue;
+      }
+    allOutside = false;
+    m_MovingValues[i] = this->m_Interpolator->Evaluate( mappedPoint );
+
+    if ( !derivatives
+         || !m_GradientImage->TransformPhysicalPointToIndex( mappedPoint,
+                                                             index ) )
+      {
+      continue;
+      }
+
+    // Derivative of the moving value with respect to the parameters.
+    const GradientType & gradient = m_GradientImage->GetPixel( index );
+    const typename Superclass::TransformJacobianType & jacobian =
+      this->m_Transform->GetJacobian( m_SamplePoints[i] );
+    double * sampleDerivative = &m_MovingDerivatives[i * numberOfParameters];
+    for ( unsigned int p = 0; p < numberOfParameters; p++ )
+      {
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        sampleDerivative[p] += jacobian[d][p] * gradient[d];
+        }
+      }
+    }
+
+  if ( allOutside )
+    {
+    itkExceptionMacro( << "All the sampled point mapped to outside of the moving image" );
+    }
+}
+
+
+template <class TFixedImage, class TMovingImage>
+ITK_THREAD_RETURN_TYPE
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::EvaluateThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const Self * self = static_cast<const Self *>( info->UserData );
+
+  const unsigned int threadId = info->ThreadID;
+  const unsigned int numberOfThreads = info->NumberOfThreads;
+  const unsigned int n = self->m_NumberOfSpatialSamples;
+  const unsigned int chunk = ( n + numberOfThreads - 1 ) / numberOfThreads;
+  const unsigned int first = threadId * chunk;
+  const unsigned int last = vnl_math_min( n, first + chunk );
+
+  const bool useTable = !self->m_FixedKernel.empty();
+  const bool computeDerivative = self->m_ComputeDerivative;
+  const unsigned int numberOfParameters =
+    self->m_Transform->GetNumberOfParameters();
+
+  const float norm = 1.0 / vcl_sqrt( 2.0 * vnl_math::pi );
+  const float invSigmaFixed = 1.0 / self->m_FixedImageStandardDeviation;
+  const float invSigmaMoving = 1.0 / self->m_MovingImageStandardDeviation;
+  const double minProbability = self->m_MinProbability;
+
+  const float * fixedA = &self->m_FixedValues[0];
+  const float * movingA = &self->m_MovingValues[0];
+
+  std::vector<float> fixedKernel( n );
+  std::vector<float> movingKernel( n );
+  double logSum = 0.0;
+  std::vector<double> & derivative = self->m_ThreadDerivatives[threadId];
+
+  for ( unsigned int b = first; b < last; b++ )
+    {
+    const float fixedB = self->m_FixedValues[n + b];
+    const float movingB = self->m_MovingValues[n + b];
+
+    double sumFixed = minProbability;
+    double sumMoving = minProbability;
+    double sumJoint = minProbability;
+
+    // Kernel sums over A, on flat arrays.
+    if ( useTable )
+      {
+      const float * row = &self->m_FixedKernel[b * n];
+      for ( unsigned int a = 0; a < n; a++ )
+        {
+        const float u = ( movingB - movingA[a] ) * invSigmaMoving;
+        movingKernel[a] = norm * vcl_exp( -0.5f * u * u );
+        fixedKernel[a] = row[a];
+        }
+      sumFixed += self->m_FixedKernelSums[b];
+      }
+    else
+      {
+      for ( unsigned int a = 0; a < n; a++ )
+        {
+        const float u = ( movingB - movingA[a] ) * invSigmaMoving;
+        const float v = ( fixedB - fixedA[a] ) * invSigmaFixed;
+        movingKernel[a] = norm * vcl_exp( -0.5f * u * u );
+        fixedKernel[a] = norm * vcl_exp( -0.5f * v * v );
+        }
+      for ( unsigned int a = 0; a < n; a++ )
+        {
+        sumFixed += fixedKernel[a];
+        }
+      }
+    for ( unsigned int a = 0; a < n; a++ )
+      {
+      sumMoving += movingKernel[a];
+      sumJoint += movingKernel[a] * fixedKernel[a];
+      }
+
+    logSum += vcl_log( sumJoint ) - vcl_log( sumFixed ) - vcl_log( sumMoving );
+
+    if ( !computeDerivative )
+      {
+      continue;
+      }
+
+    const double * derivativeB =
+      &self->m_MovingDerivatives[( n + b ) * numberOfParameters];
+    double totalWeight = 0.0;
+    for ( unsigned int a = 0; a < n; a++ )
+      {
+      const double weightMoving = movingKernel[a] / sumMoving;
+      const double weightJoint = movingKernel[a] * fixedKernel[a] / sumJoint;
+      const double weight =
+        ( weightMoving - weightJoint ) * ( movingB - movingA[a] );
+      totalWeight += weight;
+
+      const double * derivativeA =
+        &self->m_MovingDerivatives[a * numberOfParameters];
+      for ( unsigned int p = 0; p < numberOfParameters; p++ )
+        {
+        derivative[p] -= derivativeA[p] * weight;
+        }
+      }
+    for ( unsigned int p = 0; p < numberOfParameters; p++ )
+      {
+      derivative[p] += derivativeB[p] * totalWeight;
+      }
+    }
+
+  self->m_ThreadLogSums[threadId] = logSum;
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TFixedImage, class TMovingImage>
+typename ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>::MeasureType
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::Evaluate( DerivativeType * derivative ) const
+{
+  const unsigned int numberOfParameters =
+    this->m_Transform->GetNumberOfParameters();
+  const unsigned int numberOfThreads =
+    vnl_math_min( m_NumberOfThreads, m_NumberOfSpatialSamples );
+
+  m_ComputeDerivative = ( derivative != NULL );
+  m_ThreadLogSums.assign( numberOfThreads, 0.0 );
+  m_ThreadDerivatives.assign( numberOfThreads,
+    std::vector<double>( m_ComputeDerivative ? numberOfParameters : 0, 0.0 ) );
+
+  // The threader is shared with const evaluations.
+  MultiThreader * threader = const_cast<MultiThreader *>(
+    m_Threader.GetPointer() );
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( Self::EvaluateThreaderCallback,
+                             const_cast<Self *>( this ) );
+  threader->SingleMethodExecute();
+
+  // Summed in thread order, so that the result does not depend on
+  // scheduling.
+  double logSum = 0.0;
+  for ( unsigned int t = 0; t < numberOfThreads; t++ )
+    {
+    logSum += m_ThreadLogSums[t];
+    }
+
+  const double n = m_NumberOfSpatialSamples;
+  MeasureType value = logSum / n + vcl_log( n );
+
+  if ( derivative )
+    {
+    *derivative = DerivativeType( numberOfParameters );
+    derivative->Fill( 0.0 );
+    for ( unsigned int t = 0; t < numberOfThreads; t++ )
+      {
+      for ( unsigned int p = 0; p < numberOfParameters; p++ )
+        {
+        (*derivative)[p] += m_ThreadDerivatives[t][p];
+        }
+      }
+    *derivative /= n * vnl_math_sqr( m_MovingImageStandardDeviation );
+    }
+
+  return value;
+}
+
+
+template <class TFixedImage, class TMovingImage>
+typename ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>::MeasureType
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::GetValue( const ParametersType & parameters ) const
+{
+  if ( m_SamplePoints.empty() )
+    {
+    this->DrawSamples();
+    }
+
+  this->SetTransformParameters( parameters );
+  this->MapSamples( false );
+
+  return this->Evaluate( NULL );
+}
+
+
+template <class TFixedImage, class TMovingImage>
+void
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::GetValueAndDerivative( const ParametersType & parameters,
+                         MeasureType & value,
+                         DerivativeType & derivative ) const
+{
+  if ( m_SamplePoints.empty() || m_Calls % m_SampleRefreshPeriod == 0 )
+    {
+    this->DrawSamples();
+    }
+  m_Calls++;
+
+  this->SetTransformParameters( parameters );
+  this->MapSamples( true );
+
+  value = this->Evaluate( &derivative );
+}
+
+
+template <class TFixedImage, class TMovingImage>
+void
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::GetDerivative( const ParametersType & parameters,
+                 DerivativeType & derivative ) const
+{
+  MeasureType value;
+  this->GetValueAndDerivative( parameters, value, derivative );
+}
+
+
+template <class TFixedImage, class TMovingImage>
+void
+ParallelMutualInformationImageToImageMetric<TFixedImage,TMovingImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfSpatialSamples: " << m_NumberOfSpatialSamples << std::endl;
+  os << indent << "MovingImageStandardDeviation: " << m_MovingImageStandardDeviation << std::endl;
+  os << indent << "FixedImageStandardDeviation: " << m_FixedImageStandardDeviation << std::endl;
+  os << indent << "SampleRefreshPeriod: " << m_SampleRefreshPeriod << std::endl;
+  os << indent << "Seed: " << m_Seed << std::endl;
+  os << indent << "MaximumFixedKernelTableSize: " << m_MaximumFixedKernelTableSize << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+}
+
+} // namespace itk
+
+#endif
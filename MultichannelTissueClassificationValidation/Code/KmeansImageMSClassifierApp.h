@@ -20,6 +20,7 @@
 #include "itkObject.h"
 
 #include "itkImageKmeansModelEstimator.h"
+#include "itkMiniBatchKmeansImageModelEstimator.h"
 #include "itkDistanceToCentroidMembershipFunction.h"
 
 #include "itkMinimumDecisionRule.h"
@@ -62,6 +63,12 @@ public:
  * Outputs:
  *    - pointer to the classified image 
  *
+ * The codebook is trained either by ImageKmeansModelEstimator over every
+ * voxel (default) or, with UseMiniBatchKmeans on, by the multithreaded
+ * MiniBatchKmeansImageModelEstimator over a sample of the voxels inside
+ * the mask. With CompareKmeansEstimators on, both are run and their
+ * training time and distortion on the same sample set are reported.
+ *
  * TODO: Right now an initial code book needed by the Kmeans modeler is
  * hardcoded. Need to move it into a parameter file.
  *
@@ -140,6 +147,20 @@ public:
     m_ClassCovariances = classCovariances;
     } 
 
+  /** Train the codebook with the mini-batch estimator. */
+  itkSetMacro( UseMiniBatchKmeans, bool );
+  itkGetMacro( UseMiniBatchKmeans, bool );
+  itkBooleanMacro( UseMiniBatchKmeans );
+
+  /** Run both estimators and report time and distortion. */
+  itkSetMacro( CompareKmeansEstimators, bool );
+  itkGetMacro( CompareKmeansEstimators, bool );
+  itkBooleanMacro( CompareKmeansEstimators );
+
+  /** Set the number of voxels sampled by the mini-batch estimator. */
+  itkSetMacro( NumberOfKmeansSamples, unsigned long );
+  itkGetMacro( NumberOfKmeansSamples, unsigned long );
+
   /** Method to execute the preprocessing. */
   virtual void Execute();
 
@@ -169,6 +190,10 @@ private:
   IntegerMatrixType                            m_ClassNumberOfSamples;
   DoubleMatrixArrayType                        m_ClassCovariances;      
 
+  bool                                         m_UseMiniBatchKmeans;
+  bool                                         m_CompareKmeansEstimators;
+  unsigned long                                m_NumberOfKmeansSamples;
+
 };
 
 } // namespace itk
@@ -18,6 +18,7 @@
 #define _KmeansImageMSClassifierApp_txx
 
 #include "KmeansImageMSClassifierApp.h"
+#include "itkTimeProbe.h"
 
 namespace itk
 {
@@ -32,6 +33,10 @@ KmeansImageMSClassifierApp<TVectorInputImage,TMaskImage>
   m_NumberOfClasses    = 1;
   m_NumberOfChannels   = 1;
 
+  m_UseMiniBatchKmeans      = false;
+  m_CompareKmeansEstimators = false;
+  m_NumberOfKmeansSamples   = 100000;
+
   //-------------------------------------------------------------------
   // Initialize the containers for means/covariance/number of samples 
   //-------------------------------------------------------------------
@@ -102,19 +107,84 @@ KmeansImageMSClassifierApp<TVectorInputImage,TMaskImage>
   //Set the parameters of the clusterer
   //----------------------------------------------------------------------
 
-  std::cout << "Starting to build the K-means model ....." << std::endl;
+  typedef itk::MiniBatchKmeansImageModelEstimator< VectorInputImageType,
+    MembershipFunctionType, MaskImageType> MiniBatchKmeansModelEstimatorType;
+
+  typename MiniBatchKmeansModelEstimatorType::Pointer
+    miniBatchKmeansModelEstimator = MiniBatchKmeansModelEstimatorType::New();
+
+  MembershipFunctionPointerVector membershipFunctions;
 
-  applyKmeansModelEstimator->SetInputImage( m_VectorInputImage );
-  applyKmeansModelEstimator->SetNumberOfModels(m_NumberOfClasses);
-  applyKmeansModelEstimator->SetThreshold(0.01);
-  applyKmeansModelEstimator->SetCodebook(inCDBK);
+  TimeProbe kmeansTimer;
+  TimeProbe miniBatchTimer;
 
-  applyKmeansModelEstimator->Update();
+  if( !m_UseMiniBatchKmeans || m_CompareKmeansEstimators )
+    {
+    std::cout << "Starting to build the K-means model ....." << std::endl;
+
+    applyKmeansModelEstimator->SetInputImage( m_VectorInputImage );
+    applyKmeansModelEstimator->SetNumberOfModels(m_NumberOfClasses);
+    applyKmeansModelEstimator->SetThreshold(0.01);
+    applyKmeansModelEstimator->SetCodebook(inCDBK);
 
-  MembershipFunctionPointerVector membershipFunctions = 
-    applyKmeansModelEstimator->GetMembershipFunctions(); 
+    kmeansTimer.Start();
+    applyKmeansModelEstimator->Update();
+    kmeansTimer.Stop();
 
+    membershipFunctions = applyKmeansModelEstimator->GetMembershipFunctions(); 
+    }
 
+  if( m_UseMiniBatchKmeans || m_CompareKmeansEstimators )
+    {
+    std::cout << "Starting to build the mini-batch K-means model ....." 
+      << std::endl;
+
+    miniBatchKmeansModelEstimator->SetInputImage( m_VectorInputImage );
+    miniBatchKmeansModelEstimator->SetMaskImage( m_MaskInputImage );
+    miniBatchKmeansModelEstimator->SetNumberOfModels(m_NumberOfClasses);
+    miniBatchKmeansModelEstimator->SetNumberOfSamples(m_NumberOfKmeansSamples);
+    miniBatchKmeansModelEstimator->SetCodebook(inCDBK);
+
+    miniBatchTimer.Start();
+    miniBatchKmeansModelEstimator->Update();
+    miniBatchTimer.Stop();
+
+    if( m_UseMiniBatchKmeans )
+      {
+      membershipFunctions = 
+        miniBatchKmeansModelEstimator->GetMembershipFunctions(); 
+      }
+
+    std::cout << "Mini-batch K-means: " 
+      << miniBatchKmeansModelEstimator->GetNumberOfDrawnSamples() 
+      << " samples, " 
+      << miniBatchKmeansModelEstimator->GetNumberOfIterationsPerformed()
+      << " iterations, " << miniBatchTimer.GetMeanTime() << " s, distortion "
+      << miniBatchKmeansModelEstimator->GetDistortion() << std::endl;
+    }
+
+  if( m_CompareKmeansEstimators )
+    {
+    // Score the full-image codebook on the same samples so both
+    // distortions are directly comparable.
+    MembershipFunctionPointerVector kmeansFunctions = applyKmeansModelEstimator->GetMembershipFunctions();
+
+    vnl_matrix<double> kmeansCodebook( m_NumberOfClasses, m_NumberOfChannels );
+    for(unsigned int classIndex=0; classIndex < kmeansFunctions.size(); 
+      classIndex++ )
+      {
+      for(unsigned int channel=0; channel < m_NumberOfChannels; channel++ )
+        {
+        kmeansCodebook.put( classIndex, channel, 
+          (kmeansFunctions[classIndex]->GetCentroid())[channel] );
+        }
+      }
+
+    std::cout << "K-means: " << kmeansTimer.GetMeanTime() 
+      << " s, distortion " 
+      << miniBatchKmeansModelEstimator->EvaluateDistortion( kmeansCodebook )
+      << std::endl;
+    }
 
   std::vector<double> kmeansResultForClass(membershipFunctions.size());
   std::vector<double> kmeansRes( membershipFunctions.size() );
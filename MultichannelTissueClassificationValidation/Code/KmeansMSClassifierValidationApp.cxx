@@ -17,6 +17,7 @@
 #include <iostream>
 #include <fstream>
 #include <stdio.h>
+#include <string.h>
 
 #include "KmeansMSClassifierValidationApp.h"
 #include "itkImage.h"
@@ -31,7 +32,8 @@ int main(int argc, char *argv[])
     {
     std::cout << "Parameter file name missing" << std::endl;
     std::cout << std::endl;
-    std::cout << "Usage:  KMeansClassifierValidationApp param.file" << std::endl;
+    std::cout << "Usage:  KMeansClassifierValidationApp param.file"
+              << " [-minibatch|-compare]" << std::endl;
     return 1;
     }
 
@@ -64,6 +66,20 @@ int main(int argc, char *argv[])
 
   app->SetTruthLabels( truthLabels );
 
+  // Optionally train the codebook with the mini-batch estimator, or run
+  // both estimators and report their time and distortion.
+  if ( argc > 2 )
+    {
+    if ( strcmp( argv[2], "-minibatch" ) == 0 )
+      {
+      app->UseMiniBatchKmeansOn();
+      }
+    else if ( strcmp( argv[2], "-compare" ) == 0 )
+      {
+      app->CompareKmeansEstimatorsOn();
+      }
+    }
+
   // Parse the input file and set up the app
   std::ifstream inputStream( argv[1], std::ios::in );
 
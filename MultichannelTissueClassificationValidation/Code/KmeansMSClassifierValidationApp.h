@@ -139,6 +139,16 @@ public:
   itkGetMacro( AppendOutputFile, bool );
   itkBooleanMacro( AppendOutputFile );
 
+  /** Train the codebook with the mini-batch K-means estimator. */
+  itkSetMacro( UseMiniBatchKmeans, bool );
+  itkGetMacro( UseMiniBatchKmeans, bool );
+  itkBooleanMacro( UseMiniBatchKmeans );
+
+  /** Run both K-means estimators and report time and distortion. */
+  itkSetMacro( CompareKmeansEstimators, bool );
+  itkGetMacro( CompareKmeansEstimators, bool );
+  itkBooleanMacro( CompareKmeansEstimators );
+
   /** Get the file extension vector */
   StringVectorType GetFileExtensions()
     {
@@ -180,6 +190,8 @@ private:
   std::string                   m_ParameterFileName;
   std::string                   m_OutputFileName;
   bool                          m_AppendOutputFile;
+  bool                          m_UseMiniBatchKmeans;
+  bool                          m_CompareKmeansEstimators;
 
   StringVectorType              m_FileExtensions;
   std::string                   m_tempstring;
@@ -38,6 +38,8 @@ KmeansMSClassifierValidationApp<TImage,TMaskImage>
   m_ParameterFileName = "";
   m_OutputFileName = "";
   m_AppendOutputFile = true;
+  m_UseMiniBatchKmeans = false;
+  m_CompareKmeansEstimators = false;
   m_FileExtensions.resize(0);
 }
 
@@ -75,6 +77,8 @@ KmeansMSClassifierValidationApp<TImage,TMaskImage>
   this->m_MSClassifier->SetMaskInputImage( this->m_Parser->GetMaskImage() );
   this->m_MSClassifier->SetNumberOfClasses( m_NumberOfClasses );  
   this->m_MSClassifier->SetNumberOfChannels( this->m_Parser->GetNumberOfChannels() );  
+  this->m_MSClassifier->SetUseMiniBatchKmeans( m_UseMiniBatchKmeans );
+  this->m_MSClassifier->SetCompareKmeansEstimators( m_CompareKmeansEstimators );
  
 }
 
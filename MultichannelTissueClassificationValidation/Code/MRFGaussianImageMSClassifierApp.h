@@ -19,6 +19,7 @@
 
 #include "itkObject.h"
 #include "itkMRFImageFilter.h"
+#include "itkCheckerboardMRFImageFilter.h"
 
 #include "itkMahalanobisDistanceMembershipFunction.h"
 
@@ -162,6 +163,17 @@ public:
   itkSetMacro( NeighborhoodRadius, unsigned long );
   itkGetMacro( NeighborhoodRadius, unsigned long );
 
+  /** Relabel with the parallel CheckerboardMRFImageFilter instead of
+   * MRFImageFilter. */
+  itkSetMacro( UseCheckerboardMRF, bool );
+  itkGetMacro( UseCheckerboardMRF, bool );
+  itkBooleanMacro( UseCheckerboardMRF );
+
+  /** Run both MRF solvers and report their time and label agreement. */
+  itkSetMacro( CompareMRFSolvers, bool );
+  itkGetMacro( CompareMRFSolvers, bool );
+  itkBooleanMacro( CompareMRFSolvers );
+
 
 protected:
   MRFGaussianImageMSClassifierApp();
@@ -189,6 +201,9 @@ private:
   unsigned int                                 m_NeighborhoodRadius;
   double                                       m_ErrorTolerance;   
   double                                       m_SmoothingFactor; 
+
+  bool                                         m_UseCheckerboardMRF;
+  bool                                         m_CompareMRFSolvers;
   
 
 
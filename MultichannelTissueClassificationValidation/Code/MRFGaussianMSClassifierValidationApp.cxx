@@ -17,6 +17,7 @@
 #include <iostream>
 #include <fstream>
 #include <stdio.h>
+#include <string.h>
 
 #include "MRFGaussianMSClassifierValidationApp.h"
 #include "itkImage.h"
@@ -31,7 +32,8 @@ int main(int argc, char *argv[])
     {
     std::cout << "Parameter file name missing" << std::endl;
     std::cout << std::endl;
-    std::cout << "Usage:  MRFGaussianMSClassifierValidationApp param.file" << std::endl;
+    std::cout << "Usage:  MRFGaussianMSClassifierValidationApp param.file"
+              << " [-checkerboard|-compare]" << std::endl;
     return 1;
     }
 
@@ -138,6 +140,20 @@ int main(int argc, char *argv[])
 
   app->SetSmoothingFactor( 1 );
 
+  // Optionally relabel with the parallel checkerboard MRF solver, or run
+  // both solvers and report the speedup and the label agreement.
+  if ( argc > 2 )
+    {
+    if ( strcmp( argv[2], "-checkerboard" ) == 0 )
+      {
+      app->UseCheckerboardMRFOn();
+      }
+    else if ( strcmp( argv[2], "-compare" ) == 0 )
+      {
+      app->CompareMRFSolversOn();
+      }
+    }
+
   unsigned int numberOfSlices;
 //  signed int startSlice;  
 //  signed int startSegSlice;
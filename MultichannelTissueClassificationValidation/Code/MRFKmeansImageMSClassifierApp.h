@@ -20,6 +20,7 @@
 #include "itkObject.h"
 
 #include "itkMRFImageFilter.h"
+#include "itkCheckerboardMRFImageFilter.h"
 #include "itkImageKmeansModelEstimator.h"
 #include "itkDistanceToCentroidMembershipFunction.h"
 
@@ -160,6 +161,17 @@ public:
   itkSetMacro( NeighborhoodRadius, unsigned long );
   itkGetMacro( NeighborhoodRadius, unsigned long );
 
+  /** Relabel with the parallel CheckerboardMRFImageFilter instead of
+   * MRFImageFilter. */
+  itkSetMacro( UseCheckerboardMRF, bool );
+  itkGetMacro( UseCheckerboardMRF, bool );
+  itkBooleanMacro( UseCheckerboardMRF );
+
+  /** Run both MRF solvers and report their time and label agreement. */
+  itkSetMacro( CompareMRFSolvers, bool );
+  itkGetMacro( CompareMRFSolvers, bool );
+  itkBooleanMacro( CompareMRFSolvers );
+
 
   /** Method to execute the preprocessing. */
   virtual void Execute();
@@ -195,6 +207,9 @@ private:
   double                                       m_ErrorTolerance;   
   double                                       m_SmoothingFactor;   
 
+  bool                                         m_UseCheckerboardMRF;
+  bool                                         m_CompareMRFSolvers;
+
 };
 
 } // namespace itk
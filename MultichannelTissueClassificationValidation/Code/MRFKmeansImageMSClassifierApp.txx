@@ -18,6 +18,8 @@
 #define _MRFKmeansImageMSClassifierApp_txx
 
 #include "MRFKmeansImageMSClassifierApp.h"
+#include "itkTimeProbe.h"
+#include "itkImageRegionConstIterator.h"
 
 namespace itk
 {
@@ -32,6 +34,9 @@ MRFKmeansImageMSClassifierApp<TVectorInputImage,TMaskImage>
   m_NumberOfClasses    = 1;
   m_NumberOfChannels   = 1;
 
+  m_UseCheckerboardMRF = false;
+  m_CompareMRFSolvers  = false;
+
   //-------------------------------------------------------------------
   // Initialize the containers for means/covariance/number of samples 
   //-------------------------------------------------------------------
@@ -215,25 +220,99 @@ MRFKmeansImageMSClassifierApp<TVectorInputImage,TMaskImage>
   typedef itk::MRFImageFilter<VectorInputImageType,ClassifiedImageType> 
     MRFFilterType;
 
-  MRFFilterType::Pointer applyMRFFilter = MRFFilterType::New();
+  typename MRFFilterType::Pointer applyMRFFilter = MRFFilterType::New();
+
+  typedef itk::CheckerboardMRFImageFilter<VectorInputImageType,
+    ClassifiedImageType> CheckerboardMRFFilterType;
+
+  typename CheckerboardMRFFilterType::Pointer checkerboardMRFFilter = 
+    CheckerboardMRFFilterType::New();
 
-  // Set the MRF labeller parameters
-  applyMRFFilter->SetNumberOfClasses(m_NumberOfClasses);
-  applyMRFFilter->SetMaximumNumberOfIterations(m_MaximumNumberOfIterations);
-  applyMRFFilter->SetErrorTolerance(m_ErrorTolerance);
-  applyMRFFilter->SetSmoothingFactor( m_SmoothingFactor );
+  TimeProbe serialTimer;
+  TimeProbe checkerboardTimer;
 
-  //For setting up a square/cubic or hypercubic neighborhood
-  applyMRFFilter->SetNeighborhoodRadius( m_NeighborhoodRadius );
+  if( !m_UseCheckerboardMRF || m_CompareMRFSolvers )
+    {
+    // Set the MRF labeller parameters
+    applyMRFFilter->SetNumberOfClasses(m_NumberOfClasses);
+    applyMRFFilter->SetMaximumNumberOfIterations(m_MaximumNumberOfIterations);
+    applyMRFFilter->SetErrorTolerance(m_ErrorTolerance);
+    applyMRFFilter->SetSmoothingFactor( m_SmoothingFactor );
+
+    //For setting up a square/cubic or hypercubic neighborhood
+    applyMRFFilter->SetNeighborhoodRadius( m_NeighborhoodRadius );
  
-  applyMRFFilter->SetInput(m_VectorInputImage);
-  applyMRFFilter->SetClassifier( classifierPointer ); 
+    applyMRFFilter->SetInput(m_VectorInputImage);
+    applyMRFFilter->SetClassifier( classifierPointer ); 
   
-  //Kick off the MRF labeller function
-  applyMRFFilter->Update();
+    //Kick off the MRF labeller function
+    serialTimer.Start();
+    applyMRFFilter->Update();
+    serialTimer.Stop();
+
+    std::cout << "MRF labelling: " << serialTimer.GetMeanTime() << " s" 
+      << std::endl;
+
+    this->SetClassifiedImage( 
+      applyMRFFilter->GetOutput() );
+    }
+
+  if( m_UseCheckerboardMRF || m_CompareMRFSolvers )
+    {
+    checkerboardMRFFilter->SetNumberOfClasses(m_NumberOfClasses);
+    checkerboardMRFFilter->SetMaximumNumberOfIterations(m_MaximumNumberOfIterations);
+    checkerboardMRFFilter->SetErrorTolerance(m_ErrorTolerance);
+    checkerboardMRFFilter->SetSmoothingFactor( m_SmoothingFactor );
+    checkerboardMRFFilter->SetNeighborhoodRadius( m_NeighborhoodRadius );
+
+    checkerboardMRFFilter->SetInput(m_VectorInputImage);
+    checkerboardMRFFilter->SetClassifier( classifierPointer ); 
+
+    checkerboardTimer.Start();
+    checkerboardMRFFilter->Update();
+    checkerboardTimer.Stop();
+
+    std::cout << "Checkerboard MRF labelling: " 
+      << checkerboardTimer.GetMeanTime() << " s, "
+      << checkerboardMRFFilter->GetNumberOfIterations() << " iterations"
+      << std::endl;
+
+    if( m_UseCheckerboardMRF )
+      {
+      this->SetClassifiedImage( 
+        checkerboardMRFFilter->GetOutput() );
+      }
+    }
 
-  this->SetClassifiedImage( 
-    applyMRFFilter->GetOutput() );
+  if( m_CompareMRFSolvers )
+    {
+    //------------------------------------------------------
+    //Report the speedup and the fraction of identical labels
+    //------------------------------------------------------
+    typedef ImageRegionConstIterator<ClassifiedImageType> LabelIteratorType;
+
+    LabelIteratorType serialIt( applyMRFFilter->GetOutput(),
+      applyMRFFilter->GetOutput()->GetBufferedRegion() );
+    LabelIteratorType checkerboardIt( checkerboardMRFFilter->GetOutput(),
+      checkerboardMRFFilter->GetOutput()->GetBufferedRegion() );
+
+    unsigned long agree = 0;
+    unsigned long total = 0;
+    for( ; !serialIt.IsAtEnd(); ++serialIt, ++checkerboardIt )
+      {
+      if( serialIt.Get() == checkerboardIt.Get() )
+        {
+        agree++;
+        }
+      total++;
+      }
+
+    std::cout << "MRF speedup: " 
+      << serialTimer.GetMeanTime() / checkerboardTimer.GetMeanTime()
+      << ", label agreement: " 
+      << static_cast<double>( agree ) / static_cast<double>( total )
+      << std::endl;
+    }
 
 }
 
@@ -143,6 +143,16 @@ public:
   itkSetMacro( NeighborhoodRadius, unsigned long );
   itkGetMacro( NeighborhoodRadius, unsigned long );
 
+  /** Relabel with the parallel checkerboard MRF solver. */
+  itkSetMacro( UseCheckerboardMRF, bool );
+  itkGetMacro( UseCheckerboardMRF, bool );
+  itkBooleanMacro( UseCheckerboardMRF );
+
+  /** Run both MRF solvers and report their time and label agreement. */
+  itkSetMacro( CompareMRFSolvers, bool );
+  itkGetMacro( CompareMRFSolvers, bool );
+  itkBooleanMacro( CompareMRFSolvers );
+
   /** Set input parameter file */
   itkSetStringMacro( ParameterFileName );
 
@@ -199,6 +209,8 @@ private:
   std::string                   m_ParameterFileName;
   std::string                   m_OutputFileName;
   bool                          m_AppendOutputFile;
+  bool                          m_UseCheckerboardMRF;
+  bool                          m_CompareMRFSolvers;
 
   StringVectorType              m_FileExtensions;
   std::string                   m_tempstring;
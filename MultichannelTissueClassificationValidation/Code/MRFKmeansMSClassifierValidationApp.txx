@@ -38,6 +38,8 @@ MRFKmeansMSClassifierValidationApp<TImage,TMaskImage>
   m_ParameterFileName = "";
   m_OutputFileName = "";
   m_AppendOutputFile = true;
+  m_UseCheckerboardMRF = false;
+  m_CompareMRFSolvers = false;
   m_FileExtensions.resize(0);
 }
 
@@ -78,6 +80,8 @@ MRFKmeansMSClassifierValidationApp<TImage,TMaskImage>
 
   m_MSClassifier->SetMaximumNumberOfIterations( m_MaximumNumberOfIterations );
   m_MSClassifier->SetNeighborhoodRadius( m_NeighborhoodRadius );
+  m_MSClassifier->SetUseCheckerboardMRF( m_UseCheckerboardMRF );
+  m_MSClassifier->SetCompareMRFSolvers( m_CompareMRFSolvers );
   m_MSClassifier->SetErrorTolerance( m_ErrorTolerance ); 
   m_MSClassifier->SetSmoothingFactor( m_SmoothingFactor ); 
  
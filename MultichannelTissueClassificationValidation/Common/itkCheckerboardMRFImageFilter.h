@@ -0,0 +1,214 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkCheckerboardMRFImageFilter.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkCheckerboardMRFImageFilter_h
+#define _itkCheckerboardMRFImageFilter_h
+
+#include <vector>
+
+#include "itkImageToImageFilter.h"
+#include "itkImageClassifierBase.h"
+#include "itkMultiThreader.h"
+
+namespace itk
+{
+
+/** \class CheckerboardMRFImageFilter
+ *
+ * Parallel replacement for MRFImageFilter. It minimizes the same energy
+ * (class membership value of the pixel minus the weighted count of
+ * neighbours carrying each label) with iterated conditional modes, but
+ * visits the pixels in a multi-colour checkerboard order so that all the
+ * pixels of one colour can be relabelled concurrently.
+ *
+ * With a neighbourhood radius r, pixels whose indices are congruent modulo
+ * (r + 1) along every axis never see each other, so (r + 1)^ImageDimension
+ * colours (8 for the usual 3x3x3 neighbourhood, 2 per axis) give
+ * independent update sets. Each colour is a parallel sweep over blocks of
+ * the image; a barrier separates colours.
+ *
+ * The class membership values do not change during relabelling, so they
+ * are evaluated once per pixel and stored as a float table. A block is
+ * skipped in an iteration when neither it nor any adjacent block changed
+ * a label in the previous iteration.
+ *
+ * The parameters mirror MRFImageFilter (number of classes, maximum number
+ * of iterations, error tolerance, smoothing factor, neighbourhood radius
+ * and weights), and the default weights are the ones MRFImageFilter uses,
+ * so the filter can be swapped in without retuning.
+ *
+ */
+template <class TInputImage, class TClassifiedImage>
+class ITK_EXPORT CheckerboardMRFImageFilter :
+    public ImageToImageFilter<TInputImage, TClassifiedImage>
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef CheckerboardMRFImageFilter Self;
+  typedef ImageToImageFilter<TInputImage, TClassifiedImage> Superclass;
+  typedef SmartPointer<Self> Pointer;
+  typedef SmartPointer<const Self>  ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(CheckerboardMRFImageFilter, ImageToImageFilter);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Image dimension. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  /** Input image types. */
+  typedef TInputImage                              InputImageType;
+  typedef typename TInputImage::ConstPointer       InputImageConstPointer;
+  typedef typename TInputImage::PixelType          InputImagePixelType;
+  typedef typename TInputImage::SizeType           SizeType;
+  typedef typename TInputImage::IndexType          IndexType;
+
+  /** Label image types. */
+  typedef TClassifiedImage                         LabelledImageType;
+  typedef typename TClassifiedImage::Pointer       LabelledImagePointer;
+  typedef typename TClassifiedImage::PixelType     LabelledImagePixelType;
+
+  /** Classifier providing the initial labels and the membership values. */
+  typedef ImageClassifierBase<TInputImage, TClassifiedImage> ClassifierType;
+  typedef typename ClassifierType::Pointer                   ClassifierPointer;
+
+  /** Set the classifier. */
+  void SetClassifier( ClassifierType * classifier )
+    {
+    m_Classifier = classifier;
+    this->Modified();
+    }
+
+  /** Set/Get the number of classes. */
+  itkSetMacro( NumberOfClasses, unsigned int );
+  itkGetConstMacro( NumberOfClasses, unsigned int );
+
+  /** Set/Get the maximum number of relabelling iterations. */
+  itkSetMacro( MaximumNumberOfIterations, unsigned int );
+  itkGetConstMacro( MaximumNumberOfIterations, unsigned int );
+
+  /** Set/Get the fraction of changed labels below which to stop. */
+  itkSetMacro( ErrorTolerance, double );
+  itkGetConstMacro( ErrorTolerance, double );
+
+  /** Set/Get the smoothing factor scaling the default weights. */
+  itkSetMacro( SmoothingFactor, double );
+  itkGetConstMacro( SmoothingFactor, double );
+
+  /** Set the neighbourhood radius, the same along all axes. */
+  void SetNeighborhoodRadius( unsigned long radius );
+
+  /** Set/Get explicit neighbourhood weights. The vector is indexed like a
+   * Neighborhood of the current radius. If not set, the MRFImageFilter
+   * defaults scaled by the smoothing factor are used. */
+  void SetMRFNeighborhoodWeight( const std::vector<double> & weights )
+    {
+    m_MRFNeighborhoodWeight = weights;
+    this->Modified();
+    }
+  const std::vector<double> & GetMRFNeighborhoodWeight() const
+    {
+    return m_MRFNeighborhoodWeight;
+    }
+
+  /** Set/Get the edge length of the blocks tracked for early
+   * termination. */
+  itkSetMacro( BlockSize, unsigned int );
+  itkGetConstMacro( BlockSize, unsigned int );
+
+  /** Set/Get the number of threads used for relabelling. */
+  itkSetClampMacro( NumberOfThreads, int, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, int );
+
+  /** Number of iterations performed by the last run. */
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+protected:
+  CheckerboardMRFImageFilter();
+  ~CheckerboardMRFImageFilter() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** The whole input is needed and the whole output is produced. */
+  virtual void GenerateInputRequestedRegion();
+  virtual void EnlargeOutputRequestedRegion( DataObject * );
+
+  virtual void GenerateData();
+
+private:
+  CheckerboardMRFImageFilter( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  /** Fill m_Weights from the user weights or the defaults. */
+  void InitializeWeights();
+
+  /** Split the image into blocks. */
+  void InitializeBlocks();
+
+  /** Membership values of every pixel into m_MembershipTable. */
+  void ComputeMembershipTable();
+
+  /** Relabel the pixels of colour m_CurrentColor in the active blocks. */
+  static ITK_THREAD_RETURN_TYPE RelabelThreaderCallback( void * arg );
+
+  /** Relabel one pixel; returns true if its label changed. */
+  bool RelabelPixel( unsigned long offset, const IndexType & index,
+                     float * influence );
+
+  ClassifierPointer               m_Classifier;
+
+  unsigned int                    m_NumberOfClasses;
+  unsigned int                    m_MaximumNumberOfIterations;
+  double                          m_ErrorTolerance;
+  double                          m_SmoothingFactor;
+  unsigned long                   m_NeighborhoodRadius;
+  std::vector<double>             m_MRFNeighborhoodWeight;
+  unsigned int                    m_BlockSize;
+  int                             m_NumberOfThreads;
+  unsigned int                    m_NumberOfIterations;
+
+  /** Neighbourhood as weights and linear / index offsets. */
+  std::vector<float>              m_Weights;
+  std::vector<long>               m_LinearOffsets;
+  std::vector<IndexType>          m_IndexOffsets;
+
+  /** Pixels x classes, row major. */
+  std::vector<float>              m_MembershipTable;
+
+  /** Block grid and per-block state. */
+  SizeType                        m_ImageSize;
+  SizeType                        m_NumberOfBlocks;
+  unsigned long                   m_BlockEdge;
+  std::vector<unsigned char>      m_BlockActive;
+  std::vector<unsigned long>      m_BlockChanges;
+
+  LabelledImagePixelType *        m_Labels;
+  const InputImagePixelType *     m_InputBuffer;
+  unsigned long                   m_NumberOfPixels;
+  unsigned int                    m_CurrentColor;
+
+  MultiThreader::Pointer          m_Threader;
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkCheckerboardMRFImageFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,543 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkCheckerboardMRFImageFilter.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkCheckerboardMRFImageFilter_txx
+#define _itkCheckerboardMRFImageFilter_txx
+
+#include "itkCheckerboardMRFImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template <class TInputImage, class TClassifiedImage>
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::CheckerboardMRFImageFilter()
+{
+  m_Classifier                = NULL;
+  m_NumberOfClasses           = 0;
+  m_MaximumNumberOfIterations = 50;
+  m_ErrorTolerance            = 0.2;
+  m_SmoothingFactor           = 1.0;
+  m_NeighborhoodRadius        = 1;
+  m_BlockSize                 = 16;
+  m_BlockEdge                 = 16;
+  m_NumberOfThreads           = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_NumberOfIterations        = 0;
+
+  m_Labels                    = NULL;
+  m_InputBuffer               = NULL;
+  m_NumberOfPixels            = 0;
+  m_CurrentColor              = 0;
+
+  m_ImageSize.Fill( 0 );
+  m_NumberOfBlocks.Fill( 0 );
+
+  m_Threader = MultiThreader::New();
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+void
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfClasses: " << m_NumberOfClasses << std::endl;
+  os << indent << "MaximumNumberOfIterations: "
+     << m_MaximumNumberOfIterations << std::endl;
+  os << indent << "ErrorTolerance: " << m_ErrorTolerance << std::endl;
+  os << indent << "SmoothingFactor: " << m_SmoothingFactor << std::endl;
+  os << indent << "NeighborhoodRadius: " << m_NeighborhoodRadius << std::endl;
+  os << indent << "BlockSize: " << m_BlockSize << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfIterations: " << m_NumberOfIterations << std::endl;
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+void
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::SetNeighborhoodRadius( unsigned long radius )
+{
+  if ( m_NeighborhoodRadius != radius )
+    {
+    m_NeighborhoodRadius = radius;
+    this->Modified();
+    }
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+void
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>( this->GetInput() );
+  if ( input )
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+void
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+void
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::InitializeWeights()
+{
+  const long width = 2 * m_NeighborhoodRadius + 1;
+
+  unsigned long neighborhoodSize = 1;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    neighborhoodSize *= width;
+    }
+
+  // Defaults of MRFImageFilter::SetDefaultMRFNeighborhoodWeight().
+  std::vector<double> weights( m_MRFNeighborhoodWeight );
+  if ( weights.size() != neighborhoodSize )
+    {
+    weights.assign( neighborhoodSize, m_SmoothingFactor );
+    if ( ImageDimension == 3 && m_NeighborhoodRadius == 1 )
+      {
+      for ( unsigned int i = 0; i < 27; i++ )
+        {
+        weights[i] = ( i >= 9 && i < 18 ? 1.7 : 1.3 ) * m_SmoothingFactor;
+        }
+      weights[4]  = 1.5 * m_SmoothingFactor;
+      weights[22] = 1.5 * m_SmoothingFactor;
+      }
+    weights[ neighborhoodSize / 2 ] = 0.0;
+    }
+
+  // Strides of the label buffer.
+  unsigned long stride[ImageDimension];
+  stride[0] = 1;
+  for ( unsigned int d = 1; d < ImageDimension; d++ )
+    {
+    stride[d] = stride[d-1] * m_ImageSize[d-1];
+    }
+
+  // Keep only the neighbours that actually contribute.
+  m_Weights.clear();
+  m_LinearOffsets.clear();
+  m_IndexOffsets.clear();
+  for ( unsigned long i = 0; i < neighborhoodSize; i++ )
+    {
+    if ( weights[i] == 0.0 )
+      {
+      continue;
+      }
+    IndexType offset;
+    long linear = 0;
+    unsigned long rest = i;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      offset[d] = static_cast<long>( rest % width ) -
+        static_cast<long>( m_NeighborhoodRadius );
+      rest /= width;
+      linear += offset[d] * static_cast<long>( stride[d] );
+      }
+    m_Weights.push_back( static_cast<float>( weights[i] ) );
+    m_LinearOffsets.push_back( linear );
+    m_IndexOffsets.push_back( offset );
+    }
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+void
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::InitializeBlocks()
+{
+  // A change can only affect pixels within one radius, so as long as
+  // blocks are at least that wide only the adjacent blocks need to be
+  // revisited.
+  const unsigned long blockSize =
+    std::max( static_cast<unsigned long>( m_BlockSize ),
+              m_NeighborhoodRadius + 1 );
+
+  unsigned long numberOfBlocks = 1;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    m_NumberOfBlocks[d] = ( m_ImageSize[d] + blockSize - 1 ) / blockSize;
+    numberOfBlocks *= m_NumberOfBlocks[d];
+    }
+  m_BlockEdge = blockSize;
+
+  m_BlockActive.assign( numberOfBlocks, 1 );
+  m_BlockChanges.assign( numberOfBlocks, 0 );
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+void
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::ComputeMembershipTable()
+{
+  // The membership functions keep scratch storage of their own, so the
+  // table is filled on one thread. It is evaluated once, instead of on
+  // every visit of every pixel as in MRFImageFilter.
+  m_MembershipTable.resize( m_NumberOfPixels * m_NumberOfClasses );
+
+  for ( unsigned long p = 0; p < m_NumberOfPixels; p++ )
+    {
+    const std::vector<double> membership =
+      m_Classifier->GetPixelMembershipValue( m_InputBuffer[p] );
+    float * row = &m_MembershipTable[ p * m_NumberOfClasses ];
+    for ( unsigned int k = 0; k < m_NumberOfClasses; k++ )
+      {
+      row[k] = static_cast<float>( membership[k] );
+      }
+    }
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+bool
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::RelabelPixel( unsigned long offset, const IndexType & index,
+                float * influence )
+{
+  const unsigned int numberOfClasses = m_NumberOfClasses;
+  const unsigned int numberOfNeighbors = m_Weights.size();
+  const long radius = static_cast<long>( m_NeighborhoodRadius );
+
+  for ( unsigned int k = 0; k < numberOfClasses; k++ )
+    {
+    influence[k] = 0.0f;
+    }
+
+  bool interior = true;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    if ( index[d] < radius ||
+         index[d] + radius >= static_cast<long>( m_ImageSize[d] ) )
+      {
+      interior = false;
+      break;
+      }
+    }
+
+  if ( interior )
+    {
+    for ( unsigned int j = 0; j < numberOfNeighbors; j++ )
+      {
+      const unsigned int label = m_Labels[ offset + m_LinearOffsets[j] ];
+      if ( label < numberOfClasses )
+        {
+        influence[label] += m_Weights[j];
+        }
+      }
+    }
+  else
+    {
+    for ( unsigned int j = 0; j < numberOfNeighbors; j++ )
+      {
+      bool inside = true;
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        const long n = index[d] + m_IndexOffsets[j][d];
+        if ( n < 0 || n >= static_cast<long>( m_ImageSize[d] ) )
+          {
+          inside = false;
+          break;
+          }
+        }
+      if ( inside )
+        {
+        const unsigned int label = m_Labels[ offset + m_LinearOffsets[j] ];
+        if ( label < numberOfClasses )
+          {
+          influence[label] += m_Weights[j];
+          }
+        }
+      }
+    }
+
+  // Same decision as MRFImageFilter: maximize neighbour agreement minus
+  // the class membership (distance) value.
+  const float * membership = &m_MembershipTable[ offset * numberOfClasses ];
+  unsigned int best = 0;
+  float bestScore = influence[0] - membership[0];
+  for ( unsigned int k = 1; k < numberOfClasses; k++ )
+    {
+    const float score = influence[k] - membership[k];
+    if ( score > bestScore )
+      {
+      bestScore = score;
+      best = k;
+      }
+    }
+
+  if ( static_cast<unsigned int>( m_Labels[offset] ) != best )
+    {
+    m_Labels[offset] = static_cast<LabelledImagePixelType>( best );
+    return true;
+    }
+  return false;
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+ITK_THREAD_RETURN_TYPE
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::RelabelThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+
+  const unsigned long threadId = info->ThreadID;
+  const unsigned long numberOfThreads = info->NumberOfThreads;
+  const unsigned long period = self->m_NeighborhoodRadius + 1;
+  const unsigned long blockSize = self->m_BlockEdge;
+
+  // Phase of the current colour along each axis.
+  unsigned long phase[ImageDimension];
+  unsigned long color = self->m_CurrentColor;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    phase[d] = color % period;
+    color /= period;
+    }
+
+  unsigned long stride[ImageDimension];
+  stride[0] = 1;
+  for ( unsigned int d = 1; d < ImageDimension; d++ )
+    {
+    stride[d] = stride[d-1] * self->m_ImageSize[d-1];
+    }
+
+  std::vector<float> influence( self->m_NumberOfClasses );
+
+  // Blocks are dealt round-robin so that every thread gets a share of
+  // the interior and of the boundary.
+  const unsigned long numberOfBlocks = self->m_BlockActive.size();
+  for ( unsigned long b = threadId; b < numberOfBlocks; b += numberOfThreads )
+    {
+    if ( !self->m_BlockActive[b] )
+      {
+      continue;
+      }
+
+    // First pixel of the colour and end of the block along each axis.
+    IndexType start;
+    IndexType end;
+    bool empty = false;
+    unsigned long rest = b;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      const unsigned long blockStart = ( rest % self->m_NumberOfBlocks[d] ) * blockSize;
+      rest /= self->m_NumberOfBlocks[d];
+      start[d] = blockStart + ( period + phase[d] - blockStart % period ) % period;
+      end[d] = std::min( blockStart + blockSize,
+                         static_cast<unsigned long>( self->m_ImageSize[d] ) );
+      if ( start[d] >= end[d] )
+        {
+        empty = true;
+        }
+      }
+    if ( empty )
+      {
+      continue;
+      }
+
+    unsigned long changes = 0;
+    IndexType index = start;
+    while ( true )
+      {
+      unsigned long offset = 0;
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        offset += index[d] * stride[d];
+        }
+      if ( self->RelabelPixel( offset, index, &influence[0] ) )
+        {
+        changes++;
+        }
+
+      unsigned int d = 0;
+      for ( ; d < ImageDimension; d++ )
+        {
+        index[d] += period;
+        if ( index[d] < end[d] )
+          {
+          break;
+          }
+        index[d] = start[d];
+        }
+      if ( d == ImageDimension )
+        {
+        break;
+        }
+      }
+
+    self->m_BlockChanges[b] += changes;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TInputImage, class TClassifiedImage>
+void
+CheckerboardMRFImageFilter<TInputImage,TClassifiedImage>
+::GenerateData()
+{
+  if ( !m_Classifier )
+    {
+    itkExceptionMacro( << "Classifier not set" );
+    }
+  if ( m_NumberOfClasses == 0 )
+    {
+    itkExceptionMacro( << "Number of classes must be at least one" );
+    }
+
+  InputImageConstPointer inputImage = this->GetInput();
+
+  // Initial labelling by the classifier.
+  m_Classifier->SetInputImage( inputImage );
+  m_Classifier->Update();
+
+  LabelledImagePointer outputImage = this->GetOutput();
+  outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
+  outputImage->Allocate();
+
+  typedef ImageRegionConstIterator<LabelledImageType> LabelConstIterator;
+  typedef ImageRegionIterator<LabelledImageType>      LabelIterator;
+  LabelConstIterator inIt( m_Classifier->GetClassifiedImage(),
+                           outputImage->GetBufferedRegion() );
+  LabelIterator outIt( outputImage, outputImage->GetBufferedRegion() );
+  for ( ; !outIt.IsAtEnd(); ++inIt, ++outIt )
+    {
+    outIt.Set( inIt.Get() );
+    }
+
+  m_ImageSize      = inputImage->GetBufferedRegion().GetSize();
+  m_NumberOfPixels = inputImage->GetBufferedRegion().GetNumberOfPixels();
+  m_InputBuffer    = inputImage->GetBufferPointer();
+  m_Labels         = outputImage->GetBufferPointer();
+
+  this->InitializeWeights();
+  this->InitializeBlocks();
+  this->ComputeMembershipTable();
+
+  unsigned long numberOfColors = 1;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    numberOfColors *= m_NeighborhoodRadius + 1;
+    }
+
+  m_Threader->SetNumberOfThreads( m_NumberOfThreads );
+  m_Threader->SetSingleMethod( Self::RelabelThreaderCallback, this );
+
+  const unsigned long numberOfBlocks = m_BlockActive.size();
+
+  m_NumberOfIterations = 0;
+  while ( m_NumberOfIterations < m_MaximumNumberOfIterations )
+    {
+    std::fill( m_BlockChanges.begin(), m_BlockChanges.end(), 0 );
+
+    for ( m_CurrentColor = 0; m_CurrentColor < numberOfColors; m_CurrentColor++ )
+      {
+      m_Threader->SingleMethodExecute();
+      }
+    m_NumberOfIterations++;
+
+    // Next iteration visits the blocks that changed and their neighbours.
+    unsigned long totalChanges = 0;
+    std::fill( m_BlockActive.begin(), m_BlockActive.end(), 0 );
+    for ( unsigned long b = 0; b < numberOfBlocks; b++ )
+      {
+      if ( m_BlockChanges[b] == 0 )
+        {
+        continue;
+        }
+      totalChanges += m_BlockChanges[b];
+
+      long blockIndex[ImageDimension];
+      unsigned long rest = b;
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        blockIndex[d] = rest % m_NumberOfBlocks[d];
+        rest /= m_NumberOfBlocks[d];
+        }
+
+      unsigned long numberOfNeighbors = 1;
+      for ( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        numberOfNeighbors *= 3;
+        }
+      for ( unsigned long n = 0; n < numberOfNeighbors; n++ )
+        {
+        unsigned long neighbor = 0;
+        unsigned long blockStride = 1;
+        unsigned long code = n;
+        bool inside = true;
+        for ( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          const long i = blockIndex[d] + static_cast<long>( code % 3 ) - 1;
+          code /= 3;
+          if ( i < 0 || i >= static_cast<long>( m_NumberOfBlocks[d] ) )
+            {
+            inside = false;
+            break;
+            }
+          neighbor += i * blockStride;
+          blockStride *= m_NumberOfBlocks[d];
+          }
+        if ( inside )
+          {
+          m_BlockActive[neighbor] = 1;
+          }
+        }
+      }
+
+    itkDebugMacro( << "Iteration " << m_NumberOfIterations << ": "
+                   << totalChanges << " labels changed" );
+
+    if ( static_cast<double>( totalChanges ) /
+         static_cast<double>( m_NumberOfPixels ) < m_ErrorTolerance )
+      {
+      break;
+      }
+    }
+
+  m_MembershipTable.clear();
+  m_Labels = NULL;
+  m_InputBuffer = NULL;
+}
+
+} // namespace itk
+
+#endif
@@ -0,0 +1,234 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMiniBatchKmeansImageModelEstimator.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkMiniBatchKmeansImageModelEstimator_h
+#define _itkMiniBatchKmeansImageModelEstimator_h
+
+#include <vector>
+
+#include "itkImageModelEstimatorBase.h"
+#include "itkMultiThreader.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "vnl/vnl_matrix.h"
+
+namespace itk
+{
+
+/** \class MiniBatchKmeansImageModelEstimator
+ *
+ * Drop-in alternative to ImageKmeansModelEstimator for training a
+ * codebook on a multichannel (vector pixel) image.
+ *
+ * Instead of sweeping every voxel of the vector image on every
+ * iteration, a fixed random subset of voxels is drawn once (restricted to
+ * the non-zero voxels of an optional mask image) and copied into a
+ * contiguous float array. Training then runs the mini-batch k-means
+ * update of Sculley (2010): each iteration draws a small batch from the
+ * sample set, assigns it to the nearest centroids in parallel, and moves
+ * each centroid towards its batch members with a per-centroid learning
+ * rate of 1/count.
+ *
+ * Centroids are kept in a channel-major float table so that the distance
+ * from one sample to all centroids is a sequence of contiguous
+ * multiply-adds over the centroid index, which the compiler vectorizes.
+ *
+ * The result is exposed through the same membership function interface
+ * as ImageKmeansModelEstimator, so the estimated models plug into
+ * ImageClassifierBase unchanged. The mean squared distortion of the final
+ * codebook over the sample set is available through GetDistortion(), and
+ * EvaluateDistortion() scores any other codebook (e.g. the one found by
+ * ImageKmeansModelEstimator) on the same samples.
+ *
+ * Inputs:
+ *    - vector input image
+ *    - optional mask image (voxels with mask value zero are ignored)
+ *    - number of models and an optional initial codebook
+ *
+ * Outputs:
+ *    - one membership function per model
+ *
+ */
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+class ITK_EXPORT MiniBatchKmeansImageModelEstimator :
+    public ImageModelEstimatorBase<TInputImage, TMembershipFunction>
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef MiniBatchKmeansImageModelEstimator Self;
+  typedef ImageModelEstimatorBase<TInputImage, TMembershipFunction> Superclass;
+  typedef SmartPointer<Self> Pointer;
+  typedef SmartPointer<const Self>  ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MiniBatchKmeansImageModelEstimator, ImageModelEstimatorBase);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Input image types. */
+  typedef TInputImage                              InputImageType;
+  typedef typename TInputImage::ConstPointer       InputImageConstPointer;
+  typedef typename TInputImage::PixelType          InputImagePixelType;
+
+  /** Mask image types. */
+  typedef TMaskImage                               MaskImageType;
+  typedef typename TMaskImage::ConstPointer        MaskImageConstPointer;
+
+  /** Membership function types. */
+  typedef TMembershipFunction                      MembershipFunctionType;
+  typedef typename TMembershipFunction::Pointer    MembershipFunctionPointer;
+
+  /** Codebook type, one row per model, one column per channel. */
+  typedef vnl_matrix<double>                       CodebookMatrixOfDoubleType;
+
+  /** Set the mask restricting which voxels may be sampled. Its buffered
+   * region must cover the buffered region of the input. */
+  itkSetConstObjectMacro( MaskImage, MaskImageType );
+  itkGetConstObjectMacro( MaskImage, MaskImageType );
+
+  /** Set/Get the initial codebook. If not set, the centroids are seeded
+   * with k-means++ on the sample set. */
+  void SetCodebook( const CodebookMatrixOfDoubleType & codebook )
+    {
+    m_Codebook = codebook;
+    this->Modified();
+    }
+  itkGetConstReferenceMacro( Codebook, CodebookMatrixOfDoubleType );
+
+  /** Set/Get the number of voxels drawn from the (masked) image. */
+  itkSetMacro( NumberOfSamples, unsigned long );
+  itkGetConstMacro( NumberOfSamples, unsigned long );
+
+  /** Set/Get the number of samples per mini-batch. */
+  itkSetMacro( BatchSize, unsigned long );
+  itkGetConstMacro( BatchSize, unsigned long );
+
+  /** Set/Get the maximum number of mini-batch iterations. */
+  itkSetMacro( MaximumNumberOfIterations, unsigned long );
+  itkGetConstMacro( MaximumNumberOfIterations, unsigned long );
+
+  /** Set/Get the convergence threshold. Training stops once the largest
+   * centroid displacement over one iteration, relative to the largest
+   * centroid norm, falls below this value. */
+  itkSetMacro( Threshold, double );
+  itkGetConstMacro( Threshold, double );
+
+  /** Set/Get the seed of the sampler, for reproducible runs. */
+  itkSetMacro( Seed, unsigned long );
+  itkGetConstMacro( Seed, unsigned long );
+
+  /** Set/Get the number of threads used for sampling and assignment. */
+  itkSetClampMacro( NumberOfThreads, int, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, int );
+
+  /** Mean squared distance of the samples to the final codebook. */
+  itkGetConstMacro( Distortion, double );
+
+  /** Number of samples actually drawn (may be smaller than requested
+   * when the mask is small). */
+  unsigned long GetNumberOfDrawnSamples() const
+    {
+    return m_NumberOfDrawnSamples;
+    }
+
+  /** Number of iterations performed by the last run. */
+  itkGetConstMacro( NumberOfIterationsPerformed, unsigned long );
+
+  /** Get the trained codebook (one row per model). */
+  itkGetConstReferenceMacro( Centroids, CodebookMatrixOfDoubleType );
+
+  /** Mean squared distance of the current sample set to the given
+   * codebook. Samples must have been drawn by a previous Update(). */
+  double EvaluateDistortion( const CodebookMatrixOfDoubleType & codebook );
+
+protected:
+  MiniBatchKmeansImageModelEstimator();
+  ~MiniBatchKmeansImageModelEstimator() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  /** Draw the samples, run the mini-batch iterations and build the
+   * membership functions. */
+  virtual void EstimateModels();
+
+private:
+  MiniBatchKmeansImageModelEstimator( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  typedef Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+  /** Copy the sampled voxels into m_Samples. */
+  void DrawSamples();
+
+  /** Seed the centroid table from the codebook or with k-means++. */
+  void InitializeCentroids();
+
+  /** Copy m_Centroids into the channel-major float table. */
+  void UpdateCentroidTable();
+
+  /** Index and squared distance of the nearest centroid to a sample. */
+  unsigned int FindNearestCentroid( const float * sample, float & distance,
+                                    float * scratch ) const;
+
+  /** Assign the samples [first, last) of m_Batch, or of the whole sample
+   * set when m_AssignWholeSampleSet is on, to the nearest centroid. */
+  static ITK_THREAD_RETURN_TYPE AssignThreaderCallback( void * arg );
+
+  /** Run AssignThreaderCallback over all threads. */
+  void AssignInParallel( unsigned long numberOfItems, bool wholeSampleSet );
+
+  MaskImageConstPointer        m_MaskImage;
+  CodebookMatrixOfDoubleType   m_Codebook;
+  CodebookMatrixOfDoubleType   m_Centroids;
+
+  unsigned long                m_NumberOfSamples;
+  unsigned long                m_BatchSize;
+  unsigned long                m_MaximumNumberOfIterations;
+  double                       m_Threshold;
+  unsigned long                m_Seed;
+  int                          m_NumberOfThreads;
+
+  double                       m_Distortion;
+  unsigned long                m_NumberOfDrawnSamples;
+  unsigned long                m_NumberOfIterationsPerformed;
+  unsigned int                 m_VectorDimension;
+
+  /** Samples, m_NumberOfDrawnSamples x m_VectorDimension, row major. */
+  std::vector<float>           m_Samples;
+
+  /** Centroids, m_VectorDimension x NumberOfModels, channel major. */
+  std::vector<float>           m_CentroidTable;
+
+  /** Sample indices of the current batch and their assignments. */
+  std::vector<unsigned long>   m_Batch;
+  std::vector<unsigned int>    m_Labels;
+
+  /** Per-thread sums of squared distances of the last assignment. */
+  std::vector<double>          m_ThreadDistortion;
+  unsigned long                m_NumberOfItemsToAssign;
+  bool                         m_AssignWholeSampleSet;
+
+  MultiThreader::Pointer       m_Threader;
+  GeneratorType::Pointer       m_Generator;
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMiniBatchKmeansImageModelEstimator.txx"
+#endif
+
+#endif
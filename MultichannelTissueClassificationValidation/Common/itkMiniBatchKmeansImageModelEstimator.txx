@@ -0,0 +1,484 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkMiniBatchKmeansImageModelEstimator.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkMiniBatchKmeansImageModelEstimator_txx
+#define _itkMiniBatchKmeansImageModelEstimator_txx
+
+#include "itkMiniBatchKmeansImageModelEstimator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::MiniBatchKmeansImageModelEstimator()
+{
+  m_MaskImage                   = NULL;
+  m_NumberOfSamples             = 100000;
+  m_BatchSize                   = 1024;
+  m_MaximumNumberOfIterations   = 500;
+  m_Threshold                   = 0.001;
+  m_Seed                        = 121212;
+  m_NumberOfThreads             = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  m_Distortion                  = 0.0;
+  m_NumberOfDrawnSamples        = 0;
+  m_NumberOfIterationsPerformed = 0;
+  m_VectorDimension             = InputImagePixelType::Dimension;
+  m_NumberOfItemsToAssign       = 0;
+  m_AssignWholeSampleSet        = false;
+
+  m_Threader  = MultiThreader::New();
+  m_Generator = GeneratorType::New();
+}
+
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+void
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfSamples: " << m_NumberOfSamples << std::endl;
+  os << indent << "BatchSize: " << m_BatchSize << std::endl;
+  os << indent << "MaximumNumberOfIterations: "
+     << m_MaximumNumberOfIterations << std::endl;
+  os << indent << "Threshold: " << m_Threshold << std::endl;
+  os << indent << "Seed: " << m_Seed << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "Distortion: " << m_Distortion << std::endl;
+  os << indent << "Codebook: " << m_Codebook << std::endl;
+  os << indent << "Centroids: " << m_Centroids << std::endl;
+}
+
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+void
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::EstimateModels()
+{
+  const unsigned int numberOfModels = this->GetNumberOfModels();
+
+  if ( numberOfModels == 0 )
+    {
+    itkExceptionMacro( << "Number of models must be at least one" );
+    }
+
+  if ( m_Codebook.rows() != 0 &&
+       ( m_Codebook.rows() != numberOfModels ||
+         m_Codebook.cols() != m_VectorDimension ) )
+    {
+    itkExceptionMacro( << "Codebook must be " << numberOfModels << " x "
+                       << m_VectorDimension );
+    }
+
+  m_Generator->SetSeed( m_Seed );
+
+  this->DrawSamples();
+
+  if ( m_NumberOfDrawnSamples < numberOfModels )
+    {
+    itkExceptionMacro( << "Only " << m_NumberOfDrawnSamples
+                       << " voxels available for " << numberOfModels
+                       << " models" );
+    }
+
+  this->InitializeCentroids();
+
+  //-------------------------------------------------------------------
+  // Mini-batch iterations
+  //-------------------------------------------------------------------
+  const unsigned long batchSize =
+    std::min( std::max( m_BatchSize, 1UL ), m_NumberOfDrawnSamples );
+
+  m_Batch.resize( batchSize );
+  m_Labels.resize( m_NumberOfDrawnSamples );
+
+  std::vector<double> counts( numberOfModels, 0.0 );
+  CodebookMatrixOfDoubleType previous;
+
+  m_NumberOfIterationsPerformed = 0;
+  for ( unsigned long iter = 0; iter < m_MaximumNumberOfIterations; iter++ )
+    {
+    for ( unsigned long b = 0; b < batchSize; b++ )
+      {
+      m_Batch[b] = m_Generator->GetIntegerVariate( m_NumberOfDrawnSamples - 1 );
+      }
+
+    this->AssignInParallel( batchSize, false );
+
+    previous = m_Centroids;
+    for ( unsigned long b = 0; b < batchSize; b++ )
+      {
+      const unsigned int label = m_Labels[b];
+      const float * sample = &m_Samples[ m_Batch[b] * m_VectorDimension ];
+      counts[label] += 1.0;
+      const double eta = 1.0 / counts[label];
+      for ( unsigned int c = 0; c < m_VectorDimension; c++ )
+        {
+        m_Centroids( label, c ) =
+          ( 1.0 - eta ) * m_Centroids( label, c ) + eta * sample[c];
+        }
+      }
+    this->UpdateCentroidTable();
+    m_NumberOfIterationsPerformed++;
+
+    double maxShift = 0.0;
+    double maxNorm  = 0.0;
+    for ( unsigned int k = 0; k < numberOfModels; k++ )
+      {
+      maxShift = std::max( maxShift,
+        ( m_Centroids.get_row( k ) - previous.get_row( k ) ).two_norm() );
+      maxNorm = std::max( maxNorm, m_Centroids.get_row( k ).two_norm() );
+      }
+    if ( maxNorm > 0.0 && maxShift / maxNorm < m_Threshold )
+      {
+      break;
+      }
+    }
+
+  //-------------------------------------------------------------------
+  // Final distortion over the whole sample set
+  //-------------------------------------------------------------------
+  this->AssignInParallel( m_NumberOfDrawnSamples, true );
+
+  double sum = 0.0;
+  for ( unsigned int t = 0; t < m_ThreadDistortion.size(); t++ )
+    {
+    sum += m_ThreadDistortion[t];
+    }
+  m_Distortion = sum / static_cast<double>( m_NumberOfDrawnSamples );
+
+  //-------------------------------------------------------------------
+  // Export the codebook as membership functions
+  //-------------------------------------------------------------------
+  this->DeleteAllMembershipFunctions();
+  for ( unsigned int k = 0; k < numberOfModels; k++ )
+    {
+    MembershipFunctionPointer membershipFunction = TMembershipFunction::New();
+    membershipFunction->SetMeasurementVectorSize( m_VectorDimension );
+
+    typename MembershipFunctionType::CentroidType centroid( m_VectorDimension );
+    for ( unsigned int c = 0; c < m_VectorDimension; c++ )
+      {
+      centroid[c] = m_Centroids( k, c );
+      }
+    membershipFunction->SetCentroid( centroid );
+    this->AddMembershipFunction( membershipFunction );
+    }
+}
+
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+void
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::DrawSamples()
+{
+  InputImageConstPointer inputImage = this->GetInputImage();
+
+  if ( !inputImage )
+    {
+    itkExceptionMacro( << "Input image not set" );
+    }
+
+  typedef typename InputImageType::RegionType InputRegionType;
+  const InputRegionType & region = inputImage->GetBufferedRegion();
+
+  // The mask is read at the input indices: it must cover the input.
+  if ( m_MaskImage && region.GetNumberOfPixels() > 0 )
+    {
+    typename InputImageType::IndexType last = region.GetIndex();
+    for ( unsigned int d = 0; d < InputImageType::ImageDimension; d++ )
+      {
+      last[d] += static_cast<long>( region.GetSize()[d] ) - 1;
+      }
+    if ( !m_MaskImage->GetBufferedRegion().IsInside( region.GetIndex() ) ||
+         !m_MaskImage->GetBufferedRegion().IsInside( last ) )
+      {
+      itkExceptionMacro( << "Mask buffered region "
+                         << m_MaskImage->GetBufferedRegion()
+                         << " does not cover the input buffered region "
+                         << region );
+      }
+    }
+
+  typedef ImageRegionConstIteratorWithIndex<InputImageType> InputIterator;
+  InputIterator inIter( inputImage, region );
+
+  const unsigned long requested = std::max( m_NumberOfSamples, 1UL );
+  m_Samples.resize( requested * m_VectorDimension );
+
+  // Reservoir sampling over the voxels inside the mask: a single pass,
+  // independent of the number of masked voxels, and reproducible for a
+  // given seed.
+  unsigned long seen = 0;
+  for ( inIter.GoToBegin(); !inIter.IsAtEnd(); ++inIter )
+    {
+    if ( m_MaskImage &&
+         m_MaskImage->GetPixel( inIter.GetIndex() ) ==
+           NumericTraits<typename MaskImageType::PixelType>::Zero )
+      {
+      continue;
+      }
+
+    unsigned long slot = seen;
+    if ( seen >= requested )
+      {
+      slot = m_Generator->GetIntegerVariate( seen );
+      }
+    seen++;
+
+    if ( slot < requested )
+      {
+      const InputImagePixelType & pixel = inIter.Get();
+      float * sample = &m_Samples[ slot * m_VectorDimension ];
+      for ( unsigned int c = 0; c < m_VectorDimension; c++ )
+        {
+        sample[c] = static_cast<float>( pixel[c] );
+        }
+      }
+    }
+
+  m_NumberOfDrawnSamples = std::min( seen, requested );
+  m_Samples.resize( m_NumberOfDrawnSamples * m_VectorDimension );
+}
+
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+void
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::InitializeCentroids()
+{
+  const unsigned int numberOfModels = this->GetNumberOfModels();
+
+  if ( m_Codebook.rows() != 0 )
+    {
+    m_Centroids = m_Codebook;
+    this->UpdateCentroidTable();
+    return;
+    }
+
+  // k-means++ seeding on the drawn samples.
+  m_Centroids.set_size( numberOfModels, m_VectorDimension );
+
+  unsigned long first = m_Generator->GetIntegerVariate( m_NumberOfDrawnSamples - 1 );
+  for ( unsigned int c = 0; c < m_VectorDimension; c++ )
+    {
+    m_Centroids( 0, c ) = m_Samples[ first * m_VectorDimension + c ];
+    }
+
+  std::vector<double> nearest( m_NumberOfDrawnSamples,
+                               NumericTraits<double>::max() );
+
+  for ( unsigned int k = 1; k < numberOfModels; k++ )
+    {
+    double total = 0.0;
+    for ( unsigned long i = 0; i < m_NumberOfDrawnSamples; i++ )
+      {
+      const float * sample = &m_Samples[ i * m_VectorDimension ];
+      double d = 0.0;
+      for ( unsigned int c = 0; c < m_VectorDimension; c++ )
+        {
+        const double diff = sample[c] - m_Centroids( k - 1, c );
+        d += diff * diff;
+        }
+      nearest[i] = std::min( nearest[i], d );
+      total += nearest[i];
+      }
+
+    unsigned long chosen = m_NumberOfDrawnSamples - 1;
+    double target = m_Generator->GetVariateWithOpenUpperRange() * total;
+    for ( unsigned long i = 0; i < m_NumberOfDrawnSamples; i++ )
+      {
+      target -= nearest[i];
+      if ( target < 0.0 )
+        {
+        chosen = i;
+        break;
+        }
+      }
+
+    for ( unsigned int c = 0; c < m_VectorDimension; c++ )
+      {
+      m_Centroids( k, c ) = m_Samples[ chosen * m_VectorDimension + c ];
+      }
+    }
+
+  this->UpdateCentroidTable();
+}
+
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+void
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::UpdateCentroidTable()
+{
+  const unsigned int numberOfModels = m_Centroids.rows();
+
+  m_CentroidTable.resize( m_VectorDimension * numberOfModels );
+  for ( unsigned int c = 0; c < m_VectorDimension; c++ )
+    {
+    for ( unsigned int k = 0; k < numberOfModels; k++ )
+      {
+      m_CentroidTable[ c * numberOfModels + k ] =
+        static_cast<float>( m_Centroids( k, c ) );
+      }
+    }
+}
+
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+unsigned int
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::FindNearestCentroid( const float * sample, float & distance,
+                       float * scratch ) const
+{
+  const unsigned int numberOfModels = m_Centroids.rows();
+  const float * table = &m_CentroidTable[0];
+
+  // Distances to all centroids at once, one channel at a time. The inner
+  // loops run over contiguous memory with no dependency between
+  // iterations.
+  for ( unsigned int k = 0; k < numberOfModels; k++ )
+    {
+    scratch[k] = 0.0f;
+    }
+  for ( unsigned int c = 0; c < m_VectorDimension; c++ )
+    {
+    const float value = sample[c];
+    const float * row = table + c * numberOfModels;
+    for ( unsigned int k = 0; k < numberOfModels; k++ )
+      {
+      const float diff = value - row[k];
+      scratch[k] += diff * diff;
+      }
+    }
+
+  unsigned int best = 0;
+  for ( unsigned int k = 1; k < numberOfModels; k++ )
+    {
+    if ( scratch[k] < scratch[best] )
+      {
+      best = k;
+      }
+    }
+  distance = scratch[best];
+  return best;
+}
+
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+ITK_THREAD_RETURN_TYPE
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::AssignThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+
+  const unsigned long threadId = info->ThreadID;
+  const unsigned long numberOfThreads = info->NumberOfThreads;
+  const unsigned long numberOfItems = self->m_NumberOfItemsToAssign;
+
+  const unsigned long chunk = ( numberOfItems + numberOfThreads - 1 ) / numberOfThreads;
+  const unsigned long first = std::min( threadId * chunk, numberOfItems );
+  const unsigned long last  = std::min( first + chunk, numberOfItems );
+
+  std::vector<float> scratch( self->m_Centroids.rows() );
+  double sum = 0.0;
+  float distance;
+
+  for ( unsigned long i = first; i < last; i++ )
+    {
+    const unsigned long sampleIndex =
+      self->m_AssignWholeSampleSet ? i : self->m_Batch[i];
+    self->m_Labels[i] = self->FindNearestCentroid(
+      &self->m_Samples[ sampleIndex * self->m_VectorDimension ],
+      distance, &scratch[0] );
+    sum += distance;
+    }
+
+  self->m_ThreadDistortion[threadId] = sum;
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+void
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::AssignInParallel( unsigned long numberOfItems, bool wholeSampleSet )
+{
+  m_NumberOfItemsToAssign = numberOfItems;
+  m_AssignWholeSampleSet  = wholeSampleSet;
+
+  // Small batches are not worth the thread start-up cost.
+  int numberOfThreads = m_NumberOfThreads;
+  if ( numberOfItems < 4096 )
+    {
+    numberOfThreads = 1;
+    }
+
+  m_ThreadDistortion.assign( numberOfThreads, 0.0 );
+
+  m_Threader->SetNumberOfThreads( numberOfThreads );
+  m_Threader->SetSingleMethod( Self::AssignThreaderCallback, this );
+  m_Threader->SingleMethodExecute();
+}
+
+
+template <class TInputImage, class TMembershipFunction, class TMaskImage>
+double
+MiniBatchKmeansImageModelEstimator<TInputImage,TMembershipFunction,TMaskImage>
+::EvaluateDistortion( const CodebookMatrixOfDoubleType & codebook )
+{
+  if ( m_NumberOfDrawnSamples == 0 )
+    {
+    itkExceptionMacro( << "No samples drawn, call Update() first" );
+    }
+  if ( codebook.cols() != m_VectorDimension || codebook.rows() == 0 )
+    {
+    itkExceptionMacro( << "Codebook must have " << m_VectorDimension
+                       << " columns" );
+    }
+
+  const CodebookMatrixOfDoubleType trained = m_Centroids;
+
+  m_Centroids = codebook;
+  this->UpdateCentroidTable();
+  m_Labels.resize( m_NumberOfDrawnSamples );
+  this->AssignInParallel( m_NumberOfDrawnSamples, true );
+
+  double sum = 0.0;
+  for ( unsigned int t = 0; t < m_ThreadDistortion.size(); t++ )
+    {
+    sum += m_ThreadDistortion[t];
+    }
+
+  m_Centroids = trained;
+  this->UpdateCentroidTable();
+
+  return sum / static_cast<double>( m_NumberOfDrawnSamples );
+}
+
+} // namespace itk
+
+#endif
@@ -0,0 +1,144 @@
+#!/usr/bin/perl
+
+# Benchmarks the ITK filters described by the itk_*.xml files.
+#
+# For each itk_*.xml file in the ITK directory, a benchmark.cc is generated
+# with java, xalan and Benchmark.xsl (in the same way Validate.py generates
+# validate.cc), then compiled and run for every instantiation of the filter,
+# every image size of its dimension and every number of threads. Each run is
+# a separate process, so that the reported peak memory is the one of that run.
+#
+# Results are written to benchmark.csv and benchmark.json with one record
+# per run:
+#   filter, instantiation, dimension, size, voxels, threads, repeats,
+#   seconds (fastest of the repeats), voxels_per_second,
+#   scaling_efficiency (time with 1 thread / (threads * time)),
+#   peak_memory_kb
+#
+# This perl script is meant to be run inside of the SCIRun/Test directory.
+# The variables $path_to_SCIRun, $ITK_SRC, and $ITK_BIN should be set specific
+# to your machine, as for Validate.py.
+#       $path_to_SCIRun = the full path to the ITKApps/SCIRun directory
+#       $ITK_SRC = the full path to the Insight source directory (InsightToolkit)
+#       $ITK_BIN = the full path to the Inisght binary directory
+#
+# Usage: perl Benchmark.pl [filter-substring]
+
+# Set absolute path to ITKApps/SCIRun
+$path_to_SCIRun = "/scratch/darbyb/TEST/ITKApps/SCIRun";
+
+$ITK_SRC = "/home/sci/darbyb/work/projects/SCIRunITK/InsightToolkit-1.4.0";
+$ITK_BIN = "/home/sci/darbyb/work/projects/SCIRunITK/InsightBin";
+
+# Image sizes (pixels along each axis), thread counts and repeats
+@sizes2D = (256, 1024, 2048);
+@sizes3D = (64, 128, 256);
+@threads = (1, 2, 4, 8);
+$repeats = 3;
+
+$xmlDir = "$path_to_SCIRun/ITK";
+$testDir = "$path_to_SCIRun/Test";
+$only = $ARGV[0];
+
+$classpath = "$path_to_SCIRun/Thirdparty/xercesImpl.jar:$path_to_SCIRun/Thirdparty/xalan.jar:$path_to_SCIRun/Thirdparty/xml-apis.jar:$path_to_SCIRun/Examples/CodeGenerator";
+
+$includes = "-I$testDir -I$ITK_BIN -I$ITK_SRC/Code/Algorithms -I$ITK_SRC/Code/BasicFilters -I$ITK_SRC/Code/Common -I$ITK_SRC/Code/Numerics -I$ITK_SRC/Code/IO -I$ITK_SRC/Code/Numerics/FEM -I$ITK_SRC/Code/Numerics/Statistics -I$ITK_SRC/Code/SpatialObject -I$ITK_SRC/Utilities/MetaIO -I$ITK_SRC/Utilities/DICOMParser -I$ITK_BIN/Utilities/expat -I$ITK_SRC/Utilities/expat -I$ITK_BIN/Utilities -I$ITK_SRC/Utilities/vxl/vcl -I$ITK_SRC/Utilities/vxl/v3p/netlib -I$ITK_SRC/Utilities/vxl -I$ITK_BIN/Utilities/vxl/vcl -I$ITK_BIN/Utilities/vxl -I$ITK_SRC/Utilities/zlib -I$ITK_BIN/Utilities/zlib -I$ITK_SRC/Utilities/jpeg -I$ITK_BIN/Utilities/jpeg -I/usr/include";
+
+$libraries = "-L$ITK_BIN/bin -lITKFEM -lITKIO -lITKMetaIO -lITKAlgorithms -lITKStatistics -lITKBasicFilters -lITKCommon -litkvnl -litkvnl_algo -litknetlib -litksys -lz -lpthread";
+
+@records = ();
+
+opendir(DIR, $xmlDir) or die "can't opendir $xmlDir: $!";
+@files = sort grep { /^itk_.*\.xml$/ } readdir(DIR);
+closedir(DIR);
+
+foreach $file (@files) {
+  if ($only && index($file, $only) < 0) {
+    next;
+  }
+
+  print "BENCHMARKING: $file\n";
+
+  # Generate and compile benchmark.cc
+  unlink("$testDir/benchmark");
+  system("java -classpath $classpath SCIRun.GenerateSCIRunCode Benchmark $xmlDir/$file $testDir/Benchmark.xsl $testDir/benchmark.cc");
+  system("g++ -O2 -o $testDir/benchmark $testDir/benchmark.cc $includes $libraries");
+  if (! -x "$testDir/benchmark") {
+    print "\tcould not build the benchmark, skipped\n";
+    next;
+  }
+
+  # List the instantiations: "  <number> <dimension> <types>"
+  @instantiations = ();
+  open(LIST, "$testDir/benchmark |") or die "can't run benchmark: $!";
+  while (<LIST>) {
+    if (/^\s+(\d+)\s+(\d+)\s/) {
+      push(@instantiations, [$1, $2]);
+    }
+  }
+  close(LIST);
+
+  foreach $instantiation (@instantiations) {
+    ($number, $dimension) = @$instantiation;
+    @sizes = ($dimension == 3) ? @sizes3D : @sizes2D;
+
+    foreach $size (@sizes) {
+      $singleThread = 0;
+      foreach $thread (@threads) {
+        $line = `$testDir/benchmark $number $size $thread $repeats`;
+        chomp($line);
+        @fields = split(/,/, $line);
+        if (@fields != 10) {
+          print "\t$number size $size threads $thread: failed\n";
+          next;
+        }
+        ($filter, $inst, $dim, $sz, $voxels, $thr, $rep, $seconds, $rate, $memory) = @fields;
+
+        if ($thread == 1) {
+          $singleThread = $seconds;
+        }
+        $efficiency = ($singleThread > 0 && $seconds > 0)
+          ? $singleThread / ($thread * $seconds) : "";
+
+        push(@records, [$filter, $inst, $dim, $sz, $voxels, $thr, $rep,
+                        $seconds, $rate, $efficiency, $memory]);
+        printf("\t%d %dD size %d threads %d: %.4g s, %.4g voxels/s\n",
+               $number, $dim, $sz, $thr, $seconds, $rate);
+      }
+    }
+  }
+}
+
+@columns = ("filter", "instantiation", "dimension", "size", "voxels",
+            "threads", "repeats", "seconds", "voxels_per_second",
+            "scaling_efficiency", "peak_memory_kb");
+
+# CSV
+open(CSV, ">$testDir/benchmark.csv") or die "can't write benchmark.csv: $!";
+print CSV join(",", @columns), "\n";
+foreach $record (@records) {
+  print CSV join(",", @$record), "\n";
+}
+close(CSV);
+
+# JSON
+open(JSON, ">$testDir/benchmark.json") or die "can't write benchmark.json: $!";
+print JSON "[\n";
+for ($r = 0; $r < @records; $r++) {
+  @values = @{$records[$r]};
+  @pairs = ();
+  for ($c = 0; $c < @columns; $c++) {
+    $value = $values[$c];
+    if ($c == 0) {
+      $value = "\"$value\"";
+    } elsif ($value eq "") {
+      $value = "null";
+    }
+    push(@pairs, "\"$columns[$c]\": $value");
+  }
+  print JSON "  {", join(", ", @pairs), "}", ($r < @records - 1) ? ",\n" : "\n";
+}
+print JSON "]\n";
+close(JSON);
+
+print "Results written to $testDir/benchmark.csv and $testDir/benchmark.json\n";
@@ -0,0 +1,254 @@
+<?xml version="1.0"?>
+<xsl:stylesheet
+  xmlns:xsl="http://www.w3.org/1999/XSL/Transform" version="1.0">
+<xsl:output method="text" indent="yes"/>
+
+<!-- Generates a standalone benchmark for one itk_*.xml filter
+     description. Every instantiation listed in the templated/defaults
+     elements whose inputs are all images becomes a struct with a Run
+     function: the inputs are synthetic images (see BenchmarkSupport.h),
+     the parameters that have a default in the XML are set to it, and
+     the filter is updated a number of times with a given number of
+     threads, which is also the global default and maximum for the
+     filters it runs internally. The fastest update is reported as one CSV line.
+
+     The generated main takes the instantiation number, the image size,
+     the number of threads and the number of repeats. Without arguments
+     it lists the instantiations with their dimension.
+-->
+
+<xsl:template match="/filter-itk">
+<xsl:call-template name="includes"/>
+<xsl:text>#include "BenchmarkSupport.h"
+
+#include &lt;cstdlib&gt;
+
+</xsl:text>
+<xsl:for-each select="/filter-itk/templated/defaults">
+<xsl:call-template name="create_instantiation">
+  <xsl:with-param name="number" select="position()"/>
+</xsl:call-template>
+</xsl:for-each>
+<xsl:call-template name="create_main"/>
+</xsl:template>
+
+
+<!-- Set filter include file -->
+<xsl:template name="includes">
+<xsl:for-each select="/filter-itk/includes/file">
+#include &lt;<xsl:value-of select="."/>&gt;
+</xsl:for-each>
+<xsl:text>
+</xsl:text>
+</xsl:template>
+
+
+<!-- Outputs one character per required input of the filter which is
+     not an image in the given instantiation. -->
+<xsl:template name="unsupported_inputs">
+<xsl:param name="instantiation"/>
+<xsl:for-each select="/filter-itk/inputs/input[not(@optional='yes')]">
+  <xsl:variable name="type" select="normalize-space(type)"/>
+  <xsl:variable name="template" select="/filter-itk/templated/template[normalize-space(.)=$type]"/>
+  <xsl:choose>
+    <xsl:when test="not($template)">x</xsl:when>
+    <xsl:otherwise>
+      <xsl:variable name="pos" select="count($template/preceding-sibling::template) + 1"/>
+      <xsl:if test="not(starts-with(normalize-space($instantiation/default[$pos]), 'itk::Image'))">x</xsl:if>
+    </xsl:otherwise>
+  </xsl:choose>
+</xsl:for-each>
+</xsl:template>
+
+
+<!-- Position of the template named by the type of the given input. -->
+<xsl:template name="input_template">
+<xsl:param name="input"/>
+<xsl:variable name="type" select="normalize-space($input/type)"/>
+<xsl:value-of select="count(/filter-itk/templated/template[normalize-space(.)=$type]/preceding-sibling::template) + 1"/>
+</xsl:template>
+
+
+<!-- Template arguments of an instantiation, for the listing. -->
+<xsl:template name="describe">
+<xsl:param name="instantiation"/>
+<xsl:variable name="count" select="count(/filter-itk/templated/template)"/>
+<xsl:for-each select="$instantiation/default[position() &lt;= $count]">
+<xsl:value-of select="normalize-space(.)"/><xsl:if test="position() &lt; last()">, </xsl:if>
+</xsl:for-each>
+</xsl:template>
+
+
+<!-- One struct per instantiation with image inputs. -->
+<xsl:template name="create_instantiation">
+<xsl:param name="number"/>
+<xsl:variable name="instantiation" select="."/>
+<xsl:variable name="unsupported">
+  <xsl:call-template name="unsupported_inputs">
+    <xsl:with-param name="instantiation" select="$instantiation"/>
+  </xsl:call-template>
+</xsl:variable>
+<xsl:variable name="first_input">
+  <xsl:call-template name="input_template">
+    <xsl:with-param name="input" select="/filter-itk/inputs/input[not(@optional='yes')][1]"/>
+  </xsl:call-template>
+</xsl:variable>
+<xsl:choose>
+<xsl:when test="string-length($unsupported) &gt; 0">
+// Instantiation <xsl:value-of select="$number"/> is not benchmarked: not all of its inputs are images.
+</xsl:when>
+<xsl:otherwise>
+// <xsl:value-of select="/filter-itk/@name"/>&lt; <xsl:call-template name="describe"><xsl:with-param name="instantiation" select="$instantiation"/></xsl:call-template> &gt;
+struct Instantiation<xsl:value-of select="$number"/>
+{
+<xsl:for-each select="/filter-itk/templated/template">
+<xsl:variable name="pos" select="position()"/>
+<xsl:choose>
+<xsl:when test="@type">  static const <xsl:value-of select="@type"/> T<xsl:value-of select="$pos"/> = <xsl:value-of select="normalize-space($instantiation/default[$pos])"/>;
+</xsl:when>
+<xsl:otherwise>  typedef <xsl:value-of select="normalize-space($instantiation/default[$pos])"/> T<xsl:value-of select="$pos"/>;
+</xsl:otherwise>
+</xsl:choose>
+</xsl:for-each>
+  typedef <xsl:value-of select="/filter-itk/@name"/>&lt; <xsl:for-each select="/filter-itk/templated/template">T<xsl:value-of select="position()"/><xsl:if test="position() &lt; last()">, </xsl:if></xsl:for-each> &gt; FilterType;
+
+  static unsigned int Dimension()
+    {
+    return T<xsl:value-of select="$first_input"/>::ImageDimension;
+    }
+
+  static void Run( const BenchmarkSettings &amp; settings, BenchmarkResult &amp; result )
+    {
+    // synthetic inputs
+<xsl:for-each select="/filter-itk/inputs/input[not(@optional='yes')]">
+<xsl:variable name="pos"><xsl:call-template name="input_template"><xsl:with-param name="input" select="."/></xsl:call-template></xsl:variable>    T<xsl:value-of select="$pos"/>::Pointer input<xsl:value-of select="position()"/> =
+      CreateSyntheticImage&lt; T<xsl:value-of select="$pos"/> &gt;( settings.Size );
+</xsl:for-each>
+    result.Voxels = input1-&gt;GetLargestPossibleRegion().GetNumberOfPixels();
+    result.Seconds = -1.0;
+
+    for ( unsigned int r = 0; r &lt; settings.Repeats; r++ )
+      {
+      FilterType::Pointer filter = FilterType::New();
+
+      // set inputs
+<xsl:for-each select="/filter-itk/inputs/input[not(@optional='yes')]">      filter-&gt;<xsl:value-of select="call"/>( input<xsl:value-of select="position()"/> );
+</xsl:for-each>
+      // set parameters with a default
+<xsl:for-each select="/filter-itk/parameters/param[default]">
+<xsl:call-template name="set_parameter"/>
+</xsl:for-each>
+      filter-&gt;SetNumberOfThreads( settings.Threads );
+
+      itk::TimeProbe probe;
+      probe.Start();
+      filter-&gt;Update();
+      probe.Stop();
+
+      if ( result.Seconds &lt; 0.0 || probe.GetMeanTime() &lt; result.Seconds )
+        {
+        result.Seconds = probe.GetMeanTime();
+        }
+      }
+    }
+};
+</xsl:otherwise>
+</xsl:choose>
+</xsl:template>
+
+
+<!-- Set one parameter to its default. Seeds are put at the center of
+     the image, where the synthetic blob is. -->
+<xsl:template name="set_parameter">
+<xsl:variable name="type" select="normalize-space(type)"/>
+<xsl:variable name="default" select="normalize-space(default)"/>
+<xsl:choose>
+<xsl:when test="/filter-itk/datatypes/array[@name=$type]">
+<xsl:choose>
+<xsl:when test="substring($type, string-length($type) - 8) = 'IndexType'">      {
+      <xsl:value-of select="$type"/> value;
+      value.Fill( settings.Size / 2 );
+      filter-&gt;<xsl:value-of select="call"/>( value );
+      }
+</xsl:when>
+<xsl:otherwise>      {
+      <xsl:value-of select="$type"/> value;
+      value.Fill( <xsl:value-of select="$default"/> );
+      filter-&gt;<xsl:value-of select="call"/>( value );
+      }
+</xsl:otherwise>
+</xsl:choose>
+</xsl:when>
+<xsl:when test="count(call) = 2">
+<xsl:choose>
+<xsl:when test="$default = '0' or $default = 'false'">      filter-&gt;<xsl:value-of select="call[@value='off']"/>();
+</xsl:when>
+<xsl:otherwise>      filter-&gt;<xsl:value-of select="call[@value='on']"/>();
+</xsl:otherwise>
+</xsl:choose>
+</xsl:when>
+<xsl:otherwise>      filter-&gt;<xsl:value-of select="call"/>( <xsl:value-of select="$default"/> );
+</xsl:otherwise>
+</xsl:choose>
+</xsl:template>
+
+
+<xsl:template name="create_main">
+int main( int argc, char * argv[] )
+{
+  if ( argc &lt; 5 )
+    {
+    std::cout &lt;&lt; "Usage: " &lt;&lt; argv[0]
+              &lt;&lt; " instantiation size threads repeats" &lt;&lt; std::endl;
+    std::cout &lt;&lt; "Instantiations (number, dimension, types):" &lt;&lt; std::endl;
+<xsl:for-each select="/filter-itk/templated/defaults">
+<xsl:variable name="unsupported"><xsl:call-template name="unsupported_inputs"><xsl:with-param name="instantiation" select="."/></xsl:call-template></xsl:variable>
+<xsl:if test="string-length($unsupported) = 0">    std::cout &lt;&lt; "  <xsl:value-of select="position()"/> " &lt;&lt; Instantiation<xsl:value-of select="position()"/>::Dimension()
+              &lt;&lt; " <xsl:call-template name="describe"><xsl:with-param name="instantiation" select="."/></xsl:call-template>" &lt;&lt; std::endl;
+</xsl:if>
+</xsl:for-each>
+    return 0;
+    }
+
+  const unsigned int instantiation = atoi( argv[1] );
+  BenchmarkSettings settings;
+  settings.Size = atoi( argv[2] );
+  settings.Threads = atoi( argv[3] );
+  settings.Repeats = atoi( argv[4] );
+  BenchmarkResult result;
+
+  // the filters run internal pipelines whose threads are set from the
+  // global values, not from the top filter
+  itk::MultiThreader::SetGlobalMaximumNumberOfThreads( settings.Threads );
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads( settings.Threads );
+  unsigned int dimension = 0;
+
+  try
+    {
+    switch ( instantiation )
+      {
+<xsl:for-each select="/filter-itk/templated/defaults">
+<xsl:variable name="unsupported"><xsl:call-template name="unsupported_inputs"><xsl:with-param name="instantiation" select="."/></xsl:call-template></xsl:variable>
+<xsl:if test="string-length($unsupported) = 0">      case <xsl:value-of select="position()"/>:
+        Instantiation<xsl:value-of select="position()"/>::Run( settings, result );
+        dimension = Instantiation<xsl:value-of select="position()"/>::Dimension();
+        break;
+</xsl:if>
+</xsl:for-each>      default:
+        std::cerr &lt;&lt; "Unknown instantiation " &lt;&lt; instantiation &lt;&lt; std::endl;
+        return 1;
+      }
+    }
+  catch ( itk::ExceptionObject &amp; err )
+    {
+    std::cerr &lt;&lt; err &lt;&lt; std::endl;
+    return 1;
+    }
+
+  PrintBenchmarkResult( "<xsl:value-of select="/filter-itk/@name"/>", instantiation, dimension,
+                        settings, result );
+  return 0;
+}
+</xsl:template>
+
+</xsl:stylesheet>
@@ -0,0 +1,175 @@
+/*
+  The contents of this file are subject to the University of Utah Public
+  License (the "License"); you may not use this file except in compliance
+  with the License.
+
+  Software distributed under the License is distributed on an "AS IS"
+  basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+  License for the specific language governing rights and limitations under
+  the License.
+
+  The Original Source Code is SCIRun, released March 12, 2001.
+
+  The Original Source Code was developed by the University of Utah.
+  Portions created by UNIVERSITY are Copyright (C) 2001, 1994
+  University of Utah. All Rights Reserved.
+*/
+
+/*
+ * BenchmarkSupport.h
+ *
+ *   Helpers shared by the benchmark.cc files generated with Benchmark.xsl:
+ *   synthetic input images, run settings and the CSV result line.
+ *
+ */
+
+#ifndef BenchmarkSupport_h
+#define BenchmarkSupport_h
+
+#include <itkImage.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkRGBPixel.h>
+#include <itkVector.h>
+#include <itkTimeProbe.h>
+#include <itkMultiThreader.h>
+
+#include <cmath>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+// Settings of one benchmark run, read from the command line.
+struct BenchmarkSettings
+{
+  unsigned int Size;      // number of pixels along each axis
+  unsigned int Threads;   // number of threads of the filter and of ITK
+  unsigned int Repeats;   // number of timed updates, the fastest is kept
+};
+
+// Result of one benchmark run.
+struct BenchmarkResult
+{
+  unsigned long Voxels;
+  double        Seconds;
+};
+
+
+// Conversion of a synthetic intensity to the pixel types used in the
+// filter descriptions.
+template <class TPixel>
+struct SyntheticPixel
+{
+  static TPixel Make( double value )
+  {
+    return static_cast<TPixel>( value );
+  }
+};
+
+template <class TComponent, unsigned int VLength>
+struct SyntheticPixel< itk::Vector<TComponent, VLength> >
+{
+  static itk::Vector<TComponent, VLength> Make( double value )
+  {
+    itk::Vector<TComponent, VLength> pixel;
+    pixel.Fill( static_cast<TComponent>( value ) );
+    return pixel;
+  }
+};
+
+template <class TComponent>
+struct SyntheticPixel< itk::RGBPixel<TComponent> >
+{
+  static itk::RGBPixel<TComponent> Make( double value )
+  {
+    itk::RGBPixel<TComponent> pixel;
+    pixel.Fill( static_cast<TComponent>( value ) );
+    return pixel;
+  }
+};
+
+
+// Image of size^Dimension pixels holding a centered Gaussian blob with
+// values from 0 to 255, plus a fixed pseudo-random noise of +/- 8, so
+// that smoothing, threshold and region growing filters all have some
+// structure to work on. The same size always gives the same image.
+template <class TImage>
+typename TImage::Pointer
+CreateSyntheticImage( unsigned int size )
+{
+  typedef typename TImage::PixelType PixelType;
+
+  typename TImage::SizeType imageSize;
+  imageSize.Fill( size );
+  typename TImage::RegionType region;
+  region.SetSize( imageSize );
+
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  const double center = 0.5 * ( size - 1 );
+  const double sigma = 0.25 * size;
+  unsigned long seed = 12345;
+
+  itk::ImageRegionIteratorWithIndex<TImage> it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double r2 = 0.0;
+    for ( unsigned int d = 0; d < TImage::ImageDimension; d++ )
+      {
+      const double x = it.GetIndex()[d] - center;
+      r2 += x * x;
+      }
+    seed = seed * 1103515245 + 12345;
+    const double noise = ( ( seed >> 16 ) % 17 ) - 8.0;
+    const double value = 247.0 * std::exp( -0.5 * r2 / ( sigma * sigma ) )
+                         + 8.0 + noise;
+    it.Set( SyntheticPixel<PixelType>::Make( value ) );
+    }
+
+  return image;
+}
+
+
+// Peak resident memory of the process, in kilobytes, or -1 where it is
+// not available.
+inline long GetPeakMemory()
+{
+#if !defined(_WIN32)
+  struct rusage usage;
+  if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+    {
+    return -1;
+    }
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return -1;
+#endif
+}
+
+
+// One CSV line:
+//   filter,instantiation,dimension,size,voxels,threads,repeats,seconds,
+//   voxels_per_second,peak_memory_kb
+inline void PrintBenchmarkResult( const char * filter,
+                                  unsigned int instantiation,
+                                  unsigned int dimension,
+                                  const BenchmarkSettings & settings,
+                                  const BenchmarkResult & result )
+{
+  const double rate = result.Seconds > 0.0
+    ? result.Voxels / result.Seconds : 0.0;
+  std::cout << filter << "," << instantiation << "," << dimension << ","
+            << settings.Size << "," << result.Voxels << ","
+            << settings.Threads << "," << settings.Repeats << ","
+            << result.Seconds << "," << rate << ","
+            << GetPeakMemory() << std::endl;
+}
+
+#endif
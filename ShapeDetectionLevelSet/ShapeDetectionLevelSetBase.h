@@ -20,7 +20,7 @@
 
 #include "itkImage.h"
 #include "itkCastImageFilter.h"
-#include "itkFastMarchingImageFilter.h"
+#include "itkFastIterativeMarchingImageFilter.h"
 #include "itkShapeDetectionLevelSetImageFilter.h"
 #include "itkGradientMagnitudeRecursiveGaussianImageFilter.h"
 #include "itkSigmoidImageFilter.h"
@@ -99,7 +99,7 @@ public:
                     ThresholdedImageType >                ThresholdFilterType;
     
   /** Fast Marching filte use to evolve the contours */
-  typedef   itk::FastMarchingImageFilter< 
+  typedef   itk::FastIterativeMarchingImageFilter< 
                                InternalImageType >     FastMarchingFilterType;
 
 
@@ -1,4 +1,6 @@
 #include "FuzzySegGrayRun.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
 #include <FL/Fl_Int_Input.H>
 #include <fstream>
 #include <iostream>
@@ -113,7 +115,7 @@ ReadImage( const char * filename )
   m_ImageSize=m_Cols*m_Rows*m_Pages;
   unsigned long iter;
   std::ifstream fin(filename,std::ios::binary);
-  itk::ImageRegionIteratorWithIndex<FloatImage> iit(m_DataImage, m_ImageRegion);
+  itk::ImageRegionIterator<FloatImage> iit(m_DataImage, m_ImageRegion);
   char *offread=new char[m_Offset];
   fin.read(offread,m_Offset);
   delete[] offread;
@@ -127,6 +129,7 @@ ReadImage( const char * filename )
         iit.Set((float)(reader1[iter]));
         ++iit;
         }
+      delete[] reader1;
       }
       break;
     case 1:
@@ -137,6 +140,7 @@ ReadImage( const char * filename )
         iit.Set((float)(reader2[iter]));
         ++iit;
         }
+      delete[] reader2;
       }
       break;
     case 2:
@@ -147,6 +151,7 @@ ReadImage( const char * filename )
         iit.Set(reader3[iter]);
         ++iit;
         }
+      delete[] reader3;
       }
       break;
     default:
@@ -255,16 +260,16 @@ FuzzySegGrayRun::
 ShowResult()
 {
   if(m_AskScene){
-    itk::ImageRegionIteratorWithIndex<FloatImage> iit(m_ViewResultImage, m_ImageRegion);
-    itk::ImageRegionConstIteratorWithIndex<FuzzySceneImage> iit2(m_Segmenter->GetFuzzyScene(), m_ImageRegion);
+    itk::ImageRegionIterator<FloatImage> iit(m_ViewResultImage, m_ImageRegion);
+    itk::ImageRegionConstIterator<FuzzySceneImage> iit2(m_Segmenter->GetFuzzyScene(), m_ImageRegion);
     while (!iit.IsAtEnd()){
        iit.Set(iit2.Get());
        ++iit;++iit2;  
     }  
   }
   else{
-    itk::ImageRegionIteratorWithIndex<FloatImage> iit(m_ViewResultImage, m_ImageRegion);
-    itk::ImageRegionConstIteratorWithIndex<OutputImage> iit2(m_Segmenter->GetOutput(), m_ImageRegion);
+    itk::ImageRegionIterator<FloatImage> iit(m_ViewResultImage, m_ImageRegion);
+    itk::ImageRegionConstIterator<OutputImage> iit2(m_Segmenter->GetOutput(), m_ImageRegion);
     while (!iit.IsAtEnd()){
        iit.Set(iit2.Get());
        ++iit;++iit2;  
@@ -306,7 +311,7 @@ Save(const char *filename)
 {
   std::ofstream fout(filename,std::ios::binary);
 
-  itk::ImageRegionIteratorWithIndex<OutputImage> iit(m_Segmenter->GetOutput(), m_ImageRegion);
+  itk::ImageRegionConstIterator<OutputImage> iit(m_Segmenter->GetOutput(), m_ImageRegion);
   unsigned char *writer=new unsigned char [m_ImageSize];
   unsigned long i=0;
   while (!iit.IsAtEnd()){
@@ -315,6 +320,7 @@ Save(const char *filename)
   }
 
   fout.write((char *)(writer),m_ImageSize);
+  delete[] writer;
 }
 
 
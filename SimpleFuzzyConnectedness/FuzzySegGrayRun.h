@@ -1,7 +1,7 @@
 #include <FL/Fl_File_Chooser.H>
 
 #include "GLSliceView.h"
-#include "itkSimpleFuzzyConnectednessScalarImageFilter.h"
+#include "itkParallelFuzzyConnectednessImageFilter.h"
 
 class FuzzySegGrayRun
 {
@@ -10,9 +10,9 @@ public:
   typedef itk::Image<float,3> FloatImage;
   typedef FloatImage::IndexType IndexType;
   typedef itk::Image<unsigned char ,3> OutputImage;
-  typedef itk::Image<unsigned short,3> FuzzySceneImage;
   typedef GLSliceView<float,bool>   ViewerType;
-  typedef itk::SimpleFuzzyConnectednessScalarImageFilter<FloatImage,OutputImage> FuzzyFilter;
+  typedef itk::ParallelFuzzyConnectednessImageFilter<FloatImage,OutputImage> FuzzyFilter;
+  typedef FuzzyFilter::FuzzySceneType FuzzySceneImage;
 
   FuzzySegGrayRun();
   virtual ~FuzzySegGrayRun();
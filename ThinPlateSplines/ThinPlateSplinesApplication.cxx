@@ -65,6 +65,24 @@ ThinPlateSplinesApplication
 
 
 
+void 
+ThinPlateSplinesApplication
+::MapPointsIncrementally()
+{
+  // The VTK spline solves its whole system again: its points are dropped
+  // until the next Map Points instead of following every edit
+  this->MapPointsITK();
+  this->ClearPointsTransformedByVTK();
+  this->RemoveActors();
+  this->DisplayAxes();
+  this->DisplayPoints();
+  this->DisplayLandMarks();
+  m_FlRenderWindowInteractor->redraw();
+  Fl::check();
+}
+
+
+
 void
 ThinPlateSplinesApplication
 ::MapPointsITK(void)
@@ -87,8 +105,29 @@ ThinPlateSplinesApplication
   case 4:
     this->MapPointsVolumeSplineITK();
     break;
+  case 5:
+    this->MapPointsIncrementalSplineITK( 
+             IncrementalKernelTransformType::ThinPlateKernel );
+    break;
+  case 6:
+    this->MapPointsIncrementalSplineITK( 
+             IncrementalKernelTransformType::ThinPlateR2LogRKernel );
+    break;
+  case 7:
+    this->MapPointsIncrementalSplineITK( 
+             IncrementalKernelTransformType::VolumeKernel );
+    break;
   }
 }
+
+
+
+bool
+ThinPlateSplinesApplication
+::IsIncrementalSplineSelected(void) const
+{
+  return splineKernelITKChoice->value() >= 5;
+}
   
 
 
@@ -154,6 +193,14 @@ ThinPlateSplinesApplication
   landmark[1] = y;
   landmark[2] = z;
 
+  // The incremental splines only update the moved landmark,
+  // so the points can be mapped again at every edit
+  if( this->IsIncrementalSplineSelected() )
+    {
+    this->MapPointsIncrementally();
+    return;
+    }
+
   this->RemoveActors();
   this->CreateSourcePoints();
   this->DisplayLandMarks();
@@ -208,6 +255,14 @@ ThinPlateSplinesApplication
   landmark[1] = y;
   landmark[2] = z;
 
+  // The incremental splines only update the moved landmark,
+  // so the points can be mapped again at every edit
+  if( this->IsIncrementalSplineSelected() )
+    {
+    this->MapPointsIncrementally();
+    return;
+    }
+
   this->RemoveActors();
   this->CreateSourcePoints();
   this->DisplayLandMarks();
@@ -54,6 +54,11 @@ protected:
   virtual void MapPointsVTK(void);
   virtual void CreateSourcePoints(void);
 
+  /** Map the points with the ITK spline only, after a landmark edit */
+  void MapPointsIncrementally(void);
+
+  bool IsIncrementalSplineSelected(void) const;
+
 private:
 
 
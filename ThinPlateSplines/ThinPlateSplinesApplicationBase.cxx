@@ -70,6 +70,8 @@ ThinPlateSplinesApplicationBase
 
   m_VolumeSplineTransformITK = VolumeSplineTransformType::New();
 
+  m_IncrementalKernelTransformITK = IncrementalKernelTransformType::New();
+
   m_ThinPlateSplineTransformVTK = vtkThinPlateSplineTransform::New();
 
 }
@@ -441,6 +443,20 @@ ThinPlateSplinesApplicationBase
  
 
 
+void
+ThinPlateSplinesApplicationBase
+::ClearPointsTransformedByVTK(void)
+{
+  m_VTKPointsTransformedByVTK->Delete();
+  m_VTKPointsTransformedByVTK = vtkPoints::New();
+
+  m_VTKLinesTransformedByVTK->Delete();
+  m_VTKLinesTransformedByVTK = vtkCellArray::New();
+}
+
+ 
+
+
 void
 ThinPlateSplinesApplicationBase
 ::MapPointsITK(void)
@@ -605,6 +621,44 @@ ThinPlateSplinesApplicationBase
 }
 
 
+void
+ThinPlateSplinesApplicationBase
+::MapPointsIncrementalSplineITK( 
+                     IncrementalKernelTransformType::KernelType kernel )
+{
+
+  // Only the landmarks that moved since the last call are updated
+  PointArrayType sourceLandMarks;
+  PointArrayType targetLandMarks;
+
+  typedef PointSetType::PointsContainer::Iterator  PointIteratorType;
+  PointIteratorType slm = m_SourceLandMarks->GetPoints()->Begin();
+  PointIteratorType end = m_SourceLandMarks->GetPoints()->End();
+  PointIteratorType tlm = m_TargetLandMarks->GetPoints()->Begin();
+  while( slm != end )
+    {
+    sourceLandMarks.push_back( slm.Value() );
+    targetLandMarks.push_back( tlm.Value() );
+    ++slm;
+    ++tlm;
+    }
+
+  m_TimeCollector.Start("ITK Incremental Spline");
+
+  m_IncrementalKernelTransformITK->SetKernel( kernel );
+  m_IncrementalKernelTransformITK->SetLandmarks( sourceLandMarks, 
+                                                 targetLandMarks );
+
+  m_IncrementalKernelTransformITK->TransformPoints( m_PointsToTransform,
+                                                    m_PointsTransformedByITK );
+
+  m_TimeCollector.Stop("ITK Incremental Spline");
+
+  this->ConvertITKMappedPointsToVTK();
+
+}
+
+
 void
 ThinPlateSplinesApplicationBase
 ::ConvertITKMappedPointsToVTK(void)
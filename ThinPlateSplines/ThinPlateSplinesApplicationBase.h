@@ -32,6 +32,7 @@
 #include "itkElasticBodySplineKernelTransform.h"
 #include "itkElasticBodyReciprocalSplineKernelTransform.h"
 #include "itkVolumeSplineKernelTransform.h"
+#include "itkIncrementalKernelTransform.h"
 #include "vtkThinPlateSplineTransform.h"
 
 #include <set>
@@ -91,6 +92,12 @@ public:
 
   typedef VolumeSplineTransformType::Pointer  VolumeSplineTransformPointer;
 
+  typedef itk::IncrementalKernelTransform< 
+                              CoordinateRepresentationType,
+                              PointsDimension >  IncrementalKernelTransformType;
+
+  typedef IncrementalKernelTransformType::Pointer  IncrementalKernelTransformPointer;
+
 
 
 public:
@@ -147,7 +154,10 @@ protected:
   virtual void    MapPointsThinPlateSplineITK(void);
   virtual void    MapPointsThinPlateR2LogRSplineITK(void);
   virtual void    MapPointsVolumeSplineITK(void);
+  virtual void    MapPointsIncrementalSplineITK(
+                     IncrementalKernelTransformType::KernelType kernel );
   virtual void    MapPointsVTK(void);
+  virtual void    ClearPointsTransformedByVTK(void);
   virtual void    CreateSourcePoints(void);
   virtual void    ConvertITKMappedPointsToVTK(void);
   virtual void    RemoveActors(void);
@@ -163,6 +173,8 @@ protected:
 
   VolumeSplineTransformPointer        m_VolumeSplineTransformITK;
 
+  IncrementalKernelTransformPointer   m_IncrementalKernelTransformITK;
+
   vtkThinPlateSplineTransform       * m_ThinPlateSplineTransformVTK;
 
 private:
@@ -0,0 +1,199 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkIncrementalKernelTransform.h
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkIncrementalKernelTransform_h
+#define _itkIncrementalKernelTransform_h
+
+#include "itkObject.h"
+#include "itkPoint.h"
+#include "itkMultiThreader.h"
+#include "vnl/vnl_matrix.h"
+#include "vnl/vnl_vector.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class IncrementalKernelTransform
+ *
+ * Kernel spline through a set of landmarks, as computed by
+ * ThinPlateSplineKernelTransform (kernel r), ThinPlateR2LogRSplineKernelTransform
+ * (kernel r^2 log r) and VolumeSplineKernelTransform (kernel r^3), meant for
+ * landmarks that are edited one at a time.
+ *
+ * With a radial scalar kernel, the system solved by KernelTransform is the
+ * same for each coordinate, so a single (L + NDimensions + 1) square matrix
+ * is inverted once, when the landmarks are first set, and then kept:
+ *
+ * - moving a target landmark only changes the right hand side, and the
+ *   coefficients are corrected with one column of the inverse, in O(L);
+ * - moving a source landmark changes one row and one column of the matrix,
+ *   and the inverse is updated with a rank two Sherman-Morrison-Woodbury
+ *   correction, in O(L^2) instead of O(L^3).
+ *
+ * After RefactorizationPeriod source updates, or when an update is badly
+ * conditioned, the matrix is inverted again from scratch so that the
+ * rounding errors of the corrections do not accumulate.
+ *
+ * TransformPoints() maps an array of points split between NumberOfThreads
+ * threads.
+ *
+ * The elastic body kernels are matrix valued and are not supported; use
+ * the ITK kernel transforms for them.
+ *
+ * \ingroup Transforms
+ */
+template <class TScalarType=double, unsigned int NDimensions=3>
+class ITK_EXPORT IncrementalKernelTransform : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef IncrementalKernelTransform  Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer<Self>          Pointer;
+  typedef SmartPointer<const Self>    ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(IncrementalKernelTransform, Object);
+
+  itkStaticConstMacro(SpaceDimension, unsigned int, NDimensions);
+
+  typedef Point<TScalarType, NDimensions>     PointType;
+  typedef std::vector<PointType>              PointArrayType;
+  typedef vnl_matrix<double>                  MatrixType;
+  typedef vnl_vector<double>                  VectorType;
+
+  /** Radial kernels of the ITK thin plate, thin plate R2LogR and volume
+   * spline transforms. */
+  typedef enum { ThinPlateKernel, ThinPlateR2LogRKernel, VolumeKernel }
+                                              KernelType;
+
+  /** The kernel and the stiffness take effect at the next SetLandmarks(),
+   * which then recomputes the whole solution. */
+  itkSetMacro( Kernel, KernelType );
+  itkGetConstMacro( Kernel, KernelType );
+
+  /** Added to the diagonal of the kernel matrix; zero interpolates the
+   * landmarks exactly. */
+  itkSetMacro( Stiffness, double );
+  itkGetConstMacro( Stiffness, double );
+
+  /** Number of source landmark updates between two full inversions. */
+  itkSetClampMacro( RefactorizationPeriod, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( RefactorizationPeriod, unsigned int );
+
+  itkSetClampMacro( NumberOfThreads, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfThreads, unsigned int );
+
+  /** Number of source landmark updates since the last full inversion. */
+  itkGetConstMacro( NumberOfUpdates, unsigned int );
+
+  /** Set all the landmarks. The first call, or a call with a different
+   * number of landmarks, kernel or stiffness, inverts the matrix; the
+   * following calls compare the landmarks with the current ones and only
+   * apply the updates of the landmarks that moved. */
+  void SetLandmarks( const PointArrayType & source,
+                     const PointArrayType & target );
+
+  /** Move one landmark. SetLandmarks() must have been called before. */
+  void SetSourceLandmark( unsigned int id, const PointType & point );
+  void SetTargetLandmark( unsigned int id, const PointType & point );
+
+  const PointArrayType & GetSourceLandmarks() const
+    { return m_SourceLandmarks; }
+  const PointArrayType & GetTargetLandmarks() const
+    { return m_TargetLandmarks; }
+
+  PointType TransformPoint( const PointType & point ) const;
+
+  /** Map all the input points into output, which is resized. */
+  void TransformPoints( const PointArrayType & input,
+                        PointArrayType & output ) const;
+
+protected:
+  IncrementalKernelTransform();
+  virtual ~IncrementalKernelTransform() {};
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+private:
+  IncrementalKernelTransform( const Self& ); //purposely not implemented
+  void operator=( const Self& ); //purposely not implemented
+
+  /** Kernel used by the current solution. */
+  double EvaluateKernel( const PointType & p1, const PointType & p2 ) const;
+
+  /** Build and invert the whole matrix, and compute the coefficients. */
+  void Factorize();
+
+  /** Rank two update of the inverse for a moved source landmark. Returns
+   * false, leaving everything unchanged, when the update is badly
+   * conditioned. */
+  bool UpdateInverse( unsigned int id, const PointType & point );
+
+  /** Right hand side: the landmark displacements, then zeros. */
+  void ComputeDisplacements();
+
+  /** Kernel and affine coefficients from the inverse and the displacements. */
+  void ComputeCoefficients();
+
+  static ITK_THREAD_RETURN_TYPE TransformThreaderCallback( void * arg );
+
+  KernelType                   m_Kernel;
+  double                       m_Stiffness;
+  unsigned int                 m_RefactorizationPeriod;
+  unsigned int                 m_NumberOfThreads;
+
+  bool                         m_Factorized;
+  KernelType                   m_FactorizedKernel;
+  double                       m_FactorizedStiffness;
+  unsigned int                 m_NumberOfUpdates;
+
+  PointArrayType               m_SourceLandmarks;
+  PointArrayType               m_TargetLandmarks;
+
+  /** Inverse of [ K P ; P^T 0 ], with K the kernel between the source
+   * landmarks and P their homogeneous coordinates. */
+  MatrixType                   m_InverseMatrix;
+
+  /** Displacements (one column per coordinate) and coefficients: one row
+   * per landmark, then the linear part and the translation. */
+  MatrixType                   m_DisplacementMatrix;
+  MatrixType                   m_CoefficientMatrix;
+
+  MultiThreader::Pointer       m_Threader;
+
+  /** Arguments of TransformPoints() for the threads. */
+  struct ThreadStruct
+    {
+    const Self *               Transform;
+    const PointArrayType *     Input;
+    PointArrayType *           Output;
+    };
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkIncrementalKernelTransform.txx"
+#endif
+
+#endif
@@ -0,0 +1,438 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    itkIncrementalKernelTransform.txx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef _itkIncrementalKernelTransform_txx
+#define _itkIncrementalKernelTransform_txx
+
+#include "itkIncrementalKernelTransform.h"
+#include "vnl/vnl_math.h"
+#include "vnl/algo/vnl_svd.h"
+
+#include <cmath>
+
+namespace itk
+{
+
+template <class TScalarType, unsigned int NDimensions>
+IncrementalKernelTransform<TScalarType,NDimensions>
+::IncrementalKernelTransform()
+{
+  m_Kernel = ThinPlateKernel;
+  m_Stiffness = 0.0;
+  m_RefactorizationPeriod = 32;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  m_Factorized = false;
+  m_FactorizedKernel = m_Kernel;
+  m_FactorizedStiffness = m_Stiffness;
+  m_NumberOfUpdates = 0;
+
+  m_Threader = MultiThreader::New();
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+double
+IncrementalKernelTransform<TScalarType,NDimensions>
+::EvaluateKernel( const PointType & p1, const PointType & p2 ) const
+{
+  const double r = p1.EuclideanDistanceTo( p2 );
+  switch ( m_FactorizedKernel )
+    {
+    case ThinPlateR2LogRKernel:
+      return ( r < 1e-8 ) ? 0.0 : r * r * vcl_log( r );
+    case VolumeKernel:
+      return r * r * r;
+    case ThinPlateKernel:
+    default:
+      return r;
+    }
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+void
+IncrementalKernelTransform<TScalarType,NDimensions>
+::SetLandmarks( const PointArrayType & source,
+                const PointArrayType & target )
+{
+  if ( source.size() != target.size() )
+    {
+    itkExceptionMacro( << "Number of source landmarks (" << source.size()
+                       << ") != number of target landmarks ("
+                       << target.size() << ")" );
+    }
+
+  if ( !m_Factorized ||
+       source.size() != m_SourceLandmarks.size() ||
+       m_Kernel != m_FactorizedKernel ||
+       m_Stiffness != m_FactorizedStiffness )
+    {
+    m_SourceLandmarks = source;
+    m_TargetLandmarks = target;
+    this->Factorize();
+    return;
+    }
+
+  const unsigned int numberOfLandmarks = source.size();
+
+  // Moved sources first: they change the displacements of their own
+  // landmark, so the targets are taken as they are afterwards.
+  bool sourceMoved = false;
+  for ( unsigned int i = 0; i < numberOfLandmarks; i++ )
+    {
+    if ( source[i] == m_SourceLandmarks[i] )
+      {
+      continue;
+      }
+    if ( m_NumberOfUpdates >= m_RefactorizationPeriod ||
+         !this->UpdateInverse( i, source[i] ) )
+      {
+      m_SourceLandmarks = source;
+      m_TargetLandmarks = target;
+      this->Factorize();
+      return;
+      }
+    sourceMoved = true;
+    }
+
+  if ( sourceMoved )
+    {
+    m_TargetLandmarks = target;
+    this->ComputeDisplacements();
+    this->ComputeCoefficients();
+    this->Modified();
+    return;
+    }
+
+  for ( unsigned int i = 0; i < numberOfLandmarks; i++ )
+    {
+    if ( target[i] != m_TargetLandmarks[i] )
+      {
+      this->SetTargetLandmark( i, target[i] );
+      }
+    }
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+void
+IncrementalKernelTransform<TScalarType,NDimensions>
+::SetSourceLandmark( unsigned int id, const PointType & point )
+{
+  if ( !m_Factorized || id >= m_SourceLandmarks.size() )
+    {
+    itkExceptionMacro( << "No landmark " << id );
+    }
+
+  if ( m_NumberOfUpdates >= m_RefactorizationPeriod ||
+       !this->UpdateInverse( id, point ) )
+    {
+    m_SourceLandmarks[id] = point;
+    this->Factorize();
+    return;
+    }
+
+  this->ComputeDisplacements();
+  this->ComputeCoefficients();
+  this->Modified();
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+void
+IncrementalKernelTransform<TScalarType,NDimensions>
+::SetTargetLandmark( unsigned int id, const PointType & point )
+{
+  if ( !m_Factorized || id >= m_TargetLandmarks.size() )
+    {
+    itkExceptionMacro( << "No landmark " << id );
+    }
+
+  // Only the displacement of row id changes: the coefficients move along
+  // column id of the inverse.
+  const unsigned int n = m_InverseMatrix.rows();
+  for ( unsigned int d = 0; d < NDimensions; d++ )
+    {
+    const double delta = point[d] - m_TargetLandmarks[id][d];
+    m_DisplacementMatrix( id, d ) += delta;
+    for ( unsigned int r = 0; r < n; r++ )
+      {
+      m_CoefficientMatrix( r, d ) += m_InverseMatrix( r, id ) * delta;
+      }
+    }
+  m_TargetLandmarks[id] = point;
+  this->Modified();
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+void
+IncrementalKernelTransform<TScalarType,NDimensions>
+::Factorize()
+{
+  m_FactorizedKernel = m_Kernel;
+  m_FactorizedStiffness = m_Stiffness;
+
+  const unsigned int numberOfLandmarks = m_SourceLandmarks.size();
+  const unsigned int n = numberOfLandmarks + NDimensions + 1;
+
+  MatrixType matrix( n, n, 0.0 );
+  for ( unsigned int i = 0; i < numberOfLandmarks; i++ )
+    {
+    const PointType & pi = m_SourceLandmarks[i];
+    matrix( i, i ) = this->EvaluateKernel( pi, pi ) + m_Stiffness;
+    for ( unsigned int j = 0; j < i; j++ )
+      {
+      const double k = this->EvaluateKernel( pi, m_SourceLandmarks[j] );
+      matrix( i, j ) = k;
+      matrix( j, i ) = k;
+      }
+    for ( unsigned int d = 0; d < NDimensions; d++ )
+      {
+      matrix( i, numberOfLandmarks + d ) = pi[d];
+      matrix( numberOfLandmarks + d, i ) = pi[d];
+      }
+    matrix( i, n - 1 ) = 1.0;
+    matrix( n - 1, i ) = 1.0;
+    }
+
+  // Same tolerance as KernelTransform::ComputeWMatrix()
+  vnl_svd<double> svd( matrix, 1e-8 );
+  m_InverseMatrix = svd.inverse();
+
+  m_NumberOfUpdates = 0;
+  m_Factorized = true;
+
+  this->ComputeDisplacements();
+  this->ComputeCoefficients();
+  this->Modified();
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+bool
+IncrementalKernelTransform<TScalarType,NDimensions>
+::UpdateInverse( unsigned int id, const PointType & point )
+{
+  const unsigned int numberOfLandmarks = m_SourceLandmarks.size();
+  const unsigned int n = m_InverseMatrix.rows();
+  const PointType & old = m_SourceLandmarks[id];
+
+  // Change of column id of the matrix. Its diagonal entry and its
+  // homogeneous coordinate do not change, so the new matrix is
+  // M + delta e^T + e delta^T, with e the unit vector id.
+  VectorType delta( n, 0.0 );
+  for ( unsigned int j = 0; j < numberOfLandmarks; j++ )
+    {
+    if ( j != id )
+      {
+      delta[j] = this->EvaluateKernel( point, m_SourceLandmarks[j] )
+               - this->EvaluateKernel( old, m_SourceLandmarks[j] );
+      }
+    }
+  for ( unsigned int d = 0; d < NDimensions; d++ )
+    {
+    delta[numberOfLandmarks + d] = point[d] - old[d];
+    }
+
+  // Woodbury with U = [ delta e ], V = [ e delta ]: the 2x2 capacitance
+  // matrix is [ a b ; c a ], using the symmetry of the inverse.
+  const VectorType z = m_InverseMatrix * delta;
+  const VectorType m = m_InverseMatrix.get_column( id );
+  const double a = 1.0 + z[id];
+  const double b = m[id];
+  const double c = dot_product( delta, z );
+  const double determinant = a * a - b * c;
+
+  if ( vcl_fabs( determinant ) <= 1e-8 * ( a * a + vcl_fabs( b * c ) ) )
+    {
+    return false;
+    }
+
+  const double scale = 1.0 / determinant;
+  for ( unsigned int r = 0; r < n; r++ )
+    {
+    const double zr = z[r] * scale;
+    const double mr = m[r] * scale;
+    for ( unsigned int s = 0; s < n; s++ )
+      {
+      m_InverseMatrix( r, s ) -= a * ( zr * m[s] + mr * z[s] )
+                                 - b * zr * z[s] - c * mr * m[s];
+      }
+    }
+
+  m_SourceLandmarks[id] = point;
+  m_NumberOfUpdates++;
+  return true;
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+void
+IncrementalKernelTransform<TScalarType,NDimensions>
+::ComputeDisplacements()
+{
+  const unsigned int numberOfLandmarks = m_SourceLandmarks.size();
+  m_DisplacementMatrix.set_size( m_InverseMatrix.rows(), NDimensions );
+  m_DisplacementMatrix.fill( 0.0 );
+  for ( unsigned int i = 0; i < numberOfLandmarks; i++ )
+    {
+    for ( unsigned int d = 0; d < NDimensions; d++ )
+      {
+      m_DisplacementMatrix( i, d ) =
+        m_TargetLandmarks[i][d] - m_SourceLandmarks[i][d];
+      }
+    }
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+void
+IncrementalKernelTransform<TScalarType,NDimensions>
+::ComputeCoefficients()
+{
+  // The displacements are zero below the landmark rows.
+  const unsigned int numberOfLandmarks = m_SourceLandmarks.size();
+  const unsigned int n = m_InverseMatrix.rows();
+  m_CoefficientMatrix.set_size( n, NDimensions );
+  m_CoefficientMatrix.fill( 0.0 );
+  for ( unsigned int r = 0; r < n; r++ )
+    {
+    for ( unsigned int i = 0; i < numberOfLandmarks; i++ )
+      {
+      const double inverse = m_InverseMatrix( r, i );
+      for ( unsigned int d = 0; d < NDimensions; d++ )
+        {
+        m_CoefficientMatrix( r, d ) += inverse * m_DisplacementMatrix( i, d );
+        }
+      }
+    }
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+typename IncrementalKernelTransform<TScalarType,NDimensions>::PointType
+IncrementalKernelTransform<TScalarType,NDimensions>
+::TransformPoint( const PointType & point ) const
+{
+  const unsigned int numberOfLandmarks = m_SourceLandmarks.size();
+
+  double result[NDimensions];
+  for ( unsigned int d = 0; d < NDimensions; d++ )
+    {
+    // identity and translation
+    result[d] = point[d] +
+      m_CoefficientMatrix( numberOfLandmarks + NDimensions, d );
+    }
+  for ( unsigned int e = 0; e < NDimensions; e++ )
+    {
+    for ( unsigned int d = 0; d < NDimensions; d++ )
+      {
+      result[d] += m_CoefficientMatrix( numberOfLandmarks + e, d ) * point[e];
+      }
+    }
+  for ( unsigned int i = 0; i < numberOfLandmarks; i++ )
+    {
+    const double k = this->EvaluateKernel( point, m_SourceLandmarks[i] );
+    for ( unsigned int d = 0; d < NDimensions; d++ )
+      {
+      result[d] += k * m_CoefficientMatrix( i, d );
+      }
+    }
+
+  PointType mapped;
+  for ( unsigned int d = 0; d < NDimensions; d++ )
+    {
+    mapped[d] = static_cast<TScalarType>( result[d] );
+    }
+  return mapped;
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+ITK_THREAD_RETURN_TYPE
+IncrementalKernelTransform<TScalarType,NDimensions>
+::TransformThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const ThreadStruct * str = static_cast<const ThreadStruct *>( info->UserData );
+
+  const unsigned int threadId = info->ThreadID;
+  const unsigned int numberOfThreads = info->NumberOfThreads;
+  const unsigned int n = str->Input->size();
+  const unsigned int chunk = ( n + numberOfThreads - 1 ) / numberOfThreads;
+  const unsigned int first = threadId * chunk;
+  const unsigned int last = vnl_math_min( n, first + chunk );
+
+  const PointArrayType & input = *str->Input;
+  PointArrayType & output = *str->Output;
+  for ( unsigned int p = first; p < last; p++ )
+    {
+    output[p] = str->Transform->TransformPoint( input[p] );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+void
+IncrementalKernelTransform<TScalarType,NDimensions>
+::TransformPoints( const PointArrayType & input,
+                   PointArrayType & output ) const
+{
+  output.resize( input.size() );
+  if ( input.empty() )
+    {
+    return;
+    }
+
+  ThreadStruct str;
+  str.Transform = this;
+  str.Input = &input;
+  str.Output = &output;
+
+  // The threader is shared with const evaluations.
+  MultiThreader * threader = const_cast<MultiThreader *>(
+    m_Threader.GetPointer() );
+  threader->SetNumberOfThreads(
+    vnl_math_min( m_NumberOfThreads, static_cast<unsigned int>( input.size() ) ) );
+  threader->SetSingleMethod( Self::TransformThreaderCallback, &str );
+  threader->SingleMethodExecute();
+}
+
+
+template <class TScalarType, unsigned int NDimensions>
+void
+IncrementalKernelTransform<TScalarType,NDimensions>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Kernel: " << m_Kernel << std::endl;
+  os << indent << "Stiffness: " << m_Stiffness << std::endl;
+  os << indent << "RefactorizationPeriod: " << m_RefactorizationPeriod
+     << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfLandmarks: " << m_SourceLandmarks.size()
+     << std::endl;
+  os << indent << "NumberOfUpdates: " << m_NumberOfUpdates << std::endl;
+}
+
+} // namespace itk
+
+#endif
@@ -220,8 +220,11 @@ void
 ThresholdSegmentationLevelSet
 ::ShowThresholdedImage( void )
 {
-  m_ThresholdLevelSetFilter->Update();
-  m_ThresholdedImageViewer.SetImage( m_ThresholdLevelSetFilter->GetOutput() );  
+  if( !m_UseBrickedLevelSet )
+    {
+    m_ThresholdLevelSetFilter->Update();
+    }
+  m_ThresholdedImageViewer.SetImage( this->GetSegmentedImage() );  
   m_ThresholdedImageViewer.Show();
 
 }
@@ -229,6 +232,24 @@ ThresholdSegmentationLevelSet
 
 
 
+ 
+/************************************
+ *
+ *  Run the segmentation
+ *
+ ***********************************/
+void
+ThresholdSegmentationLevelSet
+::RunSegmentation( void )
+{
+  ThresholdSegmentationLevelSetBase::RunSegmentation();
+  m_ThresholdedImageViewer.SetImage( this->GetSegmentedImage() );  
+  m_VTKSegmentedImageViewer->SetImage( this->GetSegmentedImage() );
+}
+
+
+
+
 
  
 /************************************
@@ -81,6 +81,8 @@ public:
 
   virtual void ShowThresholdedImageWithVTK();
 
+  virtual void RunSegmentation();
+
   virtual void Quit();
 
   virtual void UpdateGUIAfterIteration();
@@ -38,7 +38,10 @@ ThresholdSegmentationLevelSetBase
   m_ThresholdLevelSetFilter = ThresholdLevelSetImageFilterType::New();
   m_ThresholdLevelSetFilter->SetFeatureImage( m_CastImageFilter->GetOutput() );
 
-  m_ThresholdLevelSetFilter->SetInput( m_SeedImage );
+  m_SeedCastImageFilter = SeedCastImageFilterType::New();
+  m_SeedCastImageFilter->SetInput( m_SeedImage );
+
+  m_ThresholdLevelSetFilter->SetInput( m_SeedCastImageFilter->GetOutput() );
 
   m_ThresholdLevelSetFilter->SetUpperThreshold(63);
   m_ThresholdLevelSetFilter->SetLowerThreshold(50);
@@ -52,6 +55,13 @@ ThresholdSegmentationLevelSetBase
 
   m_SeedValue = 1;
 
+  m_BrickedEvolution = BrickedEvolutionType::New();
+  m_BrickedEvolution->SetFilter( m_ThresholdLevelSetFilter );
+  m_BrickedEvolution->SetInitialImage( m_SeedImage );
+  m_BrickedEvolution->SetFeatureImage( m_CastImageFilter->GetOutput() );
+
+  m_UseBrickedLevelSet = false;
+
 }
 
 
@@ -111,6 +121,9 @@ ThresholdSegmentationLevelSetBase
   m_SeedImage->Allocate();
   m_SeedImage->FillBuffer( itk::NumericTraits<SeedImageType::PixelType>::Zero );
 
+  m_BrickedEvolution->ReleaseFeatureCache();
+  m_BrickedSegmentedImage = 0;
+
 }
 
 
@@ -131,6 +144,80 @@ ThresholdSegmentationLevelSetBase
 
 
 
+/************************************
+ *
+ *  Run the segmentation
+ *
+ ***********************************/
+void
+ThresholdSegmentationLevelSetBase 
+::RunSegmentation( void )
+{
+  if( !m_InputImageIsLoaded )
+    {
+    return;
+    }
+
+  if( !m_UseBrickedLevelSet )
+    {
+    m_BrickedSegmentedImage = 0;
+    m_ThresholdLevelSetFilter->SetInput( m_SeedCastImageFilter->GetOutput() );
+    m_ThresholdLevelSetFilter->SetFeatureImage( m_CastImageFilter->GetOutput() );
+    m_ThresholdLevelSetFilter->Update();
+    return;
+    }
+
+  // The level set, feature and speed images only cover the bricks around
+  // the seeds, the result is pasted in an image of the whole volume.
+  m_BrickedEvolution->SetIsoSurfaceValue( 
+                          m_ThresholdLevelSetFilter->GetIsoSurfaceValue() );
+  m_BrickedEvolution->Update();
+  m_BrickedSegmentedImage = m_BrickedEvolution->MakeVolumeOutput();
+
+  std::cout << "Level set on " << m_BrickedEvolution->GetRegion().GetSize()
+            << " pixels, " << m_BrickedEvolution->GetNumberOfRounds()
+            << " rounds, " << m_BrickedEvolution->GetNumberOfFeatureBricks()
+            << " of " << m_BrickedEvolution->GetNumberOfBricks()
+            << " feature bricks computed" << std::endl;
+}
+
+
+
+
+/************************************
+ *
+ *  Use the bricked evolution
+ *
+ ***********************************/
+void
+ThresholdSegmentationLevelSetBase 
+::SetUseBrickedLevelSet( bool value )
+{
+  m_UseBrickedLevelSet = value;
+}
+
+
+
+
+/************************************
+ *
+ *  Segmented image
+ *
+ ***********************************/
+ThresholdSegmentationLevelSetBase::InternalImageType *
+ThresholdSegmentationLevelSetBase 
+::GetSegmentedImage( void )
+{
+  if( m_BrickedSegmentedImage )
+    {
+    return m_BrickedSegmentedImage;
+    }
+  return m_ThresholdLevelSetFilter->GetOutput();
+}
+
+
+
+
 /************************************
  *
  *  Stop Registration
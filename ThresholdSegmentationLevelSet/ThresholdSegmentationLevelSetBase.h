@@ -23,6 +23,7 @@
 #include "itkImage.h"
 #include "itkCastImageFilter.h"
 #include "itkThresholdSegmentationLevelSetImageFilter.h"
+#include "itkBrickedLevelSetEvolution.h"
 
 
 /**
@@ -64,11 +65,21 @@ public:
                  InputImageType, 
                  InternalImageType >     CastImageFilterType;
 
+  /** Cast filter for the seeds, the level set holds signed values */
+  typedef   itk::CastImageFilter< 
+                 SeedImageType, 
+                 InternalImageType >     SeedCastImageFilterType;
+
   /** Curvature flow image filter for producing homogeneous regions */
   typedef   itk::ThresholdSegmentationLevelSetImageFilter< 
-                 SeedImageType, 
+                 InternalImageType, 
                  InternalImageType >     ThresholdLevelSetImageFilterType;
 
+  /** Runs the level set on the bricks of the volume around the front */
+  typedef   itk::BrickedLevelSetEvolution< 
+                 ThresholdLevelSetImageFilterType, 
+                 SeedImageType >         BrickedEvolutionType;
+
 public:
   ThresholdSegmentationLevelSetBase();
   virtual ~ThresholdSegmentationLevelSetBase();
@@ -82,6 +93,14 @@ public:
 
   virtual void AddSeed( const SeedImageType::IndexType & seed );
 
+  /** Run the level set on the whole volume, or on bricks around the seeds */
+  virtual void RunSegmentation(void);
+
+  virtual void SetUseBrickedLevelSet( bool value );
+
+  /** Level set over the whole volume */
+  InternalImageType * GetSegmentedImage(void);
+
 protected:
 
   ImageReaderType::Pointer                    m_ImageReader;
@@ -90,8 +109,16 @@ protected:
 
   CastImageFilterType::Pointer                m_CastImageFilter;
 
+  SeedCastImageFilterType::Pointer            m_SeedCastImageFilter;
+
   ThresholdLevelSetImageFilterType::Pointer   m_ThresholdLevelSetFilter;
 
+  BrickedEvolutionType::Pointer               m_BrickedEvolution;
+
+  bool                                        m_UseBrickedLevelSet;
+
+  InternalImageType::Pointer                  m_BrickedSegmentedImage;
+
   SeedImageType::Pointer                      m_SeedImage;
 
   SeedImageType::PixelType                    m_SeedValue;
@@ -75,6 +75,9 @@ SegmenterConsole
   updateIterations->step(1);
   updateIterations->value(1);
 
+  checkpointPeriod->value(0);
+  continueIterations->value(100);
+
   progressBar->minimum(0.0);
   progressBar->maximum(1.0);
   progressBar->value(0.0);
@@ -98,6 +101,8 @@ SegmenterConsole
   loadingSession = false;
   inputFilename = "";
   seedFilename = "";
+  segmentationStarted = false;
+  checkpointFilename = "";
 
   // set up the segmentation observer
   typedef itk::SimpleMemberCommand< SegmenterConsole > SimpleCommandType;
@@ -337,6 +342,7 @@ SegmenterConsole::SmoothImage()
     {
     // Triggers updates in m_Reader, m_Curvature, and m_InputCaster
     this->ResetAllParameters();
+    this->InvalidateSegmentation();
     m_InputCaster->UpdateLargestPossibleRegion();
     }
   catch( ... ) 
@@ -396,6 +402,10 @@ SegmenterConsole::ShowSpeedImage()
   if ( maxThresh2->value() >= minThresh2->value() )
     {
     this->ResetAllParameters();
+
+    // The speed image is only computed again from an uninitialized state,
+    // and this update replaces the level set kept by the filter
+    this->InvalidateSegmentation();
     
     // Only run one iteration
     m_thresholdSegmentation->SetNumberOfIterations( 0 );
@@ -490,6 +500,8 @@ SegmenterConsole::ResetAllParameters()
 
 void SegmenterConsole::SetThresholdSegmentationInput()
 {
+  this->InvalidateSegmentation();
+
   switch( m_filterCase )
     {
     case 1:
@@ -545,6 +557,38 @@ SegmenterConsole::ShowSegmentedImage(void)
   // Pick the correct input from the radio buttons
   this->SetThresholdSegmentationInput();
 
+  m_checkpointCommand->SetIterationOffset(0);
+  this->RunSegmentation(true);
+}
+
+/***********************************
+ *
+ * RunSegmentation
+ *
+ **********************************/
+void 
+SegmenterConsole::RunSegmentation(bool reinitialize)
+{
+  // the filter keeps its level set between two runs unless it is told to
+  // start again from its input
+  if (reinitialize)
+    {
+    m_thresholdSegmentation->SetStateToUninitialized();
+    }
+  m_thresholdSegmentation->AbortGenerateDataOff();
+
+  const unsigned int period = (unsigned int)checkpointPeriod->value();
+  if (period > 0 && checkpointFilename == "")
+    {
+    const char * filename = fl_file_chooser("Checkpoint filename","*.lsc","");
+    if (filename)
+      {
+      checkpointFilename = filename;
+      }
+    }
+  m_checkpointCommand->SetFileName(checkpointFilename.c_str());
+  m_checkpointCommand->SetPeriod(period);
+
   try
     {
     // Execute the pipline
@@ -556,6 +600,12 @@ SegmenterConsole::ShowSegmentedImage(void)
     std::cerr << "Exception caught !" << std::endl;
     std::cerr << excep << std::endl;
     }
+
+  segmentationStarted = true;
+  elapsedIterations->value(m_checkpointCommand->GetIterationOffset()
+                           + m_thresholdSegmentation->GetElapsedIterations());
+  lastRMSChange->value(m_thresholdSegmentation->GetRMSChange());
+  m_checkpointCommand->Report(std::cout);
   
   // activate segmented saving options
   save->activate();
@@ -571,6 +621,7 @@ void
 SegmenterConsole::SwitchCase(int c)
 {
   this->ClearThresh();
+  this->InvalidateSegmentation();
   
   // uncheck option to be in threshold drawing mode
   m_filterCase = c;
@@ -641,6 +692,8 @@ SegmenterConsole::LoadSeedImage()
     std::cerr << excep << std::endl;
     }
   
+  this->InvalidateSegmentation();
+
   // calculate the min and max to determine a good isosurface
   m_minMax->SetImage(m_SeedReader->GetOutput());
   try
@@ -717,7 +770,7 @@ void SegmenterConsole::GetClickPoints(float x, float y)
     case 2: // setting x and y seed points
       seedX->value(x);
       seedY->value(y);
-      m_thresholdSegmentation->Modified();
+      this->InvalidateSegmentation();
       break;
     case 3: // drawing initial segmentation guess
       m_InputViewer->SetOverlay( m_image );
@@ -855,10 +908,11 @@ void SegmenterConsole::UpdateViewerAfterIteration()
     m_InputViewer->Update();
     Fl::check();
     
-    elapsedIterations->value(m_thresholdSegmentation->GetElapsedIterations());
+    elapsedIterations->value(m_checkpointCommand->GetIterationOffset()
+                             + m_thresholdSegmentation->GetElapsedIterations());
     lastRMSChange->value(m_thresholdSegmentation->GetRMSChange());
     progressBar->value( m_thresholdSegmentation->GetElapsedIterations()
-                        / maxIterations->value() );
+                        / (double)m_thresholdSegmentation->GetNumberOfIterations() );
     }
   iterationCounter++;
 }
@@ -1087,8 +1141,24 @@ void SegmenterConsole::ChangeMaxThresh(float val)
  *****************************/
 void SegmenterConsole::SetThresholdFilterToModified()
 {
-  // this is mainly used when parameters are changed
+  // this is mainly used when parameters are changed; the edge weight and
+  // the smoothing change the speed image
+  this->InvalidateSegmentation();
+}
+
+/*****************************
+ *
+ * InvalidateSegmentation
+ *
+ *****************************/
+void SegmenterConsole::InvalidateSegmentation()
+{
+  // With ManualReinitialization on, the filter keeps its level set and
+  // its speed image until it is uninitialized: the next update starts
+  // again from the input, and "Continue" needs a new segmentation.
+  m_thresholdSegmentation->SetStateToUninitialized();
   m_thresholdSegmentation->Modified();
+  segmentationStarted = false;
 }
 
 /****************************
@@ -1294,3 +1364,119 @@ void SegmenterConsole::LoadSession()
   in.close();
   loadingSession = false;
 }
+
+/****************************
+ *
+ * SaveCheckpoint
+ *
+ ****************************/
+void SegmenterConsole::SaveCheckpoint()
+{
+  if(!segmentationStarted)
+    {
+    fl_alert("Error! Please run a segmentation first.");
+    return;
+    }
+
+  const char * filename = fl_file_chooser("Checkpoint filename","*.lsc",
+                                          checkpointFilename.c_str());
+  if( !filename )
+    {
+    return;
+    }
+
+  // the periodic checkpoints go to the same file from now on
+  checkpointFilename = filename;
+  m_checkpointCommand->SetFileName(filename);
+  try
+    {
+    m_checkpointCommand->WriteCheckpoint(m_thresholdSegmentation);
+    }
+  catch( itk::ExceptionObject & excep )
+    {
+    std::cerr << "Exception caught !" << std::endl;
+    std::cerr << excep << std::endl;
+    fl_alert("Error! The checkpoint could not be written.");
+    return;
+    }
+  m_checkpointCommand->Report(std::cout);
+}
+
+/****************************
+ *
+ * ResumeCheckpoint
+ *
+ ****************************/
+void SegmenterConsole::ResumeCheckpoint()
+{
+  if (m_Reader->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() == 0)
+    {
+    fl_alert("Error! Please load the input image first.");
+    return;
+    }
+
+  const char * filename = fl_file_chooser("Checkpoint filename","*.lsc","");
+  if( !filename )
+    {
+    return;
+    }
+
+  CheckpointType::Pointer checkpoint = CheckpointType::New();
+  try
+    {
+    checkpoint->Read(filename);
+    }
+  catch( itk::ExceptionObject & excep )
+    {
+    std::cerr << "Exception caught !" << std::endl;
+    std::cerr << excep << std::endl;
+    fl_alert("Error! The checkpoint could not be read.");
+    return;
+    }
+
+  if (checkpoint->GetLevelSet()->GetLargestPossibleRegion() !=
+      m_Reader->GetOutput()->GetLargestPossibleRegion())
+    {
+    fl_alert("Error! The checkpoint does not match the input image.");
+    return;
+    }
+
+  // Start from the saved level set, whose isosurface is at 0. Maximum
+  // Iterations counts from the initial level set of the checkpoint.
+  this->ResetAllParameters();
+  m_checkpointImage = checkpoint->GetLevelSet();
+  m_thresholdSegmentation->SetInput(m_checkpointImage);
+  m_thresholdSegmentation->SetIsoSurfaceValue(0.0);
+
+  const unsigned long elapsed = checkpoint->GetElapsedIterations();
+  const unsigned long total = (unsigned long)maxIterations->value();
+  m_thresholdSegmentation->SetNumberOfIterations(total > elapsed ? total - elapsed : 0);
+  m_checkpointCommand->SetIterationOffset(elapsed);
+
+  checkpointFilename = filename;
+  this->RunSegmentation(true);
+}
+
+/****************************
+ *
+ * ContinueSegmentation
+ *
+ ****************************/
+void SegmenterConsole::ContinueSegmentation()
+{
+  if(!segmentationStarted)
+    {
+    fl_alert("Error! Please run a segmentation first.");
+    return;
+    }
+
+  // The filter kept its layers and its speed image, so it goes on from
+  // where it stopped. Only the number of iterations is changed; a
+  // convergence already reached through the RMS change stops it again.
+  m_thresholdSegmentation->SetNumberOfIterations(
+          m_thresholdSegmentation->GetElapsedIterations()
+          + (unsigned int)continueIterations->value() );
+  m_thresholdSegmentation->Modified();
+
+  this->RunSegmentation(false);
+}
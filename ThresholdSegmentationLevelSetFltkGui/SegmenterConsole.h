@@ -69,6 +69,9 @@ public:
   virtual void SetThresholdFilterToModified();
   virtual void SaveSession();
   virtual void LoadSession();
+  virtual void SaveCheckpoint();
+  virtual void ResumeCheckpoint();
+  virtual void ContinueSegmentation();
   
   static void ClickSelectCallback(float x, float y, float z, float value, void * args );
 
@@ -76,6 +79,8 @@ private:
   void ResetAllParameters();
   void SetThresholdSegmentationInput();
   void SetThresholdRange(const InputImageType *);
+  void RunSegmentation(bool reinitialize);
+  void InvalidateSegmentation();
 
   InputImageViewerType*      m_InputViewer;
   SeedViewerType*            m_SeedViewer;
@@ -93,6 +98,9 @@ private:
   bool loadingSession;
   std::string inputFilename;
   std::string seedFilename;
+
+  bool segmentationStarted;
+  std::string checkpointFilename;
 };
 
 
@@ -38,6 +38,7 @@ SegmenterConsoleBase
   m_thresholder  = BinaryThresholdType::New();
   m_fastMarching = FastMarchingFilterType::New();
   m_thresholdSegmentation = ThresholdSegmentationLevelSetImageFilterType::New();
+  m_checkpointCommand = CheckpointCommandType::New();
   
   m_segmentWriter = SegmentWriterType::New();
   m_maskWriter = BinaryWriterType::New();
@@ -72,6 +73,14 @@ SegmenterConsoleBase
   m_SeedCaster->SetInput(m_SeedReader->GetOutput());
   m_segmentWriter->SetInput(m_thresholdSegmentation->GetOutput());
   m_maskWriter->SetInput(m_maskThresh->GetOutput());
+
+  // Keep the state of the level set between two updates so that an
+  // evolution can be continued without rebuilding the initial level set.
+  // The output must then not be released before the filter runs again.
+  m_thresholdSegmentation->ManualReinitializationOn();
+  m_thresholdSegmentation->ReleaseDataBeforeUpdateFlagOff();
+  m_thresholdSegmentation->AddObserver( itk::StartEvent(), m_checkpointCommand );
+  m_thresholdSegmentation->AddObserver( itk::IterationEvent(), m_checkpointCommand );
 }
 
 /************************************
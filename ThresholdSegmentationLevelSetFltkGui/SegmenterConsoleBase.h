@@ -26,6 +26,8 @@
 #include <itkCastImageFilter.h>
 #include <itkBinaryThresholdImageFilter.h>
 #include <itkMinimumMaximumImageCalculator.h>
+#include <itkLevelSetCheckpoint.h>
+#include <itkLevelSetCheckpointCommand.h>
 
 /**
  * \class SegmenterConsoleBase
@@ -91,6 +93,11 @@ public:
 
   typedef   itk::MinimumMaximumImageCalculator<InputImageType> CalculatorType;
 
+  typedef   itk::LevelSetCheckpoint<InputImageType>  CheckpointType;
+  typedef   itk::LevelSetCheckpointCommand<
+                  ThresholdSegmentationLevelSetImageFilterType >
+                                                     CheckpointCommandType;
+
   SegmenterConsoleBase();
   virtual ~SegmenterConsoleBase();
   
@@ -104,6 +111,11 @@ protected:
 
   ThresholdSegmentationLevelSetImageFilterType::Pointer          m_thresholdSegmentation;
 
+  // periodic checkpoints of m_thresholdSegmentation, and the level set
+  // of the checkpoint it was resumed from
+  CheckpointCommandType::Pointer                                 m_checkpointCommand;
+  InputImageType::Pointer                                        m_checkpointImage;
+
   WriteCasterType::Pointer                                       m_writerCaster;
   SegmentWriterType::Pointer                                     m_segmentWriter;
   BinaryWriterType::Pointer                                      m_maskWriter;
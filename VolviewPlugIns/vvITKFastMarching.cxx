@@ -4,7 +4,7 @@
 
 #include "vvITKFilterModule.h"
 
-#include "itkFastMarchingImageFilter.h"
+#include "itkFastIterativeMarchingImageFilter.h"
 
 
 template <class InputPixelType>
@@ -18,7 +18,7 @@ class FastMarchingRunner
       typedef  typename ImageType::IndexType        IndexType;
       typedef  typename ImageType::SizeType         SizeType;
 
-      typedef  itk::FastMarchingImageFilter< 
+      typedef  itk::FastIterativeMarchingImageFilter< 
                                     TimeImageType,  
                                     ImageType >     FilterType;
 
@@ -35,6 +35,7 @@ class FastMarchingRunner
     {
       const float stoppingValue         = atof( info->GetGUIProperty(info, 0, VVP_GUI_VALUE ));
       const float normalizationFactor   = atof( info->GetGUIProperty(info, 1, VVP_GUI_VALUE ));
+      const bool  fastIterative         = atoi( info->GetGUIProperty(info, 2, VVP_GUI_VALUE ));
 
       const unsigned int numberOfSeeds = info->NumberOfMarkers;
 
@@ -57,6 +58,7 @@ class FastMarchingRunner
       // Set the parameters on it
       module.GetFilter()->SetStoppingValue(  stoppingValue );
       module.GetFilter()->SetNormalizationFactor( normalizationFactor );
+      module.GetFilter()->SetUseFastIterativeMethod( fastIterative );
       NodeType node;
       node.SetValue( static_cast< NodePixelType >( seedValue ) );
       for(unsigned int i=0; i< numberOfSeeds; i++)
@@ -187,6 +189,11 @@ static int UpdateGUI(void *inf)
   info->SetGUIProperty(info, 1, VVP_GUI_HELP, "Factor to be used for dividing the pixel values of the speed image. This allows to use images of integer pixel type for representing the speed. The normalization should map the values of the integer image into the range [0,1]");
   info->SetGUIProperty(info, 1, VVP_GUI_HINTS , VolView::PlugIn::FilterModuleBase::GetInputVolumeScalarTypeRange( info ) );
 
+  info->SetGUIProperty(info, 2, VVP_GUI_LABEL, "Parallel propagation");
+  info->SetGUIProperty(info, 2, VVP_GUI_TYPE, VVP_GUI_CHECKBOX);
+  info->SetGUIProperty(info, 2, VVP_GUI_DEFAULT, "0");
+  info->SetGUIProperty(info, 2, VVP_GUI_HELP, "Compute the arrival times with the fast iterative method, which updates slabs of the volume in parallel, instead of the sequential heap of Fast Marching. The times agree with the heap up to a small tolerance.");
+
   info->SetProperty(info, VVP_REQUIRED_Z_OVERLAP, "0");
   
   info->OutputVolumeScalarType = VTK_UNSIGNED_SHORT;
@@ -221,7 +228,7 @@ void VV_PLUGIN_EXPORT vvITKFastMarchingInit(vtkVVPluginInfo *info)
 
   info->SetProperty(info, VVP_SUPPORTS_IN_PLACE_PROCESSING, "0");
   info->SetProperty(info, VVP_SUPPORTS_PROCESSING_PIECES,   "0");
-  info->SetProperty(info, VVP_NUMBER_OF_GUI_ITEMS,          "2");
+  info->SetProperty(info, VVP_NUMBER_OF_GUI_ITEMS,          "3");
   info->SetProperty(info, VVP_REQUIRED_Z_OVERLAP,           "0");
   info->SetProperty(info, VVP_PER_VOXEL_MEMORY_REQUIRED,    "2");
 
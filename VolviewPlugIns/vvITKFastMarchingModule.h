@@ -10,12 +10,13 @@
 #include <stdlib.h>
 
 #include "vvITKFilterModuleBase.h"
+#include "vvITKSessionCache.h"
 
 #include "itkImage.h"
 #include "itkImportImageFilter.h"
 #include "itkGradientMagnitudeRecursiveGaussianImageFilter.h"
 #include "itkSigmoidImageFilter.h"
-#include "itkFastMarchingImageFilter.h"
+#include "itkFastIterativeMarchingImageFilter.h"
 #include "itkIntensityWindowingImageFilter.h"
 #include "itkImageRegionConstIterator.h"
 
@@ -81,8 +82,9 @@ public:
   // Instantiation of the FastMarching filter.
   // This filter computes the propagation of the fron starting
   // at the seed points.  The input of the filter is the speed image.
-  // The output is a time-crossing map.
-  typedef itk::FastMarchingImageFilter< RealImageType,
+  // The output is a time-crossing map. The arrival times can be
+  // computed with the heap or with the parallel fast iterative method.
+  typedef itk::FastIterativeMarchingImageFilter< RealImageType,
                                         SpeedImageType >  FastMarchingFilterType;
 
 
@@ -113,6 +115,7 @@ public:
     void SetLowestBorderValue( float value );
     void SetLowestBasinValue(  float value );
     void SetInitialSeedValue(  float value );
+    void SetUseFastIterativeMethod( bool value );
 
     void ProcessData( const vtkVVProcessDataStruct * pds );
     void PostProcessData( const vtkVVProcessDataStruct * pds );
@@ -150,6 +153,13 @@ private:
     typename IntensityWindowingFilterType::Pointer  m_IntensityWindowingFilter;
 
     typename NodeContainerType::Pointer             m_NodeContainer;
+
+    // Results of the stages, computed or taken from the SessionCache
+    typename RealImageType::Pointer                 m_GradientImage;
+    typename SpeedImageType::Pointer                m_SpeedImage;
+    typename RealImageType::Pointer                 m_LevelSetImage;
+
+    float                                           m_Sigma;
     
     double                                          m_InitialSeedValue;
  
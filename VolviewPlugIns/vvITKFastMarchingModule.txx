@@ -29,6 +29,8 @@ FastMarchingModule<TInputPixelType>
 
     m_InitialSeedValue        = 0.0;
 
+    m_Sigma                   = 1.0;
+
     m_PerformPostprocessing   = true;
 
     m_ProgressWeighting = 1.0;
@@ -121,6 +123,19 @@ FastMarchingModule<TInputPixelType>
 
 
 
+/*
+ *  Choose the parallel fast iterative method instead of the heap
+ */
+template <class TInputPixelType >
+void 
+FastMarchingModule<TInputPixelType>
+::SetUseFastIterativeMethod( bool value )
+{
+  m_FastMarchingFilter->SetUseFastIterativeMethod( value );
+}
+
+
+
 /*
  *  Set the Sigma value for the Gradient Magnitude filter
  */
@@ -129,6 +144,7 @@ void
 FastMarchingModule<TInputPixelType>
 ::SetSigma( float value )
 {
+  m_Sigma = value;
   m_GradientMagnitudeFilter->SetSigma( value );
 }
 
@@ -206,6 +222,10 @@ const typename FastMarchingModule<TInputPixelType>::RealImageType *
 FastMarchingModule<TInputPixelType>
 ::GetLevelSet()
 {
+   if( m_LevelSetImage )
+     {
+     return m_LevelSetImage;
+     }
    return m_FastMarchingFilter->GetOutput();
 }
 
@@ -224,6 +244,10 @@ const typename FastMarchingModule<TInputPixelType>::SpeedImageType *
 FastMarchingModule<TInputPixelType>
 ::GetSpeedImage()
 {
+   if( m_SpeedImage )
+     {
+     return m_SpeedImage;
+     }
    return m_SigmoidFilter->GetOutput();
 }
 
@@ -301,18 +325,91 @@ FastMarchingModule<TInputPixelType>
   m_SigmoidFilter->AddObserver( itk::StartEvent(), this->GetCommandObserver() );
   m_SigmoidFilter->AddObserver( itk::EndEvent(), this->GetCommandObserver() );
 
+  // Each stage is looked up in the SessionCache under a key made of the
+  // input and of the parameters it depends on, and only computed when 
+  // missing. Computed images are detached from their filter so that they
+  // outlive this module.
+  SessionCache & cache = SessionCache::GetInstance();
+  const unsigned long realImageBytes = 
+                        totalNumberOfPixels * sizeof( RealPixelType );
+
+  std::ostringstream gradientKey;
+  gradientKey << SessionCache::GetInputKey( info, pds )
+              << " | gradient " << m_Sigma;
+
+  std::ostringstream speedKey;
+  speedKey << gradientKey.str() << " | sigmoid " 
+           << m_SigmoidFilter->GetAlpha() << " " 
+           << m_SigmoidFilter->GetBeta();
+
+  std::ostringstream levelSetKey;
+  levelSetKey << speedKey.str() << " | fastmarching "
+              << m_FastMarchingFilter->GetStoppingValue() << " "
+              << m_FastMarchingFilter->GetNormalizationFactor() << " "
+              << m_FastMarchingFilter->GetUseFastIterativeMethod();
+  typename NodeContainerType::Iterator node = m_NodeContainer->Begin();
+  while( node != m_NodeContainer->End() )
+    {
+    levelSetKey << " " << node.Value().GetIndex() 
+                << " " << node.Value().GetValue();
+    ++node;
+    }
+
   // Execute the filters and progressively remove temporary memory
   this->SetUpdateMessage("Preprocessing with gradient magnitude...");
   this->SetCurrentFilterProgressWeight( 0.5 * m_ProgressWeighting );
-  m_GradientMagnitudeFilter->Update();
+  m_GradientImage = dynamic_cast< RealImageType * >( 
+                                    cache.Find( gradientKey.str() ) );
+  if( m_GradientImage )
+    {
+    this->SkipCurrentFilter();
+    }
+  else
+    {
+    m_GradientMagnitudeFilter->Update();
+    m_GradientImage = m_GradientMagnitudeFilter->GetOutput();
+    m_GradientImage->DisconnectPipeline();
+    m_GradientImage->ReleaseDataFlagOff();
+    cache.Insert( gradientKey.str(), m_GradientImage, realImageBytes );
+    }
+  m_SigmoidFilter->SetInput( m_GradientImage );
 
   this->SetCurrentFilterProgressWeight( 0.1 * m_ProgressWeighting );
   this->SetUpdateMessage("Preprocessing with sigmoid...");
-  m_SigmoidFilter->Update();
+  m_SpeedImage = dynamic_cast< SpeedImageType * >( 
+                                    cache.Find( speedKey.str() ) );
+  if( m_SpeedImage )
+    {
+    this->SkipCurrentFilter();
+    }
+  else
+    {
+    m_SigmoidFilter->Update();
+    m_SpeedImage = m_SigmoidFilter->GetOutput();
+    m_SpeedImage->DisconnectPipeline();
+    m_SpeedImage->ReleaseDataFlagOff();
+    cache.Insert( speedKey.str(), m_SpeedImage, 
+                  totalNumberOfPixels * sizeof( SpeedPixelType ) );
+    }
+  m_FastMarchingFilter->SetInput( m_SpeedImage );
 
   this->SetCurrentFilterProgressWeight( 0.4 * m_ProgressWeighting );
   this->SetUpdateMessage("Computing Fast Marching...");
-  m_FastMarchingFilter->Update();
+  m_LevelSetImage = dynamic_cast< RealImageType * >( 
+                                    cache.Find( levelSetKey.str() ) );
+  if( m_LevelSetImage )
+    {
+    this->SkipCurrentFilter();
+    }
+  else
+    {
+    m_FastMarchingFilter->Update();
+    m_LevelSetImage = m_FastMarchingFilter->GetOutput();
+    m_LevelSetImage->DisconnectPipeline();
+    m_LevelSetImage->ReleaseDataFlagOff();
+    cache.Insert( levelSetKey.str(), m_LevelSetImage, realImageBytes );
+    }
+  m_IntensityWindowingFilter->SetInput( m_LevelSetImage );
 
   if( m_PerformPostprocessing )
     {
@@ -239,6 +239,14 @@ const char * GetInputVolumeScalarTypeRangeFraction( const vtkVVPluginInfo  * inf
   }
 
 
+  /** Account for the progress of a filter that does not need to run
+      because its output was found in the SessionCache. */
+  void SkipCurrentFilter()
+  {
+     m_CumulatedProgress += m_CurrentFilterProgressWeight;
+  }
+
+
   void SetProcessComponentsIndependetly( bool independentProcessing )
   {
      m_ProcessComponentsIndependetly = independentProcessing;
@@ -250,6 +250,11 @@ GeodesicActiveContourModule<TInputPixelType>
   m_FastMarchingModule.SetProgressWeighting( 0.7 );
   m_FastMarchingModule.ProcessData( pds );
 
+  // The level set and speed images may come from the SessionCache
+  // instead of the filters connected in the constructor.
+  m_GeodesicActiveContourFilter->SetInput(        m_FastMarchingModule.GetLevelSet() );
+  m_GeodesicActiveContourFilter->SetFeatureImage( m_FastMarchingModule.GetSpeedImage()   );
+
   // Since Fast Marching updates progress with another
   // instantiation of FilterModuleBase, the current 
   // progress here must be manually set up to the 
@@ -0,0 +1,222 @@
+/** Cache of intermediate results kept by a plug-in between two
+    executions, so that changing a parameter only recomputes the
+    stages that depend on it. */
+
+#ifndef _vvITKSessionCache_h
+#define _vvITKSessionCache_h
+
+#include "vtkVVPluginAPI.h"
+
+#include "itkLightObject.h"
+
+#include <string>
+#include <list>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+
+namespace VolView
+{
+
+namespace PlugIn
+{
+
+/**
+ *  Objects (images, or filters holding internal state such as the
+ *  watershed segment tree) stored under a string key. The key of a stage
+ *  is made of the key of the input volume followed by the parameters of
+ *  that stage and of the stages before it.
+ *
+ *  The objects are kept up to a maximum amount of memory, by default
+ *  512 Mb or the number of Mb given by the VV_ITK_SESSION_CACHE_MEMORY
+ *  environment variable (0 disables the cache). When full, the least
+ *  recently used objects are released first.
+ *
+ *  There is one cache per plug-in library.
+ */
+class SessionCache {
+
+public:
+
+  typedef itk::LightObject   ObjectType;
+
+  static SessionCache & GetInstance()
+  {
+    static SessionCache cache;
+    return cache;
+  }
+
+
+  /**  Key identifying the input volume of the current execution: the
+       buffer address and geometry, and a checksum of the whole buffer
+       that stands for a modification time, which the plug-in API does
+       not provide. Every voxel is hashed, so that a local edit of the
+       volume changes the key. */
+  static std::string GetInputKey( const vtkVVPluginInfo * info,
+                                  const vtkVVProcessDataStruct * pds )
+  {
+    const unsigned long numberOfVoxels =
+                      static_cast< unsigned long >( info->InputVolumeDimensions[0] )
+                    * info->InputVolumeDimensions[1]
+                    * info->InputVolumeDimensions[2]
+                    * info->InputVolumeNumberOfComponents;
+    const unsigned long numberOfBytes = numberOfVoxels
+                    * info->InputVolumeScalarSize;
+
+    // FNV-1a over 32 bit words, then over the remaining bytes
+    const unsigned char * data =
+                    static_cast< const unsigned char * >( pds->inData );
+    const unsigned long numberOfWords = numberOfBytes / 4;
+    unsigned long checksum = 2166136261UL;
+    for( unsigned long i = 0; i < numberOfWords; i++ )
+      {
+      unsigned int word;
+      memcpy( &word, data + 4 * i, 4 );
+      checksum = ( ( checksum ^ word ) * 16777619UL ) & 0xffffffffUL;
+      }
+    for( unsigned long i = 4 * numberOfWords; i < numberOfBytes; i++ )
+      {
+      checksum = ( ( checksum ^ data[i] ) * 16777619UL ) & 0xffffffffUL;
+      }
+
+    std::ostringstream key;
+    key << pds->inData << " " << pds->StartSlice << " "
+        << info->InputVolumeScalarType << " "
+        << info->InputVolumeNumberOfComponents;
+    for( unsigned int i = 0; i < 3; i++ )
+      {
+      key << " " << info->InputVolumeDimensions[i]
+          << " " << info->InputVolumeSpacing[i]
+          << " " << info->InputVolumeOrigin[i];
+      }
+    key << " " << checksum;
+    return key.str();
+  }
+
+
+  /**  Object stored under key, or null. A found object becomes the most
+       recently used. */
+  ObjectType * Find( const std::string & key )
+  {
+    EntryIterator entry = m_Entries.begin();
+    while( entry != m_Entries.end() )
+      {
+      if( entry->Key == key )
+        {
+        m_Entries.splice( m_Entries.begin(), m_Entries, entry );
+        return m_Entries.front().Object;
+        }
+      ++entry;
+      }
+    return 0;
+  }
+
+
+  /**  Store object under key, with the number of bytes it holds,
+       including the inputs it keeps alive. Least
+       recently used objects are released to make room for it; an object
+       larger than the whole cache is not stored. */
+  void Insert( const std::string & key, ObjectType * object,
+               unsigned long bytes )
+  {
+    this->Remove( key );
+    if( bytes > m_MaximumMemory )
+      {
+      return;
+      }
+    while( m_Memory + bytes > m_MaximumMemory && !m_Entries.empty() )
+      {
+      m_Memory -= m_Entries.back().Bytes;
+      m_Entries.pop_back();
+      }
+    Entry entry;
+    entry.Key    = key;
+    entry.Object = object;
+    entry.Bytes  = bytes;
+    m_Entries.push_front( entry );
+    m_Memory += bytes;
+  }
+
+
+  void Remove( const std::string & key )
+  {
+    EntryIterator entry = m_Entries.begin();
+    while( entry != m_Entries.end() )
+      {
+      if( entry->Key == key )
+        {
+        m_Memory -= entry->Bytes;
+        m_Entries.erase( entry );
+        return;
+        }
+      ++entry;
+      }
+  }
+
+
+  void Clear()
+  {
+    m_Entries.clear();
+    m_Memory = 0;
+  }
+
+
+  void SetMaximumMemory( unsigned long bytes )
+  {
+    m_MaximumMemory = bytes;
+    while( m_Memory > m_MaximumMemory && !m_Entries.empty() )
+      {
+      m_Memory -= m_Entries.back().Bytes;
+      m_Entries.pop_back();
+      }
+  }
+
+  unsigned long GetMaximumMemory() const
+  {
+    return m_MaximumMemory;
+  }
+
+  unsigned long GetMemory() const
+  {
+    return m_Memory;
+  }
+
+
+private:
+
+  struct Entry
+    {
+    std::string             Key;
+    ObjectType::Pointer     Object;
+    unsigned long           Bytes;
+    };
+
+  typedef std::list< Entry >            EntryListType;
+  typedef EntryListType::iterator       EntryIterator;
+
+  SessionCache()
+  {
+    m_Memory = 0;
+    m_MaximumMemory = 512UL * 1024UL * 1024UL;
+    const char * memory = getenv( "VV_ITK_SESSION_CACHE_MEMORY" );
+    if( memory )
+      {
+      m_MaximumMemory = strtoul( memory, 0, 10 ) * 1024UL * 1024UL;
+      }
+  }
+
+  SessionCache( const SessionCache & ); // purposely not implemented
+  void operator=( const SessionCache & ); // purposely not implemented
+
+  EntryListType       m_Entries;
+  unsigned long       m_Memory;
+  unsigned long       m_MaximumMemory;
+
+};
+
+
+} // end namespace PlugIn
+
+} // end namespace VolView
+
+#endif
@@ -235,6 +235,11 @@ ShapeDetectionModule<TInputPixelType>
   m_FastMarchingModule.SetProgressWeighting( 0.7 );
   m_FastMarchingModule.ProcessData( pds );
 
+  // The level set and speed images may come from the SessionCache
+  // instead of the filters connected in the constructor.
+  m_ShapeDetectionFilter->SetInput(        m_FastMarchingModule.GetLevelSet() );
+  m_ShapeDetectionFilter->SetFeatureImage( m_FastMarchingModule.GetSpeedImage()   );
+
   // Since Fast Marching updates progress with another
   // instantiation of FilterModuleBase, the current 
   // progress here must be manually set up to the 
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 
 #include "vvITKFilterModuleBase.h"
+#include "vvITKSessionCache.h"
 
 #include "itkImage.h"
 #include "itkImportImageFilter.h"
@@ -98,7 +99,14 @@ private:
     typename GradientMagnitudeFilterType::Pointer   m_GradientMagnitudeFilter;
     typename WatershedFilterType::Pointer           m_WatershedFilter;
 
+    // Gradient magnitude, computed or taken from the SessionCache
+    typename RealImageType::Pointer                 m_GradientImage;
+
     SeedsContainerType                              m_Seeds;
+
+    float                                           m_Sigma;
+    float                                           m_Threshold;
+    float                                           m_WaterLevel;
     
     bool                                            m_PerformPostprocessing;
 
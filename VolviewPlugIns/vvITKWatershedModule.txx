@@ -29,6 +29,10 @@ WatershedModule<TInputPixelType>
 
     m_PerformPostprocessing   = true;
 
+    m_Sigma                   = 1.0;
+    m_Threshold               = 0.0;
+    m_WaterLevel              = 0.0;
+
 
     // Set up the pipeline
     m_GradientMagnitudeFilter->SetInput(  m_ImportFilter->GetOutput() );
@@ -81,6 +85,7 @@ void
 WatershedModule<TInputPixelType>
 ::SetSigma( float value )
 {
+  m_Sigma = value;
   m_GradientMagnitudeFilter->SetSigma( value );
 }
 
@@ -95,7 +100,7 @@ void
 WatershedModule<TInputPixelType>
 ::SetThreshold( float value )
 {
-  m_WatershedFilter->SetThreshold( value );
+  m_Threshold = value;
 }
 
 
@@ -109,7 +114,7 @@ void
 WatershedModule<TInputPixelType>
 ::SetWaterLevel( float value )
 {
-  m_WatershedFilter->SetLevel( value );
+  m_WaterLevel = value;
 }
 
 
@@ -189,6 +194,33 @@ WatershedModule<TInputPixelType>
                                     totalNumberOfPixels,
                                     importFilterWillDeleteTheInputBuffer );
 
+  // The gradient magnitude depends on the input and sigma. The watershed
+  // filter is cached as a whole, keyed by the gradient and the threshold:
+  // it keeps its segment tree, so that a new water level only relabels
+  // the basins.
+  SessionCache & cache = SessionCache::GetInstance();
+
+  std::ostringstream gradientKey;
+  gradientKey << SessionCache::GetInputKey( info, pds )
+              << " | gradient " << m_Sigma;
+
+  std::ostringstream watershedKey;
+  watershedKey << gradientKey.str() << " | watershed " << m_Threshold;
+
+  m_GradientImage = dynamic_cast< RealImageType * >( 
+                                    cache.Find( gradientKey.str() ) );
+
+  WatershedFilterType * cachedWatershedFilter = 
+    dynamic_cast< WatershedFilterType * >( cache.Find( watershedKey.str() ) );
+  if( m_GradientImage && cachedWatershedFilter )
+    {
+    // Drop the observers of the module that ran it before
+    m_WatershedFilter = cachedWatershedFilter;
+    m_WatershedFilter->RemoveAllObservers();
+    }
+  m_WatershedFilter->SetThreshold( m_Threshold );
+  m_WatershedFilter->SetLevel( m_WaterLevel );
+
   // Set the Observer for updating progress in the GUI
   m_GradientMagnitudeFilter->AddObserver( itk::ProgressEvent(), this->GetCommandObserver() );
   m_WatershedFilter->AddObserver( itk::ProgressEvent(), this->GetCommandObserver() );
@@ -202,12 +234,35 @@ WatershedModule<TInputPixelType>
   // Execute the filters and progressively remove temporary memory
   this->SetCurrentFilterProgressWeight( 0.2 );
   this->SetUpdateMessage("Preprocessing with gradient magnitude...");
-  m_GradientMagnitudeFilter->Update();
+  if( m_GradientImage )
+    {
+    this->SkipCurrentFilter();
+    }
+  else
+    {
+    m_GradientMagnitudeFilter->Update();
+    m_GradientImage = m_GradientMagnitudeFilter->GetOutput();
+    m_GradientImage->DisconnectPipeline();
+    m_GradientImage->ReleaseDataFlagOff();
+    cache.Insert( gradientKey.str(), m_GradientImage, 
+                  totalNumberOfPixels * sizeof( RealPixelType ) );
+    }
+  m_WatershedFilter->SetInput( m_GradientImage );
 
   this->SetCurrentFilterProgressWeight( 0.8 );
   this->SetUpdateMessage("Computing watersheds...");
   m_WatershedFilter->Update();
 
+  if( m_WatershedFilter != cachedWatershedFilter )
+    {
+    // Basic segmentation and relabeled output, both of unsigned long,
+    // and the gradient magnitude input that the filter keeps alive even
+    // once the gradient entry is released
+    cache.Insert( watershedKey.str(), m_WatershedFilter,
+                  2 * totalNumberOfPixels * sizeof( unsigned long ) +
+                  totalNumberOfPixels * sizeof( RealPixelType ) );
+    }
+
   if( m_PerformPostprocessing )
     {
     this->PostProcessData( pds );
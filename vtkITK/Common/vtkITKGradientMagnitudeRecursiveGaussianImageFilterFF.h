@@ -26,16 +26,6 @@ class VTK_EXPORT vtkITKGradientMagnitudeRecursiveGaussianImageFilterFF : public
   vtkTypeRevisionMacro(vtkITKGradientMagnitudeRecursiveGaussianImageFilterFF, vtkITKImageToImageFilterFF);
 
 
-  // Description:
-  // vtkITK filters can be told to release their bulk output data
-  // during a pipeline update.  Setting the
-  // ReleaseDataBeforeUpdateFlag can minimize peak memory utilization
-  // during a pipeline update.
-  virtual void SetReleaseDataBeforeUpdateFlag(int i)
-    { DelegateSetMacro(ReleaseDataBeforeUpdateFlag, i); }
-  virtual int GetReleaseDataBeforeUpdateFlag()
-    { DelegateGetMacro(ReleaseDataBeforeUpdateFlag); }
-
   // Description:
   // Set the standard deviation of the gaussian used for smoothing
   // (measured in mm).
@@ -1,6 +1,17 @@
 // .NAME vtkITKImageToImageFilter - Abstract base class for connecting ITK and VTK
 // .SECTION Description
 // vtkITKImageToImageFilter provides a foo
+//
+// The VTK input is handed to ITK through vtkImageExport and
+// itk::VTKImageImport, which wrap the VTK scalars as the ITK pixel
+// container without copying them. The ITK output goes back through
+// itk::VTKImageExport and vtkImageImport, whose output scalars are the
+// ITK output buffer. The input is only cast, which copies it, when its
+// scalar type is not the pixel type of the ITK filter.
+//
+// The output scalars belong to the ITK filter. If the output is still
+// used when this filter is deleted, it gets its own copy of them first,
+// in the destructor of the subclass that holds the ITK pipeline.
 
 #ifndef __vtkITKImageToImageFilter_h
 #define __vtkITKImageToImageFilter_h
@@ -14,6 +25,8 @@
 #include "vtkImageToImageFilter.h"
 #include "vtkImageCast.h"
 #include "vtkImageData.h"
+#include "vtkPointData.h"
+#include "vtkDataArray.h"
 
 #ifdef VTK_USE_EXECUTIVES
 #include "vtkExecutive.h"
@@ -49,8 +62,9 @@ public:
   // Description:
   // vtkITK filters typically cast their input to pixel type
   // consistent with the particular instantiation of the ITK filter.
-  // If we know the types are going to be consistent, we can save
-  // memory by skipping the cast. Default is to cast.
+  // The cast is skipped when the input already has that scalar type,
+  // and the input scalars are then used by ITK in place. Turning
+  // CastInput off skips it for any type. Default is to cast.
   vtkBooleanMacro(CastInput, int);
   vtkSetMacro(CastInput, int);
   vtkGetMacro(CastInput, int);
@@ -60,8 +74,24 @@ public:
   // during a pipeline update.  Setting the
   // ReleaseDataBeforeUpdateFlag can minimize peak memory utilization
   // during a pipeline update.
-  virtual void SetReleaseDataBeforeUpdateFlag(int ) {};
-  virtual int GetReleaseDataBeforeUpdateFlag() {return 0;};
+  // The previous output, in ITK and in VTK, is then released before the
+  // ITK filter runs, so that it only holds its input and its new output.
+  virtual void SetReleaseDataBeforeUpdateFlag(int f)
+  {
+    if (this->m_Process)
+      {
+      this->m_Process->SetReleaseDataBeforeUpdateFlag( f != 0 );
+      }
+    if (this->ReleaseDataBeforeUpdateFlag != f)
+      {
+      this->ReleaseDataBeforeUpdateFlag = f;
+      this->vtkObject::Modified();
+      }
+  };
+  virtual int GetReleaseDataBeforeUpdateFlag()
+  {
+    return this->ReleaseDataBeforeUpdateFlag;
+  };
   vtkBooleanMacro(ReleaseDataBeforeUpdateFlag, int);
   
   // Description:
@@ -73,6 +103,8 @@ public:
     this->vtkExporter->PrintSelf ( os, indent );
     this->vtkImporter->PrintSelf ( os, indent );
     os << indent << "CastInput: " << (this->CastInput ? "On" : "Off") << std::endl;
+    os << indent << "ReleaseDataBeforeUpdateFlag: "
+       << (this->ReleaseDataBeforeUpdateFlag ? "On" : "Off") << std::endl;
   };
   
   // Description:
@@ -176,21 +208,7 @@ public:
   // this class's GetOutput(). vtkSource's GetOutput is not virtual.
   void Update()
     {
-      // Wire the internal pipeline according to how the user selected
-      // CastInput.
-      if (this->CastInput)
-        {
-        // set the pipeline to do an internal cast to a pixeltype
-        // consistent with the ITK instantiation
-        this->vtkExporter->SetInput( this->vtkCast->GetOutput() );
-        }
-      else
-        {
-        // skip the cast operation
-        this->vtkExporter->SetInput( 
-          static_cast<vtkImageData *>(this->vtkCast->GetInput()) );
-        }
-      
+      this->PrepareUpdate();
       
       // Force the internal pipeline to update.
       if (this->GetOutput(0))
@@ -207,21 +225,7 @@ public:
   // this class's GetOutput(). vtkSource's GetOutput is not virtual.
   void UpdateWholeExtent()
     {
-      // Wire the internal pipeline according to how the user selected
-      // CastInput.
-      if (this->CastInput)
-        {
-        // set the pipeline to do an internal cast to a pixeltype
-        // consistent with the ITK instantiation
-        this->vtkExporter->SetInput( this->vtkCast->GetOutput() );
-        }
-      else
-        {
-        // skip the cast operation
-        this->vtkExporter->SetInput( 
-          static_cast<vtkImageData *>(this->vtkCast->GetInput() ));
-        }
-      
+      this->PrepareUpdate();
       
       // Force the internal pipeline to update.
       if (this->GetOutput(0))
@@ -251,6 +255,87 @@ public:
  protected:
 
   // BTX
+  // Wire the internal pipeline according to how the user selected
+  // CastInput and to the input scalar type, and release the previous
+  // output if asked to.
+  void PrepareUpdate()
+    {
+      vtkImageData *input =
+        static_cast<vtkImageData *>(this->vtkCast->GetInput());
+      int cast = this->CastInput;
+      if (input)
+        {
+        input->UpdateInformation();
+        }
+      if (cast && input)
+        {
+        // the ITK importer can use the input scalars in place, unless
+        // the ITK filter writes its output over them
+        cast = (input->GetScalarType() != this->vtkCast->GetOutputScalarType()
+                || this->ProcessRunsInPlace());
+        }
+
+      if (cast)
+        {
+        // set the pipeline to do an internal cast to a pixeltype
+        // consistent with the ITK instantiation
+        this->vtkExporter->SetInput( this->vtkCast->GetOutput() );
+        }
+      else
+        {
+        // skip the cast operation, and drop a previous cast output
+        this->vtkExporter->SetInput( input );
+        this->vtkCast->GetOutput()->ReleaseData();
+        }
+
+      // The output scalars point to the ITK buffer, which the ITK filter
+      // releases when it runs again
+      vtkImageData *output = this->GetOutput(0);
+      if (this->ReleaseDataBeforeUpdateFlag && output && input && this->m_Process)
+        {
+        unsigned long t = this->GetMTime();
+        if (input->GetPipelineMTime() > t)
+          {
+          t = input->GetPipelineMTime();
+          }
+        if (this->m_Process->GetMTime() > t)
+          {
+          t = this->m_Process->GetMTime();
+          }
+        if (t > output->GetUpdateTime())
+          {
+          output->ReleaseData();
+          }
+        }
+    }
+
+  // Description:
+  // Whether the ITK filter reuses its input buffer for its output. The
+  // subclasses whose input and output types match override it.
+  virtual int ProcessRunsInPlace()
+    {
+      return 0;
+    }
+
+  // Description:
+  // Give the output its own copy of the scalars, which are otherwise the
+  // buffer of the ITK output, when it is still used downstream. Called
+  // by the subclasses before their ITK pipeline is released.
+  void DetachOutputFromITK()
+    {
+      vtkImageData *output = this->vtkImporter->GetOutput();
+      vtkDataArray *scalars =
+        output ? output->GetPointData()->GetScalars() : NULL;
+      if (!scalars || output->GetReferenceCount() <= 1)
+        {
+        return;
+        }
+      vtkDataArray *copy = scalars->NewInstance();
+      copy->DeepCopy(scalars);
+      output->GetPointData()->SetScalars(copy);
+      copy->Delete();
+    }
+
   // Dummy ExecuteData
   void ExecuteData (vtkDataObject *)
   {
@@ -274,6 +359,7 @@ public:
     this->m_EndEventCommand->SetCallbackFunction ( this, &vtkITKImageToImageFilter::HandleEndEvent );
     // default is to cast the input pixel type
     this->CastInput = 1;
+    this->ReleaseDataBeforeUpdateFlag = 0;
   };
   ~vtkITKImageToImageFilter()
   {
@@ -311,6 +397,7 @@ public:
   //ETX
 
   int CastInput;
+  int ReleaseDataBeforeUpdateFlag;
   
 private:
   vtkITKImageToImageFilter(const vtkITKImageToImageFilter&);  // Not implemented.
@@ -9,6 +9,7 @@
 #include "vtkITKImageToImageFilter.h"
 #include "vtkImageToImageFilter.h"
 #include "itkImageToImageFilter.h"
+#include "itkInPlaceImageFilter.h"
 #include "itkVTKImageExport.h"
 #include "itkVTKImageImport.h"
 #include "vtkITKUtility.h"
@@ -58,8 +59,19 @@ protected:
     this->vtkCast->SetOutputScalarTypeToFloat ();
   };
 
+  // An ITK filter running in place would overwrite the VTK input
+  virtual int ProcessRunsInPlace()
+  {
+    typedef itk::InPlaceImageFilter<InputImageType,OutputImageType> InPlaceFilterType;
+    InPlaceFilterType *inPlace =
+      dynamic_cast<InPlaceFilterType *>(m_Filter.GetPointer());
+    return inPlace && inPlace->GetInPlace();
+  };
+
   ~vtkITKImageToImageFilter2DFF()
   {
+    // before m_Filter and the exporter release the output buffer
+    this->DetachOutputFromITK();
   };
   //ETX
   
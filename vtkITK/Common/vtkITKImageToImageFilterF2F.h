@@ -60,6 +60,8 @@ protected:
 
   ~vtkITKImageToImageFilterF2F()
   {
+    // before m_Filter and the exporter release the output buffer
+    this->DetachOutputFromITK();
   };
   //ETX
   
@@ -9,6 +9,7 @@
 #include "vtkITKImageToImageFilter.h"
 #include "vtkImageToImageFilter.h"
 #include "itkImageToImageFilter.h"
+#include "itkInPlaceImageFilter.h"
 #include "itkVTKImageExport.h"
 #include "itkVTKImageImport.h"
 #include "vtkITKUtility.h"
@@ -57,8 +58,19 @@ protected:
     this->itkExporter->SetInput ( m_Filter->GetOutput() );
   };
 
+  // An ITK filter running in place would overwrite the VTK input
+  virtual int ProcessRunsInPlace()
+  {
+    typedef itk::InPlaceImageFilter<InputImageType,OutputImageType> InPlaceFilterType;
+    InPlaceFilterType *inPlace =
+      dynamic_cast<InPlaceFilterType *>(m_Filter.GetPointer());
+    return inPlace && inPlace->GetInPlace();
+  };
+
   ~vtkITKImageToImageFilterF3F3()
   {
+    // before m_Filter and the exporter release the output buffer
+    this->DetachOutputFromITK();
   };
   //ETX
   
@@ -56,6 +56,8 @@ protected:
 
   ~vtkITKImageToImageFilterFUL()
   {
+    // before m_Filter and the exporter release the output buffer
+    this->DetachOutputFromITK();
   };
   //ETX
   
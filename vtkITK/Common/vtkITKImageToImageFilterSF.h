@@ -69,6 +69,8 @@ protected:
 
   ~vtkITKImageToImageFilterSF()
   {
+    // before m_Filter and the exporter release the output buffer
+    this->DetachOutputFromITK();
   };
   //ETX
   
@@ -62,6 +62,8 @@ protected:
 
   ~vtkITKImageToImageFilterSUL()
   {
+    // before m_Filter and the exporter release the output buffer
+    this->DetachOutputFromITK();
   };
   //ETX
     
@@ -57,6 +57,8 @@ protected:
 
   ~vtkITKImageToImageFilterUSUL()
   {
+    // before m_Filter and the exporter release the output buffer
+    this->DetachOutputFromITK();
   };
   //ETX
     
@@ -0,0 +1,107 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    vtkITKRelabelComponentImageFilterTest.cxx
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) 2002 Insight Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+// Relabels an unsigned long label map, which the filter imports without
+// a cast, with the ITK filter in place, and checks that the VTK input is
+// left unchanged and that the output is relabeled.
+
+#include "vtkITKRelabelComponentImageFilter.h"
+#include "vtkImageData.h"
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+
+int main( int, char *[] )
+{
+  const int n = 16;
+
+  // a small object labeled 9 and a larger one labeled 5
+  vtkImageData *image = vtkImageData::New();
+  image->SetDimensions( n, n, n );
+  image->SetScalarTypeToUnsignedLong();
+  image->SetNumberOfScalarComponents( 1 );
+  image->AllocateScalars();
+
+  unsigned long *labels =
+    static_cast<unsigned long *>( image->GetScalarPointer() );
+  const int numberOfPixels = n * n * n;
+  for ( int i = 0; i < numberOfPixels; i++ )
+    {
+    const int x = i % n;
+    const int z = i / ( n * n );
+    labels[i] = 0;
+    if ( z < 4 && x < 4 )
+      {
+      labels[i] = 9;
+      }
+    else if ( z >= 8 )
+      {
+      labels[i] = 5;
+      }
+    }
+  std::vector<unsigned long> original( labels, labels + numberOfPixels );
+
+  vtkITKRelabelComponentImageFilter *filter =
+    vtkITKRelabelComponentImageFilter::New();
+  filter->InPlaceOn();
+  filter->SetInput( image );
+  filter->GetOutput()->Update();
+
+  int status = EXIT_SUCCESS;
+
+  int changed = 0;
+  for ( int i = 0; i < numberOfPixels; i++ )
+    {
+    if ( labels[i] != original[i] )
+      {
+      changed++;
+      }
+    }
+  if ( changed > 0 )
+    {
+    std::cerr << changed << " pixels of the input were overwritten" << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  // the largest object becomes 1 and the smallest 2
+  const unsigned long *relabeled = static_cast<const unsigned long *>(
+    filter->GetOutput()->GetScalarPointer() );
+  int wrong = 0;
+  for ( int i = 0; i < numberOfPixels; i++ )
+    {
+    const unsigned long expected =
+      original[i] == 5 ? 1 : ( original[i] == 9 ? 2 : 0 );
+    if ( relabeled[i] != expected )
+      {
+      wrong++;
+      }
+    }
+  std::cout << "Objects: " << filter->GetNumberOfObjects()
+            << ", wrong output pixels: " << wrong << std::endl;
+  if ( wrong > 0 || filter->GetNumberOfObjects() != 2 )
+    {
+    std::cerr << "The output is not relabeled" << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  filter->Delete();
+  image->Delete();
+
+  return status;
+}
@@ -30,16 +30,6 @@ class VTK_EXPORT vtkITKWatershedImageFilterSUL : public vtkITKImageToImageFilter
   void SetLevel ( double d ) { DelegateSetMacro ( Level, d ); };
   double GetLevel () { DelegateGetMacro ( Level ); };
 
-  // Description:
-  // vtkITK filters can be told to release their bulk output data
-  // during a pipeline update.  Setting the
-  // ReleaseDataBeforeUpdateFlag can minimize peak memory utilization
-  // during a pipeline update.
-  virtual void SetReleaseDataBeforeUpdateFlag(int i)
-    { DelegateSetMacro(ReleaseDataBeforeUpdateFlag, i); }
-  virtual int GetReleaseDataBeforeUpdateFlag()
-    { DelegateGetMacro(ReleaseDataBeforeUpdateFlag); }
-
 protected:
   //BTX
   typedef itk::WatershedImageFilter<Superclass::InputImageType> ImageFilterType;